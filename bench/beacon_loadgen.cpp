@@ -0,0 +1,421 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// End-to-end load generator. Opens publisher and subscriber connections to a broker,
+// publishes at a fixed rate per publisher and prints throughput and latency percentiles as
+// JSON. Without --uri an in-process broker is started on a local port.
+//
+// Usage: beacon_loadgen [--uri=ws://host:port/] [--publishers=4] [--subscribers=4]
+//                       [--rate=1000] [--duration=10] [--warmup=2] [--drain=2] [--batch=1]
+//                       [--payload=flat|nested|array] [--payload-bytes=256] [--topics=4]
+//                       [--filtered=0] [--conflated=0] [--threads=<cores>]
+//
+// --rate is events/sec per publisher and --batch events per publish_batch (0 publishes them
+// one by one with "publish", which is not acknowledged). --filtered and --conflated are the
+// shares of subscribers with a payload filter (matching half the publishers) and with
+// conflated delivery.
+//
+// Latencies are free of coordinated omission: the schedule is open loop, and every event is
+// timed from when it was due to be sent, not from when the generator got around to sending
+// it. A generator that falls behind thus shows up as latency, and as send_lag, which is how
+// late it sent. Events due during the warmup are sent but not recorded.
+//
+#include <beacon/broker.h>
+#include <beacon/hdr_histogram.h>
+#include <beacon/websocket_adapter.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using beacon::ConnectionId;
+using beacon::HdrHistogram;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Options {
+        std::string uri;
+        std::size_t publishers = 4;
+        std::size_t subscribers = 4;
+        double rate = 1000.0;
+        double duration = 10.0;
+        double warmup = 2.0;
+        double drain = 2.0;
+        std::size_t batch = 1;
+        std::string payload = "flat";
+        std::size_t payload_bytes = 256;
+        std::size_t topics = 4;
+        double filtered = 0.0;
+        double conflated = 0.0;
+        std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    };
+
+    Options parse_options(int argc, char **argv) {
+        std::map<std::string, std::string> args;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const auto equals = arg.find('=');
+            if (arg.rfind("--", 0) != 0 || equals == std::string::npos) {
+                throw std::invalid_argument("expected --name=value, got " + arg);
+            }
+            args[arg.substr(2, equals - 2)] = arg.substr(equals + 1);
+        }
+
+        Options options;
+        auto take = [&args](const char *name, auto &field) {
+            const auto it = args.find(name);
+            if (it == args.end()) return;
+            if constexpr (std::is_same_v<std::decay_t<decltype(field)>, std::string>) {
+                field = it->second;
+            } else if constexpr (std::is_same_v<std::decay_t<decltype(field)>, double>) {
+                field = std::stod(it->second);
+            } else {
+                field = std::stoul(it->second);
+            }
+            args.erase(it);
+        };
+        take("uri", options.uri);
+        take("publishers", options.publishers);
+        take("subscribers", options.subscribers);
+        take("rate", options.rate);
+        take("duration", options.duration);
+        take("warmup", options.warmup);
+        take("drain", options.drain);
+        take("batch", options.batch);
+        take("payload", options.payload);
+        take("payload-bytes", options.payload_bytes);
+        take("topics", options.topics);
+        take("filtered", options.filtered);
+        take("conflated", options.conflated);
+        take("threads", options.threads);
+        if (!args.empty()) throw std::invalid_argument("unknown option --" + args.begin()->first);
+        if (options.payload != "flat" && options.payload != "nested" && options.payload != "array") {
+            throw std::invalid_argument("--payload must be flat, nested or array");
+        }
+        options.topics = std::max<std::size_t>(options.topics, 1);
+        return options;
+    }
+
+    std::int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    HdrHistogram latency_histogram() {
+        // 1 us to 100 s, three digits
+        return HdrHistogram(1000, 100'000'000'000ULL, 3);
+    }
+
+    /**
+     * Payload fields after the timestamp, padded to roughly `bytes`.
+     */
+    std::string payload_body(const std::string &shape, std::size_t publisher, std::size_t bytes) {
+        json body;
+        if (shape == "flat") {
+            body = {{"lg_p", publisher}, {"region", "eu-west"}, {"price", 129.95}, {"sku", "SKU-000000000042"}};
+        } else if (shape == "nested") {
+            body = {
+                {"lg_p", publisher},
+                {"order", {
+                    {"customer", {{"id", "c-1042"}, {"tier", "gold"}, {"address", {{"city", "Porto"}, {"zip", "4000"}}}}},
+                    {"items", json::array({{{"sku", "A1"}, {"qty", 2}}, {{"sku", "B7"}, {"qty", 1}}})}
+                }}
+            };
+        } else {
+            body = {{"lg_p", publisher}, {"values", json::array()}};
+            while (body.dump().size() + 8 < bytes) body["values"].push_back(0.125);
+        }
+        const std::size_t size = body.dump().size();
+        if (size + 10 < bytes) body["pad"] = std::string(bytes - size - 10, 'x');
+
+        std::string text = body.dump();
+        return text.substr(1, text.size() - 2); // without the braces, to splice after lg_t
+    }
+
+    /**
+     * State of one connection, only touched on the core that serves it.
+     */
+    struct Connection {
+        enum class Role { Publisher, Subscriber } role;
+        std::size_t index = 0;
+        ConnectionId id = 0;
+        std::size_t core = 0;
+
+        // publisher
+        std::string body;
+        std::string producer;
+        std::uint64_t sent_events = 0;
+        std::uint64_t next_sequence = 1;
+        std::deque<std::int64_t> unacked; // due time of the last event of each batch, by sequence
+
+        // both
+        HdrHistogram ack_latency = latency_histogram();
+        HdrHistogram deliver_latency = latency_histogram();
+        HdrHistogram send_lag = latency_histogram();
+        std::uint64_t acked_batches = 0;
+        std::uint64_t measured_sent = 0;
+        std::uint64_t measured_delivered = 0;
+        std::uint64_t errors = 0;
+    };
+
+    json summary(const HdrHistogram &histogram) {
+        auto us = [](std::uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+        return {
+            {"count", histogram.count()},
+            {"p50", us(histogram.value_at_percentile(50))},
+            {"p90", us(histogram.value_at_percentile(90))},
+            {"p99", us(histogram.value_at_percentile(99))},
+            {"p999", us(histogram.value_at_percentile(99.9))},
+            {"max", us(histogram.max())},
+            {"mean", histogram.mean() / 1000.0}
+        };
+    }
+
+    class LoadGenerator {
+    public:
+        explicit LoadGenerator(Options options)
+            : options_(std::move(options)),
+              adapter_(beacon::ratelimit::RateLimitConfig{}, options_.threads) {
+            adapter_.on_message([this](ConnectionId id, json &&message) { on_message(id, std::move(message)); });
+            adapter_.on_close([this](ConnectionId id) {
+                if (!stopping_) std::cerr << "connection " << id << " closed" << std::endl;
+            });
+
+            for (std::size_t i = 0; i < options_.subscribers; ++i) add(Connection::Role::Subscriber, i);
+            for (std::size_t i = 0; i < options_.publishers; ++i) add(Connection::Role::Publisher, i);
+        }
+
+        json run() {
+            std::thread io([this]() { adapter_.run(); });
+
+            for (auto &[id, connection]: connections_) {
+                if (connection.role == Connection::Role::Subscriber) subscribe(connection);
+            }
+            const auto subscribe_deadline = Clock::now() + std::chrono::seconds(10);
+            while (subscribed_ < options_.subscribers && Clock::now() < subscribe_deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+
+            start_ns_ = now_ns() + 100'000'000;
+            measure_from_ns_ = start_ns_ + static_cast<std::int64_t>(options_.warmup * 1e9);
+            end_ns_ = start_ns_ + static_cast<std::int64_t>(options_.duration * 1e9);
+            for (auto &[id, connection]: connections_) {
+                if (connection.role != Connection::Role::Publisher) continue;
+                adapter_.post(connection.core, [this, &connection]() { tick(connection); });
+            }
+
+            std::this_thread::sleep_for(std::chrono::duration<double>(
+                static_cast<double>(end_ns_ - now_ns()) / 1e9 + options_.drain));
+            stopping_ = true;
+            adapter_.stop();
+            io.join();
+            return report();
+        }
+
+    private:
+        void add(Connection::Role role, std::size_t index) {
+            const ConnectionId id = adapter_.connect(options_.uri);
+            Connection &connection = connections_[id];
+            connection.role = role;
+            connection.index = index;
+            connection.id = id;
+            connection.core = adapter_.core_of(id);
+            if (role == Connection::Role::Publisher) {
+                connection.body = payload_body(options_.payload, index, options_.payload_bytes);
+                connection.producer = "loadgen-" + std::to_string(::getpid()) + "-" + std::to_string(index);
+            }
+        }
+
+        void subscribe(const Connection &connection) {
+            const std::size_t i = connection.index;
+            json request = {{"op", "subscribe"}, {"topic", "loadgen-" + std::to_string(i % options_.topics)}};
+            // spread the mixes over the subscribers evenly
+            auto in_share = [i, this](double share) {
+                return static_cast<std::size_t>(static_cast<double>(i + 1) * share) >
+                       static_cast<std::size_t>(static_cast<double>(i) * share);
+            };
+            if (in_share(options_.filtered)) {
+                request["filter"] = {{"lg_p", {{"lt", std::max<std::size_t>(options_.publishers / 2, 1)}}}};
+            }
+            if (in_share(options_.conflated)) request["mode"] = "conflated";
+            adapter_.send(connection.id, request.dump(), beacon::Lane::Control);
+        }
+
+        std::string event(const Connection &connection, std::uint64_t number, std::int64_t due_ns) const {
+            const std::size_t topic = (connection.index + number) % options_.topics;
+            return R"({"op":"publish","topic":"loadgen-)" + std::to_string(topic) +
+                   R"(","entity_id":"e-)" + std::to_string(number % 1024) +
+                   R"(","event_type":"loadgen","payload":{"lg_t":)" + std::to_string(due_ns) + "," +
+                   connection.body + "}}";
+        }
+
+        std::int64_t due_ns(std::uint64_t number) const {
+            return start_ns_ + static_cast<std::int64_t>(static_cast<double>(number) * 1e9 / options_.rate);
+        }
+
+        /**
+         * Sends every event that is due by now, then comes back in a millisecond.
+         */
+        void tick(Connection &connection) {
+            const std::int64_t now = now_ns();
+            const std::int64_t until = std::min(now, end_ns_);
+            const std::size_t batch = std::max<std::size_t>(options_.batch, 1);
+            while (true) {
+                const std::uint64_t last = connection.sent_events + batch - 1;
+                const std::int64_t last_due = due_ns(last);
+                if (last_due > until) break;
+
+                std::string frame;
+                if (options_.batch == 0) {
+                    frame = event(connection, last, last_due);
+                } else {
+                    frame = R"({"op":"publish_batch","producer":")" + connection.producer +
+                            R"(","sequence":)" + std::to_string(connection.next_sequence++) + R"(,"events":[)";
+                    for (std::uint64_t number = connection.sent_events; number <= last; ++number) {
+                        if (number != connection.sent_events) frame += ',';
+                        frame += event(connection, number, due_ns(number));
+                    }
+                    frame += "]}";
+                    connection.unacked.push_back(last_due);
+                }
+                adapter_.send(connection.id, std::move(frame));
+
+                if (last_due >= measure_from_ns_) {
+                    connection.send_lag.record(static_cast<std::uint64_t>(std::max<std::int64_t>(now - last_due, 0)));
+                    connection.measured_sent += batch;
+                }
+                connection.sent_events += batch;
+            }
+            if (now < end_ns_) {
+                adapter_.post_after(connection.core, std::chrono::milliseconds(1),
+                                    [this, &connection]() { tick(connection); });
+            }
+        }
+
+        void on_message(ConnectionId id, json &&message) {
+            const std::int64_t now = now_ns();
+            const auto it = connections_.find(id);
+            if (it == connections_.end()) return;
+            Connection &connection = it->second;
+
+            const std::string type = message.value("type", "");
+            if (type == "event") {
+                const auto due = message["payload"].value("lg_t", std::int64_t{0});
+                if (due >= measure_from_ns_) {
+                    connection.deliver_latency.record(static_cast<std::uint64_t>(std::max<std::int64_t>(now - due, 0)));
+                    ++connection.measured_delivered;
+                }
+            } else if (type == "ack") {
+                if (connection.unacked.empty()) return;
+                // batches of one producer are acknowledged in order
+                const std::int64_t due = connection.unacked.front();
+                connection.unacked.pop_front();
+                ++connection.acked_batches;
+                if (due >= measure_from_ns_) {
+                    connection.ack_latency.record(static_cast<std::uint64_t>(std::max<std::int64_t>(now - due, 0)));
+                }
+            } else if (type == "subscribed") {
+                ++subscribed_;
+            } else if (type == "error") {
+                ++connection.errors;
+                if (connection.errors == 1) std::cerr << "broker error: " << message.dump() << std::endl;
+            }
+        }
+
+        json report() const {
+            HdrHistogram ack = latency_histogram();
+            HdrHistogram deliver = latency_histogram();
+            HdrHistogram lag = latency_histogram();
+            std::uint64_t sent = 0;
+            std::uint64_t delivered = 0;
+            std::uint64_t errors = 0;
+            for (const auto &[id, connection]: connections_) {
+                ack.merge(connection.ack_latency);
+                deliver.merge(connection.deliver_latency);
+                lag.merge(connection.send_lag);
+                sent += connection.measured_sent;
+                delivered += connection.measured_delivered;
+                errors += connection.errors;
+            }
+
+            const double seconds = std::max(options_.duration - options_.warmup, 1e-9);
+            return {
+                {"config", {
+                    {"uri", options_.uri},
+                    {"publishers", options_.publishers},
+                    {"subscribers", options_.subscribers},
+                    {"rate_per_publisher", options_.rate},
+                    {"duration_secs", options_.duration},
+                    {"warmup_secs", options_.warmup},
+                    {"batch", options_.batch},
+                    {"payload", options_.payload},
+                    {"payload_bytes", options_.payload_bytes},
+                    {"topics", options_.topics},
+                    {"filtered", options_.filtered},
+                    {"conflated", options_.conflated},
+                    {"threads", options_.threads}
+                }},
+                {"subscribed", subscribed_.load()},
+                {"errors", errors},
+                {"throughput", {
+                    {"target_events_per_sec", options_.rate * static_cast<double>(options_.publishers)},
+                    {"published_events_per_sec", static_cast<double>(sent) / seconds},
+                    {"delivered_events_per_sec", static_cast<double>(delivered) / seconds}
+                }},
+                {"latency_us", {
+                    {"publish_to_ack", summary(ack)},
+                    {"publish_to_deliver", summary(deliver)},
+                    {"send_lag", summary(lag)}
+                }}
+            };
+        }
+
+        Options options_;
+        beacon::WebSocketAdapter adapter_;
+        // filled before the adapter runs, read-only afterwards
+        std::map<ConnectionId, Connection> connections_;
+        std::atomic<std::size_t> subscribed_{0};
+        std::atomic<bool> stopping_{false};
+        std::int64_t start_ns_ = 0;
+        std::int64_t measure_from_ns_ = 0;
+        std::int64_t end_ns_ = 0;
+    };
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << "beacon_loadgen: " << e.what() << std::endl;
+        return 2;
+    }
+
+    std::unique_ptr<beacon::WebSocketAdapter> adapter;
+    std::unique_ptr<beacon::Broker> broker;
+    std::thread broker_thread;
+    if (options.uri.empty()) {
+        const std::uint16_t port = 17091;
+        adapter = std::make_unique<beacon::WebSocketAdapter>(beacon::ratelimit::RateLimitConfig{},
+                                                             std::max(1u, std::thread::hardware_concurrency()));
+        broker = std::make_unique<beacon::Broker>(*adapter);
+        adapter->listen(port);
+        broker_thread = std::thread([&adapter]() { adapter->run(); });
+        options.uri = "ws://127.0.0.1:" + std::to_string(port) + "/";
+    }
+
+    const json result = LoadGenerator(options).run();
+    std::cout << result.dump(2) << std::endl;
+
+    if (adapter) {
+        adapter->stop();
+        broker_thread.join();
+    }
+    return 0;
+}
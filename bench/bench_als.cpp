@@ -0,0 +1,82 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Trains weighted ALS on synthetic implicit feedback (1M users x 100k items, 20 interactions
+// per user, item popularity Zipf distributed, by default) and prints per-iteration timings
+// as JSON.
+// Usage: bench_als [users] [items] [per user] [factors] [iterations] [threads]
+//
+#include <beacon/als.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using beacon::reco::AlsConfig;
+using beacon::reco::AlsIteration;
+using beacon::reco::CsrMatrix;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char **argv) {
+    const std::size_t users = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const std::size_t items = argc > 2 ? std::stoul(argv[2]) : 100000;
+    const std::size_t per_user = argc > 3 ? std::stoul(argv[3]) : 20;
+    AlsConfig config;
+    config.factors = argc > 4 ? std::stoul(argv[4]) : 64;
+    config.iterations = argc > 5 ? std::stoul(argv[5]) : 3;
+    config.threads = argc > 6 ? std::stoul(argv[6]) : std::max(1u, std::thread::hardware_concurrency());
+
+    // Zipf(1) popularity by inverse CDF
+    std::vector<double> popularity(items);
+    double total = 0.0;
+    for (std::size_t i = 0; i < items; ++i) popularity[i] = total += 1.0 / static_cast<double>(i + 1);
+    std::mt19937_64 rng(17);
+    std::uniform_real_distribution<double> unit(0.0, total);
+    std::uniform_int_distribution<int> kind(0, 9);
+
+    std::vector<beacon::reco::Triplet> triplets;
+    triplets.reserve(users * per_user);
+    for (std::size_t user = 0; user < users; ++user) {
+        for (std::size_t i = 0; i < per_user; ++i) {
+            const auto item = static_cast<std::size_t>(
+                std::upper_bound(popularity.begin(), popularity.end(), unit(rng)) - popularity.begin());
+            triplets.push_back({static_cast<std::uint32_t>(user), static_cast<std::uint32_t>(std::min(item, items - 1)),
+                                kind(rng) < 8 ? 1.0f : 2.0f});
+        }
+    }
+    const auto load_start = Clock::now();
+    const CsrMatrix user_items = CsrMatrix::from_triplets(users, items, std::move(triplets));
+    const double load_seconds = std::chrono::duration<double>(Clock::now() - load_start).count();
+
+    json iterations = json::array();
+    const auto train_start = Clock::now();
+    const beacon::reco::AlsModel model = beacon::reco::train_als(user_items, config, [&iterations](const AlsIteration &it) {
+        iterations.push_back({
+            {"iteration", it.iteration},
+            {"gram_seconds", it.gram_seconds},
+            {"user_seconds", it.user_seconds},
+            {"item_seconds", it.item_seconds}
+        });
+    });
+    const double train_seconds = std::chrono::duration<double>(Clock::now() - train_start).count();
+
+    std::cout << json{
+        {"users", users},
+        {"items", items},
+        {"nonzeros", user_items.nonzeros()},
+        {"factors", config.factors},
+        {"threads", config.threads},
+        {"cg_steps", config.cg_steps},
+        {"csr_seconds", load_seconds},
+        {"train_seconds", train_seconds},
+        {"seconds_per_iteration", train_seconds / static_cast<double>(config.iterations)},
+        {"factor_mb", static_cast<double>((model.users.size() + model.items.size()) * sizeof(float)) / 1e6},
+        {"iterations", iterations}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,210 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Fan-out throughput against the number of cores. The sharded variant gives every core its
+// own SubscriptionRegistry and passes published events between cores through a CoreMesh,
+// like Broker does; the baseline shares one registry behind a mutex. Prints events/sec and
+// deliveries/sec per core count as JSON. Usage: bench_core_fanout [max_cores]
+//
+#include <beacon/core_mesh.h>
+#include <beacon/subscription_registry.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+using beacon::CoreMesh;
+using beacon::Subscription;
+using beacon::SubscriptionRegistry;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    constexpr int kSubscriptions = 200000;
+    constexpr int kTopics = 16;
+    constexpr int kRegions = 50;
+    constexpr int kEvents = 40000;
+    constexpr int kPublishBatch = 32;
+
+    struct Event {
+        std::string topic;
+        json payload;
+        std::once_flag serialized;
+        std::string frame;
+
+        const std::string &serialize() {
+            std::call_once(serialized, [this]() {
+                frame = json{{"type", "event"}, {"topic", topic}, {"payload", payload}}.dump();
+            });
+            return frame;
+        }
+    };
+
+    struct alignas(64) CoreState {
+        SubscriptionRegistry registry;
+        std::vector<const Subscription *> matched;
+        std::size_t deliveries = 0;
+        std::size_t bytes = 0;
+
+        void deliver(Event &event) {
+            matched.clear();
+            registry.match(event.topic, event.payload, matched);
+            if (matched.empty()) return;
+            const std::string &frame = event.serialize();
+            // stands in for queueing the frame on each subscriber's connection
+            for (const Subscription *subscription: matched) {
+                bytes += frame.size() + subscription->connection % 2;
+            }
+            deliveries += matched.size();
+        }
+    };
+
+    Subscription make_subscription(std::mt19937 &rng, std::uint64_t connection) {
+        Subscription subscription;
+        subscription.connection = connection;
+        subscription.topic = "topic-" + std::to_string(rng() % kTopics);
+        subscription.filter = beacon::filter::parse_filter({{"region", "r" + std::to_string(rng() % kRegions)}});
+        return subscription;
+    }
+
+    std::vector<std::shared_ptr<Event> > make_events() {
+        std::mt19937 rng(11);
+        std::vector<std::shared_ptr<Event> > events;
+        events.reserve(kEvents);
+        for (int i = 0; i < kEvents; ++i) {
+            auto event = std::make_shared<Event>();
+            event->topic = "topic-" + std::to_string(rng() % kTopics);
+            event->payload = {{"region", "r" + std::to_string(rng() % kRegions)}, {"seq", i}};
+            events.push_back(std::move(event));
+        }
+        return events;
+    }
+
+    double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    /**
+     * Returns {seconds, deliveries}.
+     */
+    std::pair<double, std::size_t> run_sharded(std::size_t cores) {
+        std::vector<CoreState> states(cores);
+        std::mt19937 rng(5);
+        for (int i = 0; i < kSubscriptions; ++i) {
+            // connections are spread over the cores, each core registers its own
+            const auto connection = static_cast<std::uint64_t>(i);
+            states[connection % cores].registry.add(make_subscription(rng, connection));
+        }
+
+        const auto events = make_events();
+        CoreMesh<std::shared_ptr<Event> > mesh(cores);
+
+        const auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (std::size_t core = 0; core < cores; ++core) {
+            threads.emplace_back([&, core]() {
+                CoreState &state = states[core];
+                std::vector<std::size_t> mine;
+                for (std::size_t i = core; i < events.size(); i += cores) mine.push_back(i);
+                const std::size_t expected = events.size() - mine.size();
+
+                std::size_t published = 0;
+                std::size_t received = 0;
+                bool flushed = true;
+                while (published < mine.size() || !flushed || received < expected) {
+                    for (int k = 0; k < kPublishBatch && published < mine.size(); ++k, ++published) {
+                        const auto &event = events[mine[published]];
+                        state.deliver(*event);
+                        for (std::size_t other = 0; other < cores; ++other) {
+                            if (other != core) mesh.send(core, other, event);
+                        }
+                    }
+                    // the cores poll here, so nobody needs waking
+                    flushed = mesh.flush(core, [](std::size_t) {});
+                    received += mesh.drain(core, [&state](std::shared_ptr<Event> &event) {
+                        state.deliver(*event);
+                    });
+                }
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        const double seconds = seconds_since(start);
+
+        std::size_t deliveries = 0;
+        for (const CoreState &state: states) deliveries += state.deliveries;
+        return {seconds, deliveries};
+    }
+
+    std::pair<double, std::size_t> run_mutex(std::size_t cores) {
+        SubscriptionRegistry registry;
+        std::mutex mutex;
+        std::mt19937 rng(5);
+        for (int i = 0; i < kSubscriptions; ++i) {
+            registry.add(make_subscription(rng, static_cast<std::uint64_t>(i)));
+        }
+
+        const auto events = make_events();
+        std::vector<std::size_t> deliveries(cores * 8);
+
+        const auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (std::size_t core = 0; core < cores; ++core) {
+            threads.emplace_back([&, core]() {
+                std::vector<const Subscription *> matched;
+                std::size_t bytes = 0;
+                for (std::size_t i = core; i < events.size(); i += cores) {
+                    Event &event = *events[i];
+                    matched.clear();
+                    {
+                        const std::lock_guard lock(mutex);
+                        registry.match(event.topic, event.payload, matched);
+                    }
+                    if (matched.empty()) continue;
+                    const std::string &frame = event.serialize();
+                    for (const Subscription *subscription: matched) {
+                        bytes += frame.size() + subscription->connection % 2;
+                    }
+                    deliveries[core * 8] += matched.size();
+                }
+                deliveries[core * 8 + 1] = bytes;
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        const double seconds = seconds_since(start);
+
+        std::size_t total = 0;
+        for (std::size_t core = 0; core < cores; ++core) total += deliveries[core * 8];
+        return {seconds, total};
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t max_cores = argc > 1
+                                      ? std::stoul(argv[1])
+                                      : std::max(1u, std::thread::hardware_concurrency());
+
+    json results = json::array();
+    for (std::size_t cores = 1; cores <= max_cores; cores *= 2) {
+        const auto [sharded_seconds, sharded_deliveries] = run_sharded(cores);
+        const auto [mutex_seconds, mutex_deliveries] = run_mutex(cores);
+        results.push_back({
+            {"cores", cores},
+            {"sharded_events_per_sec", kEvents / sharded_seconds},
+            {"sharded_deliveries_per_sec", sharded_deliveries / sharded_seconds},
+            {"mutex_events_per_sec", kEvents / mutex_seconds},
+            {"mutex_deliveries_per_sec", mutex_deliveries / mutex_seconds},
+            {"deliveries_per_event", static_cast<double>(sharded_deliveries) / kEvents}
+        });
+    }
+
+    std::cout << json{
+        {"subscriptions", kSubscriptions},
+        {"events", kEvents},
+        {"hardware_concurrency", std::thread::hardware_concurrency()},
+        {"results", results}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Scores random queries against a matrix of random embeddings (1M x 64 by default) by brute
+// force with every kernel the CPU runs, on one thread, and prints latency and throughput per
+// instruction set as JSON, along with the largest score difference from the scalar kernel.
+// Usage: bench_embedding_topk [items] [dimension] [k] [dot|cosine]
+//
+#include <beacon/embedding_matrix.h>
+#include <beacon/hdr_histogram.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using beacon::HdrHistogram;
+using beacon::reco::EmbeddingMatrix;
+using beacon::reco::SimdLevel;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    constexpr std::size_t kQueries = 100;
+
+    json summary_ms(const HdrHistogram &histogram) {
+        return {
+            {"p50", static_cast<double>(histogram.value_at_percentile(50)) / 1e6},
+            {"p99", static_cast<double>(histogram.value_at_percentile(99)) / 1e6},
+            {"mean", histogram.mean() / 1e6}
+        };
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t items = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const std::size_t dimension = argc > 2 ? std::stoul(argv[2]) : 64;
+    const std::size_t k = argc > 3 ? std::stoul(argv[3]) : 10;
+    const beacon::reco::EmbeddingMetric metric = beacon::reco::parse_embedding_metric(argc > 4 ? argv[4] : "dot");
+
+    std::mt19937 rng(11);
+    std::normal_distribution<float> value(0.0f, 1.0f);
+    EmbeddingMatrix matrix(dimension);
+    std::vector<float> row(dimension);
+    for (std::size_t item = 0; item < items; ++item) {
+        for (float &v: row) v = value(rng);
+        matrix.set(static_cast<std::uint32_t>(item), row.data());
+    }
+    std::vector<std::vector<float> > queries(kQueries, std::vector<float>(dimension));
+    for (auto &query: queries) {
+        for (float &v: query) v = value(rng);
+    }
+
+    const double bytes = static_cast<double>(items) * static_cast<double>(dimension) * sizeof(float);
+    std::vector<std::vector<std::pair<float, std::uint32_t> > > scalar_results;
+    json kernels = json::array();
+    const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2, SimdLevel::Avx512};
+    for (const SimdLevel level: levels) {
+        if (level > beacon::reco::detect_simd()) break;
+        matrix.set_simd(level);
+        // one untimed pass to fault the matrix in
+        matrix.top_k(queries[0].data(), k, metric);
+
+        HdrHistogram latency(1000, 60'000'000'000ULL, 3);
+        double max_difference = 0.0;
+        const auto start = Clock::now();
+        for (std::size_t i = 0; i < kQueries; ++i) {
+            const auto query_start = Clock::now();
+            const auto result = matrix.top_k(queries[i].data(), k, metric);
+            latency.record(static_cast<std::uint64_t>((Clock::now() - query_start).count()));
+            if (level == SimdLevel::Scalar) {
+                scalar_results.push_back(result);
+            } else {
+                for (std::size_t j = 0; j < std::min(result.size(), scalar_results[i].size()); ++j) {
+                    max_difference = std::max(max_difference,
+                                              std::abs(static_cast<double>(result[j].first - scalar_results[i][j].first)));
+                }
+            }
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        kernels.push_back({
+            {"simd", beacon::reco::simd_name(level)},
+            {"query_ms", summary_ms(latency)},
+            {"items_per_sec", static_cast<double>(items * kQueries) / seconds},
+            {"gb_per_sec", bytes * static_cast<double>(kQueries) / seconds / 1e9},
+            {"max_score_difference", max_difference}
+        });
+    }
+
+    std::cout << json{
+        {"items", items},
+        {"dimension", dimension},
+        {"k", k},
+        {"matrix_mb", bytes / 1e6},
+        {"kernels", kernels}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Builds an HNSW index over synthetic clustered embeddings (100k x 64 by default) on several
+// threads, saves and reloads it, and prints build rate, file size and a recall@10 vs QPS
+// curve over ef, against brute force, as JSON.
+// Usage: bench_hnsw [items] [dimension] [m] [ef_construction] [threads]
+//
+#include <beacon/embedding_matrix.h>
+#include <beacon/hnsw_index.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using beacon::reco::EmbeddingMatrix;
+using beacon::reco::EmbeddingMetric;
+using beacon::reco::HnswConfig;
+using beacon::reco::HnswIndex;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    constexpr std::size_t kQueries = 1000;
+    constexpr std::size_t kClusters = 1000;
+    constexpr std::size_t kK = 10;
+
+    double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Gaussian clusters around random centers, the way trained embeddings bunch up
+    std::vector<float> clustered(std::size_t count, std::size_t dimension, const std::vector<float> &centers,
+                                 std::mt19937 &rng) {
+        std::normal_distribution<float> noise(0.0f, 0.5f);
+        std::uniform_int_distribution<std::size_t> center(0, kClusters - 1);
+        std::vector<float> points(count * dimension);
+        for (std::size_t i = 0; i < count; ++i) {
+            const float *base = centers.data() + center(rng) * dimension;
+            for (std::size_t d = 0; d < dimension; ++d) points[i * dimension + d] = base[d] + noise(rng);
+        }
+        return points;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t items = argc > 1 ? std::stoul(argv[1]) : 100000;
+    HnswConfig config;
+    config.dimension = argc > 2 ? std::stoul(argv[2]) : 64;
+    config.m = argc > 3 ? std::stoul(argv[3]) : 16;
+    config.ef_construction = argc > 4 ? std::stoul(argv[4]) : 200;
+    const std::size_t threads = argc > 5 ? std::stoul(argv[5]) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::mt19937 rng(13);
+    std::normal_distribution<float> value(0.0f, 1.0f);
+    std::vector<float> centers(kClusters * config.dimension);
+    for (float &v: centers) v = value(rng);
+    const std::vector<float> points = clustered(items, config.dimension, centers, rng);
+    const std::vector<float> queries = clustered(kQueries, config.dimension, centers, rng);
+    std::vector<std::uint32_t> labels(items);
+    for (std::uint32_t i = 0; i < items; ++i) labels[i] = i;
+
+    HnswIndex built(config);
+    const auto build_start = Clock::now();
+    built.add_all(labels, points.data(), threads);
+    const double build_seconds = seconds_since(build_start);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "bench_hnsw.bin").string();
+    const auto save_start = Clock::now();
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        built.save(out);
+    }
+    const double save_seconds = seconds_since(save_start);
+    const auto file_bytes = std::filesystem::file_size(path);
+    const auto load_start = Clock::now();
+    std::unique_ptr<HnswIndex> index;
+    {
+        std::ifstream in(path, std::ios::binary);
+        index = HnswIndex::load(in);
+    }
+    const double load_seconds = seconds_since(load_start);
+    std::filesystem::remove(path);
+
+    // exact answers, and what they cost
+    EmbeddingMatrix exact(config.dimension);
+    for (std::uint32_t i = 0; i < items; ++i) exact.set(i, points.data() + i * config.dimension);
+    std::vector<std::unordered_set<std::uint32_t> > truth(kQueries);
+    const auto exact_start = Clock::now();
+    for (std::size_t q = 0; q < kQueries; ++q) {
+        for (const auto &[score, row]: exact.top_k(queries.data() + q * config.dimension, kK,
+                                                   EmbeddingMetric::Cosine)) {
+            truth[q].insert(row);
+        }
+    }
+    const double exact_qps = static_cast<double>(kQueries) / seconds_since(exact_start);
+
+    json curve = json::array();
+    for (const std::size_t ef: {10, 20, 40, 80, 160, 320}) {
+        std::size_t hits = 0;
+        const auto start = Clock::now();
+        for (std::size_t q = 0; q < kQueries; ++q) {
+            for (const auto &[score, label]: index->search(queries.data() + q * config.dimension, kK, ef)) {
+                hits += truth[q].count(label);
+            }
+        }
+        const double seconds = seconds_since(start);
+        curve.push_back({
+            {"ef", ef},
+            {"recall_at_10", static_cast<double>(hits) / static_cast<double>(kQueries * kK)},
+            {"qps", static_cast<double>(kQueries) / seconds}
+        });
+    }
+
+    std::cout << json{
+        {"items", items},
+        {"dimension", config.dimension},
+        {"m", config.m},
+        {"ef_construction", config.ef_construction},
+        {"threads", threads},
+        {"build_seconds", build_seconds},
+        {"inserts_per_sec", static_cast<double>(items) / build_seconds},
+        {"file_mb", static_cast<double>(file_bytes) / 1e6},
+        {"save_seconds", save_seconds},
+        {"load_seconds", load_seconds},
+        {"brute_force_qps", exact_qps},
+        {"curve", curve}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,150 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Streams random interactions (2M by default, items drawn with a power law) into an
+// InteractionMatrix, merging as it asks, and into the hash map of per-user vectors, plus its
+// per-item transpose, that it stands in for. Prints for each the heap used, the time to take
+// the interactions in, and the time to scan every row and every column (of the matrix packed
+// once more as a whole), as JSON.
+// Usage: bench_interaction_matrix [interactions] [users] [items] [merge every]
+//
+#include <beacon/interaction_matrix.h>
+#include <nlohmann/json.hpp>
+#include <malloc.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using beacon::reco::InteractionMatrix;
+using beacon::reco::Triplet;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    using Lists = std::unordered_map<std::uint32_t, std::vector<std::pair<std::uint32_t, float> > >;
+
+    std::size_t heap_bytes() {
+        return mallinfo2().uordblks;
+    }
+
+    double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void add(Lists &lists, std::uint32_t key, std::uint32_t other, float value) {
+        auto &list = lists[key];
+        for (auto &[known, weight]: list) {
+            if (known == other) {
+                weight += value;
+                return;
+            }
+        }
+        list.emplace_back(other, value);
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    const std::size_t users = argc > 2 ? std::stoul(argv[2]) : 200000;
+    const std::size_t items = argc > 3 ? std::stoul(argv[3]) : 50000;
+    const std::size_t merge_every = argc > 4 ? std::stoul(argv[4]) : 65536;
+
+    std::mt19937 rng(9);
+    std::uniform_int_distribution<std::uint32_t> user(0, static_cast<std::uint32_t>(users - 1));
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::uniform_int_distribution<int> weight(1, 5);
+    std::vector<Triplet> stream;
+    stream.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        // item rank ~ items^u, so a few items take most of the interactions
+        const auto item = static_cast<std::uint32_t>(std::pow(static_cast<double>(items), uniform(rng)) - 1.0);
+        stream.push_back({user(rng), item, static_cast<float>(weight(rng))});
+    }
+
+    json results = json::array();
+    {
+        const std::size_t heap_before = heap_bytes();
+        auto start = Clock::now();
+        Lists by_user;
+        Lists by_item;
+        for (const Triplet &triplet: stream) {
+            add(by_user, triplet.row, triplet.column, triplet.value);
+            add(by_item, triplet.column, triplet.row, triplet.value);
+        }
+        const double add_seconds = seconds_since(start);
+        const std::size_t heap = heap_bytes() - heap_before;
+        double sum = 0.0;
+        start = Clock::now();
+        for (std::uint32_t u = 0; u < users; ++u) {
+            const auto found = by_user.find(u);
+            if (found == by_user.end()) continue;
+            for (const auto &[item, value]: found->second) sum += value;
+        }
+        const double row_seconds = seconds_since(start);
+        start = Clock::now();
+        for (std::uint32_t v = 0; v < items; ++v) {
+            const auto found = by_item.find(v);
+            if (found == by_item.end()) continue;
+            for (const auto &[u, value]: found->second) sum += value;
+        }
+        const double column_seconds = seconds_since(start);
+        results.push_back({
+            {"layout", "hash_map_of_vectors"},
+            {"memory_mb", static_cast<double>(heap) / 1e6},
+            {"add_seconds", add_seconds},
+            {"row_scan_seconds", row_seconds},
+            {"column_scan_seconds", column_seconds},
+            {"checksum", sum}
+        });
+    }
+
+    InteractionMatrix matrix(merge_every);
+    auto start = Clock::now();
+    double merge_seconds = 0.0;
+    for (const Triplet &triplet: stream) {
+        if (matrix.add(triplet.row, triplet.column, triplet.value)) {
+            const auto merge_start = Clock::now();
+            matrix.merge();
+            merge_seconds += seconds_since(merge_start);
+        }
+    }
+    matrix.merge();
+    const double add_seconds = seconds_since(start);
+    const beacon::reco::CsrMatrix csr = matrix.to_csr();
+    const beacon::reco::PackedCsrMatrix rows = beacon::reco::PackedCsrMatrix::pack(csr);
+    const beacon::reco::PackedCsrMatrix columns = beacon::reco::PackedCsrMatrix::pack(csr.transpose());
+    double sum = 0.0;
+    start = Clock::now();
+    for (std::size_t u = 0; u < rows.rows(); ++u) {
+        rows.for_each(u, [&sum](std::uint32_t, float value) { sum += value; });
+    }
+    const double row_seconds = seconds_since(start);
+    start = Clock::now();
+    for (std::size_t v = 0; v < columns.rows(); ++v) {
+        columns.for_each(v, [&sum](std::uint32_t, float value) { sum += value; });
+    }
+    const double column_seconds = seconds_since(start);
+    results.push_back({
+        {"layout", "packed_csr"},
+        {"memory_mb", static_cast<double>(matrix.memory_bytes()) / 1e6},
+        {"add_seconds", add_seconds},
+        {"merge_seconds", merge_seconds},
+        {"row_scan_seconds", row_seconds},
+        {"column_scan_seconds", column_seconds},
+        {"checksum", sum}
+    });
+
+    std::cout << json{
+        {"interactions", count},
+        {"users", users},
+        {"items", items},
+        {"nonzeros", matrix.nonzeros()},
+        {"merge_every", merge_every},
+        {"results", results}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,152 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Interns random entity ids (1M by default) into beacon::Interner and into the map and
+// vector under one reader-writer lock it replaces, then has several threads look known ids
+// up, and prints for each the insert and lookup cost, the heap used, and the interner's
+// snapshot and restore times as JSON.
+// Usage: bench_interner [names] [threads] [lookups per thread]
+//
+#include <beacon/interner.h>
+#include <nlohmann/json.hpp>
+#include <malloc.h>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using beacon::Interner;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    // what the recommendation engine used before
+    class LockedMap {
+    public:
+        std::uint32_t intern(const std::string &name) {
+            {
+                const std::shared_lock lock(mutex_);
+                const auto known = ids_.find(name);
+                if (known != ids_.end()) return known->second;
+            }
+            const std::unique_lock lock(mutex_);
+            const auto [entry, inserted] = ids_.try_emplace(name, static_cast<std::uint32_t>(names_.size()));
+            if (inserted) names_.push_back(name);
+            return entry->second;
+        }
+
+        std::uint32_t find(const std::string &name) const {
+            const std::shared_lock lock(mutex_);
+            return ids_.find(name)->second;
+        }
+
+    private:
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<std::string, std::uint32_t> ids_;
+        std::vector<std::string> names_;
+    };
+
+    std::size_t heap_bytes() {
+        return mallinfo2().uordblks;
+    }
+
+    double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    template<typename Find>
+    double lookup_ns(const std::vector<std::string> &names, std::size_t threads, std::size_t lookups, Find find) {
+        std::vector<std::thread> workers;
+        std::vector<std::uint64_t> sums(threads);
+        const auto start = Clock::now();
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                std::mt19937_64 rng(t);
+                std::uint64_t sum = 0;
+                for (std::size_t i = 0; i < lookups; ++i) sum += find(names[rng() % names.size()]);
+                sums[t] = sum;
+            });
+        }
+        for (std::thread &worker: workers) worker.join();
+        return seconds_since(start) * 1e9 / static_cast<double>(threads * lookups);
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const std::size_t threads = argc > 2 ? std::stoul(argv[2]) : 4;
+    const std::size_t lookups = argc > 3 ? std::stoul(argv[3]) : 2000000;
+
+    std::mt19937_64 rng(5);
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::ostringstream name;
+        name << "user-" << std::hex << rng();
+        names.push_back(name.str());
+    }
+
+    json results = json::array();
+    {
+        const std::size_t heap_before = heap_bytes();
+        auto start = Clock::now();
+        LockedMap map;
+        for (const std::string &name: names) map.intern(name);
+        const double insert_ns = seconds_since(start) * 1e9 / static_cast<double>(count);
+        const std::size_t heap = heap_bytes() - heap_before;
+        const double lookup = lookup_ns(names, threads, lookups, [&map](const std::string &name) {
+            return map.find(name);
+        });
+        results.push_back({
+            {"store", "locked_map"},
+            {"insert_ns", insert_ns},
+            {"lookup_ns", lookup},
+            {"heap_mb", static_cast<double>(heap) / 1e6}
+        });
+    }
+
+    Interner interner;
+    const std::size_t heap_before = heap_bytes();
+    auto start = Clock::now();
+    for (const std::string &name: names) interner.intern(name);
+    const double insert_ns = seconds_since(start) * 1e9 / static_cast<double>(count);
+    const std::size_t heap = heap_bytes() - heap_before;
+    const double lookup = lookup_ns(names, threads, lookups, [&interner](const std::string &name) {
+        return *interner.find(name);
+    });
+
+    std::ostringstream out;
+    start = Clock::now();
+    interner.snapshot(out);
+    const double snapshot_seconds = seconds_since(start);
+    const std::string bytes = out.str();
+    Interner restored;
+    std::istringstream in(bytes);
+    start = Clock::now();
+    restored.restore(in);
+    const double restore_seconds = seconds_since(start);
+    results.push_back({
+        {"store", "interner"},
+        {"insert_ns", insert_ns},
+        {"lookup_ns", lookup},
+        {"heap_mb", static_cast<double>(heap) / 1e6},
+        {"memory_mb", static_cast<double>(interner.memory_bytes()) / 1e6},
+        {"snapshot_mb", static_cast<double>(bytes.size()) / 1e6},
+        {"snapshot_seconds", snapshot_seconds},
+        {"restore_seconds", restore_seconds}
+    });
+
+    std::cout << json{
+        {"names", count},
+        {"threads", threads},
+        {"lookups_per_thread", lookups},
+        {"results", results}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,124 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Feeds the live item-to-item model synthetic interactions (10M by default: 100 per item,
+// 10 per user, item popularity Zipf distributed) and prints the sustained update rate, the
+// time of a full rebuild and query latencies as JSON.
+// Usage: bench_item_similarity [interactions] [cosine|jaccard|llr] [update threads]
+//
+#include <beacon/hdr_histogram.h>
+#include <beacon/recommendation_engine.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using beacon::HdrHistogram;
+using beacon::RecommendationConfig;
+using beacon::RecommendationEngine;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    constexpr std::size_t kQueries = 200000;
+
+    double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    json summary_us(const HdrHistogram &histogram) {
+        return {
+            {"p50", static_cast<double>(histogram.value_at_percentile(50)) / 1000.0},
+            {"p99", static_cast<double>(histogram.value_at_percentile(99)) / 1000.0},
+            {"p999", static_cast<double>(histogram.value_at_percentile(99.9)) / 1000.0},
+            {"mean", histogram.mean() / 1000.0}
+        };
+    }
+
+    std::vector<std::string> names(const char *prefix, std::size_t count) {
+        std::vector<std::string> result;
+        result.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) result.push_back(prefix + std::to_string(i));
+        return result;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t interactions = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    const std::string similarity = argc > 2 ? argv[2] : "cosine";
+    const std::size_t threads = argc > 3 ? std::stoul(argv[3]) : 2;
+    const std::size_t item_count = std::max<std::size_t>(interactions / 100, 10);
+    const std::size_t user_count = std::max<std::size_t>(interactions / 10, 10);
+
+    const std::vector<std::string> items = names("item-", item_count);
+    const std::vector<std::string> users = names("user-", user_count);
+
+    // Zipf(1) popularity by inverse CDF
+    std::vector<double> popularity(item_count);
+    double total = 0.0;
+    for (std::size_t i = 0; i < item_count; ++i) popularity[i] = total += 1.0 / static_cast<double>(i + 1);
+
+    RecommendationConfig config;
+    config.similarity = beacon::reco::parse_similarity(similarity);
+    config.update_threads = threads;
+    // everything is queued up front
+    config.max_queued = interactions;
+    RecommendationEngine engine(config);
+
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<std::size_t> user(0, user_count - 1);
+    std::uniform_real_distribution<double> unit(0.0, total);
+    std::uniform_int_distribution<int> kind(0, 9);
+
+    // applied, neighbor lists included, once flush() returns
+    const auto ingest_start = Clock::now();
+    for (std::size_t i = 0; i < interactions; ++i) {
+        const auto item = static_cast<std::size_t>(
+            std::upper_bound(popularity.begin(), popularity.end(), unit(rng)) - popularity.begin());
+        // mostly views, some clicks
+        engine.add_interaction(users[user(rng)], items[std::min(item, item_count - 1)], kind(rng) < 8 ? 1.0f : 2.0f);
+    }
+    engine.flush();
+    const double ingest_seconds = seconds_since(ingest_start);
+
+    const auto build_start = Clock::now();
+    engine.rebuild();
+    const double build_seconds = seconds_since(build_start);
+
+    // queries for items and users drawn the way traffic would draw them
+    HdrHistogram similar(10, 10'000'000'000ULL, 3);
+    HdrHistogram recommend(10, 10'000'000'000ULL, 3);
+    std::size_t returned = 0;
+    for (std::size_t i = 0; i < kQueries; ++i) {
+        const auto item = static_cast<std::size_t>(
+            std::upper_bound(popularity.begin(), popularity.end(), unit(rng)) - popularity.begin());
+        const auto start = Clock::now();
+        returned += engine.similar_items(items[std::min(item, item_count - 1)], 10).size();
+        similar.record(static_cast<std::uint64_t>((Clock::now() - start).count()));
+    }
+    for (std::size_t i = 0; i < kQueries / 10; ++i) {
+        const auto start = Clock::now();
+        returned += engine.recommend(users[user(rng)], 10).size();
+        recommend.record(static_cast<std::uint64_t>((Clock::now() - start).count()));
+    }
+
+    const beacon::RecommendationStats stats = engine.stats();
+    std::cout << json{
+        {"similarity", similarity},
+        {"interactions", interactions},
+        {"update_threads", threads},
+        {"dropped", stats.dropped},
+        {"users", stats.users},
+        {"items", stats.items},
+        {"cooccurrences", stats.cooccurrences},
+        {"updates_per_sec", static_cast<double>(interactions) / ingest_seconds},
+        {"rebuild_seconds", build_seconds},
+        {"similar_items_us", summary_us(similar)},
+        {"recommend_us", summary_us(recommend)},
+        {"results_returned", returned}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,99 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Matches synthetic events against 100k filtered subscriptions, once through the shared
+// predicate index and once by evaluating every filter, and prints events/sec for both.
+//
+#include <beacon/predicate_index.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using beacon::filter::Filter;
+using beacon::filter::PredicateIndex;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    constexpr int kSubscriptions = 100000;
+    constexpr int kRegions = 200;
+    constexpr int kEvents = 200000;
+    constexpr int kNaiveEvents = 200;
+
+    json make_filter(std::mt19937 &rng) {
+        std::uniform_int_distribution<int> region(0, kRegions - 1);
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<int> price(0, 1000);
+
+        json spec = {{"region", "r" + std::to_string(region(rng))}};
+        if (percent(rng) < 50) spec["tier"] = {{"in", {"gold", "silver"}}};
+        if (percent(rng) < 50) {
+            const int low = price(rng);
+            spec["price"] = {{"gte", low}, {"lt", low + 100}};
+        }
+        return spec;
+    }
+
+    json make_event(std::mt19937 &rng) {
+        static const char *tiers[] = {"gold", "silver", "bronze"};
+        std::uniform_int_distribution<int> region(0, kRegions - 1);
+        std::uniform_int_distribution<int> tier(0, 2);
+        std::uniform_real_distribution<double> price(0.0, 1100.0);
+        return {
+            {"region", "r" + std::to_string(region(rng))},
+            {"tier", tiers[tier(rng)]},
+            {"price", price(rng)}
+        };
+    }
+
+    double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+} // namespace
+
+int main() {
+    std::mt19937 rng(7);
+    std::vector<Filter> filters;
+    filters.reserve(kSubscriptions);
+    PredicateIndex index;
+
+    const auto build_start = Clock::now();
+    for (int i = 0; i < kSubscriptions; ++i) {
+        filters.push_back(beacon::filter::parse_filter(make_filter(rng)));
+        index.add(static_cast<PredicateIndex::Slot>(i), filters.back());
+    }
+    const double build_seconds = seconds_since(build_start);
+
+    std::vector<json> events;
+    events.reserve(kEvents);
+    for (int i = 0; i < kEvents; ++i) events.push_back(make_event(rng));
+
+    std::vector<PredicateIndex::Slot> matched;
+    std::size_t indexed_matches = 0;
+    const auto index_start = Clock::now();
+    for (const json &event: events) {
+        matched.clear();
+        index.match(event, matched);
+        indexed_matches += matched.size();
+    }
+    const double index_seconds = seconds_since(index_start);
+
+    std::size_t naive_matches = 0;
+    const auto naive_start = Clock::now();
+    for (int i = 0; i < kNaiveEvents; ++i) {
+        for (const Filter &filter: filters) {
+            if (beacon::filter::evaluate(filter, events[i])) ++naive_matches;
+        }
+    }
+    const double naive_seconds = seconds_since(naive_start);
+
+    std::cout << json{
+        {"subscriptions", kSubscriptions},
+        {"build_seconds", build_seconds},
+        {"indexed_events_per_sec", kEvents / index_seconds},
+        {"indexed_avg_matches", static_cast<double>(indexed_matches) / kEvents},
+        {"naive_events_per_sec", kNaiveEvents / naive_seconds},
+        {"naive_avg_matches", static_cast<double>(naive_matches) / kNaiveEvents}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,106 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Publishes events through one ProducerClient as fast as a single thread can and prints
+// events/sec per client configuration as JSON. Without arguments an in-process broker is
+// started on a local port; pass a ws:// URI to measure against a running broker instead.
+// Usage: bench_producer [uri] [events]
+//
+#include <beacon/broker.h>
+#include <beacon/producer_client.h>
+#include <beacon/websocket_adapter.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using beacon::ProducerClient;
+using beacon::ProducerConfig;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Scenario {
+        const char *name;
+        std::size_t batch_events;
+        std::size_t max_in_flight;
+        bool compress;
+    };
+
+    json run(const std::string &uri, const Scenario &scenario, std::size_t events) {
+        ProducerConfig config;
+        config.uri = uri;
+        config.batch_events = scenario.batch_events;
+        config.max_in_flight = scenario.max_in_flight;
+        config.compress = scenario.compress;
+        ProducerClient client(config);
+
+        const json payload = {
+            {"region", "eu-west"},
+            {"price", 129.95},
+            {"sku", "SKU-000000000042"},
+            {"note", "lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod"}
+        };
+
+        const auto start = Clock::now();
+        for (std::size_t i = 0; i < events; ++i) {
+            client.publish("bench", "entity-" + std::to_string(i % 1024), "updated", payload);
+        }
+        const double publish_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        const bool flushed = client.flush(std::chrono::minutes(5));
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const beacon::ProducerStats stats = client.stats();
+        return {
+            {"scenario", scenario.name},
+            {"batch_events", scenario.batch_events},
+            {"max_in_flight", scenario.max_in_flight},
+            {"compress", scenario.compress},
+            {"flushed", flushed},
+            {"events_acked", stats.events_acked},
+            {"events_failed", stats.events_failed},
+            {"retries", stats.retries},
+            {"publish_events_per_sec", events / publish_seconds},
+            {"acked_events_per_sec", stats.events_acked / seconds}
+        };
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string uri = argc > 1 ? argv[1] : "";
+    const std::size_t events = argc > 2 ? std::stoul(argv[2]) : 500000;
+
+    std::unique_ptr<beacon::WebSocketAdapter> adapter;
+    std::unique_ptr<beacon::Broker> broker;
+    std::thread broker_thread;
+    if (uri.empty()) {
+        const std::uint16_t port = 17090;
+        adapter = std::make_unique<beacon::WebSocketAdapter>(beacon::ratelimit::RateLimitConfig{},
+                                                             std::max(1u, std::thread::hardware_concurrency()));
+        broker = std::make_unique<beacon::Broker>(*adapter);
+        adapter->listen(port);
+        broker_thread = std::thread([&adapter]() { adapter->run(); });
+        uri = "ws://127.0.0.1:" + std::to_string(port) + "/";
+    }
+
+    const Scenario scenarios[] = {
+        {"one_event_per_message", 1, 64, false},
+        {"batched", 1000, 8, false},
+        {"batched_compressed", 1000, 8, true}
+    };
+
+    json results = json::array();
+    for (const Scenario &scenario: scenarios) {
+        // unbatched publishing is far slower, a tenth of the events tells enough
+        const std::size_t count = scenario.batch_events == 1 ? events / 10 : events;
+        results.push_back(run(uri, scenario, count));
+    }
+    std::cout << json{{"uri", uri}, {"events", events}, {"results", results}}.dump(2) << std::endl;
+
+    if (adapter) {
+        adapter->stop();
+        broker_thread.join();
+    }
+    return 0;
+}
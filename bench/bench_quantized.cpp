@@ -0,0 +1,141 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Stores clustered random embeddings (1M x 64, around 1000 centers, by default) in float32,
+// int8 and product-quantized form, with and without float32 re-ranking, scores random
+// queries against each by brute force on one thread, and prints per form its memory,
+// latency, and recall@k against float32 as JSON.
+// Usage: bench_quantized [items] [dimension] [k] [dot|cosine] [rerank] [subspaces]
+//
+#include <beacon/hdr_histogram.h>
+#include <beacon/quantized_matrix.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using beacon::HdrHistogram;
+using beacon::reco::EmbeddingMatrix;
+using beacon::reco::QuantizedConfig;
+using beacon::reco::QuantizedMatrix;
+using beacon::reco::Quantization;
+using nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    constexpr std::size_t kQueries = 100;
+    constexpr std::size_t kCenters = 1000;
+
+    using Scored = std::vector<std::pair<float, std::uint32_t> >;
+
+    json summary_ms(const HdrHistogram &histogram) {
+        return {
+            {"p50", static_cast<double>(histogram.value_at_percentile(50)) / 1e6},
+            {"p99", static_cast<double>(histogram.value_at_percentile(99)) / 1e6},
+            {"mean", histogram.mean() / 1e6}
+        };
+    }
+
+    double recall(const Scored &expected, const Scored &got) {
+        std::set<std::uint32_t> wanted;
+        for (const auto &[score, row]: expected) wanted.insert(row);
+        std::size_t hits = 0;
+        for (const auto &[score, row]: got) hits += wanted.count(row);
+        return expected.empty() ? 1.0 : static_cast<double>(hits) / static_cast<double>(expected.size());
+    }
+
+    template<typename Matrix>
+    json measure(const char *name, const Matrix &matrix, const std::vector<std::vector<float> > &queries,
+                 const std::vector<Scored> &exact, std::size_t k, beacon::reco::EmbeddingMetric metric,
+                 std::size_t float_bytes) {
+        // one untimed pass to fault the matrix in
+        matrix.top_k(queries[0].data(), k, metric);
+        HdrHistogram latency(1000, 60'000'000'000ULL, 3);
+        double total = 0.0;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            const auto start = Clock::now();
+            const Scored result = matrix.top_k(queries[i].data(), k, metric);
+            latency.record(static_cast<std::uint64_t>((Clock::now() - start).count()));
+            total += recall(exact[i], result);
+        }
+        const double recall_at_k = total / static_cast<double>(queries.size());
+        return {
+            {"storage", name},
+            {"memory_mb", static_cast<double>(matrix.memory_bytes()) / 1e6},
+            {"compression", static_cast<double>(float_bytes) / static_cast<double>(matrix.memory_bytes())},
+            {"query_ms", summary_ms(latency)},
+            {"recall", recall_at_k},
+            {"recall_loss", 1.0 - recall_at_k}
+        };
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t items = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const std::size_t dimension = argc > 2 ? std::stoul(argv[2]) : 64;
+    const std::size_t k = argc > 3 ? std::stoul(argv[3]) : 10;
+    const beacon::reco::EmbeddingMetric metric = beacon::reco::parse_embedding_metric(argc > 4 ? argv[4] : "dot");
+    const std::size_t rerank = argc > 5 ? std::stoul(argv[5]) : 4;
+    const std::size_t subspaces = argc > 6 ? std::stoul(argv[6]) : 0;
+
+    std::mt19937 rng(11);
+    std::normal_distribution<float> value(0.0f, 1.0f);
+    std::uniform_int_distribution<std::size_t> pick(0, kCenters - 1);
+    std::vector<float> centers(kCenters * dimension);
+    for (float &v: centers) v = value(rng);
+
+    EmbeddingMatrix exact(dimension);
+    std::vector<QuantizedMatrix> quantized;
+    const std::pair<Quantization, std::size_t> forms[] = {
+        {Quantization::Int8, 0}, {Quantization::Int8, rerank}, {Quantization::Product, 0},
+        {Quantization::Product, rerank}
+    };
+    for (const auto &[quantization, candidates]: forms) {
+        QuantizedConfig config;
+        config.dimension = dimension;
+        config.quantization = quantization;
+        config.subspaces = subspaces;
+        config.rerank = candidates;
+        quantized.emplace_back(config);
+    }
+    const auto load_start = Clock::now();
+    std::vector<float> row(dimension);
+    for (std::size_t item = 0; item < items; ++item) {
+        const float *center = centers.data() + pick(rng) * dimension;
+        for (std::size_t d = 0; d < dimension; ++d) row[d] = center[d] + 0.5f * value(rng);
+        exact.set(static_cast<std::uint32_t>(item), row.data());
+        for (QuantizedMatrix &matrix: quantized) matrix.set(static_cast<std::uint32_t>(item), row.data());
+    }
+    for (QuantizedMatrix &matrix: quantized) matrix.train();
+    const double load_seconds = std::chrono::duration<double>(Clock::now() - load_start).count();
+
+    std::vector<std::vector<float> > queries(kQueries, std::vector<float>(dimension));
+    for (auto &query: queries) {
+        const float *center = centers.data() + pick(rng) * dimension;
+        for (std::size_t d = 0; d < dimension; ++d) query[d] = center[d] + 0.5f * value(rng);
+    }
+    std::vector<Scored> expected;
+    for (const auto &query: queries) expected.push_back(exact.top_k(query.data(), k, metric));
+
+    json storages = json::array();
+    storages.push_back(measure("float32", exact, queries, expected, k, metric, exact.memory_bytes()));
+    const char *names[] = {"int8", "int8+rerank", "pq", "pq+rerank"};
+    for (std::size_t i = 0; i < quantized.size(); ++i) {
+        storages.push_back(measure(names[i], quantized[i], queries, expected, k, metric, exact.memory_bytes()));
+    }
+
+    std::cout << json{
+        {"items", items},
+        {"dimension", dimension},
+        {"k", k},
+        {"rerank", rerank},
+        {"subspaces", quantized[2].config().subspaces},
+        {"simd", beacon::reco::simd_name(beacon::reco::detect_simd())},
+        {"load_seconds", load_seconds},
+        {"storages", storages}
+    }.dump(2) << std::endl;
+    return 0;
+}
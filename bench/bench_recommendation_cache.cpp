@@ -0,0 +1,100 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Trains a beacon::RecommendationEngine on Zipf-distributed interactions (20k users over 5k
+// items by default), then replays recommend requests from Zipf-distributed users on several
+// threads, with one new event per `event_every` requests invalidating its user, once
+// straight against the engine and once through a beacon::reco::RecommendationCache. Prints
+// the cost per request both ways and the cache's hit, coalesced and invalidation counts as
+// JSON.
+// Usage: bench_recommendation_cache [requests] [users] [threads] [event_every]
+//
+#include <beacon/recommendation_cache.h>
+#include <beacon/recommendation_engine.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace beacon;
+using nlohmann::json;
+using Timer = std::chrono::steady_clock;
+
+namespace {
+    std::vector<std::size_t> zipf(std::size_t count, std::size_t n, double exponent, std::uint64_t seed) {
+        std::vector<double> cdf(n);
+        double sum = 0.0;
+        for (std::size_t i = 0; i < n; ++i) cdf[i] = sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+        std::mt19937_64 random(seed);
+        std::uniform_real_distribution<double> uniform(0.0, sum);
+        std::vector<std::size_t> picks(count);
+        for (std::size_t &pick: picks) {
+            pick = static_cast<std::size_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(random)) - cdf.begin());
+        }
+        return picks;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t requests = argc > 1 ? std::stoul(argv[1]) : 200000;
+    const std::size_t users = argc > 2 ? std::stoul(argv[2]) : 20000;
+    const std::size_t threads = argc > 3 ? std::stoul(argv[3]) : 4;
+    const std::size_t event_every = argc > 4 ? std::stoul(argv[4]) : 20;
+    const std::size_t catalog = 5000;
+
+    RecommendationEngine engine;
+    const std::vector<std::size_t> items = zipf(users * 20, catalog, 1.0, 7);
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        engine.add_interaction("user-" + std::to_string(i % users), "item-" + std::to_string(items[i]), 1.0f);
+    }
+    engine.rebuild();
+
+    const std::vector<std::size_t> asking = zipf(requests, users, 1.0, 42);
+    const auto run = [&](reco::RecommendationCache *cache) {
+        const Timer::time_point start = Timer::now();
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (std::size_t i = t; i < requests; i += threads) {
+                    const std::string user = "user-" + std::to_string(asking[i]);
+                    if (i % event_every == 0 && cache) {
+                        cache->invalidate(user);
+                    }
+                    const auto compute = [&engine, &user]() { return engine.recommend(user, 10); };
+                    const std::size_t returned = cache
+                                                     ? cache->get(user, "10", engine.model_version(), compute)->size()
+                                                     : compute().size();
+                    if (returned > 10) std::abort();
+                }
+            });
+        }
+        for (std::thread &worker: workers) worker.join();
+        return std::chrono::duration<double, std::micro>(Timer::now() - start).count() /
+               static_cast<double>(requests);
+    };
+
+    const double uncached_us = run(nullptr);
+    reco::RecommendationCache cache;
+    const double cached_us = run(&cache);
+    const reco::RecommendationCacheStats stats = cache.stats();
+
+    std::cout << json{
+        {"requests", requests},
+        {"users", users},
+        {"threads", threads},
+        {"event_every", event_every},
+        {"uncached_us_per_request", uncached_us},
+        {"cached_us_per_request", cached_us},
+        {"hit_rate", static_cast<double>(stats.hits + stats.stale_hits) / static_cast<double>(requests)},
+        {"misses", stats.misses},
+        {"coalesced", stats.coalesced},
+        {"invalidations", stats.invalidations},
+        {"entries", stats.entries}
+    }.dump(2) << std::endl;
+    return 0;
+}
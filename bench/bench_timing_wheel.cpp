@@ -0,0 +1,90 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Cost of the delayed delivery timer: schedules N delayed events spread over the next hour
+// into a TimingWheel at a 10ms tick, then advances the wheel tick by tick until all have
+// fired. The scheduling pass doubles as the restart rebuild, which inserts a loaded window
+// the same way. Also compares scheduling into a std::multimap, the obvious O(log n)
+// alternative. Prints JSON. Usage: bench_timing_wheel [events]
+//
+#include <beacon/delay_journal.h>
+#include <beacon/timing_wheel.h>
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using beacon::delay::DelayedEvent;
+using beacon::timing::TimingWheel;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    constexpr std::uint64_t kStartMs = 1'700'000'000'000ull;
+    constexpr std::uint64_t kTickMs = 10;
+    constexpr std::uint64_t kSpanMs = 3'600'000;
+
+    double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    std::vector<DelayedEvent> make_events(std::size_t count) {
+        std::mt19937_64 rng(3);
+        std::vector<DelayedEvent> events(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            events[i].id = i + 1;
+            events[i].deliver_at_ms = kStartMs + 1 + rng() % kSpanMs;
+            events[i].message = R"({"op":"publish","topic":"reminders","entity_id":"u)" + std::to_string(i % 100000) +
+                                R"(","payload":{"n":1}})";
+        }
+        return events;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t count = argc > 1 ? std::stoul(argv[1]) : 2'000'000;
+    auto events = make_events(count);
+    auto copy = events;
+
+    TimingWheel<DelayedEvent> wheel(kStartMs, kTickMs);
+    auto start = Clock::now();
+    for (DelayedEvent &event: events) {
+        const std::uint64_t deliver_at = event.deliver_at_ms;
+        wheel.schedule(deliver_at, std::move(event));
+    }
+    const double schedule_seconds = seconds_since(start);
+
+    std::size_t fired = 0;
+    std::uint64_t late_ms = 0;
+    start = Clock::now();
+    for (std::uint64_t now = kStartMs; !wheel.empty(); now += kTickMs) {
+        fired += wheel.advance(now, [&late_ms, now](DelayedEvent &&event) {
+            late_ms = std::max(late_ms, now - event.deliver_at_ms);
+        });
+    }
+    const double expire_seconds = seconds_since(start);
+
+    std::multimap<std::uint64_t, DelayedEvent> ordered;
+    start = Clock::now();
+    for (DelayedEvent &event: copy) {
+        const std::uint64_t deliver_at = event.deliver_at_ms;
+        ordered.emplace(deliver_at, std::move(event));
+    }
+    const double multimap_seconds = seconds_since(start);
+
+    const nlohmann::json result = {
+        {"events", count},
+        {"tick_ms", kTickMs},
+        {"span_ms", kSpanMs},
+        {"fired", fired},
+        {"max_lateness_ms", late_ms},
+        {"wheel_schedule_ns_per_event", schedule_seconds * 1e9 / count},
+        {"wheel_expire_ns_per_event", expire_seconds * 1e9 / count},
+        {"wheel_rebuild_seconds", schedule_seconds},
+        {"multimap_schedule_ns_per_event", multimap_seconds * 1e9 / count}
+    };
+    std::cout << result.dump(2) << std::endl;
+    return 0;
+}
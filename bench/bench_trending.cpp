@@ -0,0 +1,113 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Feeds a day of Zipf-distributed events (2M by default, over a catalog of 1M items, 4 event
+// types and 16 categories) to beacon::trending::TrendingTracker, then times top-10 queries
+// on every window and checks the 5-minute list against exact counts. Prints the ingest and
+// query cost, the tracker's memory and the recall as JSON.
+// Usage: bench_trending [events] [catalog] [queries]
+//
+#include <beacon/trending.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace beacon::trending;
+using nlohmann::json;
+using Timer = std::chrono::steady_clock;
+
+namespace {
+    struct Event {
+        std::uint32_t item;
+        std::uint8_t type;
+        std::uint8_t category;
+        Clock::time_point at;
+    };
+
+    double elapsed_ns(Timer::time_point since) {
+        return std::chrono::duration<double, std::nano>(Timer::now() - since).count();
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t events = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    const std::size_t catalog = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    const std::size_t queries = argc > 3 ? std::stoul(argv[3]) : 10000;
+    const std::vector<std::string> types = {"view", "click", "cart", "purchase"};
+
+    // Zipf(1.1) by inverse transform over a precomputed CDF
+    std::vector<double> cdf(catalog);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < catalog; ++i) cdf[i] = sum += 1.0 / std::pow(static_cast<double>(i + 1), 1.1);
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    const Clock::time_point start = Clock::now();
+    const Clock::duration step = Clock::duration(std::chrono::hours(24)) / static_cast<Clock::rep>(events);
+    std::vector<Event> stream(events);
+    std::vector<std::string> names(catalog);
+    for (std::size_t i = 0; i < catalog; ++i) names[i] = "item-" + std::to_string(i);
+    for (std::size_t i = 0; i < events; ++i) {
+        // the popular end of the catalog turns over every hour
+        const auto rank = static_cast<std::uint32_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(random)) -
+                                                     cdf.begin());
+        const std::size_t hour = i * 24 / events;
+        stream[i] = Event{
+            static_cast<std::uint32_t>((rank + hour * 7919) % catalog), static_cast<std::uint8_t>(random() % 4),
+            static_cast<std::uint8_t>(rank % 16), start + step * static_cast<Clock::rep>(i)
+        };
+    }
+
+    TrendingTracker trending;
+    const Timer::time_point ingest = Timer::now();
+    for (const Event &event: stream) {
+        trending.add(types[event.type], "c" + std::to_string(event.category), names[event.item], event.at);
+    }
+    const double ingest_ns = elapsed_ns(ingest) / static_cast<double>(events);
+
+    const Clock::time_point end = stream.back().at;
+    json windows = json::object();
+    for (const std::string window: {"5m", "1h", "24h"}) {
+        std::vector<double> samples;
+        samples.reserve(queries);
+        for (std::size_t i = 0; i < queries; ++i) {
+            const Timer::time_point at = Timer::now();
+            const std::vector<TrendingItem> top = trending.top(i % 2 == 0 ? "" : types[i % 4], "", window, 10, end);
+            samples.push_back(elapsed_ns(at) / 1000.0);
+            if (top.empty()) return 1;
+        }
+        std::sort(samples.begin(), samples.end());
+        windows[window] = {{"p50_us", samples[samples.size() / 2]}, {"p99_us", samples[samples.size() * 99 / 100]}};
+    }
+
+    // the 5-minute window ends with the current 1-minute bucket and holds four before it
+    const Clock::time_point from = end - std::chrono::minutes(4) - (end.time_since_epoch() % std::chrono::minutes(1));
+    std::unordered_map<std::uint32_t, std::uint64_t> exact;
+    for (const Event &event: stream) {
+        if (event.at >= from) ++exact[event.item];
+    }
+    std::vector<std::pair<std::uint64_t, std::uint32_t> > ranked;
+    for (const auto &[item, count]: exact) ranked.emplace_back(count, item);
+    std::sort(ranked.rbegin(), ranked.rend());
+    std::size_t found = 0;
+    const std::vector<TrendingItem> top = trending.top("", "", "5m", 10, end);
+    for (std::size_t i = 0; i < std::min<std::size_t>(10, ranked.size()); ++i) {
+        for (const TrendingItem &item: top) found += item.item == names[ranked[i].second] ? 1 : 0;
+    }
+
+    std::cout << json{
+        {"events", events},
+        {"catalog", catalog},
+        {"ingest_ns_per_event", ingest_ns},
+        {"top10", windows},
+        {"recall_at_10_5m", static_cast<double>(found) / 10.0},
+        {"streams", trending.streams()},
+        {"memory_bytes", trending.memory_bytes()}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -0,0 +1,93 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+// Writes interactions (4M by default, from 1M Zipf-distributed users over a catalog of 200k
+// items) to beacon::reco::UserHistoryStore from several threads, then times recent() for the
+// most active users. Prints the write and read cost, how many users were held and evicted,
+// and the store's memory against its cap as JSON.
+// Usage: bench_user_history [interactions] [users] [threads] [max_mb]
+//
+#include <beacon/user_history.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace beacon::reco;
+using nlohmann::json;
+using Timer = std::chrono::steady_clock;
+
+namespace {
+    double elapsed_ns(Timer::time_point since) {
+        return std::chrono::duration<double, std::nano>(Timer::now() - since).count();
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t interactions = argc > 1 ? std::stoul(argv[1]) : 4000000;
+    const std::size_t users = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    const std::size_t threads = argc > 3 ? std::stoul(argv[3]) : 4;
+    const std::size_t max_mb = argc > 4 ? std::stoul(argv[4]) : 64;
+    const std::size_t catalog = 200000;
+    const std::vector<std::string> types = {"view", "click", "cart", "purchase"};
+
+    // Zipf(0.9) users by inverse transform over a precomputed CDF
+    std::vector<double> cdf(users);
+    double sum = 0.0;
+    for (std::size_t i = 0; i < users; ++i) cdf[i] = sum += 1.0 / std::pow(static_cast<double>(i + 1), 0.9);
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    std::vector<std::string> user_names(users);
+    std::vector<std::string> item_names(catalog);
+    for (std::size_t i = 0; i < users; ++i) user_names[i] = "user-" + std::to_string(i);
+    for (std::size_t i = 0; i < catalog; ++i) item_names[i] = "item-" + std::to_string(i);
+    std::vector<std::pair<std::uint32_t, std::uint32_t> > stream(interactions);
+    for (auto &[user, item]: stream) {
+        user = static_cast<std::uint32_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(random)) - cdf.begin());
+        item = static_cast<std::uint32_t>(random() % catalog);
+    }
+
+    UserHistoryConfig config;
+    config.max_bytes = max_mb << 20;
+    UserHistoryStore store(config);
+    const Timer::time_point ingest = Timer::now();
+    std::vector<std::thread> writers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        writers.emplace_back([&, t]() {
+            for (std::size_t i = t; i < interactions; i += threads) {
+                store.add(user_names[stream[i].first], item_names[stream[i].second], types[i % 4], i);
+            }
+        });
+    }
+    for (std::thread &writer: writers) writer.join();
+    const double ingest_ns = elapsed_ns(ingest) / static_cast<double>(interactions);
+
+    std::vector<double> samples;
+    samples.reserve(10000);
+    std::size_t returned = 0;
+    for (std::size_t i = 0; i < 10000; ++i) {
+        const Timer::time_point at = Timer::now();
+        returned += store.recent(user_names[i % 1000], 20).size();
+        samples.push_back(elapsed_ns(at) / 1000.0);
+    }
+    std::sort(samples.begin(), samples.end());
+    if (returned == 0) return 1;
+
+    std::cout << json{
+        {"interactions", interactions},
+        {"users", users},
+        {"threads", threads},
+        {"ingest_ns_per_interaction", ingest_ns},
+        {"recent20", {{"p50_us", samples[samples.size() / 2]}, {"p99_us", samples[samples.size() * 99 / 100]}}},
+        {"users_held", store.users()},
+        {"users_evicted", store.evicted()},
+        {"memory_bytes", store.memory_bytes()},
+        {"max_bytes", config.max_bytes}
+    }.dump(2) << std::endl;
+    return 0;
+}
@@ -468,6 +468,7 @@ class FieldBuilder {
         }
     };
 
+public:
     AbstractSchemaValidator() = default;
 
     /**
@@ -498,6 +499,49 @@ class FieldBuilder {
         return ValidationResult::ok();
     }
 
+    /**
+     * Validate a single top-level field as soon as its value is complete, e.g. while the
+     * rest of the object is still streaming in. Unknown fields are accepted, as in validate().
+     */
+    ValidationResult validate_field(const std::string& field_name, const nlohmann::json& value) const {
+        const auto it = schema_.find(field_name);
+        if (it == schema_.end()) return ValidationResult::ok();
+        ValidationResult res = it->second.validator->validate(value);
+        if (!res) return res.prepend_path(field_name);
+        return ValidationResult::ok();
+    }
+
+    /**
+     * Check only that every required field is present; pairs with validate_field().
+     */
+    ValidationResult validate_required(const nlohmann::json& json) const {
+        if (!json.is_object()) {
+            return ValidationResult::fail("Root is not an object");
+        }
+        for (const auto& [field_name, entry] : schema_) {
+            if (entry.requirement == FieldRequirement::Required && !json.contains(field_name)) {
+                return ValidationResult::fail("Missing required field '" + field_name + "'");
+            }
+        }
+        return ValidationResult::ok();
+    }
+
+    /**
+     * Name and version the schema is registered under, e.g. for recording rejected events.
+     */
+    void set_identity(std::string name, int version) {
+        name_ = std::move(name);
+        version_ = version;
+    }
+
+    const std::string& name() const {
+        return name_;
+    }
+
+    int version() const {
+        return version_;
+    }
+
 private:
     enum class FieldRequirement {
         Required,
@@ -510,6 +554,8 @@ private:
     };
 
     std::unordered_map<std::string, FieldSchemaEntry> schema_;
+    std::string name_;
+    int version_ = 1;
 
     void add_field_schema(std::string name, ValidatorPtr validator, FieldRequirement requirement) {
         schema_.emplace(std::move(name), FieldSchemaEntry{std::move(validator), requirement});
@@ -0,0 +1,93 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace beacon {
+    namespace reco {
+        struct Triplet {
+            std::uint32_t row;
+            std::uint32_t column;
+            float value;
+        };
+
+        /**
+         * A sparse matrix in compressed sparse row form: row r's columns, ascending, and their
+         * values at [offsets[r], offsets[r + 1]).
+         */
+        struct CsrMatrix {
+            std::size_t rows = 0;
+            std::size_t columns = 0;
+            std::vector<std::uint64_t> offsets{0};
+            std::vector<std::uint32_t> indices;
+            std::vector<float> values;
+
+            /**
+             * Sums the values of repeated (row, column) pairs.
+             */
+            static CsrMatrix from_triplets(std::size_t rows, std::size_t columns, std::vector<Triplet> triplets);
+
+            CsrMatrix transpose() const;
+
+            std::size_t nonzeros() const {
+                return indices.size();
+            }
+        };
+
+        struct AlsConfig {
+            std::size_t factors = 64;
+            std::size_t iterations = 15;
+            float regularization = 0.01f;
+            // confidence in an observed pair is 1 + alpha * its weight
+            float alpha = 40.0f;
+            // conjugate gradient steps per row and half-iteration, warm started from the
+            // previous iteration's factors
+            std::size_t cg_steps = 3;
+            // 0: one per core
+            std::size_t threads = 0;
+            std::uint64_t seed = 42;
+        };
+
+        struct AlsIteration {
+            std::size_t iteration = 0;
+            // Gram matrices of the fixed side, then the solves of each side
+            double gram_seconds = 0.0;
+            double user_seconds = 0.0;
+            double item_seconds = 0.0;
+        };
+
+        /**
+         * Row-major factors, `factors` floats per user and per item; a pair's predicted
+         * preference is their inner product.
+         */
+        struct AlsModel {
+            std::size_t factors = 0;
+            std::vector<float> users;
+            std::vector<float> items;
+        };
+
+        /**
+         * Implicit-feedback matrix factorization by weighted alternating least squares (Hu,
+         * Koren and Volinsky): every pair is a preference of 1 if observed and 0 if not, with
+         * confidence 1 + alpha * weight, and each half-iteration solves for one side with the
+         * other fixed.
+         *
+         * A row's normal equations are Y'Y + Y'(C - I)Y + regularization * I, the first term
+         * shared by all rows and the second touching only the row's observed columns, so each
+         * half-iteration computes Y'Y once and then runs cg_steps of conjugate gradient per row
+         * without ever forming the row's own matrix (Takacs et al.). Y'Y is computed in blocks
+         * of rows transposed into a scratch tile so that every entry is a contiguous SIMD dot
+         * product over the block, each thread summing its own blocks. Rows are solved in
+         * parallel, taken by the threads in small chunks so that heavy rows balance out.
+         *
+         * `on_iteration` is called after each iteration with its timings.
+         */
+        AlsModel train_als(const CsrMatrix &user_items, const AlsConfig &config,
+                           const std::function<void(const AlsIteration &)> &on_iteration = {});
+    } // namespace reco
+} // namespace beacon
@@ -0,0 +1,325 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include "consumer_group.h"
+#include "core_mesh.h"
+#include "delay_journal.h"
+#include "offset_committer.h"
+#include "recommendation_cache.h"
+#include "recommendation_engine.h"
+#include "replication_log.h"
+#include "timing_wheel.h"
+#include "trending.h"
+#include "user_history.h"
+#include "subscription_registry.h"
+#include "websocket_adapter.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace beacon {
+    /**
+     * Routes the broker's wire protocol (see docs/protocol.md): publishing and filtered
+     * subscriptions, idempotent batches, delayed delivery, consumer groups, replication,
+     * and recommendation, trending and history queries.
+     *
+     * Shared-nothing per adapter core: each core keeps the subscriptions of its own
+     * connections, matches a publish on the publisher's core and hands it to the others
+     * through a CoreMesh. Partition p of a group is owned by core p % cores; membership is
+     * shared and locked only on join, leave and disconnect. No lock is taken on the publish
+     * path other than those of a RecommendationEngine, TrendingTracker or UserHistoryStore.
+     */
+    class Broker {
+    public:
+        static constexpr std::uint32_t kDefaultPartitions = 16;
+        // delivered but uncommitted events kept per partition
+        static constexpr std::size_t kMaxUncommitted = 10000;
+        // producers whose last batch sequence is remembered
+        static constexpr std::size_t kMaxProducers = 100000;
+        // emptied groups whose delivered offsets each core remembers
+        static constexpr std::size_t kMaxLeftGroups = 10000;
+        // largest k of similar_items and recommend
+        static constexpr std::size_t kMaxRecommendations = 1000;
+        // longest recommend context
+        static constexpr std::size_t kMaxContextBytes = 256;
+
+        /**
+         * `offsets` persists consumer group offsets; without it they are kept in memory.
+         */
+        explicit Broker(WebSocketAdapter &adapter, consumer::OffsetStore *offsets = nullptr,
+                        delay::DelayStore *delayed = nullptr, delay::DelayConfig delays = {},
+                        replication::ReplicationConfig replication = {});
+
+        void handle(ConnectionId connection, nlohmann::json &&message);
+
+        void disconnect(ConnectionId connection);
+
+        /**
+         * Feeds published events to `engine` and serves queries from it. Call before the
+         * adapter runs.
+         */
+        void set_recommendations(RecommendationEngine *engine);
+
+        /**
+         * Caches recommend results in `cache`, dropping a user's once the engine applied one of
+         * their events. Call after set_recommendations(), else it throws std::logic_error, and
+         * before the adapter runs.
+         */
+        void set_recommendation_cache(reco::RecommendationCache *cache);
+
+        /**
+         * Counts published events in `tracker` and serves trending from it. Call before the
+         * adapter runs.
+         */
+        void set_trending(trending::TrendingTracker *tracker);
+
+        /**
+         * Records published events in `store` and serves recent from it. Call before the
+         * adapter runs.
+         */
+        void set_user_histories(reco::UserHistoryStore *store);
+
+    private:
+        /**
+         * A published event as passed between cores.
+         */
+        struct Event {
+            std::string topic;
+            nlohmann::json message;
+
+            /**
+             * The outbound frame, serialized once by whichever core first has a subscriber.
+             */
+            const std::string &frame() const;
+
+        private:
+            mutable std::once_flag serialized_;
+            mutable std::string frame_;
+        };
+
+        using GroupKey = std::pair<std::string, std::string>; // group, topic
+
+        /**
+         * One partition of a group, on the core that owns it.
+         */
+        struct Partition {
+            ConnectionId owner = 0;
+            std::uint64_t next_offset = 1;
+            std::uint64_t committed = 0;
+            // delivered frames above the committed offset, oldest first
+            std::deque<std::pair<std::uint64_t, std::string> > uncommitted;
+        };
+
+        /**
+         * The partitions of one group that a core owns.
+         */
+        struct GroupShard {
+            std::string group;
+            std::uint32_t partitions = 0;
+            std::uint64_t generation = 0;
+            std::string frame_suffix; // ,"group":"...","partition":
+            std::vector<Partition> owned; // partition p at p / cores
+        };
+
+        struct LeftGroup {
+            // next offset of each owned partition when the group's last member left
+            std::vector<std::uint64_t> next_offsets;
+            std::list<GroupKey>::iterator recency;
+        };
+
+        /**
+         * State owned by one core.
+         */
+        struct alignas(64) Shard {
+            SubscriptionRegistry subscriptions;
+            std::vector<const Subscription *> matched;
+            bool flush_scheduled = false;
+            std::unordered_map<std::string, std::vector<GroupShard> > groups; // by topic
+            std::map<GroupKey, LeftGroup> left_at;
+            // groups by when their last member left, most recent first, at most kMaxLeftGroups
+            std::list<GroupKey> left_recency;
+            std::unique_ptr<timing::TimingWheel<delay::DelayedEvent> > delayed;
+            bool delay_timer_armed = false;
+        };
+
+        void publish(std::size_t core, nlohmann::json &&message);
+
+        /**
+         * Delivers to the subscribers on every core.
+         */
+        void fan_out(std::size_t core, nlohmann::json &&message);
+
+        /**
+         * Holds the message back if it asks for a future delivery time. Returns false if it
+         * is to be published now.
+         */
+        bool delay(std::size_t core, nlohmann::json &message);
+
+        void schedule_delayed(std::size_t core, delay::DelayedEvent &&event);
+
+        void arm_delay_timer(std::size_t core);
+
+        void on_delay_tick(std::size_t core);
+
+        /**
+         * Core 0: reads the next window of delayed events from the store once the current
+         * one is half over.
+         */
+        void load_next_window(std::uint64_t now_ms);
+
+        void deliver(std::size_t core, const Event &event);
+
+        void flush(std::size_t core);
+
+        void publish_batch(ConnectionId connection, nlohmann::json &&message);
+
+        void subscribe(ConnectionId connection, const nlohmann::json &message);
+
+        void join(ConnectionId connection, const nlohmann::json &message);
+
+        void leave(ConnectionId connection, const nlohmann::json &message);
+
+        void commit(ConnectionId connection, const nlohmann::json &message);
+
+        /**
+         * Removes a member and rebalances. Caller holds groups_mutex_.
+         */
+        void leave_locked(ConnectionId connection, const GroupKey &key);
+
+        /**
+         * Sends the group's current assignment to its cores and members, once its committed
+         * offsets are known. Until the committer has read them from the store, the group is
+         * announced from the committer's thread when they arrive. Caller holds groups_mutex_.
+         */
+        void rebalance_locked(const GroupKey &key, const consumer::GroupMembership &membership);
+
+        /**
+         * Caller holds groups_mutex_, which keeps the updates of one group in order on every
+         * core.
+         */
+        void announce_locked(const GroupKey &key, const consumer::GroupMembership &membership,
+                             std::unordered_map<std::uint32_t, std::uint64_t> committed_offsets);
+
+        void apply_assignment(std::size_t core, const GroupKey &key, std::uint32_t partitions,
+                              std::uint64_t generation, const std::vector<ConnectionId> &owners,
+                              const std::unordered_map<std::uint32_t, std::uint64_t> &committed);
+
+        static GroupShard *find_group(Shard &shard, const GroupKey &key);
+
+        void deliver_to_groups(std::size_t core, const Event &event, std::vector<GroupShard> &groups);
+
+        void apply_commits(std::size_t core, ConnectionId connection, const GroupKey &key,
+                           const std::vector<std::pair<std::uint32_t, std::uint64_t> > &offsets);
+
+        void unsubscribe(ConnectionId connection, const nlohmann::json &message);
+
+        void reply_error(ConnectionId connection, const std::string &code, const std::string &detail);
+
+        void similar_items(ConnectionId connection, const nlohmann::json &message);
+
+        void recommend(ConnectionId connection, const nlohmann::json &message);
+
+        void top_trending(ConnectionId connection, const nlohmann::json &message);
+
+        void recent_interactions(ConnectionId connection, const nlohmann::json &message);
+
+        /**
+         * A connection following this broker, served on its core.
+         */
+        struct Follower {
+            std::uint64_t next = 0;
+            std::size_t in_flight = 0;
+            // caught up, pumped again on the next append
+            bool waiting = false;
+        };
+
+        void replicate(ConnectionId connection, const nlohmann::json &message);
+
+        void replica_ack(ConnectionId connection, const nlohmann::json &message);
+
+        /**
+         * Sends batches until the follower has max_in_flight unacknowledged or is caught up.
+         */
+        void pump_follower(ConnectionId connection);
+
+        void wake_followers();
+
+        /**
+         * Starts every follower over at the start of the log, after it was renumbered.
+         */
+        void resync_followers();
+
+        std::string replicating_frame_locked(std::uint64_t from) const;
+
+        void connect_upstream();
+
+        void on_upstream(ConnectionId connection, nlohmann::json &&message);
+
+        WebSocketAdapter &adapter_;
+        std::vector<Shard> shards_;
+        CoreMesh<std::shared_ptr<const Event> > mesh_;
+
+        struct Producer {
+            // last accepted batch sequence
+            std::uint64_t sequence;
+            std::list<std::string>::iterator recency;
+        };
+
+        // shared by all cores, locked once per batch
+        std::mutex producers_mutex_;
+        std::unordered_map<std::string, Producer> producer_sequences_;
+        // producers by their last batch, most recent first, at most kMaxProducers
+        std::list<std::string> producer_recency_;
+
+        // consumer group membership; shared by all cores, locked on membership changes only
+        std::mutex groups_mutex_;
+        std::map<GroupKey, consumer::GroupMembership> groups_;
+        std::unordered_map<ConnectionId, std::vector<GroupKey> > member_of_;
+        // generation last sent to each group's cores and members
+        std::map<GroupKey, std::uint64_t> announced_;
+
+        consumer::OffsetCommitter offsets_;
+
+        delay::DelayConfig delays_;
+        std::unique_ptr<delay::DelayJournal> delay_journal_;
+        // Assigning an id, deciding whether an event is beyond the in-memory window and
+        // journaling it happen under one lock, so a window load sees exactly the events that
+        // were left out of memory (those with an id below its watermark).
+        std::mutex delay_mutex_;
+        std::uint64_t next_delay_id_ = 1;
+        std::uint64_t memory_horizon_ms_ = std::numeric_limits<std::uint64_t>::max();
+        // window loads, core 0 only
+        std::uint64_t loaded_until_ms_ = 0;
+        std::uint64_t window_below_id_ = 0;
+        bool window_loading_ = false;
+        std::uint64_t window_retry_at_ms_ = 0;
+
+        replication::ReplicationConfig replication_;
+        std::unique_ptr<replication::ReplicationLog> log_;
+        // Followers and epochs are shared by all cores. Frames to a follower are queued under
+        // the lock, so a resync cannot slip between a batch and the offsets it was read at.
+        std::mutex replication_mutex_;
+        std::string epoch_;
+        std::unordered_map<ConnectionId, Follower> followers_;
+        // follower side; the link is served on one core at a time
+        std::atomic<ConnectionId> upstream_connection_{0};
+        std::string upstream_epoch_;
+        std::uint64_t upstream_next_ = 0;
+        std::uint64_t live_from_ = 0;
+
+        RecommendationEngine *recommendations_ = nullptr;
+        reco::RecommendationCache *recommendation_cache_ = nullptr;
+        trending::TrendingTracker *trending_ = nullptr;
+        reco::UserHistoryStore *user_histories_ = nullptr;
+    };
+} // namespace beacon
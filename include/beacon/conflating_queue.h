@@ -0,0 +1,77 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace beacon {
+    /**
+     * FIFO queue whose keyed entries are conflated: pushing a key that is already pending
+     * replaces the pending value in place instead of queuing another one. The entry keeps
+     * its original position, so a busy key cannot starve the others, and the number of
+     * pending keyed entries never exceeds the number of distinct keys.
+     * Entries pushed without a key are never conflated.
+     */
+    template<typename T>
+    class ConflatingQueue {
+    public:
+        void push(T value) {
+            entries_.push_back(Entry{std::string(), std::move(value), false});
+        }
+
+        void push(const std::string &key, T value) {
+            const auto it = index_.find(key);
+            if (it != index_.end()) {
+                entries_[it->second - head_].value = std::move(value);
+                ++conflated_;
+                return;
+            }
+            index_.emplace(key, head_ + entries_.size());
+            entries_.push_back(Entry{key, std::move(value), true});
+        }
+
+        /**
+         * Removes and returns the oldest entry. The queue must not be empty.
+         */
+        T pop() {
+            Entry entry = std::move(entries_.front());
+            entries_.pop_front();
+            ++head_;
+            if (entry.keyed) index_.erase(entry.key);
+            return std::move(entry.value);
+        }
+
+        bool empty() const {
+            return entries_.empty();
+        }
+
+        std::size_t size() const {
+            return entries_.size();
+        }
+
+        /**
+         * Number of values dropped because a newer value for the same key replaced them.
+         */
+        std::uint64_t conflated() const {
+            return conflated_;
+        }
+
+    private:
+        struct Entry {
+            std::string key;
+            T value;
+            bool keyed;
+        };
+
+        std::deque<Entry> entries_;
+        // key -> absolute position (head_ + offset) of its pending entry
+        std::unordered_map<std::string, std::uint64_t> index_;
+        std::uint64_t head_ = 0;
+        std::uint64_t conflated_ = 0;
+    };
+} // namespace beacon
@@ -0,0 +1,102 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace beacon::consumer {
+    using MemberId = std::uint64_t;
+
+    /**
+     * Partition of an event key, stable across processes and restarts (FNV-1a).
+     */
+    std::uint32_t partition_of(std::string_view key, std::uint32_t partitions);
+
+    /**
+     * Members of one consumer group and which of them owns each partition.
+     *
+     * Every change of membership rebalances: each member ends up with P/N or P/N+1
+     * partitions, and a partition only moves when its owner left or holds more than its
+     * share. Member id 0 is reserved for "unowned".
+     */
+    class GroupMembership {
+    public:
+        explicit GroupMembership(std::uint32_t partitions);
+
+        /**
+         * Returns false if the member was already in the group.
+         */
+        bool join(MemberId member);
+
+        /**
+         * Returns false if the member was not in the group.
+         */
+        bool leave(MemberId member);
+
+        bool contains(MemberId member) const;
+
+        bool empty() const {
+            return members_.empty();
+        }
+
+        std::uint32_t partitions() const {
+            return static_cast<std::uint32_t>(owners_.size());
+        }
+
+        /**
+         * Incremented by every rebalance.
+         */
+        std::uint64_t generation() const {
+            return generation_;
+        }
+
+        /**
+         * Owner of every partition, 0 while the group is empty.
+         */
+        const std::vector<MemberId> &owners() const {
+            return owners_;
+        }
+
+        const std::vector<MemberId> &members() const {
+            return members_;
+        }
+
+        std::vector<std::uint32_t> partitions_of(MemberId member) const;
+
+    private:
+        void rebalance();
+
+        std::vector<MemberId> members_; // in join order
+        std::vector<MemberId> owners_;
+        std::uint64_t generation_ = 0;
+    };
+
+    /**
+     * Last processed offset of one partition, as committed by the group's consumer.
+     */
+    struct CommittedOffset {
+        std::string group;
+        std::string topic;
+        std::uint32_t partition = 0;
+        std::uint64_t offset = 0;
+    };
+
+    /**
+     * Durable home of committed offsets.
+     */
+    class OffsetStore {
+    public:
+        virtual ~OffsetStore() = default;
+
+        virtual std::vector<CommittedOffset> load_offsets(const std::string &group, const std::string &topic) = 0;
+
+        /**
+         * Writes a batch in one round trip. An offset never moves backwards.
+         */
+        virtual void save_offsets(const std::vector<CommittedOffset> &offsets) = 0;
+    };
+} // namespace beacon::consumer
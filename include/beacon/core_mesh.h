@@ -0,0 +1,103 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include "spsc_queue.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace beacon {
+    /**
+     * Message passing between shared-nothing cores: one SpscQueue per ordered pair of
+     * cores, carrying batches rather than single values. A core send()s values to other
+     * cores while it handles events and flush()es once per loop turn, so the queue and the
+     * wake-up are paid per batch.
+     *
+     * A destination is woken at most once until it drain()s: flush() calls wake(to) only
+     * when `to` has no drain pending yet. Each core must only pass its own index as `from`
+     * to send()/flush() and as `to` to drain().
+     */
+    template<typename T>
+    class CoreMesh {
+    public:
+        using Batch = std::vector<T>;
+
+        explicit CoreMesh(std::size_t cores, std::size_t queue_capacity = 256)
+            : cores_(cores),
+              outgoing_(cores * cores),
+              inboxes_(std::make_unique<Inbox[]>(cores)) {
+            queues_.reserve(cores * cores);
+            for (std::size_t i = 0; i < cores * cores; ++i) {
+                queues_.push_back(std::make_unique<SpscQueue<Batch> >(queue_capacity));
+            }
+        }
+
+        std::size_t cores() const {
+            return cores_;
+        }
+
+        /**
+         * Queues `value` for core `to`. It is handed over on the next flush(from).
+         */
+        void send(std::size_t from, std::size_t to, T value) {
+            outgoing_[from * cores_ + to].push_back(std::move(value));
+        }
+
+        /**
+         * Hands the pending batches of core `from` to their destinations. Returns false if a
+         * destination's queue was full; its batch stays pending and flush() must be retried.
+         */
+        template<typename Wake>
+        bool flush(std::size_t from, Wake &&wake) {
+            bool complete = true;
+            for (std::size_t to = 0; to < cores_; ++to) {
+                Batch &batch = outgoing_[from * cores_ + to];
+                if (batch.empty()) continue;
+                if (!queues_[from * cores_ + to]->try_push(batch)) {
+                    complete = false;
+                    continue;
+                }
+                batch = Batch{};
+
+                // pairs with the fence in drain(): either we see the drain pending, or the
+                // drain sees our batch
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!inboxes_[to].pending.exchange(true, std::memory_order_acq_rel)) wake(to);
+            }
+            return complete;
+        }
+
+        /**
+         * Calls fn(T&) for every value queued for core `to`. Returns the number of values.
+         */
+        template<typename Fn>
+        std::size_t drain(std::size_t to, Fn &&fn) {
+            inboxes_[to].pending.store(false, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            std::size_t count = 0;
+            Batch batch;
+            for (std::size_t from = 0; from < cores_; ++from) {
+                SpscQueue<Batch> &queue = *queues_[from * cores_ + to];
+                while (queue.try_pop(batch)) {
+                    for (T &value: batch) fn(value);
+                    count += batch.size();
+                }
+            }
+            return count;
+        }
+
+    private:
+        struct alignas(64) Inbox {
+            std::atomic<bool> pending{false};
+        };
+
+        std::size_t cores_;
+        std::vector<std::unique_ptr<SpscQueue<Batch> > > queues_; // [from * cores + to]
+        std::vector<Batch> outgoing_;                            // [from * cores + to], owned by `from`
+        std::unique_ptr<Inbox[]> inboxes_;
+    };
+} // namespace beacon
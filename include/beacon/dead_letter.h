@@ -0,0 +1,148 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include "rate_limiter.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace beacon::deadletter {
+    /**
+     * An inbound event that failed its topic's schema.
+     */
+    struct DeadLetter {
+        std::string schema_name;
+        int schema_version = 0;
+        std::string topic;
+        std::string error_path;
+        std::string error_message;
+        // the message as received, cut at DeadLetterConfig::max_raw_bytes
+        std::string raw_payload;
+        bool truncated = false;
+    };
+
+    struct DeadLetterConfig {
+        // share of rejects kept, per schema; schemas without an entry use sample_rate
+        double sample_rate = 1.0;
+        std::unordered_map<std::string, double> schema_sample_rates;
+        // kept rejects per second and schema, after sampling; zero disables the cap
+        ratelimit::Limit per_schema{100.0, 200.0};
+        std::size_t max_raw_bytes = 16 * 1024;
+        // rejects waiting to be written; beyond this they are dropped
+        std::size_t max_queued = 10000;
+        std::size_t batch_size = 500;
+        std::chrono::milliseconds interval{500};
+
+        /**
+         * Reads BEACON_DLQ_SAMPLE_RATE, BEACON_DLQ_SAMPLE_RATES ("name=rate,..."),
+         * BEACON_DLQ_MAX_PER_SEC, BEACON_DLQ_BURST and BEACON_DLQ_MAX_RAW_BYTES.
+         */
+        static DeadLetterConfig from_env();
+    };
+
+    struct DeadLetterStats {
+        std::uint64_t kept = 0;
+        std::uint64_t sampled_out = 0;
+        std::uint64_t rate_limited = 0;
+        std::uint64_t queue_full = 0;
+        std::uint64_t written = 0;
+        std::uint64_t write_failed = 0;
+    };
+
+    /**
+     * Durable home of dead letters.
+     */
+    class DeadLetterStore {
+    public:
+        virtual ~DeadLetterStore() = default;
+
+        /**
+         * Writes a batch in one round trip.
+         */
+        virtual void store_dead_letters(const std::vector<DeadLetter> &letters) = 0;
+    };
+
+    /**
+     * Keeps rejected events for debugging without touching the ingest path's latency.
+     * admit() decides cheaply whether a reject is kept at all: each schema is sampled at
+     * its rate, deterministically (every 1/rate-th reject), and then capped by a token
+     * bucket, so a flood of bad events costs the database at most the cap. Kept rejects
+     * are queued and written in batches by a background thread; a failed batch is dropped
+     * and counted rather than retried, so a database outage cannot back up into ingest.
+     */
+    class DeadLetterSink {
+    public:
+        DeadLetterSink(DeadLetterStore &store, DeadLetterConfig config = {});
+
+        /**
+         * Writes what is still queued.
+         */
+        ~DeadLetterSink();
+
+        DeadLetterSink(const DeadLetterSink &) = delete;
+
+        DeadLetterSink &operator=(const DeadLetterSink &) = delete;
+
+        /**
+         * Whether a reject of `schema_name` is to be kept. Safe to call from any thread;
+         * past a schema's first reject it takes no exclusive lock.
+         */
+        bool admit(const std::string &schema_name);
+
+        /**
+         * Queues an admitted reject. Safe to call from any thread.
+         */
+        void submit(DeadLetter letter);
+
+        std::size_t max_raw_bytes() const {
+            return config_.max_raw_bytes;
+        }
+
+        DeadLetterStats stats() const;
+
+    private:
+        struct SchemaState {
+            explicit SchemaState(double rate, ratelimit::Limit limit) : rate(rate), bucket(limit) {
+            }
+
+            double rate;
+            std::atomic<std::uint64_t> seen{0};
+            ratelimit::TokenBucket bucket;
+        };
+
+        SchemaState &schema_state(const std::string &schema_name);
+
+        void run();
+
+        void write(std::unique_lock<std::mutex> &lock);
+
+        DeadLetterStore &store_;
+        DeadLetterConfig config_;
+
+        // states are never dropped, so a reference stays valid once found
+        mutable std::shared_mutex schemas_mutex_;
+        std::unordered_map<std::string, std::unique_ptr<SchemaState> > schemas_;
+        // counted by admit(), outside mutex_
+        std::atomic<std::uint64_t> sampled_out_{0};
+        std::atomic<std::uint64_t> rate_limited_{0};
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::deque<DeadLetter> queue_;
+        DeadLetterStats stats_;
+        bool stopping_ = false;
+
+        std::thread writer_;
+    };
+} // namespace beacon::deadletter
@@ -0,0 +1,127 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace beacon::delay {
+    /**
+     * An event held back until deliver_at, a Unix time in milliseconds. `message` is the
+     * serialized publish message.
+     */
+    struct DelayedEvent {
+        std::uint64_t id = 0;
+        std::uint64_t deliver_at_ms = 0;
+        std::string message;
+    };
+
+    struct DelayConfig {
+        // resolution of delivery times and period of each core's timer
+        std::chrono::milliseconds tick{10};
+        // with a store, only deliveries due within this window are held in memory; the
+        // next window is read from the store while the current one is half over
+        std::chrono::seconds window{3600};
+
+        /**
+         * Reads BEACON_DELAY_TICK_MS and BEACON_DELAY_WINDOW_SECS.
+         */
+        static DelayConfig from_env();
+    };
+
+    /**
+     * Durable home of delayed events.
+     */
+    class DelayStore {
+    public:
+        virtual ~DelayStore() = default;
+
+        /**
+         * Events due in (after_ms, until_ms] with an id below `below_id`.
+         */
+        virtual std::vector<DelayedEvent> load_delayed(std::uint64_t after_ms, std::uint64_t until_ms,
+                                                       std::uint64_t below_id) = 0;
+
+        virtual std::uint64_t max_delayed_id() = 0;
+
+        /**
+         * Writes a batch of new events and deletes a batch of delivered ones, in one
+         * transaction.
+         */
+        virtual void write_delayed(const std::vector<DelayedEvent> &added,
+                                   const std::vector<std::uint64_t> &delivered) = 0;
+    };
+
+    /**
+     * Write-behind log of delayed events in a DelayStore, kept off the event loops. New and
+     * delivered events are batched and written by a background thread; an event delivered
+     * before it was written is never written at all. Range loads queue behind the pending
+     * writes, so they see every event saved before they were requested.
+     */
+    class DelayJournal {
+    public:
+        using LoadHandler = std::function<void(std::vector<DelayedEvent> &&events, bool ok)>;
+
+        explicit DelayJournal(DelayStore &store, std::chrono::milliseconds interval = std::chrono::milliseconds(100),
+                              std::size_t max_pending = 10000);
+
+        /**
+         * Writes what is still pending.
+         */
+        ~DelayJournal();
+
+        DelayJournal(const DelayJournal &) = delete;
+
+        DelayJournal &operator=(const DelayJournal &) = delete;
+
+        void save(const DelayedEvent &event);
+
+        void delivered(std::uint64_t id);
+
+        /**
+         * Loads a range on the journal's thread, after the writes already queued, and passes
+         * the events to `done` on that thread.
+         */
+        void load(std::uint64_t after_ms, std::uint64_t until_ms, std::uint64_t below_id, LoadHandler done);
+
+        /**
+         * Writes everything pending now.
+         */
+        void flush();
+
+    private:
+        struct Load {
+            std::uint64_t after_ms;
+            std::uint64_t until_ms;
+            std::uint64_t below_id;
+            LoadHandler done;
+        };
+
+        void run();
+
+        bool write_pending(std::unique_lock<std::mutex> &lock);
+
+        DelayStore &store_;
+        std::chrono::milliseconds interval_;
+        std::size_t max_pending_;
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::unordered_map<std::uint64_t, DelayedEvent> added_;
+        std::vector<std::uint64_t> delivered_;
+        std::deque<Load> loads_;
+        bool stopping_ = false;
+
+        std::mutex store_mutex_;
+        std::thread writer_;
+    };
+} // namespace beacon::delay
@@ -0,0 +1,215 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace beacon {
+    namespace reco {
+        /**
+         * Instruction sets the scoring kernels come in, weakest first.
+         */
+        enum class SimdLevel {
+            Scalar,
+            Sse2,
+            Avx2,
+            Avx512
+        };
+
+        /**
+         * The best level this CPU (and OS) runs; Scalar off x86.
+         */
+        SimdLevel detect_simd();
+
+        /**
+         * "scalar", "sse2", "avx2" or "avx512".
+         */
+        SimdLevel parse_simd(const std::string &name);
+
+        const char *simd_name(SimdLevel level);
+
+        enum class EmbeddingMetric {
+            // raw inner product
+            Dot,
+            // inner product of the normalized vectors
+            Cosine
+        };
+
+        /**
+         * "dot" or "cosine".
+         */
+        EmbeddingMetric parse_embedding_metric(const std::string &name);
+
+        using DotProduct = float (*)(const float *a, const float *b, std::size_t count);
+
+        /**
+         * The inner product kernel for `level`, capped at what the CPU supports.
+         */
+        DotProduct dot_product(SimdLevel level = detect_simd());
+
+        // y += a * x
+        using ScaledAdd = void (*)(float a, const float *x, float *y, std::size_t count);
+
+        ScaledAdd scaled_add(SimdLevel level = detect_simd());
+
+        /**
+         * The k best (score, row) seen, worst on top of the heap; rows arrive in increasing order,
+         * so a tie never displaces an earlier row.
+         */
+        class TopK {
+        public:
+            explicit TopK(std::size_t k) : k_(k) {
+                heap_.reserve(k);
+            }
+
+            /**
+             * What a score has to beat to get in.
+             */
+            float threshold() const {
+                return threshold_;
+            }
+
+            void offer(float score, std::uint32_t row) {
+                if (heap_.size() < k_) {
+                    heap_.emplace_back(score, row);
+                    std::push_heap(heap_.begin(), heap_.end(), better);
+                    if (heap_.size() == k_) threshold_ = heap_.front().first;
+                    return;
+                }
+                std::pop_heap(heap_.begin(), heap_.end(), better);
+                heap_.back() = {score, row};
+                std::push_heap(heap_.begin(), heap_.end(), better);
+                threshold_ = heap_.front().first;
+            }
+
+            /**
+             * Offers the lanes of a tile's scores set in `mask`.
+             */
+            void offer_lanes(const float *scores, unsigned mask, std::uint32_t first_row) {
+                while (mask != 0) {
+                    const int lane = std::countr_zero(mask);
+                    mask &= mask - 1;
+                    if (scores[lane] > threshold_) offer(scores[lane], first_row + static_cast<std::uint32_t>(lane));
+                }
+            }
+
+            std::vector<std::pair<float, std::uint32_t> > take() {
+                std::sort_heap(heap_.begin(), heap_.end(), better);
+                return std::move(heap_);
+            }
+
+        private:
+            static bool better(const std::pair<float, std::uint32_t> &a, const std::pair<float, std::uint32_t> &b) {
+                return a.first > b.first || (a.first == b.first && a.second < b.second);
+            }
+
+            std::size_t k_;
+            float threshold_ = -std::numeric_limits<float>::infinity();
+            std::vector<std::pair<float, std::uint32_t> > heap_;
+        };
+
+        /**
+         * Allocates on cache line boundaries, so that every tile row is one aligned vector load.
+         */
+        template<typename T>
+        struct CacheAlignedAllocator {
+            using value_type = T;
+            static constexpr std::align_val_t kAlignment{64};
+
+            CacheAlignedAllocator() = default;
+
+            template<typename U>
+            CacheAlignedAllocator(const CacheAlignedAllocator<U> &) noexcept {
+            }
+
+            T *allocate(std::size_t count) {
+                return static_cast<T *>(::operator new(count * sizeof(T), kAlignment));
+            }
+
+            void deallocate(T *pointer, std::size_t) noexcept {
+                ::operator delete(pointer, kAlignment);
+            }
+
+            template<typename U>
+            bool operator==(const CacheAlignedAllocator<U> &) const noexcept {
+                return true;
+            }
+        };
+
+        /**
+         * Dense float32 vectors of one dimension, one per row id, scored by brute force against
+         * a query. Rows are stored structure-of-arrays in tiles of kTileRows: a tile holds
+         * value d of its rows contiguously, then value d + 1, so a kernel accumulates one tile's
+         * scores in vector registers with one broadcast and one aligned load per value. Scores
+         * are checked against the k-th best so far with one vector compare per tile, so the
+         * heap is only touched by rows that make it. The kernel is picked at construction from
+         * what the CPU supports. Rows never set score as absent. Not synchronized.
+         */
+        class EmbeddingMatrix {
+        public:
+            static constexpr std::size_t kTileRows = 16;
+
+            /**
+             * `simd` is capped at what the CPU supports.
+             */
+            explicit EmbeddingMatrix(std::size_t dimension, SimdLevel simd = detect_simd());
+
+            std::size_t dimension() const { return dimension_; }
+
+            SimdLevel simd() const { return simd_; }
+
+            void set_simd(SimdLevel simd);
+
+            /**
+             * Sets row `row` to `values`, which holds dimension() floats, growing the matrix as
+             * needed.
+             */
+            void set(std::uint32_t row, const float *values);
+
+            bool contains(std::uint32_t row) const;
+
+            /**
+             * Row `row`'s values; empty if it was never set.
+             */
+            std::vector<float> row(std::uint32_t row) const;
+
+            /**
+             * Rows set so far.
+             */
+            std::size_t size() const { return size_; }
+
+            /**
+             * Bytes held by rows and their scales.
+             */
+            std::size_t memory_bytes() const {
+                return (tiles_.capacity() + present_.capacity() + inverse_norms_.capacity()) * sizeof(float);
+            }
+
+            /**
+             * Up to k (score, row) of the rows scoring highest against `query` (dimension()
+             * floats), best first; ties go to the lower row.
+             */
+            std::vector<std::pair<float, std::uint32_t> > top_k(const float *query, std::size_t k,
+                                                                EmbeddingMetric metric) const;
+
+        private:
+            std::size_t dimension_;
+            SimdLevel simd_;
+            std::size_t size_ = 0;
+            // tile t's value d of lane l at (t * dimension_ + d) * kTileRows + l
+            std::vector<float, CacheAlignedAllocator<float> > tiles_;
+            // per row: 1 or 1 / norm once set, NaN before, so that an absent row never scores
+            std::vector<float, CacheAlignedAllocator<float> > present_;
+            std::vector<float, CacheAlignedAllocator<float> > inverse_norms_;
+        };
+    } // namespace reco
+} // namespace beacon
@@ -0,0 +1,164 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace beacon {
+    /**
+     * High dynamic range histogram of non-negative integer values (e.g. nanoseconds), after
+     * Gil Tene's HdrHistogram. Values from lowest to highest are recorded with
+     * `significant_digits` decimal digits of precision: buckets double in width, and each is
+     * split into enough linear sub-buckets for that precision, so the memory needed is
+     * logarithmic in the range. Recording is a few shifts and an increment. Not thread-safe;
+     * keep one per thread and merge() them.
+     */
+    class HdrHistogram {
+    public:
+        HdrHistogram(std::uint64_t lowest, std::uint64_t highest, int significant_digits) {
+            if (lowest < 1 || highest < 2 * lowest || significant_digits < 1 || significant_digits > 5) {
+                throw std::invalid_argument("invalid HdrHistogram range or precision");
+            }
+            lowest_ = lowest;
+            highest_ = highest;
+
+            unit_magnitude_ = static_cast<int>(std::floor(std::log2(static_cast<double>(lowest))));
+            const double single_unit_resolution = 2.0 * std::pow(10.0, significant_digits);
+            const int sub_bucket_count_magnitude = static_cast<int>(std::ceil(std::log2(single_unit_resolution)));
+            sub_bucket_half_count_magnitude_ = std::max(sub_bucket_count_magnitude, 1) - 1;
+            sub_bucket_count_ = std::int64_t{1} << (sub_bucket_half_count_magnitude_ + 1);
+            sub_bucket_half_count_ = sub_bucket_count_ / 2;
+            sub_bucket_mask_ = static_cast<std::uint64_t>(sub_bucket_count_ - 1) << unit_magnitude_;
+
+            // buckets needed to cover `highest`
+            std::uint64_t smallest_untrackable = static_cast<std::uint64_t>(sub_bucket_count_) << unit_magnitude_;
+            int buckets = 1;
+            while (smallest_untrackable <= highest) {
+                if (smallest_untrackable > std::numeric_limits<std::uint64_t>::max() / 2) {
+                    ++buckets;
+                    break;
+                }
+                smallest_untrackable <<= 1;
+                ++buckets;
+            }
+            counts_.assign(static_cast<std::size_t>((buckets + 1) * sub_bucket_half_count_), 0);
+        }
+
+        /**
+         * Records `count` occurrences of `value`; values beyond the range are clamped to it.
+         */
+        void record(std::uint64_t value, std::uint64_t count = 1) {
+            value = std::clamp(value, lowest_, highest_);
+            counts_[index_of(value)] += count;
+            total_ += count;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+            sum_ += static_cast<double>(value) * static_cast<double>(count);
+        }
+
+        /**
+         * Adds the counts of a histogram of the same range and precision.
+         */
+        void merge(const HdrHistogram &other) {
+            if (other.counts_.size() != counts_.size() || other.unit_magnitude_ != unit_magnitude_) {
+                throw std::invalid_argument("merging HdrHistograms of different layouts");
+            }
+            for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+            total_ += other.total_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+            sum_ += other.sum_;
+        }
+
+        /**
+         * Smallest recorded value such that `percentile` percent of the values are at or
+         * below it (within the histogram's precision). Zero if nothing was recorded.
+         */
+        std::uint64_t value_at_percentile(double percentile) const {
+            if (total_ == 0) return 0;
+            const double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+            // rounded rather than ceiled, so 99.9% of 1000 is 999 despite floating point
+            const auto wanted = std::max<std::uint64_t>(
+                1, static_cast<std::uint64_t>(fraction * static_cast<double>(total_) + 0.5));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < counts_.size(); ++i) {
+                seen += counts_[i];
+                if (seen >= wanted) return std::min(highest_equivalent(value_at_index(i)), max_);
+            }
+            return max_;
+        }
+
+        std::uint64_t count() const {
+            return total_;
+        }
+
+        std::uint64_t min() const {
+            return total_ == 0 ? 0 : min_;
+        }
+
+        std::uint64_t max() const {
+            return max_;
+        }
+
+        double mean() const {
+            return total_ == 0 ? 0.0 : sum_ / static_cast<double>(total_);
+        }
+
+    private:
+        int bucket_index(std::uint64_t value) const {
+            const int pow2_ceiling = 64 - std::countl_zero(value | sub_bucket_mask_);
+            return pow2_ceiling - unit_magnitude_ - (sub_bucket_half_count_magnitude_ + 1);
+        }
+
+        std::size_t index_of(std::uint64_t value) const {
+            const int bucket = bucket_index(value);
+            const auto sub_bucket = static_cast<std::int64_t>(value >> (bucket + unit_magnitude_));
+            return static_cast<std::size_t>(((static_cast<std::int64_t>(bucket) + 1) << sub_bucket_half_count_magnitude_) +
+                                            (sub_bucket - sub_bucket_half_count_));
+        }
+
+        std::uint64_t value_at_index(std::size_t index) const {
+            auto bucket = static_cast<std::int64_t>(index >> sub_bucket_half_count_magnitude_) - 1;
+            auto sub_bucket = static_cast<std::int64_t>(index & static_cast<std::size_t>(sub_bucket_half_count_ - 1)) +
+                              sub_bucket_half_count_;
+            if (bucket < 0) {
+                sub_bucket -= sub_bucket_half_count_;
+                bucket = 0;
+            }
+            return static_cast<std::uint64_t>(sub_bucket) << (bucket + unit_magnitude_);
+        }
+
+        /**
+         * Largest value that lands in the same sub-bucket as `value`.
+         */
+        std::uint64_t highest_equivalent(std::uint64_t value) const {
+            const int bucket = bucket_index(value);
+            const auto sub_bucket = static_cast<std::int64_t>(value >> (bucket + unit_magnitude_));
+            const int adjusted = sub_bucket >= sub_bucket_count_ ? bucket + 1 : bucket;
+            const std::uint64_t range = std::uint64_t{1} << (unit_magnitude_ + adjusted);
+            const std::uint64_t lowest_equivalent = static_cast<std::uint64_t>(sub_bucket) << (bucket + unit_magnitude_);
+            return lowest_equivalent + range - 1;
+        }
+
+        std::uint64_t lowest_ = 1;
+        std::uint64_t highest_ = 1;
+        int unit_magnitude_ = 0;
+        int sub_bucket_half_count_magnitude_ = 0;
+        std::int64_t sub_bucket_count_ = 0;
+        std::int64_t sub_bucket_half_count_ = 0;
+        std::uint64_t sub_bucket_mask_ = 0;
+        std::vector<std::uint64_t> counts_;
+
+        std::uint64_t total_ = 0;
+        std::uint64_t min_ = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t max_ = 0;
+        double sum_ = 0.0;
+    };
+} // namespace beacon
@@ -0,0 +1,105 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <beacon/embedding_matrix.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace beacon {
+    namespace reco {
+        struct HnswConfig {
+            std::size_t dimension = 0;
+            // cosine vectors are normalized on the way in, and then compared by inner product
+            EmbeddingMetric metric = EmbeddingMetric::Cosine;
+            // links per node on the upper layers; twice as many on the bottom one
+            std::size_t m = 16;
+            // candidates kept while looking for a new node's neighbors
+            std::size_t ef_construction = 200;
+            // candidates kept while searching, unless a search asks otherwise; at least k
+            std::size_t ef_search = 64;
+            std::uint64_t seed = 42;
+        };
+
+        /**
+         * Approximate nearest neighbors by Hierarchical Navigable Small World graph (Malkov and
+         * Yashunin): every vector is a node on the bottom layer and, with probability falling
+         * by a factor of m per layer, on the layers above it. A search descends greedily from
+         * the top layer's entry point and widens to ef candidates on the bottom layer; an
+         * insert does the same with ef_construction and links the node to the neighbors the
+         * selection heuristic keeps, pruning any neighbor's list that overflows.
+         *
+         * add() and search() are safe to call from any thread at the same time: nodes never
+         * move once allocated, each node's links are behind its own lock, and an insert that
+         * raises the top layer holds the entry point until it is done. Vectors are keyed by a
+         * caller's label; adding a label again replaces it with a new node and leaves the old
+         * one in the graph as a tombstone that searches pass through but never return, nor
+         * count among their ef candidates. Once tombstones outnumber the live nodes, the add
+         * that tipped it rebuilds the graph without them, excluding searches meanwhile.
+         */
+        class HnswIndex {
+        public:
+            explicit HnswIndex(HnswConfig config);
+
+            ~HnswIndex();
+
+            HnswIndex(const HnswIndex &) = delete;
+
+            HnswIndex &operator=(const HnswIndex &) = delete;
+
+            const HnswConfig &config() const;
+
+            /**
+             * Adds `values` (dimension floats) under `label`.
+             */
+            void add(std::uint32_t label, const float *values);
+
+            /**
+             * Adds labels[i] with values[i * dimension ...] on `threads` threads.
+             */
+            void add_all(const std::vector<std::uint32_t> &labels, const float *values, std::size_t threads);
+
+            /**
+             * Up to k (score, label) closest to `query`, best first. `ef` of 0 uses ef_search.
+             */
+            std::vector<std::pair<float, std::uint32_t> > search(const float *query, std::size_t k,
+                                                                 std::size_t ef = 0) const;
+
+            /**
+             * The vector stored under `label`, normalized under cosine; empty if there is none.
+             */
+            std::vector<float> vector(std::uint32_t label) const;
+
+            /**
+             * Labels indexed.
+             */
+            std::size_t size() const;
+
+            /**
+             * Renames every label, e.g. after loading into a process that numbers items
+             * differently; excludes add() and search() while it runs.
+             */
+            void relabel(const std::function<std::uint32_t(std::uint32_t)> &rename);
+
+            /**
+             * Writes the graph and vectors; excludes add() while it runs.
+             */
+            void save(std::ostream &out) const;
+
+            /**
+             * Reads what save() wrote; throws std::runtime_error if it is not that.
+             */
+            static std::unique_ptr<HnswIndex> load(std::istream &in);
+
+        private:
+            struct Impl;
+            std::unique_ptr<Impl> impl_;
+        };
+    } // namespace reco
+} // namespace beacon
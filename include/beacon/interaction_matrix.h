@@ -0,0 +1,188 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <beacon/als.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace beacon {
+    namespace reco {
+        /**
+         * A CsrMatrix packed for memory and sequential scans. Each row is one run of bytes
+         * holding, per non-zero in ascending column order, the gap from the previous column
+         * (the first from 0) as a LEB128 varint and the value as an 8-bit code; the row's
+         * values are code * its scale, the scale being its largest value / 255, and a value
+         * never codes to 0. Rows cost 12 bytes and non-zeros two to three bytes against eight in
+         * a CsrMatrix, at an error of at most 1/510 of the row's largest value (again for each
+         * merge() that touches the row). Values must be positive.
+         */
+        class PackedCsrMatrix {
+        public:
+            PackedCsrMatrix() = default;
+
+            static PackedCsrMatrix pack(const CsrMatrix &matrix);
+
+            CsrMatrix unpack() const;
+
+            /**
+             * This matrix plus `triplets`, which must be sorted by row then column with no pair
+             * repeated; values of pairs present in both are summed. Rows the triplets leave
+             * alone are copied as they are, the others decoded and packed again. The result has
+             * at least as many rows and columns as either.
+             */
+            PackedCsrMatrix merge(const std::vector<Triplet> &triplets, std::size_t rows, std::size_t columns) const;
+
+            /**
+             * Calls visit(column, value) for each non-zero of `row` in column order.
+             */
+            template<typename F>
+            void for_each(std::size_t row, F &&visit) const {
+                if (row >= rows_) return;
+                const std::uint8_t *at = bytes_.data() + offsets_[row];
+                const std::uint8_t *end = bytes_.data() + offsets_[row + 1];
+                const float scale = scales_[row];
+                std::uint32_t column = 0;
+                while (at < end) {
+                    std::uint32_t gap = 0;
+                    for (unsigned shift = 0;; shift += 7) {
+                        const std::uint8_t byte = *at++;
+                        gap |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+                        if (byte < 0x80) break;
+                    }
+                    column += gap;
+                    visit(column, static_cast<float>(*at++) * scale);
+                }
+            }
+
+            std::size_t rows() const {
+                return rows_;
+            }
+
+            std::size_t columns() const {
+                return columns_;
+            }
+
+            std::size_t nonzeros() const {
+                return nonzeros_;
+            }
+
+            std::size_t memory_bytes() const;
+
+        private:
+            std::size_t rows_ = 0;
+            std::size_t columns_ = 0;
+            std::size_t nonzeros_ = 0;
+            std::vector<std::uint64_t> offsets_{0};
+            std::vector<float> scales_;
+            std::vector<std::uint8_t> bytes_;
+        };
+
+        /**
+         * A growing row x column matrix of summed weights, such as users' interactions with
+         * items, readable by row and by column, that forgets its oldest entries past a cap.
+         *
+         * Additions go to a small unsorted delta, which merge() sorts into a run: the delta's
+         * pairs, summed, by row and by column. Runs are merged two at a time while the newer
+         * is at least half the older, so a pair is copied about log2(runs) times, and the
+         * oldest run is folded into the newest generation, packed in both orientations (see
+         * PackedCsrMatrix), once it holds an eighth of it. A generation holding max_entries / 4
+         * entries takes no more, and generations beyond max_entries entries in all are dropped,
+         * oldest first, so a merge costs at most a generation's worth of copying and memory
+         * stays near max_entries entries plus a generation's per-row and per-column overhead
+         * each. With max_entries 0 nothing is forgotten and there is one generation.
+         *
+         * The value at a pair is its sum over generations, runs and delta. Every step builds
+         * new structures without blocking readers or adders and swaps them in. Reads scan the
+         * delta, so keep it small: add() says when it has reached merge_every entries.
+         *
+         * Safe to use from any thread; merges are serialized.
+         */
+        class InteractionMatrix {
+        public:
+            explicit InteractionMatrix(std::size_t merge_every = 65536, std::size_t max_entries = 0);
+
+            /**
+             * Adds `value` to (row, column); throws std::invalid_argument unless it is positive.
+             * Returns true when the delta has reached merge_every entries and it is time to
+             * merge().
+             */
+            bool add(std::uint32_t row, std::uint32_t column, float value);
+
+            /**
+             * Turns the delta into a run, then merges runs, folds one into a generation and
+             * drops generations as described above.
+             */
+            void merge();
+
+            /**
+             * Row `row`'s (column, value) pairs, in column order.
+             */
+            std::vector<std::pair<std::uint32_t, float> > row(std::uint32_t row) const;
+
+            /**
+             * Column `column`'s (row, value) pairs, in row order.
+             */
+            std::vector<std::pair<std::uint32_t, float> > column(std::uint32_t column) const;
+
+            /**
+             * Everything as a CsrMatrix with at least `rows` rows and `columns` columns.
+             */
+            CsrMatrix to_csr(std::size_t rows = 0, std::size_t columns = 0) const;
+
+            /**
+             * Entries merged and kept; a pair counts once in each run and generation it is in.
+             */
+            std::size_t nonzeros() const;
+
+            /**
+             * Additions waiting for merge().
+             */
+            std::size_t pending() const;
+
+            /**
+             * Packed generations currently held.
+             */
+            std::size_t generations() const;
+
+            /**
+             * Bytes held by the generations, the runs and the delta.
+             */
+            std::size_t memory_bytes() const;
+
+        private:
+            struct Packed {
+                PackedCsrMatrix rows;
+                PackedCsrMatrix columns;
+            };
+
+            // summed and sorted by row then column, and the same transposed
+            struct Run {
+                std::vector<Triplet> by_row;
+                std::vector<Triplet> by_column;
+            };
+
+            struct State {
+                // oldest first
+                std::vector<std::shared_ptr<const Packed> > generations;
+                std::vector<std::shared_ptr<const Run> > runs;
+            };
+
+            std::vector<std::pair<std::uint32_t, float> > line(std::uint32_t line, bool by_row) const;
+
+            std::size_t merge_every_;
+            std::size_t max_entries_;
+            mutable std::mutex mutex_;
+            std::shared_ptr<const State> state_;
+            // added since the last merge, and taken by the merge running, if any
+            std::vector<Triplet> delta_;
+            std::vector<Triplet> merging_;
+            std::mutex merge_mutex_;
+        };
+    } // namespace reco
+} // namespace beacon
@@ -0,0 +1,103 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace beacon {
+    /**
+     * Dense uint32 ids for strings, handed out in order of first sight from 0, and the strings
+     * back by id.
+     *
+     * Strings are copied once into an arena of large chunks and never move, so name() hands
+     * out views that live as long as the interner. The reverse table is a list of segments
+     * doubling in size, each published once, so name() takes no lock. The forward table is
+     * split into 64 open-addressing shards by hash, each under its own reader-writer lock, so
+     * lookups of known strings from many threads only share a lock with the same shard, and
+     * store just a 32-bit hash and the id per slot (comparing strings through the reverse
+     * table). Only a string seen for the first time takes the arena lock, which keeps ids
+     * dense and in order.
+     *
+     * Names may also be held by reference instead, for stores that must forget them again:
+     * acquire() counts a reference and release() drops one, and a name whose last reference
+     * goes is removed, its bytes (allocated on their own rather than in the arena) freed and
+     * its id handed out again. intern() pins a name, which is then never removed. An id's
+     * name() may only be read while the id is pinned or referenced.
+     *
+     * snapshot() writes every string in id order as one block of lengths and one of bytes;
+     * restore() reads them back into a single arena chunk, pinned, so ids survive restarts.
+     */
+    class Interner {
+    public:
+        Interner();
+
+        ~Interner();
+
+        Interner(const Interner &) = delete;
+
+        Interner &operator=(const Interner &) = delete;
+
+        /**
+         * The id of `name`, handing out the next one if it is new. `created(id)` runs for a
+         * new name under the lock that orders them, so calls to it never overlap, and before
+         * size() counts the id.
+         */
+        std::uint32_t intern(std::string_view name, const std::function<void(std::uint32_t)> &created = {});
+
+        /**
+         * The id of `name`, handing out one if it is new, with one more reference to it.
+         * `created(id)` runs for a new name as in intern().
+         */
+        std::uint32_t acquire(std::string_view name, const std::function<void(std::uint32_t)> &created = {});
+
+        /**
+         * Drops a reference acquire() took. Returns true if that removed the name: it was the
+         * last and the name is not pinned.
+         */
+        bool release(std::uint32_t id);
+
+        std::optional<std::uint32_t> find(std::string_view name) const;
+
+        /**
+         * The string with id `id`, which must be pinned or referenced; the view stays valid
+         * as long as it is.
+         */
+        std::string_view name(std::uint32_t id) const;
+
+        /**
+         * One past the highest id handed out. Unless names were released, every id below it
+         * can be passed to name().
+         */
+        std::size_t size() const;
+
+        /**
+         * Names held, pinned or referenced.
+         */
+        std::size_t names() const;
+
+        /**
+         * Bytes held by strings, the reverse table and the hash tables.
+         */
+        std::size_t memory_bytes() const;
+
+        void snapshot(std::ostream &out) const;
+
+        /**
+         * Reads a snapshot() into this interner, which must be empty. Throws
+         * std::runtime_error if it is not, or if the snapshot is malformed, leaving it empty.
+         * Meant for startup: nothing else may use the interner meanwhile.
+         */
+        void restore(std::istream &in);
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+} // namespace beacon
@@ -0,0 +1,182 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace beacon::json_stream {
+    /**
+     * SAX events emitted by JsonStreamParser. Returning false from any event stops parsing.
+     */
+    class SaxHandler {
+    public:
+        virtual ~SaxHandler() = default;
+
+        virtual bool null() = 0;
+
+        virtual bool boolean(bool value) = 0;
+
+        virtual bool number_integer(std::int64_t value) = 0;
+
+        virtual bool number_unsigned(std::uint64_t value) = 0;
+
+        virtual bool number_float(double value) = 0;
+
+        virtual bool string(std::string &value) = 0;
+
+        virtual bool start_object() = 0;
+
+        virtual bool key(std::string &value) = 0;
+
+        virtual bool end_object() = 0;
+
+        virtual bool start_array() = 0;
+
+        virtual bool end_array() = 0;
+    };
+
+    /**
+     * Push-style incremental JSON parser: input arrives in arbitrary chunks (e.g. WebSocket
+     * fragments) and is turned into SAX events as soon as each token is complete, so invalid
+     * input is rejected at the first bad byte without buffering the whole document.
+     */
+    class JsonStreamParser {
+    public:
+        explicit JsonStreamParser(SaxHandler &handler, std::size_t max_depth = 128);
+
+        /**
+         * Parses the next chunk. Returns false once the input is invalid or the handler
+         * stopped parsing; further input is then ignored until reset().
+         */
+        bool feed(std::string_view chunk);
+
+        /**
+         * Signals the end of input. Returns true if exactly one complete value was parsed.
+         */
+        bool finish();
+
+        void reset();
+
+        bool failed() const {
+            return failed_;
+        }
+
+        /**
+         * Description of the syntax error, empty if the handler stopped parsing.
+         */
+        const std::string &error() const {
+            return error_;
+        }
+
+        /**
+         * Number of bytes consumed so far.
+         */
+        std::size_t offset() const {
+            return offset_;
+        }
+
+    private:
+        enum class State {
+            Value,         // a value must follow
+            FirstKeyOrEnd, // just after '{'
+            Key,           // after ',' in an object
+            Colon,
+            FirstValueOrEnd, // just after '['
+            CommaOrEnd,
+            String,
+            Escape,
+            Unicode,
+            Number,
+            Literal,
+            Done
+        };
+
+        bool fail(std::string message);
+
+        bool step(char c);
+
+        bool begin_value(char c);
+
+        bool end_value();
+
+        bool end_string();
+
+        bool end_number();
+
+        bool string_byte(unsigned char c);
+
+        bool append_code_point(std::uint32_t code_point);
+
+        SaxHandler &handler_;
+        std::size_t max_depth_;
+
+        State state_ = State::Value;
+        std::vector<char> containers_; // '{' or '['
+        bool string_is_key_ = false;
+        std::string token_;
+        const char *literal_ = nullptr;
+        std::size_t literal_pos_ = 0;
+        std::uint32_t unicode_ = 0;
+        int unicode_digits_ = 0;
+        std::uint32_t high_surrogate_ = 0;
+        // UTF-8 validation inside strings: continuation bytes still expected and the
+        // allowed range of the next one
+        int utf8_remaining_ = 0;
+        unsigned char utf8_lower_ = 0x80;
+        unsigned char utf8_upper_ = 0xBF;
+
+        std::size_t offset_ = 0;
+        bool failed_ = false;
+        std::string error_;
+    };
+
+    /**
+     * SaxHandler that assembles the parsed document as nlohmann::json.
+     */
+    class DomBuilder : public SaxHandler {
+    public:
+        bool null() override;
+
+        bool boolean(bool value) override;
+
+        bool number_integer(std::int64_t value) override;
+
+        bool number_unsigned(std::uint64_t value) override;
+
+        bool number_float(double value) override;
+
+        bool string(std::string &value) override;
+
+        bool start_object() override;
+
+        bool key(std::string &value) override;
+
+        bool end_object() override;
+
+        bool start_array() override;
+
+        bool end_array() override;
+
+        nlohmann::json &result() {
+            return root_;
+        }
+
+        const nlohmann::json &result() const {
+            return root_;
+        }
+
+        void reset();
+
+    private:
+        nlohmann::json *put(nlohmann::json value);
+
+        nlohmann::json root_;
+        std::vector<nlohmann::json *> stack_;
+        nlohmann::json *object_element_ = nullptr;
+    };
+} // namespace beacon::json_stream
@@ -0,0 +1,131 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include "consumer_group.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace beacon::consumer {
+    struct OffsetCommitConfig {
+        // dirty offsets are written at least this often
+        std::chrono::milliseconds interval{1000};
+        // ...or as soon as this many partitions have a new offset
+        std::size_t max_dirty = 4096;
+    };
+
+    /**
+     * Write-behind cache of committed offsets. Commits only update memory and are written
+     * to the OffsetStore by a background thread, one batch per interval, keeping just the
+     * newest offset of each partition. A failed write is kept and retried with the next
+     * batch. Without a store the offsets live in memory only.
+     *
+     * A group's committed offsets are read from the store once; load() does so on the
+     * background thread, so that no event loop waits on the database. A failed read is not
+     * remembered: load() retries it every interval, and committed() on its next call.
+     */
+    class OffsetCommitter {
+    public:
+        using Offsets = std::unordered_map<std::uint32_t, std::uint64_t>;
+
+        /**
+         * Runs on the background thread, without the committer's locks held.
+         */
+        using Loaded = std::function<void(const Offsets &)>;
+
+        explicit OffsetCommitter(OffsetStore *store, OffsetCommitConfig config = {});
+
+        /**
+         * Writes what is still dirty.
+         */
+        ~OffsetCommitter();
+
+        OffsetCommitter(const OffsetCommitter &) = delete;
+
+        OffsetCommitter &operator=(const OffsetCommitter &) = delete;
+
+        /**
+         * Committed offset per partition of a group's topic. Read from the store the first
+         * time a group and topic is asked for, from memory after that. Blocks on the store;
+         * event loops use cached() and load() instead.
+         */
+        Offsets committed(const std::string &group, const std::string &topic);
+
+        /**
+         * The committed offsets of a group's topic if they were read already; never blocks
+         * on the store.
+         */
+        std::optional<Offsets> cached(const std::string &group, const std::string &topic) const;
+
+        /**
+         * Reads the committed offsets of a group's topic on the background thread, retrying
+         * every interval until the store answers, then passes them to `loaded`. Safe to
+         * call with locks held that `loaded` takes. Without a store, cached() always has
+         * them, but `loaded` still runs on the background thread.
+         */
+        void load(const std::string &group, const std::string &topic, Loaded loaded);
+
+        /**
+         * Records a commit. Offsets lower than the partition's current one are ignored.
+         * Safe to call from any thread.
+         */
+        void commit(const std::string &group, const std::string &topic, std::uint32_t partition,
+                    std::uint64_t offset);
+
+        /**
+         * Writes every dirty offset now and waits for it.
+         */
+        void flush();
+
+        std::uint64_t batches_written() const;
+
+    private:
+        using Key = std::tuple<std::string, std::string, std::uint32_t>;
+        using GroupKey = std::pair<std::string, std::string>;
+
+        void run();
+
+        /**
+         * Reads what load() asked for and runs its callbacks. Returns false if a read failed.
+         */
+        bool load_pending(std::unique_lock<std::mutex> &lock);
+
+        /**
+         * Merges offsets read from the store into the cache, keeping the higher of each.
+         * Caller holds mutex_.
+         */
+        Offsets &merge_loaded(const GroupKey &key, const Offsets &loaded);
+
+        bool write_dirty(std::unique_lock<std::mutex> &lock);
+
+        OffsetStore *store_;
+        OffsetCommitConfig config_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::map<GroupKey, Offsets> cache_;
+        // groups whose offsets were read from the store, so cache_ has the last word on them
+        std::set<GroupKey> loaded_;
+        // groups load() is to read, with who is waiting for them
+        std::map<GroupKey, std::vector<Loaded> > loads_;
+        std::map<Key, std::uint64_t> dirty_;
+        std::uint64_t batches_written_ = 0;
+        bool stopping_ = false;
+
+        // serializes use of the store, which holds a single connection
+        std::mutex store_mutex_;
+        std::thread writer_;
+    };
+} // namespace beacon::consumer
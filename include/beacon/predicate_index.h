@@ -0,0 +1,158 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace beacon::filter {
+    /**
+     * Exception type thrown for malformed subscription filters.
+     */
+    class FilterError : public std::runtime_error {
+    public:
+        explicit FilterError(const std::string &msg) : std::runtime_error(msg) {
+        }
+    };
+
+    enum class PredicateKind {
+        Equals, // equality or IN: the field equals one of `keys`
+        Greater,
+        GreaterEqual,
+        Less,
+        LessEqual
+    };
+
+    /**
+     * A single condition on one payload field. A subscription matches an event when
+     * every one of its predicates holds.
+     */
+    struct Predicate {
+        std::string field; // JSON pointer into the payload
+        PredicateKind kind = PredicateKind::Equals;
+        std::vector<std::string> keys; // canonical value keys, Equals only
+        double bound = 0.0;            // range kinds only
+    };
+
+    using Filter = std::vector<Predicate>;
+
+    /**
+     * Parses a subscription filter of the form
+     *
+     *   {"region": "eu", "tier": {"in": ["gold", "silver"]}, "price": {"gte": 10, "lt": 20}}
+     *
+     * A plain value means equality; objects combine the operators eq, in, gt, gte, lt and lte.
+     * Field names are payload keys or JSON pointers. Throws FilterError on malformed input.
+     */
+    Filter parse_filter(const nlohmann::json &spec);
+
+    /**
+     * Evaluates a filter against a payload directly, without an index.
+     */
+    bool evaluate(const Filter &filter, const nlohmann::json &payload);
+
+    /**
+     * Canonical equality key of a scalar JSON value, so 5 and 5.0 compare equal.
+     * Returns an empty string for arrays and objects, which cannot be indexed.
+     */
+    std::string value_key(const nlohmann::json &value);
+
+    /**
+     * Shared index over the filters of many subscriptions.
+     *
+     * A filter with an equality (or IN) predicate is clustered under that "access" predicate:
+     * events look up the subscriptions whose access value equals the event's field with one
+     * hash probe and check only those candidates' remaining predicates. Range-only filters are
+     * matched with the counting algorithm over sorted bound arrays: every satisfied predicate
+     * bumps its subscription's counter, which matches once the counter reaches its number of
+     * predicates. Either way an event costs work proportional to the relevant subscriptions,
+     * not to all of them.
+     *
+     * Subscriptions are identified by dense slots chosen by the caller. Not thread-safe.
+     */
+    class PredicateIndex {
+    public:
+        using Slot = std::uint32_t;
+
+        void add(Slot slot, const Filter &filter);
+
+        void remove(Slot slot);
+
+        /**
+         * Appends the slots whose filter matches `payload` to `out`.
+         */
+        void match(const nlohmann::json &payload, std::vector<Slot> &out);
+
+        /**
+         * Field ids allocated, those of fields no filter refers to any more included. Those
+         * are reused, so this is the most fields ever filtered on at once.
+         */
+        std::size_t field_ids() const {
+            return fields_.size();
+        }
+
+    private:
+        using FieldId = std::uint32_t;
+        using Bounds = std::vector<std::pair<double, Slot> >;
+
+        struct Condition {
+            FieldId field;
+            PredicateKind kind;
+            std::vector<std::string> keys;
+            double bound;
+        };
+
+        struct Field {
+            std::string name; // the pointer as written, its key in field_ids_
+            nlohmann::json::json_pointer pointer;
+            std::size_t refs = 0;
+            std::size_t live = 0; // position in live_fields_
+            // access value key -> subscriptions clustered under it
+            std::unordered_map<std::string, std::vector<Slot> > access;
+            // range predicates of range-only filters, sorted by bound
+            Bounds greater;       // value >  bound
+            Bounds greater_equal; // value >= bound
+            Bounds less;          // value <  bound
+            Bounds less_equal;    // value <= bound
+        };
+
+        struct Entry {
+            bool live = false;
+            bool counted = false; // range-only filter, matched by counting
+            FieldId access_field = 0;
+            std::vector<std::string> access_keys;
+            // residual predicates for clustered filters, all predicates for counted ones
+            std::vector<Condition> conditions;
+        };
+
+        FieldId field_id(const std::string &pointer);
+
+        void release_field(FieldId field);
+
+        bool holds(const Condition &condition) const;
+
+        void hit(Slot slot, std::vector<Slot> &out);
+
+        std::unordered_map<std::string, FieldId> field_ids_;
+        std::vector<Field> fields_;
+        // ids of the referenced fields, in no particular order, and of the unreferenced ones
+        std::vector<FieldId> live_fields_;
+        std::vector<FieldId> free_fields_;
+        std::vector<Entry> entries_;
+        std::vector<Slot> unfiltered_;
+
+        // per-match scratch: resolved field values and their equality keys
+        std::vector<const nlohmann::json *> values_;
+        std::vector<std::string> value_keys_;
+        // counters of range-only filters, stamped with the match epoch
+        std::vector<std::uint32_t> hits_;
+        std::vector<std::uint32_t> stamps_;
+        std::uint32_t epoch_ = 0;
+    };
+} // namespace beacon::filter
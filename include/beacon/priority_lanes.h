@@ -0,0 +1,59 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace beacon {
+    /**
+     * Traffic class of a frame or a task. Control traffic (subscription changes, acks,
+     * errors) is small and waits on nothing; bulk traffic (event deliveries and the work
+     * that produces them) is what fills the queues under load.
+     */
+    enum class Lane : std::uint8_t {
+        Control,
+        Bulk
+    };
+
+    /**
+     * Weighted round robin between the control and the bulk lane. While both lanes have
+     * work, `control_weight` control items are served for every `bulk_weight` bulk items,
+     * control first; a lane that is idle leaves its share to the other, so bulk runs at
+     * full speed whenever control is quiet and control waits for at most `bulk_weight`
+     * bulk items when it is not.
+     */
+    class LaneScheduler {
+    public:
+        explicit LaneScheduler(std::uint32_t control_weight = 8, std::uint32_t bulk_weight = 1)
+            : control_weight_(std::max<std::uint32_t>(control_weight, 1)),
+              bulk_weight_(std::max<std::uint32_t>(bulk_weight, 1)) {
+        }
+
+        /**
+         * Lane to serve next. At least one of them must be ready.
+         */
+        Lane next(bool control_ready, bool bulk_ready) {
+            if (!bulk_ready) return Lane::Control;
+            if (!control_ready) return Lane::Bulk;
+
+            if (control_credit_ == 0 && bulk_credit_ == 0) {
+                control_credit_ = control_weight_;
+                bulk_credit_ = bulk_weight_;
+            }
+            if (control_credit_ > 0) {
+                --control_credit_;
+                return Lane::Control;
+            }
+            --bulk_credit_;
+            return Lane::Bulk;
+        }
+
+    private:
+        std::uint32_t control_weight_;
+        std::uint32_t bulk_weight_;
+        std::uint32_t control_credit_ = 0;
+        std::uint32_t bulk_credit_ = 0;
+    };
+} // namespace beacon
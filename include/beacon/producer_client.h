@@ -0,0 +1,133 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include "websocket_adapter.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace beacon {
+    struct ProducerConfig {
+        std::string uri = "ws://127.0.0.1:7070/";
+        // identifies the producer for de-duplication; empty picks a random one
+        std::string producer_id;
+        std::string api_key;
+        // a batch is sent once it is this old, this many events or this many bytes
+        std::chrono::milliseconds linger{5};
+        std::size_t batch_events = 1000;
+        std::size_t batch_bytes = 512 * 1024;
+        // unacknowledged batches on the wire
+        std::size_t max_in_flight = 8;
+        // sealed batches waiting to be sent; publish() blocks beyond this
+        std::size_t max_queued_batches = 64;
+        bool compress = true;
+        std::chrono::milliseconds retry_backoff{200};
+    };
+
+    struct ProducerStats {
+        std::uint64_t batches_acked = 0;
+        std::uint64_t events_acked = 0;
+        std::uint64_t batches_failed = 0;
+        std::uint64_t events_failed = 0;
+        std::uint64_t retries = 0;
+        std::uint64_t reconnects = 0;
+    };
+
+    /**
+     * Batching publisher for the broker's publish_batch protocol, on an outbound
+     * WebSocketAdapter connection served by a background thread.
+     *
+     * Events are appended to the open batch on the caller's thread; a batch is sealed by
+     * linger time, event count or size, and up to max_in_flight sealed batches are on the
+     * wire at once. Each batch carries the producer id and a sequence number, so after a
+     * reconnect the unacknowledged batches are resent as they were and the broker drops
+     * the ones it already has. When a batch is refused as retriable (rate_limited,
+     * out_of_sequence) it and every batch behind it are resent after a backoff; other
+     * refusals drop the batch and count it as failed.
+     */
+    class ProducerClient {
+    public:
+        explicit ProducerClient(ProducerConfig config);
+
+        /**
+         * Stops without waiting for pending batches; call flush() first to deliver them.
+         */
+        ~ProducerClient();
+
+        ProducerClient(const ProducerClient &) = delete;
+
+        ProducerClient &operator=(const ProducerClient &) = delete;
+
+        /**
+         * Adds an event to the open batch. Blocks while max_queued_batches are waiting.
+         * Safe to call from any thread.
+         */
+        void publish(const std::string &topic, const std::string &entity_id, const std::string &event_type,
+                     const nlohmann::json &payload);
+
+        /**
+         * Sends the open batch and waits until every event published so far is acknowledged
+         * or failed. Returns false on timeout.
+         */
+        bool flush(std::chrono::milliseconds timeout);
+
+        ProducerStats stats() const;
+
+        const std::string &producer_id() const {
+            return config_.producer_id;
+        }
+
+    private:
+        struct Batch {
+            std::string events; // comma separated event objects
+            std::size_t count = 0;
+            std::uint64_t sequence = 0; // 0 until first sent
+        };
+
+        void seal_locked();
+
+        void pump();
+
+        void on_reply(ConnectionId connection, nlohmann::json &&reply);
+
+        void on_disconnect(ConnectionId connection);
+
+        void resume();
+
+        void finish(const Batch &batch, bool acked);
+
+        void reconnect();
+
+        ProducerConfig config_;
+        WebSocketAdapter adapter_;
+
+        // shared with publishing threads
+        mutable std::mutex mutex_;
+        std::condition_variable changed_;
+        Batch open_;
+        std::uint64_t open_generation_ = 0;
+        std::deque<Batch> queued_;
+        std::size_t unfinished_events_ = 0;
+        ProducerStats stats_;
+
+        // I/O thread only
+        ConnectionId connection_ = 0;
+        std::deque<Batch> in_flight_;
+        std::uint64_t next_sequence_ = 1;
+        std::uint64_t max_acked_ = 0;
+        // After a refusal nothing new is sent until every in-flight batch has its reply;
+        // the refused batches then get fresh sequence numbers and are resent.
+        bool paused_ = false;
+        std::deque<Batch> retry_;
+        std::chrono::milliseconds resume_delay_{0};
+
+        std::thread io_thread_;
+    };
+} // namespace beacon
@@ -0,0 +1,144 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <beacon/embedding_matrix.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace beacon {
+    namespace reco {
+        enum class Quantization {
+            // float32, in an EmbeddingMatrix
+            None,
+            // one signed byte per value and one scale per vector
+            Int8,
+            // one byte per subspace, indexing that subspace's codebook of 256 centroids
+            Product
+        };
+
+        /**
+         * "none", "int8" or "pq".
+         */
+        Quantization parse_quantization(const std::string &name);
+
+        struct QuantizedConfig {
+            std::size_t dimension = 0;
+            Quantization quantization = Quantization::Int8;
+            // bytes per vector under Product, which must divide dimension; 0 picks dimension / 4
+            // when that divides, else dimension
+            std::size_t subspaces = 0;
+            // vectors set before Product codebooks are trained (at least 256); until then
+            // vectors are kept and scored in float32
+            std::size_t train_rows = 8192;
+            // candidates per result to re-score in float32, which keeps a float32 copy of
+            // every vector outside the scanned codes; 0 scores by the codes alone
+            std::size_t rerank = 0;
+            SimdLevel simd = detect_simd();
+            std::uint64_t seed = 42;
+        };
+
+        /**
+         * Vectors of one dimension stored quantized, one per row id, scored by brute force like
+         * EmbeddingMatrix and in the same 16-row tiles, at a fraction of its memory.
+         *
+         * Int8 keeps each vector as bytes times its own scale (its largest magnitude over 127)
+         * and quantizes the query the same way, so a score is an exact integer dot product
+         * times two scales. A tile holds its rows' values two at a time, interleaved, which is
+         * what the 16-bit multiply-add instructions take: with AVX-512BW, one load, one widen
+         * and one multiply-add cover two values of 16 rows. AVX2 does half a tile per
+         * instruction; other CPUs run a scalar loop.
+         *
+         * Product splits vectors into subspaces, clusters each subspace's slices into 256
+         * centroids by k-means, and keeps per vector one centroid index per subspace. A query
+         * first fills a table of its slices' dot products with every centroid; a vector's score
+         * is then the sum of one table entry per subspace, which AVX2 and AVX-512 look up for a
+         * whole tile with one gather per subspace.
+         *
+         * With rerank, the best k * rerank candidates by code are re-scored against the float32
+         * copies. Not synchronized.
+         */
+        class QuantizedMatrix {
+        public:
+            /**
+             * Throws std::invalid_argument for a zero dimension, Quantization::None, or
+             * subspaces that do not divide the dimension.
+             */
+            explicit QuantizedMatrix(QuantizedConfig config);
+
+            const QuantizedConfig &config() const { return config_; }
+
+            std::size_t dimension() const { return config_.dimension; }
+
+            /**
+             * Sets row `row` to `values`, which holds dimension() floats, growing the matrix as
+             * needed. Under Product, the train_rows-th vector set trains the codebooks.
+             */
+            void set(std::uint32_t row, const float *values);
+
+            /**
+             * Trains the Product codebooks on the vectors set so far, if any and not yet done.
+             */
+            void train();
+
+            /**
+             * Whether vectors are stored as codes: always under Int8, once trained under Product.
+             */
+            bool trained() const { return config_.quantization == Quantization::Int8 || !codebooks_.empty(); }
+
+            bool contains(std::uint32_t row) const;
+
+            /**
+             * Row `row`'s values, decoded from its codes unless a float32 copy is kept; empty
+             * if it was never set.
+             */
+            std::vector<float> row(std::uint32_t row) const;
+
+            std::size_t size() const { return size_; }
+
+            /**
+             * Bytes held by codes, scales, codebooks and float32 copies.
+             */
+            std::size_t memory_bytes() const;
+
+            /**
+             * Up to k (score, row) of the rows scoring highest against `query`, best first.
+             */
+            std::vector<std::pair<float, std::uint32_t> > top_k(const float *query, std::size_t k,
+                                                                EmbeddingMetric metric) const;
+
+        private:
+            static constexpr std::size_t kTileRows = EmbeddingMatrix::kTileRows;
+
+            void grow(std::uint32_t row);
+
+            void encode(std::uint32_t row, const float *values);
+
+            QuantizedConfig config_;
+            std::size_t size_ = 0;
+            // Int8: values per vector over two, rounded up, the last pair padded with zero
+            std::size_t pairs_ = 0;
+            // Int8: value 2 * pair + j of a tile's lane at (tile * pairs_ + pair) * 32 + lane * 2
+            // + j; Product: subspace s's centroid of a tile's lane at (tile * subspaces + s) * 16
+            // + lane
+            std::vector<std::int8_t, CacheAlignedAllocator<std::int8_t> > codes_;
+            // per row, NaN until set: the code scale, and the same over the norm
+            std::vector<float, CacheAlignedAllocator<float> > dot_scales_;
+            std::vector<float, CacheAlignedAllocator<float> > cosine_scales_;
+            // Product: value d of subspace s's centroid c at (s * width + d) * kCentroids + c,
+            // width being dimension / subspaces
+            std::vector<float> codebooks_;
+            // Product: centroid c of subspace s's squared norm at s * kCentroids + c
+            std::vector<float> norms_;
+            ScaledAdd scaled_add_;
+            // Product, untrained: the vectors set so far
+            EmbeddingMatrix pending_;
+            // rerank: row-major float32 copies
+            std::vector<float> exact_;
+        };
+    } // namespace reco
+} // namespace beacon
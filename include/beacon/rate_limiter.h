@@ -0,0 +1,199 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace beacon::ratelimit {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Sustained rate and burst size of a single bucket.
+     * A rate of zero disables the bucket.
+     */
+    struct Limit {
+        double per_second = 0.0;
+        double burst = 0.0;
+
+        bool enabled() const {
+            return per_second > 0.0;
+        }
+    };
+
+    /**
+     * What the I/O thread does with a message once a bucket runs dry.
+     */
+    enum class LimitAction {
+        PauseReads, // hold the message and stop reading until tokens are available
+        Reject      // drop the message and answer the producer with an error frame
+    };
+
+    struct RateLimitConfig {
+        Limit connection_messages;
+        Limit connection_bytes;
+        Limit tenant_messages;
+        Limit tenant_bytes;
+        LimitAction action = LimitAction::PauseReads;
+
+        bool enabled() const {
+            return connection_messages.enabled() || connection_bytes.enabled() ||
+                   tenant_messages.enabled() || tenant_bytes.enabled();
+        }
+
+        /**
+         * Reads BEACON_{CONN,TENANT}_{MSGS,BYTES}_PER_SEC, the matching *_BURST variables
+         * and BEACON_RATE_LIMIT_ACTION (pause|reject). Unset rates leave the bucket disabled.
+         */
+        static RateLimitConfig from_env();
+    };
+
+    /**
+     * Outcome of an admission check. retry_after is only meaningful when the message was refused.
+     */
+    struct Decision {
+        bool admitted = true;
+        std::chrono::nanoseconds retry_after{0};
+
+        explicit operator bool() const {
+            return admitted;
+        }
+    };
+
+    /**
+     * Lock-free token bucket implemented as a generic cell rate algorithm: the whole bucket state
+     * is a single "theoretical arrival time", advanced with one CAS per admitted message.
+     * A message larger than the burst is still admitted when the bucket is full, leaving the
+     * bucket in debt, so oversized messages cannot stall a connection forever.
+     */
+    class TokenBucket {
+    public:
+        explicit TokenBucket(Limit limit);
+
+        /**
+         * Takes `cost` tokens at time `now_ns`. On refusal nothing is taken and
+         * `retry_after_ns` receives the wait until the same request would succeed.
+         */
+        bool try_acquire(std::uint64_t cost, std::int64_t now_ns, std::int64_t &retry_after_ns) noexcept;
+
+        /**
+         * Gives back tokens taken by a request that was refused further down the chain.
+         */
+        void refund(std::uint64_t cost) noexcept;
+
+        bool enabled() const {
+            return ns_per_unit_ > 0.0;
+        }
+
+    private:
+        std::int64_t cost_ns(std::uint64_t cost) const noexcept {
+            return static_cast<std::int64_t>(static_cast<double>(cost) * ns_per_unit_ + 0.5);
+        }
+
+        double ns_per_unit_;
+        std::int64_t tolerance_ns_;
+        std::atomic<std::int64_t> tat_{0};
+    };
+
+    /**
+     * A messages/sec and a bytes/sec bucket checked together.
+     */
+    class RateLimiter {
+    public:
+        RateLimiter(Limit messages, Limit bytes);
+
+        /**
+         * Takes `messages` message tokens and `bytes` byte tokens, or neither.
+         */
+        Decision try_admit(std::uint64_t messages, std::size_t bytes, std::int64_t now_ns) noexcept;
+
+        void refund(std::uint64_t messages, std::size_t bytes) noexcept;
+
+    private:
+        TokenBucket messages_;
+        TokenBucket bytes_;
+    };
+
+    /**
+     * Owns one shared RateLimiter per tenant (API key). Lookups take a mutex, so connections
+     * resolve their tenant once at handshake and keep the pointer for the hot path.
+     *
+     * The key comes from the client, so at most max_tenants limiters are kept: past that the
+     * least recently resolved one that no connection holds any more is dropped. A tenant
+     * coming back after that starts with a full bucket.
+     */
+    class TenantRateLimiters {
+    public:
+        static constexpr std::size_t kDefaultMaxTenants = 10000;
+
+        TenantRateLimiters(Limit messages, Limit bytes, std::size_t max_tenants = kDefaultMaxTenants);
+
+        /**
+         * Returns the limiter for `tenant`, or nullptr when tenant limits are disabled.
+         * Connections without an API key share the limiter of the empty tenant.
+         */
+        std::shared_ptr<RateLimiter> get(const std::string &tenant);
+
+        /**
+         * Limiters currently kept.
+         */
+        std::size_t size() const;
+
+    private:
+        struct Tenant {
+            std::shared_ptr<RateLimiter> limiter;
+            std::list<std::string>::iterator recency;
+        };
+
+        Limit messages_;
+        Limit bytes_;
+        std::size_t max_tenants_;
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, Tenant> limiters_;
+        std::list<std::string> recency_; // most recently resolved first
+    };
+
+    /**
+     * Per-connection admission: the connection's own buckets first, then its tenant's.
+     * Owned by the I/O thread serving the connection.
+     */
+    class ConnectionRateLimiter {
+    public:
+        ConnectionRateLimiter(const RateLimitConfig &config, std::shared_ptr<RateLimiter> tenant);
+
+        /**
+         * Charges a whole message of `bytes`.
+         */
+        Decision admit(std::size_t bytes, Clock::time_point now) noexcept;
+
+        /**
+         * Charges the message alone, for readers that stream it: on its first fragment,
+         * before any of it is parsed. Its bytes follow with admit_bytes().
+         */
+        Decision admit_message(Clock::time_point now) noexcept;
+
+        /**
+         * Charges one fragment of the message being read.
+         */
+        Decision admit_bytes(std::size_t bytes, Clock::time_point now) noexcept;
+
+        LimitAction action() const {
+            return action_;
+        }
+
+    private:
+        Decision charge(std::uint64_t messages, std::size_t bytes, Clock::time_point now) noexcept;
+
+        RateLimiter connection_;
+        std::shared_ptr<RateLimiter> tenant_;
+        LimitAction action_;
+    };
+} // namespace beacon::ratelimit
@@ -0,0 +1,115 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <beacon/recommendation_engine.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace beacon {
+    namespace reco {
+        struct RecommendationCacheConfig {
+            // independently locked shares of the users
+            std::size_t shards = 16;
+            // cached results across all shards, beyond which the least recently used users go
+            std::size_t max_entries = 100000;
+            // results kept per user, beyond which the user's least recently used context goes
+            std::size_t max_contexts = 16;
+            // past it a result is still served, but the next request for it recomputes it
+            std::chrono::steady_clock::duration soft_ttl = std::chrono::seconds(30);
+            // past it a result is not served at all
+            std::chrono::steady_clock::duration hard_ttl = std::chrono::minutes(5);
+
+            /**
+             * Reads BEACON_RECO_CACHE_SHARDS, BEACON_RECO_CACHE_MAX_ENTRIES,
+             * BEACON_RECO_CACHE_MAX_CONTEXTS, BEACON_RECO_CACHE_SOFT_TTL_MS and
+             * BEACON_RECO_CACHE_HARD_TTL_MS.
+             */
+            static RecommendationCacheConfig from_env();
+        };
+
+        struct RecommendationCacheStats {
+            // served from the cache fresh, and past the soft TTL
+            std::uint64_t hits = 0;
+            std::uint64_t stale_hits = 0;
+            // computed by the caller
+            std::uint64_t misses = 0;
+            // waited for a computation another caller had started
+            std::uint64_t coalesced = 0;
+            // users whose results were dropped by an event
+            std::uint64_t invalidations = 0;
+            std::size_t entries = 0;
+        };
+
+        /**
+         * Recommendation results by (user, context, model version), so that a user asking
+         * again within seconds is not scored again. The context is whatever else a result
+         * depends on, such as k.
+         *
+         * Users are split into shards by a hash of their name, each under its own lock and
+         * holding its share of max_entries; a full shard drops its least recently used user
+         * with all of that user's results. A user keeps one result per context, for at most
+         * max_contexts contexts (and never more than the shard's share), dropping the least
+         * recently used one past that: asking with another model version recomputes and
+         * replaces it, so a swapped model invalidates everything without a sweep.
+         *
+         * A result is fresh for soft_ttl. Up to hard_ttl, the first request for it after that
+         * recomputes it while the others are served the stale one meanwhile; after hard_ttl it
+         * is a miss. Concurrent misses on one key are coalesced: the first caller computes,
+         * the others wait for its result (or its exception) instead of computing it again.
+         *
+         * invalidate() drops a user's results, so that the next request sees the user's newest
+         * events (RecommendationEngine::set_on_applied() says when the engine has them); a
+         * computation already running for the user is served to its waiters but not kept.
+         * Safe to use from any thread.
+         */
+        class RecommendationCache {
+        public:
+            using Clock = std::chrono::steady_clock;
+            using Result = std::shared_ptr<const std::vector<ScoredItem> >;
+            using Compute = std::function<std::vector<ScoredItem>()>;
+
+            explicit RecommendationCache(RecommendationCacheConfig config = {});
+
+            ~RecommendationCache();
+
+            RecommendationCache(const RecommendationCache &) = delete;
+
+            RecommendationCache &operator=(const RecommendationCache &) = delete;
+
+            /**
+             * The cached result for the key, or what `compute` returns, called on this
+             * thread without a lock held. Rethrows what `compute` throws.
+             */
+            Result get(std::string_view user, std::string_view context, std::uint64_t model_version,
+                       const Compute &compute, Clock::time_point now = Clock::now());
+
+            void invalidate(std::string_view user);
+
+            RecommendationCacheStats stats() const;
+
+        private:
+            struct Shard;
+
+            Shard &shard_of(std::string_view user) const;
+
+            RecommendationCacheConfig config_;
+            std::size_t shard_entries_;
+            std::size_t user_entries_;
+            std::unique_ptr<Shard[]> shards_;
+            std::atomic<std::uint64_t> hits_{0};
+            std::atomic<std::uint64_t> stale_hits_{0};
+            std::atomic<std::uint64_t> misses_{0};
+            std::atomic<std::uint64_t> coalesced_{0};
+            std::atomic<std::uint64_t> invalidations_{0};
+        };
+    } // namespace reco
+} // namespace beacon
@@ -3,11 +3,323 @@
 //
 #pragma once
 
+#include <beacon/als.h>
+#include <beacon/embedding_matrix.h>
+#include <beacon/hnsw_index.h>
+#include <beacon/quantized_matrix.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
 namespace beacon {
+    namespace reco {
+        /**
+         * How two items' co-occurrence turns into a similarity score.
+         */
+        enum class Similarity {
+            // weighted: dot product of the items' user vectors over the product of their norms
+            Cosine,
+            // unweighted: users of both over users of either
+            Jaccard,
+            // unweighted: Dunning's log-likelihood ratio, as 1 - 1 / (1 + llr)
+            LogLikelihood
+        };
+
+        /**
+         * "cosine", "jaccard" or "llr".
+         */
+        Similarity parse_similarity(const std::string &name);
+
+        inline double cosine(double dot, double norm_a, double norm_b) {
+            const double norms = norm_a * norm_b;
+            return norms > 0.0 ? dot / norms : 0.0;
+        }
+
+        inline double jaccard(std::uint64_t both, std::uint64_t users_a, std::uint64_t users_b) {
+            const std::uint64_t either = users_a + users_b - both;
+            return either > 0 ? static_cast<double>(both) / static_cast<double>(either) : 0.0;
+        }
+
+        /**
+         * Dunning's log-likelihood ratio (G-test) over the 2x2 table of `users` users,
+         * `users_a` of which interacted with a, `users_b` with b and `both` with both.
+         */
+        inline double log_likelihood_ratio(std::uint64_t both, std::uint64_t users_a, std::uint64_t users_b,
+                                           std::uint64_t users) {
+            auto x_log_x = [](double x) { return x > 0.0 ? x * std::log(x) : 0.0; };
+            const double k11 = static_cast<double>(both);
+            const double k12 = static_cast<double>(users_a - both);
+            const double k21 = static_cast<double>(users_b - both);
+            const double k22 = static_cast<double>(users + both - users_a - users_b);
+            const double row = x_log_x(k11 + k12 + k21 + k22) - x_log_x(k11 + k12) - x_log_x(k21 + k22);
+            const double column = x_log_x(k11 + k12 + k21 + k22) - x_log_x(k11 + k21) - x_log_x(k12 + k22);
+            const double matrix = x_log_x(k11 + k12 + k21 + k22) - x_log_x(k11) - x_log_x(k12) - x_log_x(k21) -
+                                  x_log_x(k22);
+            // rounding can take a tiny ratio below zero
+            return std::max(0.0, 2.0 * (row + column - matrix));
+        }
+
+        struct ScoredItem {
+            std::string item;
+            float score = 0.0f;
+        };
+    } // namespace reco
+
+    struct RecommendationConfig {
+        reco::Similarity similarity = reco::Similarity::Cosine;
+        // neighbors kept per item
+        std::size_t neighbors = 50;
+        // most recent distinct items per user that count; the work of one interaction grows
+        // with it
+        std::size_t max_user_items = 500;
+        // users two items need in common to be neighbors
+        std::uint32_t min_support = 1;
+        // interactions are events whose entity_id is the item and whose payload names the user
+        std::string user_field = "user_id";
+        // weight per event_type; other types are ignored. A numeric payload "rating"
+        // multiplies the weight.
+        std::unordered_map<std::string, float> event_weights = {{"view", 1.0f}, {"click", 2.0f}, {"rating", 1.0f}};
+        std::string rating_field = "rating";
+        // threads applying interactions; each owns a share of the users and of the items
+        std::size_t update_threads = 2;
+        // interactions waiting to be applied; beyond this they are dropped
+        std::size_t max_queued = 1000000;
+        // co-occurrence cells a thread rescans per batch to recompute stale neighbor lists
+        // (at least one list per batch)
+        std::size_t refresh_budget = 65536;
+        // floats per item embedding; 0 keeps embeddings off
+        std::size_t embedding_dimension = 0;
+        reco::EmbeddingMetric embedding_metric = reco::EmbeddingMetric::Cosine;
+        // scoring kernel; the best the CPU runs if unset
+        std::optional<reco::SimdLevel> simd;
+        // links per node of an HNSW index over the embeddings; 0 searches them by brute force
+        std::size_t hnsw_m = 0;
+        std::size_t hnsw_ef_construction = 200;
+        std::size_t hnsw_ef_search = 64;
+        // storage of brute-force embeddings; ignored with an HNSW index
+        reco::Quantization embedding_quantization = reco::Quantization::None;
+        // see reco::QuantizedConfig
+        std::size_t embedding_pq_subspaces = 0;
+        std::size_t embedding_rerank = 0;
+        // interactions buffered before they are merged into the packed user-item matrix
+        std::size_t interaction_merge_every = 65536;
+        // (user, item) entries the user-item matrix keeps before forgetting the oldest, a
+        // quarter at a time; 0 keeps them all
+        std::size_t interaction_max_entries = 16777216;
+        // seconds in which an interaction's weight halves; 0 keeps weights as they are
+        double decay_half_life = 0.0;
+
+        /**
+         * Reads BEACON_RECO_SIMILARITY, BEACON_RECO_NEIGHBORS, BEACON_RECO_MAX_USER_ITEMS,
+         * BEACON_RECO_MIN_SUPPORT, BEACON_RECO_USER_FIELD, BEACON_RECO_EVENT_WEIGHTS
+         * ("type=weight,..."), BEACON_RECO_THREADS, BEACON_RECO_MAX_QUEUED,
+         * BEACON_RECO_REFRESH_BUDGET, BEACON_RECO_EMBEDDING_DIM, BEACON_RECO_EMBEDDING_METRIC,
+         * BEACON_RECO_SIMD ("auto" or an instruction set), BEACON_RECO_HNSW_M,
+         * BEACON_RECO_HNSW_EF_CONSTRUCTION, BEACON_RECO_HNSW_EF_SEARCH,
+         * BEACON_RECO_EMBEDDING_QUANTIZATION ("none", "int8" or "pq"),
+         * BEACON_RECO_EMBEDDING_PQ_SUBSPACES, BEACON_RECO_EMBEDDING_RERANK,
+         * BEACON_RECO_INTERACTION_MERGE, BEACON_RECO_INTERACTION_MAX_ENTRIES and
+         * BEACON_RECO_DECAY_HALF_LIFE (seconds).
+         */
+        static RecommendationConfig from_env();
+    };
+
+    struct RecommendationStats {
+        // applied so far, and dropped because too many were queued
+        std::uint64_t interactions = 0;
+        std::uint64_t dropped = 0;
+        std::size_t users = 0;
+        std::size_t items = 0;
+        // non-zero cells of the co-occurrence matrix, both triangles
+        std::size_t cooccurrences = 0;
+        // bumped by every rebuild()
+        std::uint64_t model_version = 0;
+        // items with an embedding
+        std::size_t embeddings = 0;
+        // held by the user-item matrix
+        std::size_t interaction_bytes = 0;
+    };
+
+    /**
+     * Item-to-item collaborative filtering, updated live. Interactions (user, item, weight)
+     * are kept per user, capped at the user's most recent max_user_items items, and feed a
+     * sparse, symmetric item co-occurrence matrix holding per pair of items the number of
+     * users they share and the dot product of their weights. Each item keeps its top
+     * neighbors under the configured similarity.
+     *
+     * Interactions are queued and applied in the background by update_threads threads. The
+     * thread owning a user turns an interaction into the changes it makes to the matrix (one
+     * per item in the user's history, and again for the item evicted from it) and hands each
+     * to the thread owning the row, which updates the cell and that one entry of the row's
+     * neighbor list. Nothing is locked but the queues and, briefly, a neighbor list. Work per
+     * interaction is thus bounded by the history cap and the neighbor count. A list that may
+     * have lost a better candidate (an entry fell to the bottom of a full list, or the item's
+     * own statistics moved under Jaccard or log-likelihood) is queued for a full recompute,
+     * of which a thread does refresh_budget cells' worth per batch, and a background sweep
+     * recomputes every list in turn as updates flow. Queries rescore the kept neighbors with
+     * current statistics, so scores are always fresh while list membership may trail a
+     * little.
+     *
+     * With decay_half_life set, an interaction's weight halves every half-life from the time
+     * it happened, in the history, the items' popularity and norms and the co-occurrence dot
+     * products alike. Weights are stored scaled up by how late they came (forward decay), so
+     * an update still touches only what it did and a read scales down by a factor of its time
+     * alone. Cosine is thus decayed; user counts, and with them Jaccard and log-likelihood,
+     * are not.
+     *
+     * Items may also carry an embedding, kept in an EmbeddingMatrix indexed by item id and
+     * searched by brute force with the best SIMD kernel the CPU runs (or, with
+     * embedding_quantization set, in a QuantizedMatrix at a quarter of the memory or less),
+     * or, with hnsw_m set, in an approximate HnswIndex that scales to catalogs brute force
+     * cannot. train_factors() derives them from the interactions themselves by implicit ALS,
+     * reading the interactions from a reco::InteractionMatrix that keeps the latest
+     * interaction_max_entries of them, packed, by user and by item, and is merged into by a
+     * thread of its own. Safe to use from any thread.
+     */
     class RecommendationEngine {
     public:
-        RecommendationEngine() = default;
+        explicit RecommendationEngine(RecommendationConfig config = {});
+
+        ~RecommendationEngine();
+
+        RecommendationEngine(const RecommendationEngine &) = delete;
+
+        RecommendationEngine &operator=(const RecommendationEngine &) = delete;
+
+        /**
+         * Queues a published event as an interaction if it is one. Returns whether it was.
+         */
+        bool observe(const nlohmann::json &event);
+
+        /**
+         * Queues an interaction; the user and item get their ids on the calling thread.
+         * Throws std::invalid_argument unless the weight is positive and finite.
+         */
+        void add_interaction(std::string_view user, std::string_view item, float weight);
+
+        /**
+         * Queues an interaction that happened at `at`, whose weight decays from then on.
+         */
+        void add_interaction(std::string_view user, std::string_view item, float weight,
+                             std::chrono::system_clock::time_point at);
+
+        /**
+         * Waits until everything queued so far, including neighbor list recomputes, is applied.
+         */
+        void flush();
+
+        /**
+         * Has an update thread call `applied(user)` each time it applied interactions of the
+         * user, from when recommend() may answer differently for them; before flush() returns
+         * for those interactions. Call before the first interaction is queued.
+         */
+        void set_on_applied(std::function<void(std::string_view user)> applied);
+
+        /**
+         * Recomputes every neighbor list from the current counts and bumps the model version,
+         * then waits like flush().
+         */
+        void rebuild();
+
+        /**
+         * Up to k items most similar to `item`, best first.
+         */
+        std::vector<reco::ScoredItem> similar_items(const std::string &item, std::size_t k) const;
+
+        /**
+         * Up to k items with the most summed, decayed interaction weight, best first.
+         */
+        std::vector<reco::ScoredItem> popular(std::size_t k) const;
+
+        /**
+         * Up to k items the user has not interacted with, scored by the similarity of each to
+         * the user's items, weighted by the user's interactions.
+         */
+        std::vector<reco::ScoredItem> recommend(const std::string &user, std::size_t k) const;
+
+        /**
+         * Sets an item's embedding, which must hold embedding_dimension values; throws
+         * std::invalid_argument otherwise.
+         */
+        void set_embedding(const std::string &item, const std::vector<float> &embedding);
+
+        /**
+         * Sets many embeddings at once, building an HNSW index on `threads` threads.
+         */
+        void set_embeddings(const std::vector<std::pair<std::string, std::vector<float> > > &embeddings,
+                            std::size_t threads);
+
+        /**
+         * Up to k other items whose embeddings score highest against `item`'s, best first;
+         * empty if it has none.
+         */
+        std::vector<reco::ScoredItem> similar_by_embedding(const std::string &item, std::size_t k) const;
+
+        /**
+         * Up to k items whose embeddings score highest against `query`, best first.
+         */
+        std::vector<reco::ScoredItem> nearest(const std::vector<float> &query, std::size_t k) const;
+
+        /**
+         * Writes the HNSW index and the names of the items it holds to `path`. Throws
+         * std::runtime_error without an index or if the file cannot be written.
+         */
+        void save_embeddings(const std::string &path) const;
+
+        /**
+         * Replaces the HNSW index with one save_embeddings() wrote, from this process or
+         * another. Throws std::runtime_error if it cannot, if the file is corrupt or names
+         * fewer items than it indexes, or if hnsw_m is 0, leaving the current index in place.
+         */
+        void load_embeddings(const std::string &path);
+
+        /**
+         * Writes the user and item ids handed out so far to `path`. Throws std::runtime_error
+         * if the file cannot be written.
+         */
+        void save_ids(const std::string &path) const;
+
+        /**
+         * Hands out the ids save_ids() wrote, before any interaction arrives, so that ids
+         * (and files keyed by them) survive restarts. Throws std::runtime_error if the file
+         * cannot be read or ids were already handed out.
+         */
+        void load_ids(const std::string &path);
+
+        /**
+         * Factorizes the interactions the user-item matrix keeps, histories' cap aside, by
+         * weighted ALS (see reco::train_als) and replaces every item embedding with the item
+         * factors, keeping the user factors for recommend_by_factors(). config.factors must
+         * equal embedding_dimension; throws std::invalid_argument otherwise. Returns the
+         * timings of each iteration.
+         */
+        std::vector<reco::AlsIteration> train_factors(const reco::AlsConfig &config);
+
+        /**
+         * Up to k items the user has not interacted with whose embeddings score highest
+         * against the user's factors from the last train_factors(); empty for users it did not
+         * see. Factors are meant for the dot metric.
+         */
+        std::vector<reco::ScoredItem> recommend_by_factors(const std::string &user, std::size_t k) const;
+
+        RecommendationStats stats() const;
+
+        /**
+         * The model version alone, as stats() has it, without its locks.
+         */
+        std::uint64_t model_version() const;
 
-        void run();
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
     };
-}
\ No newline at end of file
+} // namespace beacon
@@ -0,0 +1,84 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace beacon::replication {
+    struct ReplicationConfig {
+        // events (and bytes) of recent history kept for followers to catch up from; zero
+        // turns replication off on a leader, a follower needs a log for its hot buffer
+        std::size_t log_events = 0;
+        std::size_t log_bytes = 64 * 1024 * 1024;
+        // ws:// URI of the broker to follow; empty for a leader
+        std::string upstream;
+        // a batch frame holds at most this many events and bytes
+        std::size_t batch_events = 1000;
+        std::size_t batch_bytes = 256 * 1024;
+        // unacknowledged batch frames per follower
+        std::size_t max_in_flight = 4;
+        std::chrono::milliseconds retry_backoff{500};
+
+        /**
+         * Reads BEACON_REPLICATE_FROM, BEACON_REPLICATION_LOG_EVENTS (100000 by default on a
+         * follower), BEACON_REPLICATION_LOG_BYTES, BEACON_REPLICATION_BATCH_EVENTS,
+         * BEACON_REPLICATION_BATCH_BYTES and BEACON_REPLICATION_IN_FLIGHT.
+         */
+        static ReplicationConfig from_env();
+    };
+
+    /**
+     * Bounded in-memory log of serialized publish messages, numbered by consecutive offsets.
+     * The oldest events are dropped once the log holds more than max_events events or
+     * max_bytes bytes. Safe to use from any thread.
+     */
+    class ReplicationLog {
+    public:
+        using Entry = std::shared_ptr<const std::string>;
+
+        ReplicationLog(std::size_t max_events, std::size_t max_bytes);
+
+        /**
+         * Appends at end(). Returns true if a read() came back empty since the last append,
+         * i.e. some reader is waiting for this event.
+         */
+        bool append(std::string message);
+
+        /**
+         * Empties the log and continues numbering at `offset`.
+         */
+        void reset(std::uint64_t offset);
+
+        /**
+         * Copies up to max_events events, and as many bytes as max_bytes allows (at least one
+         * event), starting at `from` into `out`. Returns the offset of the first one, which is
+         * start() if `from` was dropped already or lies beyond end(). Reading nothing marks the
+         * log as waited for.
+         */
+        std::uint64_t read(std::uint64_t from, std::size_t max_events, std::size_t max_bytes,
+                           std::vector<Entry> &out);
+
+        std::uint64_t start() const;
+
+        std::uint64_t end() const;
+
+    private:
+        void trim_locked();
+
+        std::size_t max_events_;
+        std::size_t max_bytes_;
+
+        mutable std::mutex mutex_;
+        std::deque<Entry> entries_;
+        std::uint64_t start_ = 0;
+        std::size_t bytes_ = 0;
+        bool waited_for_ = false;
+    };
+} // namespace beacon::replication
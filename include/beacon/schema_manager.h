@@ -5,12 +5,58 @@
 #ifndef BEACON_BROKER_SCHEMA_MANAGER_H
 #define BEACON_BROKER_SCHEMA_MANAGER_H
 
+#include "abstract_schema_validator.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
 namespace beacon {
+    /**
+     * Exception type thrown for malformed schema definitions.
+     */
+    class SchemaError : public std::runtime_error {
+    public:
+        explicit SchemaError(const std::string &msg) : std::runtime_error(msg) {
+        }
+    };
+
+    /**
+     * Event payload schemas, one per topic.
+     */
     class SchemaManager {
     public:
         SchemaManager() = default;
 
+        /**
+         * Loads the schema file named by BEACON_SCHEMAS, a JSON object mapping each topic to
+         * a definition (see build()). Without the variable no schemas are registered.
+         */
         void load();
+
+        void add(const std::string &topic, std::shared_ptr<const validation::AbstractSchemaValidator> schema);
+
+        /**
+         * Schema of `topic`, or nullptr if its events are not validated.
+         */
+        const validation::AbstractSchemaValidator *find(const std::string &topic) const;
+
+        std::size_t size() const {
+            return schemas_.size();
+        }
+
+        /**
+         * Builds a validator from a definition of the form
+         *   {"name": "...", "version": 1,
+         *    "fields": {"name": {"type": "string", "required": true, "min_length": 1, ...}}}
+         * with type one of string, non_empty_string, integer, boolean, array, object and the
+         * optional constraints min_length, max_length, pattern, min and max. name and version
+         * are optional; load() names a schema after its topic by default.
+         */
+        static std::shared_ptr<validation::AbstractSchemaValidator> build(const nlohmann::json &definition);
+
+    private:
+        std::unordered_map<std::string, std::shared_ptr<const validation::AbstractSchemaValidator> > schemas_;
     };
 }
-#endif //BEACON_BROKER_SCHEMA_MANAGER_H
\ No newline at end of file
+#endif //BEACON_BROKER_SCHEMA_MANAGER_H
@@ -0,0 +1,45 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace beacon::handoff {
+    /**
+     * Exception type thrown when passing descriptors between processes fails.
+     */
+    class HandoffError : public std::runtime_error {
+    public:
+        explicit HandoffError(const std::string &msg) : std::runtime_error(msg) {
+        }
+    };
+
+    // One-byte messages of the handoff exchange:
+    //   successor -> predecessor  kHello
+    //   predecessor -> successor  listening sockets (SCM_RIGHTS)
+    //   successor -> predecessor  kReady, after which the predecessor stops accepting and drains
+    constexpr char kHello = 'H';
+    constexpr char kReady = 'R';
+
+    constexpr std::size_t kMaxDescriptors = 16;
+
+    /**
+     * Sends `fds` over a connected Unix socket as a single SCM_RIGHTS message.
+     */
+    void send_fds(int unix_socket, const std::vector<int> &fds);
+
+    /**
+     * Receives the descriptors of one send_fds() message. They are opened close-on-exec.
+     */
+    std::vector<int> receive_fds(int unix_socket);
+
+    /**
+     * Asks the broker serving the handoff socket at `path` for its listening sockets and
+     * confirms the takeover. Returns an empty vector when nothing is serving there, e.g. on
+     * the very first start.
+     */
+    std::vector<int> take_over(const std::string &path);
+} // namespace beacon::handoff
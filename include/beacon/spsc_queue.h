@@ -0,0 +1,81 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace beacon {
+    /**
+     * Bounded lock-free queue for exactly one producer thread and one consumer thread.
+     * Each side caches the other side's index and only reloads it when the queue looks
+     * full (producer) or empty (consumer), so steady traffic touches no shared cache line
+     * except the slots themselves.
+     */
+    template<typename T>
+    class SpscQueue {
+    public:
+        /**
+         * `capacity` is rounded up to a power of two.
+         */
+        explicit SpscQueue(std::size_t capacity) {
+            std::size_t size = 2;
+            while (size < capacity) size <<= 1;
+            slots_.resize(size);
+            mask_ = size - 1;
+        }
+
+        SpscQueue(const SpscQueue &) = delete;
+
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        /**
+         * Producer side. Moves `value` into the queue, or leaves it untouched and returns
+         * false if the queue is full.
+         */
+        bool try_push(T &value) {
+            const std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - cached_head_ > mask_) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail - cached_head_ > mask_) return false;
+            }
+            slots_[tail & mask_] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Consumer side. Moves the oldest element into `out`; false if the queue is empty.
+         */
+        bool try_pop(T &out) {
+            const std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head == cached_tail_) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head == cached_tail_) return false;
+            }
+            out = std::move(slots_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::size_t capacity() const {
+            return mask_ + 1;
+        }
+
+    private:
+        static constexpr std::size_t kCacheLine = 64;
+
+        std::vector<T> slots_;
+        std::size_t mask_ = 0;
+
+        // consumer side
+        alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+        std::size_t cached_tail_ = 0;
+
+        // producer side
+        alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+        std::size_t cached_head_ = 0;
+    };
+} // namespace beacon
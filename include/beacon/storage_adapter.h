@@ -9,7 +9,11 @@
 #include <cstdint>
 #include <nlohmann/json.hpp>
 #include "abstract_schema_validator.h"
+#include "consumer_group.h"
+#include "dead_letter.h"
+#include "delay_journal.h"
 #include "query_builder.h"
+#include "user_history.h"
 
 namespace beacon {
     using QueryBuilder = db::Db;
@@ -32,7 +36,8 @@ namespace beacon {
         std::string created_at;
     };
 
-    class StorageAdapter {
+    class StorageAdapter : public consumer::OffsetStore, public delay::DelayStore,
+                           public deadletter::DeadLetterStore, public reco::HistorySource {
     public:
         StorageAdapter();
 
@@ -44,6 +49,26 @@ namespace beacon {
 
         std::vector<Event> query_events_by_entity(const std::string &entity_id);
 
+        std::vector<consumer::CommittedOffset> load_offsets(const std::string &group,
+                                                            const std::string &topic) override;
+
+        void save_offsets(const std::vector<consumer::CommittedOffset> &offsets) override;
+
+        std::vector<delay::DelayedEvent> load_delayed(std::uint64_t after_ms, std::uint64_t until_ms,
+                                                      std::uint64_t below_id) override;
+
+        std::uint64_t max_delayed_id() override;
+
+        void write_delayed(const std::vector<delay::DelayedEvent> &added,
+                           const std::vector<std::uint64_t> &delivered) override;
+
+        void store_dead_letters(const std::vector<deadletter::DeadLetter> &letters) override;
+
+        std::vector<reco::RecentInteraction> load_recent_interactions(const std::string &user_field,
+                                                                      std::size_t per_user,
+                                                                      std::size_t users,
+                                                                      std::uint64_t since_ms) override;
+
     private:
         std::string get_connection_string();
 
@@ -51,6 +76,12 @@ namespace beacon {
 
         void create_events_table();
 
+        void create_consumer_offsets_table();
+
+        void create_delayed_events_table();
+
+        void create_dead_letters_table();
+
         std::unique_ptr<QueryBuilder> _queryBuilder;
     };
 } // namespace beacon
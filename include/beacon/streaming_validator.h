@@ -0,0 +1,117 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include "abstract_schema_validator.h"
+#include "json_stream_parser.h"
+#include <functional>
+#include <string>
+
+namespace beacon::validation {
+    /**
+     * Resolves the payload schema of a topic; nullptr means the topic is not validated.
+     */
+    using SchemaLookup = std::function<const AbstractSchemaValidator *(const std::string &topic)>;
+
+    /**
+     * SAX handler that builds an inbound broker message while checking it against the
+     * schema of its topic. Each top-level payload field is validated the moment its value is
+     * complete, so a bad field stops the parser before the rest of the message is read.
+     * Fields that arrive before "topic" are checked once the topic is known.
+     *
+     * A publish_batch message's top-level "events" array is checked event by event: each
+     * element is an event with its own topic and payload. Any other message is checked as
+     * one event, whatever "events" it carries.
+     */
+    class StreamingEventValidator : public json_stream::SaxHandler {
+    public:
+        explicit StreamingEventValidator(SchemaLookup lookup = {});
+
+        void set_lookup(SchemaLookup lookup) {
+            lookup_ = std::move(lookup);
+        }
+
+        bool null() override;
+
+        bool boolean(bool value) override;
+
+        bool number_integer(std::int64_t value) override;
+
+        bool number_unsigned(std::uint64_t value) override;
+
+        bool number_float(double value) override;
+
+        bool string(std::string &value) override;
+
+        bool start_object() override;
+
+        bool key(std::string &value) override;
+
+        bool end_object() override;
+
+        bool start_array() override;
+
+        bool end_array() override;
+
+        /**
+         * Checks what can only be checked on the whole message (required payload fields).
+         * Call after the parser finished successfully.
+         */
+        bool finish();
+
+        /**
+         * Failed schema check, if any; success otherwise.
+         */
+        const ValidationResult &result() const {
+            return result_;
+        }
+
+        /**
+         * Schema of the event being checked, i.e. the one that failed once result() is a
+         * failure; nullptr if its topic has none.
+         */
+        const AbstractSchemaValidator *schema() const {
+            return schema_;
+        }
+
+        /**
+         * Topic of the event being checked, empty until it is known.
+         */
+        std::string topic() const;
+
+        nlohmann::json &message() {
+            return dom_.result();
+        }
+
+        void reset();
+
+    private:
+        // root object -> "events" array -> event object
+        static constexpr std::size_t kBatchEventDepth = 3;
+
+        nlohmann::json &current_event();
+
+        std::string payload_path() const;
+
+        bool value_done();
+
+        bool event_done();
+
+        bool resolve_schema();
+
+        json_stream::DomBuilder dom_;
+        SchemaLookup lookup_;
+        const AbstractSchemaValidator *schema_ = nullptr; // of the current event
+        std::size_t depth_ = 0;
+        std::size_t event_depth_ = 1; // depth of the current event's fields
+        bool batch_ = false;
+        long event_index_ = -1;
+        std::string root_key_;
+        // "op" of the message, empty until it is read
+        std::string root_op_;
+        std::string event_key_;
+        std::string payload_key_;
+        ValidationResult result_ = ValidationResult::ok();
+    };
+} // namespace beacon::validation
@@ -0,0 +1,81 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include "predicate_index.h"
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace beacon {
+    using SubscriptionId = std::uint64_t;
+
+    enum class DeliveryMode {
+        All,      // every event is queued for the subscriber
+        Conflated // pending events are conflated per key, only the latest value is delivered
+    };
+
+    struct Subscription {
+        SubscriptionId id = 0;
+        std::uint64_t connection = 0;
+        std::string topic;
+        DeliveryMode mode = DeliveryMode::All;
+        // JSON pointer into the payload used as conflation key; empty means the event's entity_id.
+        std::string conflation_key;
+        // payload predicates, all of which must hold; empty receives the whole topic
+        filter::Filter filter;
+    };
+
+    /**
+     * Topic -> subscriptions index with a shared predicate index per topic. Not thread-safe:
+     * each adapter core owns the registry of the connections it serves (see Broker).
+     */
+    class SubscriptionRegistry {
+    public:
+        /**
+         * Registers the subscription and returns its assigned id.
+         */
+        SubscriptionId add(Subscription subscription);
+
+        /**
+         * Removes a subscription if it belongs to `connection`. Returns false otherwise.
+         */
+        bool remove(std::uint64_t connection, SubscriptionId id);
+
+        void remove_connection(std::uint64_t connection);
+
+        /**
+         * Appends the subscriptions of `topic` whose filter matches `payload` to `out`.
+         * The pointers stay valid until the registry is modified.
+         */
+        void match(const std::string &topic, const nlohmann::json &payload, std::vector<const Subscription *> &out);
+
+        std::size_t size() const {
+            return locations_.size();
+        }
+
+    private:
+        using Slot = filter::PredicateIndex::Slot;
+
+        struct Topic {
+            std::vector<Subscription> slots; // id 0 marks a free slot
+            std::vector<Slot> free_slots;
+            filter::PredicateIndex index;
+            std::size_t live = 0;
+        };
+
+        struct Location {
+            std::string topic;
+            Slot slot;
+        };
+
+        SubscriptionId next_id_ = 1;
+        std::unordered_map<std::string, Topic> by_topic_;
+        std::unordered_map<SubscriptionId, Location> locations_;
+        std::unordered_map<std::uint64_t, std::vector<SubscriptionId> > by_connection_;
+        std::vector<Slot> matched_slots_;
+    };
+} // namespace beacon
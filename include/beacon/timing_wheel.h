@@ -0,0 +1,183 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace beacon::timing {
+    /**
+     * Hierarchical timing wheel: four levels of 64 slots over a fixed tick, so scheduling
+     * and expiring a timer are O(1) whatever the number pending.
+     *
+     * A timer lives at the level of the highest 6-bit group in which its deadline differs
+     * from the current tick, in the slot given by that group of the deadline. Whenever the
+     * current tick rolls a group over to zero, the matching slot one level up is emptied
+     * into the levels below. Deadlines outside the current 2^24-tick block wait in an
+     * overflow list that is sorted into the wheel when the block is entered.
+     *
+     * Timers are nodes of a pooled, index-linked list, so the wheel allocates only while it
+     * grows to its high-water mark.
+     */
+    template<typename T>
+    class TimingWheel {
+    public:
+        static constexpr unsigned kLevelBits = 6;
+        static constexpr unsigned kLevels = 4;
+        static constexpr std::uint64_t kSlots = 1ull << kLevelBits;
+        static constexpr std::uint64_t kBlockTicks = 1ull << (kLevelBits * kLevels);
+
+        /**
+         * `start_ms` is the current time, on the same clock as the deadlines and advance().
+         */
+        TimingWheel(std::uint64_t start_ms, std::uint64_t tick_ms)
+            : tick_ms_(tick_ms == 0 ? 1 : tick_ms), now_(start_ms / tick_ms_) {
+            for (auto &level: slots_) level.fill(kNone);
+        }
+
+        /**
+         * Adds a timer firing at the first tick not before `deadline_ms`. A deadline that has
+         * passed fires on the next advance().
+         */
+        void schedule(std::uint64_t deadline_ms, T value) {
+            const std::uint32_t node = allocate(std::move(value));
+            nodes_[node].deadline = (deadline_ms + tick_ms_ - 1) / tick_ms_;
+            place(node);
+            ++size_;
+        }
+
+        /**
+         * Moves time forward to `now_ms` and hands every timer that is due to `expired`, in
+         * deadline order across ticks.
+         */
+        template<typename F>
+        std::size_t advance(std::uint64_t now_ms, F &&expired) {
+            const std::uint64_t target = now_ms / tick_ms_;
+            std::size_t fired = fire(due_, expired);
+
+            if (size_ == 0) {
+                now_ = std::max(now_, target);
+                return fired;
+            }
+            while (now_ < target) {
+                ++now_;
+                cascade();
+                fired += fire(slots_[0][now_ & (kSlots - 1)], expired);
+                fired += fire(due_, expired);
+                if (size_ == 0) now_ = target;
+            }
+            return fired;
+        }
+
+        std::size_t size() const {
+            return size_;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        /**
+         * Current time as of the last advance(), rounded down to the tick.
+         */
+        std::uint64_t now_ms() const {
+            return now_ * tick_ms_;
+        }
+
+    private:
+        static constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+
+        struct Node {
+            T value;
+            std::uint64_t deadline = 0; // in ticks
+            std::uint32_t next = kNone;
+        };
+
+        std::uint32_t allocate(T value) {
+            if (free_ != kNone) {
+                const std::uint32_t node = free_;
+                free_ = nodes_[node].next;
+                nodes_[node].value = std::move(value);
+                return node;
+            }
+            nodes_.push_back(Node{std::move(value)});
+            return static_cast<std::uint32_t>(nodes_.size() - 1);
+        }
+
+        static void push(std::uint32_t &head, std::vector<Node> &nodes, std::uint32_t node) {
+            nodes[node].next = head;
+            head = node;
+        }
+
+        void place(std::uint32_t node) {
+            const std::uint64_t deadline = nodes_[node].deadline;
+            if (deadline <= now_) {
+                push(due_, nodes_, node);
+                return;
+            }
+            const std::uint64_t differs = deadline ^ now_;
+            if (differs >= kBlockTicks) {
+                push(overflow_, nodes_, node);
+                return;
+            }
+            const unsigned level = (std::bit_width(differs) - 1) / kLevelBits;
+            push(slots_[level][(deadline >> (level * kLevelBits)) & (kSlots - 1)], nodes_, node);
+        }
+
+        /**
+         * Redistributes the slots whose turn has come, highest level first, so that timers
+         * moving down several levels at once land in slots that are emptied later this tick.
+         */
+        void cascade() {
+            if ((now_ & (kBlockTicks - 1)) == 0) replace(overflow_);
+            for (unsigned level = kLevels - 1; level > 0; --level) {
+                const std::uint64_t span = 1ull << (level * kLevelBits);
+                if ((now_ & (span - 1)) != 0) continue;
+                replace(slots_[level][(now_ >> (level * kLevelBits)) & (kSlots - 1)]);
+            }
+        }
+
+        void replace(std::uint32_t &head) {
+            std::uint32_t node = head;
+            head = kNone;
+            while (node != kNone) {
+                const std::uint32_t next = nodes_[node].next;
+                place(node);
+                node = next;
+            }
+        }
+
+        template<typename F>
+        std::size_t fire(std::uint32_t &head, F &expired) {
+            std::size_t fired = 0;
+            std::uint32_t node = head;
+            head = kNone;
+            while (node != kNone) {
+                const std::uint32_t next = nodes_[node].next;
+                T value = std::move(nodes_[node].value);
+                nodes_[node].value = T{};
+                nodes_[node].next = free_;
+                free_ = node;
+                --size_;
+                ++fired;
+                expired(std::move(value));
+                node = next;
+            }
+            return fired;
+        }
+
+        std::uint64_t tick_ms_;
+        std::uint64_t now_; // in ticks
+        std::array<std::array<std::uint32_t, kSlots>, kLevels> slots_{};
+        std::uint32_t due_ = kNone;
+        std::uint32_t overflow_ = kNone;
+        std::vector<Node> nodes_;
+        std::uint32_t free_ = kNone;
+        std::size_t size_ = 0;
+    };
+} // namespace beacon::timing
@@ -0,0 +1,212 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace beacon::trending {
+    using Clock = std::chrono::system_clock;
+
+    /**
+     * Count-min sketch: an item counts in one of `width` counters in each of `depth` rows and
+     * is estimated by the smallest of them, so estimates never fall short, and exceed the
+     * truth by at most about e/width of everything added with probability about 1 - e^-depth.
+     * Blocked: the hash picks one 64-byte line of 16 counters, and each row a counter in its
+     * own part of it, so an update or estimate touches one cache line rather than `depth`
+     * (depth is at most 16; width * depth is rounded up to a power-of-two number of lines).
+     * Sketches of the same shape add and subtract counter-wise.
+     */
+    class CountMinSketch {
+    public:
+        CountMinSketch(std::size_t width, std::size_t depth);
+
+        void add(std::uint64_t hash, std::uint32_t count = 1);
+
+        std::uint32_t estimate(std::uint64_t hash) const;
+
+        void add(const CountMinSketch &other);
+
+        /**
+         * Takes away `other`, which must have been added to this one.
+         */
+        void subtract(const CountMinSketch &other);
+
+        void clear();
+
+        std::size_t memory_bytes() const {
+            return counters_.capacity() * sizeof(std::uint32_t);
+        }
+
+    private:
+        static constexpr std::size_t kLine = 16;
+
+        std::size_t lines_mask_;
+        std::size_t depth_;
+        std::size_t lane_;
+        std::vector<std::uint32_t> counters_;
+    };
+
+    /**
+     * The space-saving heavy-hitter summary (Metwally et al.): at most `capacity` items with
+     * counts. An item not held replaces the one with the smallest count m and starts at
+     * m + its count, recording m as its error, so every item counted more than N / capacity
+     * times is held, with a count too high by at most its error. Counts sit in a min-heap
+     * and items are found through a linear-probing table of their hashes: an update costs
+     * O(log capacity).
+     */
+    class SpaceSaving {
+    public:
+        struct Entry {
+            std::string item;
+            std::uint64_t hash = 0;
+            std::uint32_t count = 0;
+            std::uint32_t error = 0;
+        };
+
+        explicit SpaceSaving(std::size_t capacity);
+
+        void add(std::string_view item, std::uint64_t hash, std::uint32_t count = 1);
+
+        /**
+         * The items held, in no order.
+         */
+        const std::vector<Entry> &entries() const {
+            return entries_;
+        }
+
+        void clear();
+
+        std::size_t memory_bytes() const;
+
+    private:
+        static constexpr std::uint32_t kEmpty = 0xffffffffu;
+
+        std::size_t find(std::string_view item, std::uint64_t hash) const;
+
+        void erase_slot(std::size_t slot);
+
+        void sift_up(std::size_t at);
+
+        void sift_down(std::size_t at);
+
+        std::size_t capacity_;
+        std::vector<Entry> entries_;
+        // indices into entries_ by count, smallest first, and each entry's place in it
+        std::vector<std::uint32_t> heap_;
+        std::vector<std::uint32_t> places_;
+        // indices into entries_ by hash, at most half full
+        std::vector<std::uint32_t> slots_;
+    };
+
+    /**
+     * A sliding window: the last `buckets` buckets of span / buckets each, the current one
+     * included, so it slides a bucket at a time.
+     */
+    struct Window {
+        std::string name;
+        Clock::duration span;
+        std::size_t buckets;
+    };
+
+    struct TrendingConfig {
+        std::vector<Window> windows = {
+            {"5m", std::chrono::minutes(5), 5}, {"1h", std::chrono::hours(1), 12}, {"24h", std::chrono::hours(24), 24}
+        };
+        // count-min sketch shape of every bucket
+        std::size_t sketch_width = 512;
+        std::size_t sketch_depth = 4;
+        // items held per bucket, and at most in a top-K list
+        std::size_t heavy_hitters = 64;
+        // (event_type, category) pairs tracked; events of pairs beyond it only count in the
+        // pairs already tracked
+        std::size_t max_streams = 128;
+        // payload field naming the item's category
+        std::string category_field = "category";
+
+        /**
+         * Reads BEACON_TRENDING_WINDOWS ("5m=5,1h=12,24h=24": name and bucket count, the name
+         * being a number of s, m, h or d), BEACON_TRENDING_SKETCH_WIDTH,
+         * BEACON_TRENDING_SKETCH_DEPTH, BEACON_TRENDING_HEAVY_HITTERS,
+         * BEACON_TRENDING_MAX_STREAMS and BEACON_TRENDING_CATEGORY_FIELD.
+         */
+        static TrendingConfig from_env();
+    };
+
+    struct TrendingItem {
+        std::string item;
+        std::uint64_t count = 0;
+    };
+
+    /**
+     * Items seen most in the last few minutes, hours or days, per event type and category.
+     *
+     * Each event counts in four streams: every event, its event_type, its category, and the
+     * pair (any left out when the event has none). A stream keeps, per window, a ring of
+     * buckets, each a CountMinSketch and a SpaceSaving summary, plus the sum of the ring's
+     * sketches. As time moves into a new bucket the one falling out of the window is
+     * subtracted from the sum and reused. A top-K query ranks the heavy hitters of the
+     * current bucket and those of the earlier ones (merged once per bucket, keeping the
+     * heavy_hitters best) by their estimate in the sum, so it costs a few hundred counter
+     * reads whatever the catalog or the traffic. Memory is fixed by the configuration:
+     * max_streams streams of sketch_width * sketch_depth counters and heavy_hitters items
+     * per bucket.
+     *
+     * Events may come late, down to the start of the window; a late event's item joins
+     * the merged heavy hitters of its window the next time it slides. Safe to use from any
+     * thread: streams are locked one at a time, briefly.
+     */
+    class TrendingTracker {
+    public:
+        explicit TrendingTracker(TrendingConfig config = {});
+
+        ~TrendingTracker();
+
+        TrendingTracker(const TrendingTracker &) = delete;
+
+        TrendingTracker &operator=(const TrendingTracker &) = delete;
+
+        /**
+         * Counts a published event (its entity_id as the item) if it has an event_type.
+         * Returns whether it did.
+         */
+        bool observe(const nlohmann::json &event);
+
+        /**
+         * Counts `item` under `event_type` and `category`, either of which may be empty.
+         */
+        void add(std::string_view event_type, std::string_view category, std::string_view item,
+                 Clock::time_point at = Clock::now(), std::uint32_t count = 1);
+
+        /**
+         * Up to k items counted most in the window named `window` as of `now`, most first,
+         * among events of `event_type` and `category` (empty for any). Throws
+         * std::invalid_argument for an unknown window.
+         */
+        std::vector<TrendingItem> top(std::string_view event_type, std::string_view category,
+                                      std::string_view window, std::size_t k, Clock::time_point now = Clock::now());
+
+        std::size_t streams() const;
+
+        std::size_t memory_bytes() const;
+
+    private:
+        struct Stream;
+
+        Stream *stream(std::string_view event_type, std::string_view category, bool create);
+
+        TrendingConfig config_;
+        mutable std::shared_mutex streams_mutex_;
+        std::unordered_map<std::string, std::unique_ptr<Stream> > streams_;
+    };
+} // namespace beacon::trending
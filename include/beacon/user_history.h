@@ -0,0 +1,165 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#pragma once
+
+#include <beacon/interner.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace beacon {
+    namespace reco {
+        struct RecentInteraction {
+            std::string user;
+            std::string item;
+            std::string event_type;
+            // unix milliseconds
+            std::uint64_t at_ms = 0;
+        };
+
+        /**
+         * Durable home of past interactions, read once to warm a UserHistoryStore up.
+         */
+        class HistorySource {
+        public:
+            virtual ~HistorySource() = default;
+
+            /**
+             * The last `per_user` interactions of each of the `users` most recently active users,
+             * the user named by the payload field `user_field`, among the interactions at or after
+             * `since_ms` (unix milliseconds): users least recently active first, each user's
+             * interactions oldest first.
+             */
+            virtual std::vector<RecentInteraction> load_recent_interactions(const std::string &user_field,
+                                                                            std::size_t per_user,
+                                                                            std::size_t users,
+                                                                            std::uint64_t since_ms) = 0;
+        };
+
+        struct UserHistoryConfig {
+            // interactions kept per user
+            std::size_t capacity = 32;
+            // bytes of ring buffers and names, past which the least recently active users go
+            std::size_t max_bytes = std::size_t{256} << 20;
+            // independently locked shares of the users
+            std::size_t stripes = 64;
+            // interactions are events whose entity_id is the item and whose payload names the user
+            std::string user_field = "user_id";
+            // how far back warm_start() reads, so that it does not read all history ever stored
+            std::chrono::hours lookback{24 * 7};
+
+            /**
+             * Reads BEACON_USER_HISTORY_CAPACITY, BEACON_USER_HISTORY_MAX_MB,
+             * BEACON_USER_HISTORY_STRIPES, BEACON_USER_HISTORY_USER_FIELD and
+             * BEACON_USER_HISTORY_LOOKBACK_HOURS.
+             */
+            static UserHistoryConfig from_env();
+        };
+
+        /**
+         * Each user's last `capacity` interactions, at hand without a trip to storage.
+         *
+         * Users, items and event types are interned into one beacon::Interner by reference
+         * (see Interner::acquire()), so an interaction is 16 bytes in a ring buffer of fixed
+         * size, rings live back to back in one array per stripe and users find theirs by
+         * interned id. Users are split into stripes by a hash of their id, each under its own
+         * lock, so writers on different stripes never meet and a write takes one short lock.
+         * The rings of a stripe and an equal share of the names (see name_bytes()) are held
+         * within the stripe's share of max_bytes; once full, a stripe evicts its least recently
+         * active users (activity being an interaction; reads do not count) until the new
+         * interaction fits. A name is released with the last interaction or user that refers
+         * to it, so memory stays within the cap however many users and items come and go. The
+         * interner is the store's own rather than the recommendation engine's, whose names
+         * stay pinned for as long as it runs.
+         *
+         * warm_start() fills the store from a HistorySource, such as the events table, so a
+         * restarted broker serves histories at once. Safe to use from any thread.
+         */
+        class UserHistoryStore {
+        public:
+            explicit UserHistoryStore(UserHistoryConfig config = {});
+
+            ~UserHistoryStore();
+
+            UserHistoryStore(const UserHistoryStore &) = delete;
+
+            UserHistoryStore &operator=(const UserHistoryStore &) = delete;
+
+            /**
+             * Records a published event as an interaction if it is one. Returns whether it was.
+             */
+            bool observe(const nlohmann::json &event);
+
+            void add(std::string_view user, std::string_view item, std::string_view event_type, std::uint64_t at_ms);
+
+            /**
+             * Up to n of the user's interactions, most recent first.
+             */
+            std::vector<RecentInteraction> recent(std::string_view user, std::size_t n) const;
+
+            /**
+             * Loads as many users as their rings alone would fit from `source`, among those
+             * active within the lookback, as if their interactions had just been added in its
+             * order; names may make the first of them give way. Returns the interactions loaded.
+             */
+            std::size_t warm_start(HistorySource &source);
+
+            /**
+             * Users held.
+             */
+            std::size_t users() const;
+
+            /**
+             * Users evicted to make room so far.
+             */
+            std::uint64_t evicted() const;
+
+            std::size_t memory_bytes() const;
+
+            /**
+             * What a user's ring counts against max_bytes.
+             */
+            static std::size_t ring_bytes(std::size_t capacity);
+
+            /**
+             * What a user, item or event type name counts against max_bytes: its characters and
+             * an estimate of its entries in the interner and in its stripe's ring index.
+             */
+            static std::size_t name_bytes(std::string_view name);
+
+        private:
+            struct Stripe;
+
+            std::uint32_t acquire(std::string_view name);
+
+            void release(std::uint32_t id);
+
+            /**
+             * Evicts the stripe's least recently active user; under its lock.
+             */
+            void evict_oldest(Stripe &stripe);
+
+            /**
+             * What the stripe holds against its share: its rings and its part of the names.
+             */
+            std::size_t held(const Stripe &stripe) const;
+
+            UserHistoryConfig config_;
+            // bytes a stripe may hold, and rings if those were all
+            std::size_t share_;
+            std::size_t max_rings_;
+            std::unique_ptr<Stripe[]> stripes_;
+            beacon::Interner names_;
+            // counted for the names held, all stripes together
+            std::atomic<std::size_t> name_bytes_{0};
+            std::atomic<std::uint64_t> evicted_{0};
+        };
+    } // namespace reco
+} // namespace beacon
@@ -3,13 +3,179 @@
 //
 #pragma once
 
+#include "dead_letter.h"
+#include "priority_lanes.h"
+#include "rate_limiter.h"
+#include "streaming_validator.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 
 namespace beacon {
+    using ConnectionId = std::uint64_t;
+
+    /**
+     * Options of an outbound connection opened with WebSocketAdapter::connect().
+     */
+    struct ClientOptions {
+        // negotiate permessage-deflate, compressing every frame in both directions
+        bool compress = false;
+        // sent as X-Api-Key, which the broker uses as the tenant for rate limits
+        std::string api_key;
+    };
+
+    /**
+     * Scheduling of the control and bulk lanes on each core.
+     */
+    struct LaneConfig {
+        // while both lanes have work, control_weight control items go per bulk_weight bulk ones
+        std::uint32_t control_weight = 8;
+        std::uint32_t bulk_weight = 1;
+        // posted tasks a core runs in a row before socket I/O that completed meanwhile goes
+        std::size_t task_budget = 64;
+
+        /**
+         * Reads BEACON_LANE_CONTROL_WEIGHT, BEACON_LANE_BULK_WEIGHT and BEACON_LANE_TASK_BUDGET.
+         */
+        static LaneConfig from_env();
+    };
+
+    /**
+     * WebSocket front end of the broker. Accepts producer and subscriber connections and
+     * serves them on a fixed set of cores, each an event loop on its own thread. Every
+     * connection is owned by one core, and its handlers always run on that core's thread.
+     *
+     * Outbound frames and posted tasks travel in two lanes, control and bulk, each FIFO.
+     * A connection's outbox and a core's task queue serve them by weighted round robin
+     * (see LaneScheduler), so a subscribe ack does not wait behind a subscriber's backlog
+     * of events, nor behind the fan-out a core has queued. Frames of different lanes may
+     * therefore overtake each other.
+     *
+     * Inbound messages are parsed as their fragments arrive, and only the message built so
+     * far is kept between them. One that grows past 4 MiB is rejected with bad_request at
+     * that point and its partial DOM freed; the rest of it is read and dropped.
+     */
     class WebSocketAdapter {
     public:
-        WebSocketAdapter() = default;
+        /**
+         * Invoked on the connection's core for every inbound message that parsed, passed its
+         * topic's schema and passed admission.
+         */
+        using MessageHandler = std::function<void(ConnectionId, nlohmann::json &&)>;
+
+        /**
+         * Invoked on the connection's core once the connection is gone.
+         */
+        using CloseHandler = std::function<void(ConnectionId)>;
+
+        WebSocketAdapter();
+
+        /**
+         * `cores` event loops serve the connections (at most 256). Core 0 runs on the thread
+         * that calls run(), the others on threads run() starts.
+         */
+        explicit WebSocketAdapter(ratelimit::RateLimitConfig limits, std::size_t cores = 1, LaneConfig lanes = {});
+
+        ~WebSocketAdapter();
+
+        WebSocketAdapter(const WebSocketAdapter &) = delete;
+
+        WebSocketAdapter &operator=(const WebSocketAdapter &) = delete;
+
+        /**
+         * Opens an outbound connection to a ws://host[:port][/target] URI. Returns its id at
+         * once; frames sent before the handshake completes are queued. Inbound messages go to
+         * the message handler, and the close handler fires if connecting fails or the
+         * connection drops. Throws std::invalid_argument for malformed URIs.
+         */
+        ConnectionId connect(const std::string &uri, ClientOptions options = {});
+
+        /**
+         * Opens a listening socket on `port`. Connections are accepted once run() starts.
+         */
+        void listen(std::uint16_t port);
+
+        /**
+         * Takes ownership of an already listening socket, e.g. one inherited through
+         * handoff::take_over(). Connections are accepted once run() starts.
+         */
+        void adopt(int native_handle);
+
+        /**
+         * Serves hot restarts on the Unix socket at `path`: a successor process that calls
+         * handoff::take_over(path) receives the listening sockets, after which this adapter
+         * stops accepting, lets its connections finish for up to `drain_timeout`, closes the
+         * rest with "going away" and returns from run().
+         */
+        void enable_handoff(const std::string &path, std::chrono::seconds drain_timeout);
+
+        /**
+         * Whether a successor took the listening sockets over, so that run() returned to let
+         * it serve. Files the successor loaded on start are then its own to write.
+         */
+        bool handed_off() const;
+
+        void on_message(MessageHandler handler);
+
+        /**
+         * Schemas that inbound messages are validated against while their fragments arrive.
+         * A message is rejected at its first invalid token or field; the rest of it is read
+         * and dropped without being buffered. Call before run().
+         */
+        void set_schema_lookup(validation::SchemaLookup lookup);
+
+        /**
+         * Records messages rejected by their schema in `sink`, which admits, samples and
+         * writes them. Call before run().
+         */
+        void set_dead_letters(deadletter::DeadLetterSink *sink);
+
+        void on_close(CloseHandler handler);
+
+        std::size_t cores() const;
+
+        /**
+         * Index of the core that owns the connection.
+         */
+        std::size_t core_of(ConnectionId id) const;
+
+        /**
+         * Runs `task` on the given core's thread, after the tasks already posted to its lane.
+         * Safe to call from any thread.
+         */
+        void post(std::size_t core, std::function<void()> task, Lane lane = Lane::Bulk);
+
+        /**
+         * Runs `task` on the given core's thread once `delay` has passed, unless the adapter
+         * stops first.
+         */
+        void post_after(std::size_t core, std::chrono::steady_clock::duration delay, std::function<void()> task);
+
+        /**
+         * Queues a text frame for a connection, behind the frames already queued in its lane.
+         * Safe to call from any thread.
+         */
+        void send(ConnectionId id, std::string message, Lane lane = Lane::Bulk);
+
+        /**
+         * Like send() in the bulk lane, but while the frame is still queued a later frame
+         * with the same key replaces it. Lagging subscribers thus receive only the latest
+         * value per key.
+         */
+        void send_conflated(ConnectionId id, std::string key, std::string message);
+
+        /**
+         * Runs the event loops, core 0 on the calling thread, until stop() is called.
+         */
+        void run();
+
+        void stop();
 
-        void connect(const std::string &uri);
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
     };
-} // namespace beacon
\ No newline at end of file
+} // namespace beacon
@@ -73,4 +73,40 @@ CREATE TABLE IF NOT EXISTS events
 CREATE INDEX IF NOT EXISTS idx_events_schema ON events (schema_name, schema_version);
 CREATE INDEX IF NOT EXISTS idx_events_entity ON events (entity_id);
 CREATE INDEX IF NOT EXISTS idx_events_type_ts ON events (event_type, created_at DESC);
+CREATE INDEX IF NOT EXISTS idx_events_created_at ON events (created_at);
 CREATE INDEX IF NOT EXISTS idx_events_payload_gin ON events USING GIN (payload jsonb_path_ops);
+
+-- Committed offsets of consumer groups, one row per group, topic and partition
+CREATE TABLE IF NOT EXISTS consumer_offsets
+(
+    group_name       TEXT    NOT NULL,
+    topic            TEXT    NOT NULL,
+    partition        INTEGER NOT NULL,
+    committed_offset BIGINT  NOT NULL,
+    updated_at       TIMESTAMP WITH TIME ZONE DEFAULT now(),
+    PRIMARY KEY (group_name, topic, partition)
+);
+
+-- Events held back for delivery at deliver_at_ms (Unix milliseconds)
+CREATE TABLE IF NOT EXISTS delayed_events
+(
+    id            BIGINT PRIMARY KEY,
+    deliver_at_ms BIGINT NOT NULL,
+    message       JSONB  NOT NULL
+);
+CREATE INDEX IF NOT EXISTS idx_delayed_events_deliver_at ON delayed_events (deliver_at_ms);
+
+-- Inbound events rejected by their schema, sampled and capped per schema
+CREATE TABLE IF NOT EXISTS dead_letters
+(
+    id             BIGSERIAL PRIMARY KEY,
+    schema_name    TEXT    NOT NULL,
+    schema_version INTEGER NOT NULL,
+    topic          TEXT,
+    error_path     TEXT,
+    error_message  TEXT    NOT NULL,
+    raw_payload    TEXT    NOT NULL,
+    truncated      BOOLEAN NOT NULL DEFAULT false,
+    received_at    TIMESTAMP WITH TIME ZONE DEFAULT now()
+);
+CREATE INDEX IF NOT EXISTS idx_dead_letters_schema ON dead_letters (schema_name, schema_version, received_at DESC);
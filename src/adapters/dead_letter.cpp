@@ -0,0 +1,149 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/dead_letter.h>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace beacon::deadletter {
+    DeadLetterConfig DeadLetterConfig::from_env() {
+        DeadLetterConfig config;
+        if (const char *rate = std::getenv("BEACON_DLQ_SAMPLE_RATE")) {
+            config.sample_rate = std::atof(rate);
+        }
+        if (const char *rates = std::getenv("BEACON_DLQ_SAMPLE_RATES")) {
+            std::istringstream entries(rates);
+            std::string entry;
+            while (std::getline(entries, entry, ',')) {
+                const auto equals = entry.find('=');
+                if (equals == std::string::npos) continue;
+                config.schema_sample_rates[entry.substr(0, equals)] = std::atof(entry.c_str() + equals + 1);
+            }
+        }
+        if (const char *per_second = std::getenv("BEACON_DLQ_MAX_PER_SEC")) {
+            config.per_schema.per_second = std::atof(per_second);
+            config.per_schema.burst = config.per_schema.per_second;
+        }
+        if (const char *burst = std::getenv("BEACON_DLQ_BURST")) {
+            config.per_schema.burst = std::atof(burst);
+        }
+        if (const char *raw = std::getenv("BEACON_DLQ_MAX_RAW_BYTES")) {
+            config.max_raw_bytes = std::strtoul(raw, nullptr, 10);
+        }
+        return config;
+    }
+
+    DeadLetterSink::DeadLetterSink(DeadLetterStore &store, DeadLetterConfig config)
+        : store_(store), config_(std::move(config)) {
+        writer_ = std::thread([this]() { run(); });
+    }
+
+    DeadLetterSink::~DeadLetterSink() {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        writer_.join();
+    }
+
+    DeadLetterSink::SchemaState &DeadLetterSink::schema_state(const std::string &schema_name) {
+        {
+            const std::shared_lock lock(schemas_mutex_);
+            const auto found = schemas_.find(schema_name);
+            if (found != schemas_.end()) return *found->second;
+        }
+        const std::lock_guard lock(schemas_mutex_);
+        auto &state = schemas_[schema_name];
+        if (!state) {
+            const auto rate = config_.schema_sample_rates.find(schema_name);
+            state = std::make_unique<SchemaState>(
+                rate != config_.schema_sample_rates.end() ? rate->second : config_.sample_rate, config_.per_schema);
+        }
+        return *state;
+    }
+
+    bool DeadLetterSink::admit(const std::string &schema_name) {
+        SchemaState &state = schema_state(schema_name);
+
+        // keep the n-th reject when n * rate crosses an integer: exactly `rate` of them, evenly spread
+        const std::uint64_t n = state.seen.fetch_add(1, std::memory_order_relaxed);
+        const bool sampled = std::floor(static_cast<double>(n + 1) * state.rate) >
+                             std::floor(static_cast<double>(n) * state.rate);
+        if (!sampled) {
+            sampled_out_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        std::int64_t retry_after = 0;
+        const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            ratelimit::Clock::now().time_since_epoch()).count();
+        if (!state.bucket.try_acquire(1, now, retry_after)) {
+            rate_limited_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void DeadLetterSink::submit(DeadLetter letter) {
+        bool full;
+        {
+            const std::lock_guard lock(mutex_);
+            if (queue_.size() >= config_.max_queued) {
+                ++stats_.queue_full;
+                return;
+            }
+            queue_.push_back(std::move(letter));
+            ++stats_.kept;
+            full = queue_.size() >= config_.batch_size;
+        }
+        if (full) wake_.notify_one();
+    }
+
+    DeadLetterStats DeadLetterSink::stats() const {
+        DeadLetterStats stats;
+        {
+            const std::lock_guard lock(mutex_);
+            stats = stats_;
+        }
+        stats.sampled_out = sampled_out_.load(std::memory_order_relaxed);
+        stats.rate_limited = rate_limited_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void DeadLetterSink::run() {
+        std::unique_lock lock(mutex_);
+        while (!stopping_) {
+            wake_.wait_for(lock, config_.interval, [this]() {
+                return stopping_ || queue_.size() >= config_.batch_size;
+            });
+            write(lock);
+        }
+        write(lock);
+    }
+
+    void DeadLetterSink::write(std::unique_lock<std::mutex> &lock) {
+        while (!queue_.empty()) {
+            const std::size_t count = std::min(queue_.size(), config_.batch_size);
+            std::vector<DeadLetter> batch(std::make_move_iterator(queue_.begin()),
+                                          std::make_move_iterator(queue_.begin() + static_cast<long>(count)));
+            queue_.erase(queue_.begin(), queue_.begin() + static_cast<long>(count));
+            lock.unlock();
+
+            bool written = true;
+            try {
+                store_.store_dead_letters(batch);
+            } catch (const std::exception &e) {
+                std::cerr << "store_dead_letters error: " << e.what() << std::endl;
+                written = false;
+            }
+
+            lock.lock();
+            (written ? stats_.written : stats_.write_failed) += batch.size();
+            if (!written) return;
+        }
+    }
+} // namespace beacon::deadletter
@@ -0,0 +1,138 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/delay_journal.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace beacon::delay {
+    DelayConfig DelayConfig::from_env() {
+        DelayConfig config;
+        if (const char *tick = std::getenv("BEACON_DELAY_TICK_MS")) {
+            config.tick = std::chrono::milliseconds(std::max(1L, std::atol(tick)));
+        }
+        if (const char *window = std::getenv("BEACON_DELAY_WINDOW_SECS")) {
+            config.window = std::chrono::seconds(std::max(1L, std::atol(window)));
+        }
+        return config;
+    }
+
+    DelayJournal::DelayJournal(DelayStore &store, std::chrono::milliseconds interval, std::size_t max_pending)
+        : store_(store), interval_(interval), max_pending_(max_pending) {
+        writer_ = std::thread([this]() { run(); });
+    }
+
+    DelayJournal::~DelayJournal() {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        writer_.join();
+    }
+
+    void DelayJournal::save(const DelayedEvent &event) {
+        bool full;
+        {
+            const std::lock_guard lock(mutex_);
+            added_.emplace(event.id, event);
+            full = added_.size() + delivered_.size() >= max_pending_;
+        }
+        if (full) wake_.notify_one();
+    }
+
+    void DelayJournal::delivered(std::uint64_t id) {
+        bool full;
+        {
+            const std::lock_guard lock(mutex_);
+            // delivered before it was ever written: nothing to delete either
+            if (added_.erase(id) != 0) return;
+            delivered_.push_back(id);
+            full = added_.size() + delivered_.size() >= max_pending_;
+        }
+        if (full) wake_.notify_one();
+    }
+
+    void DelayJournal::load(std::uint64_t after_ms, std::uint64_t until_ms, std::uint64_t below_id,
+                            LoadHandler done) {
+        {
+            const std::lock_guard lock(mutex_);
+            loads_.push_back(Load{after_ms, until_ms, below_id, std::move(done)});
+        }
+        wake_.notify_one();
+    }
+
+    void DelayJournal::flush() {
+        std::unique_lock lock(mutex_);
+        write_pending(lock);
+    }
+
+    void DelayJournal::run() {
+        std::unique_lock lock(mutex_);
+        bool healthy = true;
+        while (true) {
+            wake_.wait_for(lock, interval_, [this, healthy]() {
+                return stopping_ || (healthy && (!loads_.empty() || added_.size() + delivered_.size() >= max_pending_));
+            });
+            healthy = write_pending(lock);
+            if (stopping_) break;
+
+            // A load must see every save queued before it, so it waits for a good write.
+            while (healthy && !loads_.empty()) {
+                Load next = std::move(loads_.front());
+                loads_.pop_front();
+                lock.unlock();
+
+                std::vector<DelayedEvent> events;
+                bool ok = true;
+                try {
+                    const std::lock_guard store_lock(store_mutex_);
+                    events = store_.load_delayed(next.after_ms, next.until_ms, next.below_id);
+                } catch (const std::exception &e) {
+                    std::cerr << "load_delayed error: " << e.what() << std::endl;
+                    ok = false;
+                }
+                next.done(std::move(events), ok);
+                lock.lock();
+            }
+        }
+    }
+
+    bool DelayJournal::write_pending(std::unique_lock<std::mutex> &lock) {
+        if (added_.empty() && delivered_.empty()) return true;
+
+        std::unordered_map<std::uint64_t, DelayedEvent> added;
+        std::vector<std::uint64_t> delivered;
+        added.swap(added_);
+        delivered.swap(delivered_);
+        lock.unlock();
+
+        std::vector<DelayedEvent> batch;
+        batch.reserve(added.size());
+        for (auto &[id, event]: added) batch.push_back(std::move(event));
+
+        bool written = true;
+        try {
+            const std::lock_guard store_lock(store_mutex_);
+            store_.write_delayed(batch, delivered);
+        } catch (const std::exception &e) {
+            std::cerr << "write_delayed error: " << e.what() << std::endl;
+            written = false;
+        }
+
+        lock.lock();
+        if (!written) {
+            // retried with the next batch; deliveries that happened meanwhile cancel out
+            for (DelayedEvent &event: batch) {
+                const auto id = event.id;
+                added_.emplace(id, std::move(event));
+            }
+            for (const std::uint64_t id: delivered) {
+                if (added_.erase(id) == 0) delivered_.push_back(id);
+            }
+        }
+        return written;
+    }
+} // namespace beacon::delay
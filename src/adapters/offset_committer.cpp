@@ -0,0 +1,198 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/offset_committer.h>
+#include <iostream>
+#include <vector>
+
+namespace beacon::consumer {
+    OffsetCommitter::OffsetCommitter(OffsetStore *store, OffsetCommitConfig config)
+        : store_(store), config_(config), writer_([this]() { run(); }) {
+    }
+
+    OffsetCommitter::~OffsetCommitter() {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (writer_.joinable()) writer_.join();
+    }
+
+    OffsetCommitter::Offsets OffsetCommitter::committed(const std::string &group, const std::string &topic) {
+        if (std::optional<Offsets> known = cached(group, topic)) return std::move(*known);
+
+        Offsets loaded;
+        bool read = true;
+        try {
+            const std::lock_guard store_lock(store_mutex_);
+            for (const CommittedOffset &offset: store_->load_offsets(group, topic)) {
+                loaded[offset.partition] = offset.offset;
+            }
+        } catch (const std::exception &e) {
+            // Start from what is in memory rather than refuse the group, and read again next time.
+            std::cerr << "load_offsets error: " << e.what() << std::endl;
+            read = false;
+        }
+
+        const std::lock_guard lock(mutex_);
+        if (!read) {
+            const auto it = cache_.find({group, topic});
+            return it == cache_.end() ? Offsets{} : it->second;
+        }
+        return merge_loaded({group, topic}, loaded);
+    }
+
+    std::optional<OffsetCommitter::Offsets> OffsetCommitter::cached(const std::string &group,
+                                                                    const std::string &topic) const {
+        const std::lock_guard lock(mutex_);
+        const GroupKey key{group, topic};
+        if (store_ != nullptr && !loaded_.contains(key)) return std::nullopt;
+        const auto it = cache_.find(key);
+        return it == cache_.end() ? Offsets{} : it->second;
+    }
+
+    void OffsetCommitter::load(const std::string &group, const std::string &topic, Loaded loaded) {
+        {
+            const std::lock_guard lock(mutex_);
+            loads_[{group, topic}].push_back(std::move(loaded));
+        }
+        wake_.notify_one();
+    }
+
+    OffsetCommitter::Offsets &OffsetCommitter::merge_loaded(const GroupKey &key, const Offsets &loaded) {
+        // a commit may have raced the load; keep the higher offset
+        Offsets &cached = cache_[key];
+        for (const auto &[partition, offset]: loaded) {
+            auto &current = cached[partition];
+            if (offset > current) current = offset;
+        }
+        loaded_.insert(key);
+        return cached;
+    }
+
+    void OffsetCommitter::commit(const std::string &group, const std::string &topic, std::uint32_t partition,
+                                 std::uint64_t offset) {
+        bool full = false;
+        {
+            const std::lock_guard lock(mutex_);
+            auto &current = cache_[{group, topic}][partition];
+            if (offset <= current) return;
+            current = offset;
+            if (store_ == nullptr) return;
+            dirty_[Key{group, topic, partition}] = offset;
+            full = dirty_.size() >= config_.max_dirty;
+        }
+        if (full) wake_.notify_one();
+    }
+
+    void OffsetCommitter::flush() {
+        if (store_ == nullptr) return;
+        std::unique_lock lock(mutex_);
+        write_dirty(lock);
+    }
+
+    std::uint64_t OffsetCommitter::batches_written() const {
+        const std::lock_guard lock(mutex_);
+        return batches_written_;
+    }
+
+    void OffsetCommitter::run() {
+        std::unique_lock lock(mutex_);
+        bool healthy = true;
+        while (!stopping_) {
+            // after a failed read or write wait out the whole interval, however much is pending
+            wake_.wait_for(lock, config_.interval, [this, healthy]() {
+                return stopping_ || (healthy && (dirty_.size() >= config_.max_dirty || !loads_.empty()));
+            });
+            if (stopping_) break;
+            const bool loaded = load_pending(lock);
+            healthy = write_dirty(lock) && loaded;
+        }
+        write_dirty(lock);
+    }
+
+    bool OffsetCommitter::load_pending(std::unique_lock<std::mutex> &lock) {
+        if (loads_.empty()) return true;
+        std::vector<GroupKey> keys;
+        for (const auto &[key, waiting]: loads_) {
+            if (!loaded_.contains(key)) keys.push_back(key);
+        }
+        lock.unlock();
+
+        std::vector<std::pair<GroupKey, Offsets> > read;
+        bool healthy = true;
+        for (const GroupKey &key: keys) {
+            if (store_ == nullptr) {
+                // nothing to read; the callbacks still run here rather than on the caller
+                read.emplace_back(key, Offsets{});
+                continue;
+            }
+            try {
+                Offsets offsets;
+                const std::lock_guard store_lock(store_mutex_);
+                for (const CommittedOffset &offset: store_->load_offsets(key.first, key.second)) {
+                    offsets[offset.partition] = offset.offset;
+                }
+                read.emplace_back(key, std::move(offsets));
+            } catch (const std::exception &e) {
+                std::cerr << "load_offsets error: " << e.what() << std::endl;
+                healthy = false;
+            }
+        }
+
+        lock.lock();
+        for (const auto &[key, offsets]: read) merge_loaded(key, offsets);
+        // what is known now goes to its waiters; the rest waits for the next round
+        std::vector<std::pair<Offsets, std::vector<Loaded> > > ready;
+        for (auto it = loads_.begin(); it != loads_.end();) {
+            if (!loaded_.contains(it->first)) {
+                ++it;
+                continue;
+            }
+            ready.emplace_back(cache_[it->first], std::move(it->second));
+            it = loads_.erase(it);
+        }
+        lock.unlock();
+        for (const auto &[offsets, waiting]: ready) {
+            for (const Loaded &loaded: waiting) loaded(offsets);
+        }
+        lock.lock();
+        return healthy;
+    }
+
+    bool OffsetCommitter::write_dirty(std::unique_lock<std::mutex> &lock) {
+        if (dirty_.empty()) return true;
+
+        std::map<Key, std::uint64_t> batch;
+        batch.swap(dirty_);
+        lock.unlock();
+
+        std::vector<CommittedOffset> offsets;
+        offsets.reserve(batch.size());
+        for (const auto &[key, offset]: batch) {
+            offsets.push_back({std::get<0>(key), std::get<1>(key), std::get<2>(key), offset});
+        }
+
+        bool written = true;
+        try {
+            const std::lock_guard store_lock(store_mutex_);
+            store_->save_offsets(offsets);
+        } catch (const std::exception &e) {
+            std::cerr << "save_offsets error: " << e.what() << std::endl;
+            written = false;
+        }
+
+        lock.lock();
+        if (written) {
+            ++batches_written_;
+        } else {
+            // retried with the next batch, unless a newer commit superseded it meanwhile
+            for (const auto &[key, offset]: batch) {
+                dirty_.try_emplace(key, offset);
+            }
+        }
+        return written;
+    }
+} // namespace beacon::consumer
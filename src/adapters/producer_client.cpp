@@ -0,0 +1,231 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/producer_client.h>
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <utility>
+
+namespace beacon {
+    namespace {
+        std::string random_producer_id() {
+            std::random_device device;
+            std::mt19937_64 rng((static_cast<std::uint64_t>(device()) << 32) ^ device());
+            static const char digits[] = "0123456789abcdef";
+            std::string id = "producer-";
+            for (int i = 0; i < 16; ++i) id += digits[rng() % 16];
+            return id;
+        }
+    } // namespace
+
+    ProducerClient::ProducerClient(ProducerConfig config) : config_(std::move(config)) {
+        if (config_.producer_id.empty()) config_.producer_id = random_producer_id();
+
+        adapter_.on_message([this](ConnectionId connection, nlohmann::json &&reply) {
+            on_reply(connection, std::move(reply));
+        });
+        adapter_.on_close([this](ConnectionId connection) {
+            on_disconnect(connection);
+        });
+        connection_ = adapter_.connect(config_.uri, ClientOptions{config_.compress, config_.api_key});
+        io_thread_ = std::thread([this]() { adapter_.run(); });
+    }
+
+    ProducerClient::~ProducerClient() {
+        adapter_.stop();
+        io_thread_.join();
+    }
+
+    void ProducerClient::publish(const std::string &topic, const std::string &entity_id,
+                                 const std::string &event_type, const nlohmann::json &payload) {
+        // serialize outside the lock
+        const std::string event = nlohmann::json{
+            {"topic", topic},
+            {"entity_id", entity_id},
+            {"event_type", event_type},
+            {"payload", payload}
+        }.dump();
+
+        bool sealed = false;
+        bool first = false;
+        std::uint64_t generation = 0;
+        {
+            std::unique_lock lock(mutex_);
+            changed_.wait(lock, [this]() { return queued_.size() < config_.max_queued_batches; });
+            if (open_.count == 0) {
+                first = true;
+                generation = open_generation_;
+            } else {
+                open_.events += ',';
+            }
+            open_.events += event;
+            ++open_.count;
+            ++unfinished_events_;
+            if (open_.count >= config_.batch_events || open_.events.size() >= config_.batch_bytes) {
+                seal_locked();
+                sealed = true;
+            }
+        }
+
+        if (sealed) {
+            adapter_.post(0, [this]() { pump(); });
+        } else if (first) {
+            adapter_.post_after(0, config_.linger, [this, generation]() {
+                {
+                    const std::lock_guard lock(mutex_);
+                    if (open_generation_ != generation || open_.count == 0) return;
+                    seal_locked();
+                }
+                pump();
+            });
+        }
+    }
+
+    bool ProducerClient::flush(std::chrono::milliseconds timeout) {
+        {
+            const std::lock_guard lock(mutex_);
+            if (open_.count > 0) seal_locked();
+        }
+        adapter_.post(0, [this]() { pump(); });
+
+        std::unique_lock lock(mutex_);
+        return changed_.wait_for(lock, timeout, [this]() { return unfinished_events_ == 0; });
+    }
+
+    ProducerStats ProducerClient::stats() const {
+        const std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+    void ProducerClient::seal_locked() {
+        queued_.push_back(std::move(open_));
+        open_ = Batch{};
+        ++open_generation_;
+    }
+
+    void ProducerClient::pump() {
+        if (connection_ == 0 || paused_) return;
+
+        const std::string prefix = R"({"op":"publish_batch","producer":)" + nlohmann::json(config_.producer_id).dump() +
+                                   R"(,"sequence":)";
+        const std::lock_guard lock(mutex_);
+        const bool was_full = queued_.size() >= config_.max_queued_batches;
+        while (in_flight_.size() < config_.max_in_flight && !queued_.empty()) {
+            Batch batch = std::move(queued_.front());
+            queued_.pop_front();
+            if (batch.sequence == 0) batch.sequence = next_sequence_++;
+
+            std::string frame;
+            frame.reserve(prefix.size() + batch.events.size() + 32);
+            frame += prefix;
+            frame += std::to_string(batch.sequence);
+            frame += R"(,"events":[)";
+            frame += batch.events;
+            frame += "]}";
+            adapter_.send(connection_, std::move(frame));
+            in_flight_.push_back(std::move(batch));
+        }
+        if (was_full && queued_.size() < config_.max_queued_batches) changed_.notify_all();
+    }
+
+    void ProducerClient::on_reply(ConnectionId connection, nlohmann::json &&reply) {
+        // Replies come one per batch, in the order the batches were sent.
+        if (connection != connection_ || in_flight_.empty()) return;
+
+        Batch batch = std::move(in_flight_.front());
+        in_flight_.pop_front();
+
+        if (reply.value("type", "") == "ack") {
+            max_acked_ = std::max(max_acked_, batch.sequence);
+            finish(batch, true);
+        } else {
+            // Every batch behind a refused one is refused too, its sequence no longer follows.
+            paused_ = true;
+            const std::string code = reply.value("code", "");
+            if (code == "rate_limited" || code == "out_of_sequence") {
+                // this runs on the I/O thread, so a malformed reply must not throw
+                const auto retry_after = reply.find("retry_after_ms");
+                const auto delay = retry_after != reply.end() && retry_after->is_number_integer()
+                                       ? std::chrono::milliseconds(reply.value("retry_after_ms", std::int64_t{0}))
+                                       : config_.retry_backoff;
+                resume_delay_ = std::max(resume_delay_, delay);
+                retry_.push_back(std::move(batch));
+            } else {
+                std::cerr << "producer " << config_.producer_id << ": batch " << batch.sequence << " refused: "
+                          << reply.value("message", code) << std::endl;
+                finish(batch, false);
+            }
+        }
+
+        if (!paused_) return pump();
+        if (in_flight_.empty()) resume();
+    }
+
+    void ProducerClient::resume() {
+        // Nothing sent is unanswered now, so the broker's last sequence is our last ack and
+        // the refused batches can be numbered on from there.
+        next_sequence_ = max_acked_ + 1;
+        {
+            const std::lock_guard lock(mutex_);
+            stats_.retries += retry_.size();
+            while (!retry_.empty()) {
+                retry_.back().sequence = 0;
+                queued_.push_front(std::move(retry_.back()));
+                retry_.pop_back();
+            }
+        }
+
+        const auto delay = std::exchange(resume_delay_, std::chrono::milliseconds(0));
+        adapter_.post_after(0, delay, [this, connection = connection_]() {
+            if (connection != connection_) return;
+            paused_ = false;
+            pump();
+        });
+    }
+
+    void ProducerClient::on_disconnect(ConnectionId connection) {
+        if (connection != connection_) return;
+        connection_ = 0;
+        paused_ = false;
+        resume_delay_ = std::chrono::milliseconds(0);
+
+        // Unanswered batches may or may not have been published; resending them with their
+        // sequence numbers lets the broker tell.
+        {
+            const std::lock_guard lock(mutex_);
+            while (!in_flight_.empty()) {
+                queued_.push_front(std::move(in_flight_.back()));
+                in_flight_.pop_back();
+            }
+            while (!retry_.empty()) {
+                queued_.push_front(std::move(retry_.back()));
+                retry_.pop_back();
+            }
+        }
+        adapter_.post_after(0, config_.retry_backoff, [this]() { reconnect(); });
+    }
+
+    void ProducerClient::reconnect() {
+        connection_ = adapter_.connect(config_.uri, ClientOptions{config_.compress, config_.api_key});
+        {
+            const std::lock_guard lock(mutex_);
+            ++stats_.reconnects;
+        }
+        pump();
+    }
+
+    void ProducerClient::finish(const Batch &batch, bool acked) {
+        const std::lock_guard lock(mutex_);
+        if (acked) {
+            ++stats_.batches_acked;
+            stats_.events_acked += batch.count;
+        } else {
+            ++stats_.batches_failed;
+            stats_.events_failed += batch.count;
+        }
+        unfinished_events_ -= batch.count;
+        changed_.notify_all();
+    }
+} // namespace beacon
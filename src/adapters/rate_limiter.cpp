@@ -0,0 +1,165 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/rate_limiter.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace beacon::ratelimit {
+    namespace {
+        double env_double(const char *var) {
+            const char *val = std::getenv(var);
+            if (val == nullptr || *val == '\0') return 0.0;
+
+            char *end = nullptr;
+            const double parsed = std::strtod(val, &end);
+            if (end == val || parsed < 0.0) {
+                std::cerr << "Ignoring invalid value for " << var << ": " << val << std::endl;
+                return 0.0;
+            }
+            return parsed;
+        }
+
+        Limit env_limit(const char *rate_var, const char *burst_var) {
+            return Limit{env_double(rate_var), env_double(burst_var)};
+        }
+
+        std::int64_t to_ns(Clock::time_point now) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+        }
+    } // namespace
+
+    RateLimitConfig RateLimitConfig::from_env() {
+        RateLimitConfig config;
+        config.connection_messages = env_limit("BEACON_CONN_MSGS_PER_SEC", "BEACON_CONN_MSGS_BURST");
+        config.connection_bytes = env_limit("BEACON_CONN_BYTES_PER_SEC", "BEACON_CONN_BYTES_BURST");
+        config.tenant_messages = env_limit("BEACON_TENANT_MSGS_PER_SEC", "BEACON_TENANT_MSGS_BURST");
+        config.tenant_bytes = env_limit("BEACON_TENANT_BYTES_PER_SEC", "BEACON_TENANT_BYTES_BURST");
+
+        const char *action = std::getenv("BEACON_RATE_LIMIT_ACTION");
+        if (action != nullptr && std::string(action) == "reject") {
+            config.action = LimitAction::Reject;
+        }
+        return config;
+    }
+
+    TokenBucket::TokenBucket(Limit limit)
+        : ns_per_unit_(limit.enabled() ? 1e9 / limit.per_second : 0.0),
+          tolerance_ns_(0) {
+        // Without an explicit burst the bucket holds one second worth of tokens.
+        const double burst = std::max(limit.burst > 0.0 ? limit.burst : limit.per_second, 1.0);
+        tolerance_ns_ = static_cast<std::int64_t>(burst * ns_per_unit_);
+    }
+
+    bool TokenBucket::try_acquire(std::uint64_t cost, std::int64_t now_ns, std::int64_t &retry_after_ns) noexcept {
+        if (!enabled()) return true;
+
+        const std::int64_t increment = cost_ns(cost);
+        std::int64_t tat = tat_.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::int64_t next = std::max(tat, now_ns) + increment;
+            // A full bucket (tat <= now) always admits, even a request larger than the burst.
+            if (tat > now_ns && next - now_ns > tolerance_ns_) {
+                retry_after_ns = next - now_ns - tolerance_ns_;
+                return false;
+            }
+            if (tat_.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    void TokenBucket::refund(std::uint64_t cost) noexcept {
+        if (!enabled()) return;
+        tat_.fetch_sub(cost_ns(cost), std::memory_order_relaxed);
+    }
+
+    RateLimiter::RateLimiter(Limit messages, Limit bytes)
+        : messages_(messages), bytes_(bytes) {
+    }
+
+    Decision RateLimiter::try_admit(std::uint64_t messages, std::size_t bytes, std::int64_t now_ns) noexcept {
+        std::int64_t retry_after = 0;
+        // a zero cost is no charge, not a check for debt
+        if (messages > 0 && !messages_.try_acquire(messages, now_ns, retry_after)) {
+            return Decision{false, std::chrono::nanoseconds(retry_after)};
+        }
+        if (bytes > 0 && !bytes_.try_acquire(bytes, now_ns, retry_after)) {
+            messages_.refund(messages);
+            return Decision{false, std::chrono::nanoseconds(retry_after)};
+        }
+        return Decision{};
+    }
+
+    void RateLimiter::refund(std::uint64_t messages, std::size_t bytes) noexcept {
+        messages_.refund(messages);
+        bytes_.refund(bytes);
+    }
+
+    TenantRateLimiters::TenantRateLimiters(Limit messages, Limit bytes, std::size_t max_tenants)
+        : messages_(messages), bytes_(bytes), max_tenants_(max_tenants) {
+    }
+
+    std::shared_ptr<RateLimiter> TenantRateLimiters::get(const std::string &tenant) {
+        if (!messages_.enabled() && !bytes_.enabled()) return nullptr;
+
+        std::lock_guard lock(mutex_);
+        const auto [it, inserted] = limiters_.try_emplace(tenant);
+        if (!inserted) {
+            recency_.splice(recency_.begin(), recency_, it->second.recency);
+            return it->second.limiter;
+        }
+        it->second.limiter = std::make_shared<RateLimiter>(messages_, bytes_);
+        recency_.push_front(tenant);
+        it->second.recency = recency_.begin();
+
+        // Limiters still held by a connection stay, so what is kept beyond max_tenants is
+        // bounded by the open connections.
+        for (auto old = recency_.end(); limiters_.size() > max_tenants_ && std::prev(old) != recency_.begin();) {
+            --old;
+            const auto evicted = limiters_.find(*old);
+            if (evicted->second.limiter.use_count() > 1) continue;
+            limiters_.erase(evicted);
+            old = recency_.erase(old);
+        }
+        return it->second.limiter;
+    }
+
+    std::size_t TenantRateLimiters::size() const {
+        const std::lock_guard lock(mutex_);
+        return limiters_.size();
+    }
+
+    ConnectionRateLimiter::ConnectionRateLimiter(const RateLimitConfig &config, std::shared_ptr<RateLimiter> tenant)
+        : connection_(config.connection_messages, config.connection_bytes),
+          tenant_(std::move(tenant)),
+          action_(config.action) {
+    }
+
+    Decision ConnectionRateLimiter::admit(std::size_t bytes, Clock::time_point now) noexcept {
+        return charge(1, bytes, now);
+    }
+
+    Decision ConnectionRateLimiter::admit_message(Clock::time_point now) noexcept {
+        return charge(1, 0, now);
+    }
+
+    Decision ConnectionRateLimiter::admit_bytes(std::size_t bytes, Clock::time_point now) noexcept {
+        return charge(0, bytes, now);
+    }
+
+    Decision ConnectionRateLimiter::charge(std::uint64_t messages, std::size_t bytes, Clock::time_point now) noexcept {
+        const std::int64_t now_ns = to_ns(now);
+
+        Decision decision = connection_.try_admit(messages, bytes, now_ns);
+        if (!decision || !tenant_) return decision;
+
+        decision = tenant_->try_admit(messages, bytes, now_ns);
+        if (!decision) {
+            connection_.refund(messages, bytes);
+        }
+        return decision;
+    }
+} // namespace beacon::ratelimit
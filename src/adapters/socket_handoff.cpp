@@ -0,0 +1,135 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/socket_handoff.h>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace beacon::handoff {
+    namespace {
+        std::string errno_message(const std::string &what) {
+            return what + ": " + std::strerror(errno);
+        }
+
+        /**
+         * Closes the descriptor when leaving scope.
+         */
+        class UniqueFd {
+        public:
+            explicit UniqueFd(int fd) : fd_(fd) {
+            }
+
+            ~UniqueFd() {
+                if (fd_ >= 0) ::close(fd_);
+            }
+
+            UniqueFd(const UniqueFd &) = delete;
+
+            UniqueFd &operator=(const UniqueFd &) = delete;
+
+            int get() const {
+                return fd_;
+            }
+
+        private:
+            int fd_;
+        };
+
+        void write_byte(int fd, char byte) {
+            ssize_t written;
+            do {
+                written = ::write(fd, &byte, 1);
+            } while (written < 0 && errno == EINTR);
+            if (written != 1) throw HandoffError(errno_message("handoff write failed"));
+        }
+    } // namespace
+
+    void send_fds(int unix_socket, const std::vector<int> &fds) {
+        if (fds.empty() || fds.size() > kMaxDescriptors) {
+            throw HandoffError("can only pass between 1 and " + std::to_string(kMaxDescriptors) + " descriptors");
+        }
+
+        // The payload carries the count so the receiver can detect truncated control data.
+        char count = static_cast<char>(fds.size());
+        iovec iov{&count, 1};
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxDescriptors)] = {};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+        std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+
+        ssize_t sent;
+        do {
+            sent = ::sendmsg(unix_socket, &msg, MSG_NOSIGNAL);
+        } while (sent < 0 && errno == EINTR);
+        if (sent != 1) throw HandoffError(errno_message("sendmsg failed"));
+    }
+
+    std::vector<int> receive_fds(int unix_socket) {
+        char count = 0;
+        iovec iov{&count, 1};
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxDescriptors)] = {};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t received;
+        do {
+            received = ::recvmsg(unix_socket, &msg, MSG_CMSG_CLOEXEC);
+        } while (received < 0 && errno == EINTR);
+        if (received != 1) throw HandoffError(errno_message("recvmsg failed"));
+
+        std::vector<int> fds;
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+            const std::size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const std::size_t offset = fds.size();
+            fds.resize(offset + n);
+            std::memcpy(fds.data() + offset, CMSG_DATA(cmsg), sizeof(int) * n);
+        }
+
+        if ((msg.msg_flags & MSG_CTRUNC) != 0 || fds.size() != static_cast<std::size_t>(count)) {
+            for (const int fd: fds) ::close(fd);
+            throw HandoffError("handoff message lost descriptors");
+        }
+        return fds;
+    }
+
+    std::vector<int> take_over(const std::string &path) {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw HandoffError("handoff socket path too long: " + path);
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        const UniqueFd sock(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (sock.get() < 0) throw HandoffError(errno_message("socket failed"));
+
+        if (::connect(sock.get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0) {
+            // No predecessor: a stale path or nothing there at all.
+            if (errno == ENOENT || errno == ECONNREFUSED) return {};
+            throw HandoffError(errno_message("connect to " + path + " failed"));
+        }
+
+        write_byte(sock.get(), kHello);
+        std::vector<int> fds = receive_fds(sock.get());
+        write_byte(sock.get(), kReady);
+        return fds;
+    }
+} // namespace beacon::handoff
@@ -5,7 +5,8 @@
 #include <beacon/storage_adapter.h>
 #include <iostream>
 
-#define CREATE_SCHEMA_TABLE_IF_NOT_EXISTS R"(
+// Raw strings cannot span lines inside a #define, so the DDL lives in constants.
+constexpr const char *CREATE_SCHEMA_TABLE_IF_NOT_EXISTS = R"(
 CREATE TABLE IF NOT EXISTS schemas (
 id SERIAL PRIMARY KEY,
 name TEXT NOT NULL,
@@ -14,9 +15,9 @@ definition JSONB NOT NULL,
 created_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
 UNIQUE(name, version)
 );
-)"
+)";
 
-#define CREATE_EVENTS_TABLE_IF_NOT_EXISTS R"(
+constexpr const char *CREATE_EVENTS_TABLE_IF_NOT_EXISTS = R"(
 CREATE TABLE IF NOT EXISTS events (
 id BIGSERIAL PRIMARY KEY,
 schema_name TEXT NOT NULL,
@@ -26,7 +27,53 @@ payload JSONB NOT NULL,
 event_type TEXT,
 created_at TIMESTAMP WITH TIME ZONE DEFAULT now()
 );
-)"
+)";
+
+// PQexecParams runs one command per call, so each index gets its own constant.
+constexpr const char *CREATE_EVENTS_CREATED_AT_INDEX_IF_NOT_EXISTS = R"(
+CREATE INDEX IF NOT EXISTS idx_events_created_at ON events (created_at);
+)";
+
+constexpr const char *CREATE_CONSUMER_OFFSETS_TABLE_IF_NOT_EXISTS = R"(
+CREATE TABLE IF NOT EXISTS consumer_offsets (
+group_name TEXT NOT NULL,
+topic TEXT NOT NULL,
+partition INTEGER NOT NULL,
+committed_offset BIGINT NOT NULL,
+updated_at TIMESTAMP WITH TIME ZONE DEFAULT now(),
+PRIMARY KEY (group_name, topic, partition)
+);
+)";
+
+constexpr const char *CREATE_DELAYED_EVENTS_TABLE_IF_NOT_EXISTS = R"(
+CREATE TABLE IF NOT EXISTS delayed_events (
+id BIGINT PRIMARY KEY,
+deliver_at_ms BIGINT NOT NULL,
+message JSONB NOT NULL
+);
+)";
+
+constexpr const char *CREATE_DELAYED_EVENTS_INDEX_IF_NOT_EXISTS = R"(
+CREATE INDEX IF NOT EXISTS idx_delayed_events_deliver_at ON delayed_events (deliver_at_ms);
+)";
+
+constexpr const char *CREATE_DEAD_LETTERS_TABLE_IF_NOT_EXISTS = R"(
+CREATE TABLE IF NOT EXISTS dead_letters (
+id BIGSERIAL PRIMARY KEY,
+schema_name TEXT NOT NULL,
+schema_version INTEGER NOT NULL,
+topic TEXT,
+error_path TEXT,
+error_message TEXT NOT NULL,
+raw_payload TEXT NOT NULL,
+truncated BOOLEAN NOT NULL DEFAULT false,
+received_at TIMESTAMP WITH TIME ZONE DEFAULT now()
+);
+)";
+
+constexpr const char *CREATE_DEAD_LETTERS_INDEX_IF_NOT_EXISTS = R"(
+CREATE INDEX IF NOT EXISTS idx_dead_letters_schema ON dead_letters (schema_name, schema_version, received_at DESC);
+)";
 
 namespace beacon {
     StorageAdapter::StorageAdapter() {
@@ -41,6 +88,9 @@ namespace beacon {
         [&]() -> void {
             this->create_schema_table();
             this->create_events_table();
+            this->create_consumer_offsets_table();
+            this->create_delayed_events_table();
+            this->create_dead_letters_table();
         }();
     }
 
@@ -139,6 +189,225 @@ namespace beacon {
         }
     }
 
+    std::vector<consumer::CommittedOffset> StorageAdapter::load_offsets(const std::string &group,
+                                                                        const std::string &topic) {
+        const std::string sql = R"(
+            SELECT partition, committed_offset
+            FROM consumer_offsets
+            WHERE group_name = $1 AND topic = $2
+        )";
+
+        try {
+            return this->_queryBuilder->query<consumer::CommittedOffset>(
+                sql,
+                [&group, &topic](const pqxx::row &row) {
+                    consumer::CommittedOffset offset;
+                    offset.group = group;
+                    offset.topic = topic;
+                    offset.partition = row["partition"].as<std::uint32_t>();
+                    offset.offset = row["committed_offset"].as<std::uint64_t>();
+                    return offset;
+                },
+                group, topic
+            );
+        } catch (const db::DbError &e) {
+            std::cerr << "loadOffsets error: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    /**
+     * Upserts the whole batch with a single statement: the columns travel as four arrays
+     * and are zipped back into rows by unnest.
+     */
+    void StorageAdapter::save_offsets(const std::vector<consumer::CommittedOffset> &offsets) {
+        if (offsets.empty()) return;
+
+        const std::string sql = R"(
+            INSERT INTO consumer_offsets (group_name, topic, partition, committed_offset)
+            SELECT * FROM unnest($1::text[], $2::text[], $3::integer[], $4::bigint[])
+            ON CONFLICT (group_name, topic, partition) DO UPDATE
+            SET committed_offset = GREATEST(consumer_offsets.committed_offset, EXCLUDED.committed_offset),
+                updated_at = now()
+        )";
+
+        std::vector<std::string> groups;
+        std::vector<std::string> topics;
+        std::vector<std::int32_t> partitions;
+        std::vector<std::int64_t> committed;
+        for (const consumer::CommittedOffset &offset: offsets) {
+            groups.push_back(offset.group);
+            topics.push_back(offset.topic);
+            partitions.push_back(static_cast<std::int32_t>(offset.partition));
+            committed.push_back(static_cast<std::int64_t>(offset.offset));
+        }
+
+        try {
+            this->_queryBuilder->exec(sql, groups, topics, partitions, committed);
+        } catch (const db::DbError &e) {
+            std::cerr << "saveOffsets error: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    std::vector<delay::DelayedEvent> StorageAdapter::load_delayed(std::uint64_t after_ms, std::uint64_t until_ms,
+                                                                  std::uint64_t below_id) {
+        const std::string sql = R"(
+            SELECT id, deliver_at_ms, message
+            FROM delayed_events
+            WHERE deliver_at_ms > $1 AND deliver_at_ms <= $2 AND id < $3
+        )";
+
+        try {
+            return this->_queryBuilder->query<delay::DelayedEvent>(
+                sql,
+                [](const pqxx::row &row) {
+                    delay::DelayedEvent event;
+                    event.id = row["id"].as<std::uint64_t>();
+                    event.deliver_at_ms = row["deliver_at_ms"].as<std::uint64_t>();
+                    event.message = row["message"].as<std::string>();
+                    return event;
+                },
+                static_cast<std::int64_t>(after_ms), static_cast<std::int64_t>(until_ms),
+                static_cast<std::int64_t>(below_id)
+            );
+        } catch (const db::DbError &e) {
+            std::cerr << "loadDelayed error: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    std::uint64_t StorageAdapter::max_delayed_id() {
+        try {
+            return this->_queryBuilder->exec_scalar<std::uint64_t>("SELECT COALESCE(MAX(id), 0) FROM delayed_events");
+        } catch (const db::DbError &e) {
+            std::cerr << "maxDelayedId error: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    /**
+     * Inserts and deletes in one statement. A delete cannot see rows inserted by the same
+     * statement, so events in both lists are left out of the insert instead.
+     */
+    void StorageAdapter::write_delayed(const std::vector<delay::DelayedEvent> &added,
+                                       const std::vector<std::uint64_t> &delivered) {
+        const std::string sql = R"(
+            WITH added AS (
+                INSERT INTO delayed_events (id, deliver_at_ms, message)
+                SELECT a.id, a.deliver_at_ms, a.message
+                FROM unnest($1::bigint[], $2::bigint[], $3::jsonb[]) AS a(id, deliver_at_ms, message)
+                WHERE NOT (a.id = ANY($4::bigint[]))
+                ON CONFLICT (id) DO NOTHING
+            )
+            DELETE FROM delayed_events WHERE id = ANY($4::bigint[])
+        )";
+
+        std::vector<std::int64_t> ids;
+        std::vector<std::int64_t> deliver_at;
+        std::vector<std::string> messages;
+        for (const delay::DelayedEvent &event: added) {
+            ids.push_back(static_cast<std::int64_t>(event.id));
+            deliver_at.push_back(static_cast<std::int64_t>(event.deliver_at_ms));
+            messages.push_back(event.message);
+        }
+        std::vector<std::int64_t> removed(delivered.begin(), delivered.end());
+
+        try {
+            this->_queryBuilder->exec(sql, ids, deliver_at, messages, removed);
+        } catch (const db::DbError &e) {
+            std::cerr << "writeDelayed error: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    /**
+     * Inserts the whole batch with a single statement, as save_offsets does. Booleans
+     * travel as text, which the boolean[] cast parses.
+     */
+    void StorageAdapter::store_dead_letters(const std::vector<deadletter::DeadLetter> &letters) {
+        if (letters.empty()) return;
+
+        const std::string sql = R"(
+            INSERT INTO dead_letters (schema_name, schema_version, topic, error_path, error_message,
+                                      raw_payload, truncated)
+            SELECT * FROM unnest($1::text[], $2::integer[], $3::text[], $4::text[], $5::text[],
+                                 $6::text[], $7::boolean[])
+        )";
+
+        std::vector<std::string> names;
+        std::vector<std::int32_t> versions;
+        std::vector<std::string> topics;
+        std::vector<std::string> paths;
+        std::vector<std::string> messages;
+        std::vector<std::string> payloads;
+        std::vector<std::string> truncated;
+        for (const deadletter::DeadLetter &letter: letters) {
+            names.push_back(letter.schema_name);
+            versions.push_back(letter.schema_version);
+            topics.push_back(letter.topic);
+            paths.push_back(letter.error_path);
+            messages.push_back(letter.error_message);
+            payloads.push_back(letter.raw_payload);
+            truncated.emplace_back(letter.truncated ? "true" : "false");
+        }
+
+        try {
+            this->_queryBuilder->exec(sql, names, versions, topics, paths, messages, payloads, truncated);
+        } catch (const db::DbError &e) {
+            std::cerr << "storeDeadLetters error: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    /**
+     * One range scan of the events since the lookback, by their created_at index: each user's
+     * events ranked newest first, the users cut to the most recently active, and the survivors
+     * sorted for replay.
+     */
+    std::vector<reco::RecentInteraction> StorageAdapter::load_recent_interactions(const std::string &user_field,
+                                                                                  std::size_t per_user,
+                                                                                  std::size_t users,
+                                                                                  std::uint64_t since_ms) {
+        const std::string sql = R"(
+            WITH ranked AS (
+                SELECT payload->>$1 AS user_id, entity_id, COALESCE(event_type, '') AS event_type, created_at, id,
+                       ROW_NUMBER() OVER (PARTITION BY payload->>$1 ORDER BY created_at DESC, id DESC) AS recency
+                FROM events
+                WHERE created_at >= to_timestamp($4::BIGINT / 1000.0) AND payload ? $1 AND entity_id IS NOT NULL
+            ), active AS (
+                SELECT user_id, created_at AS last_seen
+                FROM ranked
+                WHERE recency = 1
+                ORDER BY created_at DESC
+                LIMIT $3
+            )
+            SELECT r.user_id, r.entity_id, r.event_type,
+                   (EXTRACT(EPOCH FROM r.created_at) * 1000)::BIGINT AS at_ms
+            FROM ranked r JOIN active a ON a.user_id = r.user_id
+            WHERE r.recency <= $2
+            ORDER BY a.last_seen ASC, r.user_id, r.created_at ASC, r.id ASC
+        )";
+
+        try {
+            return this->_queryBuilder->query<reco::RecentInteraction>(
+                sql,
+                [](const pqxx::row &row) {
+                    reco::RecentInteraction interaction;
+                    interaction.user = row["user_id"].as<std::string>();
+                    interaction.item = row["entity_id"].as<std::string>();
+                    interaction.event_type = row["event_type"].as<std::string>();
+                    interaction.at_ms = row["at_ms"].as<std::uint64_t>();
+                    return interaction;
+                },
+                user_field, static_cast<std::int64_t>(per_user), static_cast<std::int64_t>(users),
+                static_cast<std::int64_t>(since_ms)
+            );
+        } catch (const db::DbError &e) {
+            std::cerr << "loadRecentInteractions error: " << e.what() << std::endl;
+            throw;
+        }
+    }
 
     /**
      * The create_schema_table creates a schema table in the respective postgresql database if it doesn't already exist.
@@ -155,12 +424,42 @@ namespace beacon {
     void StorageAdapter::create_events_table() {
         try {
             this->_queryBuilder->exec(CREATE_EVENTS_TABLE_IF_NOT_EXISTS);
+            this->_queryBuilder->exec(CREATE_EVENTS_CREATED_AT_INDEX_IF_NOT_EXISTS);
         } catch (const db::DbError &e) {
             std::cerr << "create_events_table error: " << e.what() << std::endl;
             throw;
         }
     }
 
+    void StorageAdapter::create_consumer_offsets_table() {
+        try {
+            this->_queryBuilder->exec(CREATE_CONSUMER_OFFSETS_TABLE_IF_NOT_EXISTS);
+        } catch (const db::DbError &e) {
+            std::cerr << "create_consumer_offsets_table error: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    void StorageAdapter::create_delayed_events_table() {
+        try {
+            this->_queryBuilder->exec(CREATE_DELAYED_EVENTS_TABLE_IF_NOT_EXISTS);
+            this->_queryBuilder->exec(CREATE_DELAYED_EVENTS_INDEX_IF_NOT_EXISTS);
+        } catch (const db::DbError &e) {
+            std::cerr << "create_delayed_events_table error: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
+    void StorageAdapter::create_dead_letters_table() {
+        try {
+            this->_queryBuilder->exec(CREATE_DEAD_LETTERS_TABLE_IF_NOT_EXISTS);
+            this->_queryBuilder->exec(CREATE_DEAD_LETTERS_INDEX_IF_NOT_EXISTS);
+        } catch (const db::DbError &e) {
+            std::cerr << "create_dead_letters_table error: " << e.what() << std::endl;
+            throw;
+        }
+    }
+
     /**
      * The get_connection_string function is resposible to check for database environment variables,
      * such as postgreSQL's user, password or database. Based on this information it will retrieve a string
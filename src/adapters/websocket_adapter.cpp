@@ -3,10 +3,776 @@
 //
 
 #include <beacon/websocket_adapter.h>
+#include <beacon/conflating_queue.h>
+#include <beacon/json_stream_parser.h>
+#include <beacon/socket_handoff.h>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+using tcp = asio::ip::tcp;
+using unix_socket = asio::local::stream_protocol;
 
 namespace beacon {
-    void WebSocketAdapter::connect(const std::string &uri) {
-        std::cout << "Connecting to WebSocket at " << uri << "..." << std::endl;
+    namespace {
+        // The low bits of a ConnectionId name the core that owns the connection.
+        constexpr unsigned kCoreBits = 8;
+        constexpr std::size_t kMaxCores = std::size_t{1} << kCoreBits;
+    } // namespace
+
+    struct WebSocketAdapter::Impl {
+        class Session;
+
+        /**
+         * One event loop and the connections it serves. A connection stays on its core for
+         * its whole life, so per-connection state never crosses threads.
+         */
+        struct Core {
+            explicit Core(const LaneConfig &lanes) : task_lanes(lanes.control_weight, lanes.bulk_weight) {
+            }
+
+            asio::io_context ioc{1};
+            asio::executor_work_guard<asio::io_context::executor_type> work = asio::make_work_guard(ioc);
+            // Only touched from this core's thread.
+            std::unordered_map<ConnectionId, std::weak_ptr<Session> > sessions;
+            std::atomic<ConnectionId> next_sequence{1};
+
+            // Posted tasks wait here by lane rather than in the io_context, which is FIFO.
+            // One run_tasks() handler at a time is queued in the io_context to drain them.
+            std::mutex tasks_mutex;
+            std::deque<std::function<void()> > control_tasks;
+            std::deque<std::function<void()> > bulk_tasks;
+            LaneScheduler task_lanes;
+            bool tasks_scheduled = false;
+        };
+
+        Impl(ratelimit::RateLimitConfig config, std::size_t core_count, LaneConfig lane_config)
+            : limits(config),
+              tenants(config.tenant_messages, config.tenant_bytes),
+              lanes(lane_config) {
+            for (std::size_t i = 0; i < core_count; ++i) cores.push_back(std::make_unique<Core>(lanes));
+        }
+
+        /**
+         * Core 0 also runs the listeners, the handoff socket and the drain timer.
+         */
+        asio::io_context &ioc() {
+            return cores.front()->ioc;
+        }
+
+        void stop_all() {
+            for (auto &core: cores) core->ioc.stop();
+        }
+
+        void post(Core &core, std::function<void()> task, Lane lane);
+
+        void run_tasks(Core &core);
+
+        void accept(tcp::acceptor &acceptor);
+
+        void serve_handoff();
+
+        void drain();
+
+        void check_drained();
+
+        std::vector<std::unique_ptr<Core> > cores;
+        ratelimit::RateLimitConfig limits;
+        ratelimit::TenantRateLimiters tenants;
+        LaneConfig lanes;
+        std::vector<std::unique_ptr<tcp::acceptor> > acceptors;
+        std::atomic<std::size_t> next_core{0};
+        std::atomic<std::size_t> live_sessions{0};
+        MessageHandler handler;
+        CloseHandler close_handler;
+        validation::SchemaLookup schema_lookup;
+        deadletter::DeadLetterSink *dead_letters = nullptr;
+
+        // hot restart: successors connect here to take over the listening sockets
+        std::unique_ptr<unix_socket::acceptor> handoff_acceptor;
+        std::chrono::seconds drain_timeout{0};
+        std::optional<asio::steady_timer> drain_timer;
+        std::chrono::steady_clock::time_point drain_deadline;
+        bool shutting_down = false;
+        std::atomic<bool> handed_off{false};
+    };
+
+    /**
+     * One accepted WebSocket connection. Reads a message fragment by fragment, charging
+     * each to the connection's rate limiter before parsing and validating it, and hands
+     * complete messages to the message handler.
+     */
+    class WebSocketAdapter::Impl::Session : public std::enable_shared_from_this<Session> {
+    public:
+        static constexpr std::size_t kReadChunk = 64 * 1024;
+        // the parsed message grows with the raw one, so this bounds both
+        static constexpr std::size_t kMaxMessageBytes = 4 * 1024 * 1024;
+
+        Session(Impl &owner, Core &core, ConnectionId id, tcp::socket socket)
+            : owner_(owner), core_(core), id_(id), ws_(std::move(socket)), pause_timer_(core.ioc),
+              validator_(owner.schema_lookup), parser_(validator_),
+              outbox_lanes_(owner.lanes.control_weight, owner.lanes.bulk_weight) {
+        }
+
+        void start() {
+            // Read the upgrade request ourselves so the API key header is available for tenant limits.
+            http::async_read(ws_.next_layer(), buffer_, request_,
+                             [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                                 self->on_request(ec);
+                             });
+        }
+
+        /**
+         * Outbound connection: resolves, connects and performs the client handshake. Frames
+         * sent in the meantime are queued and go out once the connection is open.
+         */
+        void start_client(std::string host, std::string port, std::string target, ClientOptions options) {
+            auto resolver = std::make_shared<tcp::resolver>(core_.ioc);
+            resolver->async_resolve(host, port, [self = shared_from_this(), resolver, host, target, options](
+                                        beast::error_code ec, const tcp::resolver::results_type &results) {
+                if (ec) return self->close();
+                self->connect_to(results, host, target, options);
+            });
+        }
+
+        void send(std::string message, Lane lane) {
+            if (closing_) return;
+            if (lane == Lane::Control) {
+                control_outbox_.push_back(std::move(message));
+            } else {
+                outbox_.push(std::move(message));
+            }
+            if (open_ && !writing_) do_write();
+        }
+
+        void send_conflated(const std::string &key, std::string message) {
+            if (closing_) return;
+            outbox_.push(key, std::move(message));
+            if (open_ && !writing_) do_write();
+        }
+
+        /**
+         * Closes the connection with "going away" once the frame being written is out,
+         * telling the client to reconnect (to whichever process now owns the listener).
+         */
+        void shutdown() {
+            if (closing_) return;
+            closing_ = true;
+            if (!open_) {
+                beast::error_code ec;
+                ws_.next_layer().socket().close(ec);
+                return;
+            }
+            if (!writing_) do_close();
+        }
+
+    private:
+        void on_request(beast::error_code ec) {
+            if (ec) return close();
+
+            if (owner_.limits.enabled()) {
+                const std::string tenant(request_["X-Api-Key"]);
+                limiter_.emplace(owner_.limits, owner_.tenants.get(tenant));
+            }
+
+            ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+            // compression is used only by clients that ask for it, e.g. batching producers
+            websocket::permessage_deflate deflate;
+            deflate.server_enable = true;
+            ws_.set_option(deflate);
+            ws_.async_accept(request_, [self = shared_from_this()](beast::error_code accept_ec) {
+                if (accept_ec) return self->close();
+                self->on_open();
+            });
+        }
+
+        void connect_to(const tcp::resolver::results_type &results, const std::string &host, const std::string &target,
+                        const ClientOptions &options) {
+            beast::get_lowest_layer(ws_).async_connect(results, [self = shared_from_this(), host, target, options](
+                                                           beast::error_code ec, const tcp::endpoint &) {
+                if (ec) return self->close();
+                self->handshake(host, target, options);
+            });
+        }
+
+        void handshake(const std::string &host, const std::string &target, const ClientOptions &options) {
+            beast::get_lowest_layer(ws_).expires_never();
+            ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::client));
+            if (options.compress) {
+                websocket::permessage_deflate deflate;
+                deflate.client_enable = true;
+                ws_.set_option(deflate);
+            }
+            ws_.set_option(websocket::stream_base::decorator([api_key = options.api_key](websocket::request_type &request) {
+                if (!api_key.empty()) request.set("X-Api-Key", api_key);
+            }));
+            ws_.async_handshake(host, target, [self = shared_from_this()](beast::error_code ec) {
+                if (ec) return self->close();
+                self->on_open();
+            });
+        }
+
+        void on_open() {
+            open_ = true;
+            if (closing_) return do_close();
+            if (has_output() && !writing_) do_write();
+            do_read();
+        }
+
+        /**
+         * Queues a frame of our own behind the replies the message handler has already
+         * posted to the control lane, so a client sees exactly one reply per message, in
+         * message order.
+         */
+        void reply(std::string frame) {
+            owner_.post(core_, [self = shared_from_this(), frame = std::move(frame)]() mutable {
+                self->send(std::move(frame), Lane::Control);
+            }, Lane::Control);
+        }
+
+        void do_read() {
+            // Bounded reads: a large message arrives as several chunks, none of which is kept
+            // once the parser has seen it.
+            ws_.async_read_some(buffer_, kReadChunk, [self = shared_from_this()](beast::error_code ec, std::size_t bytes) {
+                if (ec) return self->close();
+                self->on_fragment(bytes);
+            });
+        }
+
+        void on_fragment(std::size_t bytes) {
+            if (limiter_ && !throttle(bytes)) return;
+            message_bytes_ += bytes;
+            const auto data = buffer_.data();
+            const std::string_view chunk(static_cast<const char *>(data.data()), data.size());
+            const bool done = ws_.is_message_done();
+            if (!rejected_ && message_bytes_ > kMaxMessageBytes) {
+                rejected_ = true;
+                parser_.reset();
+                validator_.reset();
+                reply(error_frame("bad_request", "Message exceeds " + std::to_string(kMaxMessageBytes) + " bytes"));
+            }
+            if (!rejected_ && !parser_.feed(chunk)) reject();
+            if (!rejected_ && done && (!parser_.finish() || !validator_.finish())) reject();
+
+            // Raw bytes are only kept for dead letters. A message that fits in one read (the
+            // common case) is copied only if it was rejected; a longer one is kept up to the
+            // cap while it streams in, as its first fragments are gone by the time it fails.
+            if (owner_.dead_letters != nullptr && (rejected_ ? dead_letter_.has_value() : !done)) {
+                keep_raw(chunk);
+            }
+            buffer_.consume(buffer_.size());
+            if (!done) return do_read();
+
+            if (dead_letter_) {
+                dead_letter_->raw_payload = std::move(raw_);
+                dead_letter_->truncated = raw_truncated_;
+                owner_.dead_letters->submit(std::move(*dead_letter_));
+            }
+            if (!rejected_ && owner_.handler) {
+                owner_.handler(id_, std::move(validator_.message()));
+            }
+            next_message();
+            do_read();
+        }
+
+        /**
+         * Charges a fragment before the parser sees it: the message on its first fragment,
+         * its bytes on every one. Rejected messages still count against the limits. Returns
+         * false when reads pause until the tokens are there; the fragment is handled then.
+         */
+        bool throttle(std::size_t bytes) {
+            const ratelimit::Clock::time_point now = ratelimit::Clock::now();
+            ratelimit::Decision decision;
+            if (!message_charged_) {
+                decision = limiter_->admit_message(now);
+                message_charged_ = static_cast<bool>(decision);
+            }
+            if (decision) decision = limiter_->admit_bytes(bytes, now);
+            if (decision) return true;
+
+            if (limiter_->action() == ratelimit::LimitAction::Reject) {
+                // the rest of the message is read and discarded unparsed
+                if (!rejected_) {
+                    rejected_ = true;
+                    parser_.reset();
+                    validator_.reset();
+                    reply(rate_limited_frame(decision.retry_after));
+                }
+                return true;
+            }
+            // Stop reading with the fragment unparsed; TCP flow control pushes back on the producer.
+            pause_timer_.expires_after(decision.retry_after);
+            pause_timer_.async_wait([self = shared_from_this(), bytes](beast::error_code ec) {
+                if (!ec) self->on_fragment(bytes);
+            });
+            return false;
+        }
+
+        void keep_raw(std::string_view chunk) {
+            const std::size_t room = owner_.dead_letters->max_raw_bytes() - std::min(
+                                         raw_.size(), owner_.dead_letters->max_raw_bytes());
+            if (chunk.size() > room) raw_truncated_ = true;
+            raw_.append(chunk.substr(0, room));
+        }
+
+        /**
+         * Tells the client why its message is invalid; the remaining fragments are discarded.
+         */
+        void reject() {
+            rejected_ = true;
+            if (!parser_.error().empty()) {
+                reply(error_frame("bad_request", "Invalid JSON: " + parser_.error()));
+                return;
+            }
+            const validation::ValidationResult &result = validator_.result();
+            const validation::AbstractSchemaValidator *schema = validator_.schema();
+            if (owner_.dead_letters != nullptr && schema != nullptr) {
+                // schemas added without a name go by their topic, as load() names them
+                std::string topic = validator_.topic();
+                const std::string &name = schema->name().empty() ? topic : schema->name();
+                if (owner_.dead_letters->admit(name)) {
+                    dead_letter_.emplace();
+                    dead_letter_->schema_name = name;
+                    dead_letter_->schema_version = schema->version();
+                    dead_letter_->topic = std::move(topic);
+                    dead_letter_->error_path = result.path;
+                    dead_letter_->error_message = result.error_message;
+                }
+            }
+            nlohmann::json frame = {
+                {"type", "error"},
+                {"code", "invalid_event"},
+                {"message", result.error_message}
+            };
+            if (!result.path.empty()) frame["path"] = result.path;
+            reply(frame.dump());
+        }
+
+        void next_message() {
+            parser_.reset();
+            validator_.reset();
+            message_bytes_ = 0;
+            message_charged_ = false;
+            rejected_ = false;
+            dead_letter_.reset();
+            raw_.clear();
+            raw_truncated_ = false;
+        }
+
+        bool has_output() const {
+            return !control_outbox_.empty() || !outbox_.empty();
+        }
+
+        void do_write() {
+            // The frame being written leaves the outbox, so later values for its key queue up
+            // behind it instead of replacing bytes that are already on the wire.
+            writing_ = true;
+            if (outbox_lanes_.next(!control_outbox_.empty(), !outbox_.empty()) == Lane::Control) {
+                in_flight_ = std::move(control_outbox_.front());
+                control_outbox_.pop_front();
+            } else {
+                in_flight_ = outbox_.pop();
+            }
+            ws_.text(true);
+            ws_.async_write(asio::buffer(in_flight_),
+                            [self = shared_from_this()](beast::error_code ec, std::size_t) {
+                                if (ec) return self->close();
+                                if (self->closing_) {
+                                    self->writing_ = false;
+                                    self->do_close();
+                                } else if (!self->has_output()) {
+                                    self->writing_ = false;
+                                } else {
+                                    self->do_write();
+                                }
+                            });
+        }
+
+        void do_close() {
+            ws_.async_close(websocket::close_code::going_away,
+                            [self = shared_from_this()](beast::error_code) { self->close(); });
+        }
+
+        void close() {
+            if (closed_) return;
+            closed_ = true;
+            pause_timer_.cancel();
+            core_.sessions.erase(id_);
+            --owner_.live_sessions;
+            if (owner_.close_handler) owner_.close_handler(id_);
+        }
+
+        static std::string error_frame(const std::string &code, const std::string &message) {
+            return nlohmann::json{
+                {"type", "error"},
+                {"code", code},
+                {"message", message}
+            }.dump();
+        }
+
+        static std::string rate_limited_frame(std::chrono::nanoseconds retry_after) {
+            const auto retry_ms = std::chrono::ceil<std::chrono::milliseconds>(retry_after).count();
+            return nlohmann::json{
+                {"type", "error"},
+                {"code", "rate_limited"},
+                {"retry_after_ms", retry_ms}
+            }.dump();
+        }
+
+        Impl &owner_;
+        Core &core_;
+        ConnectionId id_;
+        websocket::stream<beast::tcp_stream> ws_;
+        beast::flat_buffer buffer_;
+        http::request<http::string_body> request_;
+        asio::steady_timer pause_timer_;
+        std::optional<ratelimit::ConnectionRateLimiter> limiter_;
+        validation::StreamingEventValidator validator_;
+        json_stream::JsonStreamParser parser_;
+        std::size_t message_bytes_ = 0;
+        bool message_charged_ = false;
+        bool rejected_ = false;
+        // reject being recorded, and the raw message kept for it
+        std::optional<deadletter::DeadLetter> dead_letter_;
+        std::string raw_;
+        bool raw_truncated_ = false;
+        // the bulk lane of the outbox is conflating, the control lane plain FIFO
+        std::deque<std::string> control_outbox_;
+        ConflatingQueue<std::string> outbox_;
+        LaneScheduler outbox_lanes_;
+        std::string in_flight_;
+        bool writing_ = false;
+        bool open_ = false;
+        bool closing_ = false;
+        bool closed_ = false;
+    };
+
+    void WebSocketAdapter::Impl::post(Core &core, std::function<void()> task, Lane lane) {
+        {
+            const std::lock_guard lock(core.tasks_mutex);
+            (lane == Lane::Control ? core.control_tasks : core.bulk_tasks).push_back(std::move(task));
+            if (core.tasks_scheduled) return;
+            core.tasks_scheduled = true;
+        }
+        asio::post(core.ioc, [this, &core]() { run_tasks(core); });
+    }
+
+    /**
+     * Runs up to task_budget posted tasks, picking lanes by weight, then queues itself
+     * behind the socket completions that arrived meanwhile if tasks are left. A burst of
+     * fan-out thus delays a control message read from a socket by one budget at most.
+     */
+    void WebSocketAdapter::Impl::run_tasks(Core &core) {
+        for (std::size_t run = 0; run < lanes.task_budget; ++run) {
+            std::function<void()> task;
+            {
+                const std::lock_guard lock(core.tasks_mutex);
+                if (core.control_tasks.empty() && core.bulk_tasks.empty()) {
+                    core.tasks_scheduled = false;
+                    return;
+                }
+                auto &tasks = core.task_lanes.next(!core.control_tasks.empty(), !core.bulk_tasks.empty()) ==
+                              Lane::Control
+                                  ? core.control_tasks
+                                  : core.bulk_tasks;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+        asio::post(core.ioc, [this, &core]() { run_tasks(core); });
+    }
+
+    void WebSocketAdapter::Impl::accept(tcp::acceptor &acceptor) {
+        // Connections are spread over the cores round robin; the socket is created on the
+        // io_context of the core that will serve it.
+        const std::size_t index = next_core++ % cores.size();
+        Core &core = *cores[index];
+        acceptor.async_accept(core.ioc, [this, &acceptor, &core, index](beast::error_code ec, tcp::socket socket) {
+            if (ec) {
+                if (ec != asio::error::operation_aborted) {
+                    std::cerr << "accept error: " << ec.message() << std::endl;
+                    accept(acceptor);
+                }
+                return;
+            }
+
+            ++live_sessions;
+            asio::post(core.ioc, [this, &core, index, socket = std::move(socket)]() mutable {
+                const ConnectionId id = (core.next_sequence++ << kCoreBits) | index;
+                auto session = std::make_shared<Session>(*this, core, id, std::move(socket));
+                core.sessions.emplace(id, session);
+                session->start();
+            });
+            accept(acceptor);
+        });
+    }
+
+    void WebSocketAdapter::Impl::serve_handoff() {
+        handoff_acceptor->async_accept([this](beast::error_code ec, unix_socket::socket socket) {
+            if (ec) return;
+
+            auto peer = std::make_shared<unix_socket::socket>(std::move(socket));
+            auto byte = std::make_shared<char>(0);
+            asio::async_read(*peer, asio::buffer(byte.get(), 1), [this, peer, byte](beast::error_code read_ec, std::size_t) {
+                if (read_ec || *byte != handoff::kHello) return serve_handoff();
+
+                std::vector<int> fds;
+                for (const auto &acceptor: acceptors) fds.push_back(acceptor->native_handle());
+                try {
+                    handoff::send_fds(peer->native_handle(), fds);
+                } catch (const handoff::HandoffError &e) {
+                    std::cerr << "handoff error: " << e.what() << std::endl;
+                    return serve_handoff();
+                }
+
+                // Keep accepting until the successor confirms it owns the sockets.
+                asio::async_read(*peer, asio::buffer(byte.get(), 1), [this, peer, byte](beast::error_code ack_ec, std::size_t) {
+                    if (ack_ec || *byte != handoff::kReady) {
+                        std::cerr << "handoff not confirmed by successor, keeping listeners" << std::endl;
+                        return serve_handoff();
+                    }
+                    drain();
+                });
+            });
+        });
+    }
+
+    void WebSocketAdapter::Impl::drain() {
+        handed_off.store(true, std::memory_order_relaxed);
+        std::cout << "Listeners handed off, draining " << live_sessions.load() << " connections" << std::endl;
+
+        // Our copies of the listening sockets go away; the successor's keep them open, and
+        // connections still in the backlog are accepted there.
+        for (auto &acceptor: acceptors) {
+            beast::error_code ec;
+            acceptor->close(ec);
+        }
+        beast::error_code ec;
+        handoff_acceptor->close(ec);
+
+        drain_deadline = std::chrono::steady_clock::now() + drain_timeout;
+        drain_timer.emplace(ioc());
+        check_drained();
+    }
+
+    void WebSocketAdapter::Impl::check_drained() {
+        if (live_sessions.load() == 0) {
+            stop_all();
+            return;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= drain_deadline + std::chrono::seconds(5)) {
+            // clients that ignore the close handshake do not hold the exit any longer
+            stop_all();
+            return;
+        }
+        if (now >= drain_deadline && !shutting_down) {
+            shutting_down = true;
+            for (auto &core: cores) {
+                asio::post(core->ioc, [&core = *core]() {
+                    for (const auto &[id, weak]: core.sessions) {
+                        if (auto session = weak.lock()) session->shutdown();
+                    }
+                });
+            }
+        }
+
+        drain_timer->expires_after(std::chrono::milliseconds(100));
+        drain_timer->async_wait([this](beast::error_code timer_ec) {
+            if (!timer_ec) check_drained();
+        });
+    }
+
+    WebSocketAdapter::WebSocketAdapter()
+        : WebSocketAdapter(ratelimit::RateLimitConfig{}) {
+    }
+
+    LaneConfig LaneConfig::from_env() {
+        LaneConfig config;
+        if (const char *weight = std::getenv("BEACON_LANE_CONTROL_WEIGHT")) {
+            config.control_weight = static_cast<std::uint32_t>(std::max(1L, std::atol(weight)));
+        }
+        if (const char *weight = std::getenv("BEACON_LANE_BULK_WEIGHT")) {
+            config.bulk_weight = static_cast<std::uint32_t>(std::max(1L, std::atol(weight)));
+        }
+        if (const char *budget = std::getenv("BEACON_LANE_TASK_BUDGET")) {
+            config.task_budget = static_cast<std::size_t>(std::max(1L, std::atol(budget)));
+        }
+        return config;
+    }
+
+    WebSocketAdapter::WebSocketAdapter(ratelimit::RateLimitConfig limits, std::size_t cores, LaneConfig lanes)
+        : impl_(std::make_unique<Impl>(limits, std::clamp<std::size_t>(cores, 1, kMaxCores), lanes)) {
+    }
+
+    WebSocketAdapter::~WebSocketAdapter() = default;
+
+    ConnectionId WebSocketAdapter::connect(const std::string &uri, ClientOptions options) {
+        // ws://host[:port][/target]
+        const std::string scheme = "ws://";
+        if (uri.compare(0, scheme.size(), scheme) != 0) {
+            throw std::invalid_argument("unsupported WebSocket URI (expected ws://): " + uri);
+        }
+        const std::size_t authority_end = uri.find('/', scheme.size());
+        const std::string authority = uri.substr(scheme.size(), authority_end - scheme.size());
+        const std::string target = authority_end == std::string::npos ? "/" : uri.substr(authority_end);
+        const std::size_t colon = authority.rfind(':');
+        std::string host = authority.substr(0, colon);
+        std::string port = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+        if (host.empty() || port.empty()) throw std::invalid_argument("invalid WebSocket URI: " + uri);
+
+        const std::size_t index = impl_->next_core++ % impl_->cores.size();
+        Impl::Core &core = *impl_->cores[index];
+        const ConnectionId id = (core.next_sequence++ << kCoreBits) | index;
+        ++impl_->live_sessions;
+        // in the control lane, so it runs before any frame sent to the connection meanwhile
+        impl_->post(core, [impl = impl_.get(), &core, id, host = std::move(host), port = std::move(port),
+                        target, options = std::move(options)]() mutable {
+                        auto session = std::make_shared<Impl::Session>(*impl, core, id, tcp::socket(core.ioc));
+                        core.sessions.emplace(id, session);
+                        session->start_client(std::move(host), std::move(port), std::move(target), std::move(options));
+                    }, Lane::Control);
+        return id;
+    }
+
+    void WebSocketAdapter::listen(std::uint16_t port) {
+        auto acceptor = std::make_unique<tcp::acceptor>(impl_->ioc());
+        const tcp::endpoint endpoint(tcp::v4(), port);
+        acceptor->open(endpoint.protocol());
+        acceptor->set_option(asio::socket_base::reuse_address(true));
+        acceptor->bind(endpoint);
+        acceptor->listen(asio::socket_base::max_listen_connections);
+        impl_->acceptors.push_back(std::move(acceptor));
+    }
+
+    void WebSocketAdapter::adopt(int native_handle) {
+        sockaddr_storage address{};
+        socklen_t length = sizeof(address);
+        if (::getsockname(native_handle, reinterpret_cast<sockaddr *>(&address), &length) < 0) {
+            ::close(native_handle);
+            throw handoff::HandoffError("inherited descriptor is not a socket");
+        }
+
+        auto acceptor = std::make_unique<tcp::acceptor>(impl_->ioc());
+        acceptor->assign(address.ss_family == AF_INET6 ? tcp::v6() : tcp::v4(), native_handle);
+        impl_->acceptors.push_back(std::move(acceptor));
+    }
+
+    void WebSocketAdapter::enable_handoff(const std::string &path, std::chrono::seconds drain_timeout) {
+        // A predecessor's socket file is stale by now: take_over() has already been served.
+        ::unlink(path.c_str());
+
+        impl_->drain_timeout = drain_timeout;
+        impl_->handoff_acceptor = std::make_unique<unix_socket::acceptor>(impl_->ioc(), unix_socket::endpoint(path));
+    }
+
+    void WebSocketAdapter::on_message(MessageHandler handler) {
+        impl_->handler = std::move(handler);
+    }
+
+    void WebSocketAdapter::set_schema_lookup(validation::SchemaLookup lookup) {
+        impl_->schema_lookup = std::move(lookup);
+    }
+
+    void WebSocketAdapter::set_dead_letters(deadletter::DeadLetterSink *sink) {
+        impl_->dead_letters = sink;
+    }
+
+    void WebSocketAdapter::on_close(CloseHandler handler) {
+        impl_->close_handler = std::move(handler);
+    }
+
+    std::size_t WebSocketAdapter::cores() const {
+        return impl_->cores.size();
+    }
+
+    std::size_t WebSocketAdapter::core_of(ConnectionId id) const {
+        return id & (kMaxCores - 1);
+    }
+
+    void WebSocketAdapter::post(std::size_t core, std::function<void()> task, Lane lane) {
+        impl_->post(*impl_->cores[core], std::move(task), lane);
+    }
+
+    void WebSocketAdapter::post_after(std::size_t core, std::chrono::steady_clock::duration delay,
+                                      std::function<void()> task) {
+        auto timer = std::make_shared<asio::steady_timer>(impl_->cores[core]->ioc, delay);
+        timer->async_wait([timer, task = std::move(task)](beast::error_code ec) {
+            if (!ec) task();
+        });
+    }
+
+    void WebSocketAdapter::send(ConnectionId id, std::string message, Lane lane) {
+        Impl::Core &core = *impl_->cores[core_of(id)];
+        impl_->post(core, [&core, id, lane, message = std::move(message)]() mutable {
+            const auto it = core.sessions.find(id);
+            if (it == core.sessions.end()) return;
+            if (auto session = it->second.lock()) {
+                session->send(std::move(message), lane);
+            }
+        }, lane);
+    }
+
+    void WebSocketAdapter::send_conflated(ConnectionId id, std::string key, std::string message) {
+        Impl::Core &core = *impl_->cores[core_of(id)];
+        impl_->post(core, [&core, id, key = std::move(key), message = std::move(message)]() mutable {
+            const auto it = core.sessions.find(id);
+            if (it == core.sessions.end()) return;
+            if (auto session = it->second.lock()) {
+                session->send_conflated(key, std::move(message));
+            }
+        }, Lane::Bulk);
+    }
+
+    void WebSocketAdapter::run() {
+        for (auto &acceptor: impl_->acceptors) {
+            impl_->accept(*acceptor);
+        }
+        if (impl_->handoff_acceptor) impl_->serve_handoff();
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < impl_->cores.size(); ++i) {
+            threads.emplace_back([&core = *impl_->cores[i]]() { core.ioc.run(); });
+        }
+        impl_->ioc().run();
+
+        impl_->stop_all();
+        for (auto &thread: threads) thread.join();
+    }
+
+    void WebSocketAdapter::stop() {
+        impl_->stop_all();
+    }
+
+    bool WebSocketAdapter::handed_off() const {
+        return impl_->handed_off.load(std::memory_order_relaxed);
     }
-} // namespace beacon
\ No newline at end of file
+} // namespace beacon
@@ -0,0 +1,1083 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/broker.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace beacon {
+    namespace {
+        std::string string_or_empty(const nlohmann::json &message, const char *field) {
+            const auto it = message.find(field);
+            if (it == message.end() || !it->is_string()) return "";
+            return it->get<std::string>();
+        }
+
+        const nlohmann::json &payload_of(const nlohmann::json &message) {
+            static const nlohmann::json no_payload = nlohmann::json::object();
+            const auto it = message.find("payload");
+            return it != message.end() ? *it : no_payload;
+        }
+
+        /**
+         * Conflation key of an event for a conflated subscription, or empty if the event has none.
+         */
+        std::string conflation_key(const Subscription &subscription, const nlohmann::json &message) {
+            if (subscription.conflation_key.empty()) {
+                return string_or_empty(message, "entity_id");
+            }
+
+            const auto payload = message.find("payload");
+            if (payload == message.end()) return "";
+
+            const nlohmann::json::json_pointer pointer(subscription.conflation_key);
+            if (!payload->contains(pointer)) return "";
+
+            const nlohmann::json &key = payload->at(pointer);
+            return key.is_string() ? key.get<std::string>() : key.dump();
+        }
+
+        std::uint64_t unix_ms() {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        }
+
+        std::uint64_t non_negative(std::int64_t value) {
+            return value < 0 ? 0 : static_cast<std::uint64_t>(value);
+        }
+
+        /**
+         * Whether deliver_at and delay_ms, where given, are integers Broker::delay can read.
+         */
+        bool valid_delay(const nlohmann::json &event) {
+            const auto at = event.find("deliver_at");
+            const auto after = event.find("delay_ms");
+            return (at == event.end() || at->is_number_integer()) &&
+                   (after == event.end() || after->is_number_integer());
+        }
+
+        std::string random_epoch() {
+            std::random_device device;
+            std::mt19937_64 rng((static_cast<std::uint64_t>(device()) << 32) ^ device());
+            static const char digits[] = "0123456789abcdef";
+            std::string epoch;
+            for (int i = 0; i < 16; ++i) epoch += digits[rng() % 16];
+            return epoch;
+        }
+
+        /**
+         * Batch frame of replicated events, spliced together from their serialized form.
+         */
+        std::string replica_frame(std::uint64_t first, const std::vector<replication::ReplicationLog::Entry> &events) {
+            std::string frame = R"({"type":"replica","offset":)" + std::to_string(first) + R"(,"events":[)";
+            for (std::size_t i = 0; i < events.size(); ++i) {
+                if (i != 0) frame += ',';
+                frame += *events[i];
+            }
+            frame += "]}";
+            return frame;
+        }
+    } // namespace
+
+    const std::string &Broker::Event::frame() const {
+        // Serialize once, every subscriber on every core gets the same frame.
+        std::call_once(serialized_, [this]() {
+            nlohmann::json frame{
+                {"type", "event"},
+                {"topic", topic},
+                {"entity_id", message.value("entity_id", nlohmann::json())},
+                {"event_type", message.value("event_type", nlohmann::json())},
+                {"payload", payload_of(message)}
+            };
+            if (const auto at = message.find("deliver_at"); at != message.end()) frame["deliver_at"] = *at;
+            frame_ = frame.dump();
+        });
+        return frame_;
+    }
+
+    Broker::Broker(WebSocketAdapter &adapter, consumer::OffsetStore *offsets, delay::DelayStore *delayed,
+                   delay::DelayConfig delays, replication::ReplicationConfig replication)
+        : adapter_(adapter), shards_(adapter.cores()), mesh_(adapter.cores()), offsets_(offsets), delays_(delays),
+          replication_(std::move(replication)), epoch_(random_epoch()) {
+        adapter_.on_message([this](ConnectionId connection, nlohmann::json &&message) {
+            handle(connection, std::move(message));
+        });
+        adapter_.on_close([this](ConnectionId connection) {
+            disconnect(connection);
+        });
+
+        if (replication_.log_events > 0) {
+            log_ = std::make_unique<replication::ReplicationLog>(replication_.log_events, replication_.log_bytes);
+        }
+        if (!replication_.upstream.empty()) {
+            if (!log_) throw std::invalid_argument("a follower needs a replication log");
+            connect_upstream();
+        }
+
+        const std::uint64_t now = unix_ms();
+        for (Shard &shard: shards_) {
+            shard.delayed = std::make_unique<timing::TimingWheel<delay::DelayedEvent> >(
+                now, static_cast<std::uint64_t>(delays_.tick.count()));
+        }
+        if (delayed == nullptr) return;
+
+        // Restart: ids continue after the stored ones, and the current window is read back
+        // in one query and spread over the cores. Overdue events go out on the first tick.
+        next_delay_id_ = delayed->max_delayed_id() + 1;
+        loaded_until_ms_ = memory_horizon_ms_ =
+                now + static_cast<std::uint64_t>(std::chrono::milliseconds(delays_.window).count());
+        std::size_t core = 0;
+        for (delay::DelayedEvent &event: delayed->load_delayed(0, loaded_until_ms_, next_delay_id_)) {
+            schedule_delayed(core, std::move(event));
+            core = (core + 1) % shards_.size();
+        }
+        delay_journal_ = std::make_unique<delay::DelayJournal>(*delayed);
+        arm_delay_timer(0);
+    }
+
+    void Broker::handle(ConnectionId connection, nlohmann::json &&message) {
+        if (connection == upstream_connection_.load(std::memory_order_relaxed)) {
+            try {
+                on_upstream(connection, std::move(message));
+            } catch (const nlohmann::json::exception &e) {
+                std::cerr << "replication error: " << e.what() << std::endl;
+            }
+            return;
+        }
+        if (!message.is_object()) {
+            return reply_error(connection, "bad_request", "Message is not a JSON object");
+        }
+
+        const std::string op = string_or_empty(message, "op");
+        try {
+            if (op == "publish") {
+                if (message.contains("events")) {
+                    return reply_error(connection, "bad_request", "A publish carries no events; use publish_batch");
+                }
+                if (!valid_delay(message)) {
+                    return reply_error(connection, "bad_request", "deliver_at and delay_ms must be integers");
+                }
+                const std::size_t core = adapter_.core_of(connection);
+                if (!delay(core, message)) publish(core, std::move(message));
+            } else if (op == "publish_batch") {
+                publish_batch(connection, std::move(message));
+            } else if (op == "subscribe") {
+                subscribe(connection, message);
+            } else if (op == "unsubscribe") {
+                unsubscribe(connection, message);
+            } else if (op == "join") {
+                join(connection, message);
+            } else if (op == "leave") {
+                leave(connection, message);
+            } else if (op == "commit") {
+                commit(connection, message);
+            } else if (op == "replicate") {
+                replicate(connection, message);
+            } else if (op == "replica_ack") {
+                replica_ack(connection, message);
+            } else if (op == "similar_items") {
+                similar_items(connection, message);
+            } else if (op == "recommend") {
+                recommend(connection, message);
+            } else if (op == "trending") {
+                top_trending(connection, message);
+            } else if (op == "recent") {
+                recent_interactions(connection, message);
+            } else {
+                reply_error(connection, "bad_request", "Unknown op '" + op + "'");
+            }
+        } catch (const nlohmann::json::exception &e) {
+            // wrongly typed fields
+            reply_error(connection, "bad_request", e.what());
+        }
+    }
+
+    void Broker::disconnect(ConnectionId connection) {
+        shards_[adapter_.core_of(connection)].subscriptions.remove_connection(connection);
+
+        if (log_) {
+            ConnectionId upstream = connection;
+            if (upstream_connection_.compare_exchange_strong(upstream, 0)) {
+                // the link dropped or never came up: resume from the hot buffer after a pause
+                adapter_.post_after(0, replication_.retry_backoff, [this]() { connect_upstream(); });
+                return;
+            }
+            const std::lock_guard lock(replication_mutex_);
+            followers_.erase(connection);
+        }
+
+        const std::lock_guard lock(groups_mutex_);
+        const auto member = member_of_.find(connection);
+        if (member == member_of_.end()) return;
+        const std::vector<GroupKey> keys = std::move(member->second);
+        member_of_.erase(member);
+        for (const GroupKey &key: keys) {
+            leave_locked(connection, key);
+        }
+    }
+
+    void Broker::publish(std::size_t core, nlohmann::json &&message) {
+        if (log_ && replication_.upstream.empty() && log_->append(message.dump())) wake_followers();
+        fan_out(core, std::move(message));
+    }
+
+    void Broker::fan_out(std::size_t core, nlohmann::json &&message) {
+        if (recommendations_) recommendations_->observe(message);
+        if (trending_) trending_->observe(message);
+        if (user_histories_) user_histories_->observe(message);
+
+        auto event = std::make_shared<Event>();
+        event->topic = string_or_empty(message, "topic");
+        event->message = std::move(message);
+
+        deliver(core, *event);
+        if (shards_.size() == 1) return;
+
+        for (std::size_t other = 0; other < shards_.size(); ++other) {
+            if (other != core) mesh_.send(core, other, event);
+        }
+        // Everything published during this turn of the loop goes out as one batch per core.
+        Shard &shard = shards_[core];
+        if (!shard.flush_scheduled) {
+            shard.flush_scheduled = true;
+            adapter_.post(core, [this, core]() { flush(core); });
+        }
+    }
+
+    bool Broker::delay(std::size_t core, nlohmann::json &message) {
+        const auto at = message.find("deliver_at");
+        const auto after = message.find("delay_ms");
+        if (at == message.end() && after == message.end()) return false;
+
+        const std::uint64_t now = unix_ms();
+        const std::uint64_t deliver_at = at != message.end()
+                                             ? non_negative(at->get<std::int64_t>())
+                                             : now + non_negative(after->get<std::int64_t>());
+        if (deliver_at <= now) return false;
+
+        // subscribers see when it was meant to arrive, however it was asked for, and the
+        // event is not delayed again when it is published
+        if (after != message.end()) message.erase(after);
+        message["deliver_at"] = deliver_at;
+
+        delay::DelayedEvent event{0, deliver_at, message.dump()};
+        bool in_memory;
+        {
+            const std::lock_guard lock(delay_mutex_);
+            event.id = next_delay_id_++;
+            in_memory = deliver_at <= memory_horizon_ms_;
+            if (delay_journal_) delay_journal_->save(event);
+        }
+        if (in_memory) schedule_delayed(core, std::move(event));
+        return true;
+    }
+
+    void Broker::schedule_delayed(std::size_t core, delay::DelayedEvent &&event) {
+        const std::uint64_t deliver_at = event.deliver_at_ms;
+        shards_[core].delayed->schedule(deliver_at, std::move(event));
+        arm_delay_timer(core);
+    }
+
+    void Broker::arm_delay_timer(std::size_t core) {
+        Shard &shard = shards_[core];
+        if (shard.delay_timer_armed) return;
+        shard.delay_timer_armed = true;
+        adapter_.post_after(core, delays_.tick, [this, core]() { on_delay_tick(core); });
+    }
+
+    void Broker::on_delay_tick(std::size_t core) {
+        Shard &shard = shards_[core];
+        shard.delay_timer_armed = false;
+
+        const std::uint64_t now = unix_ms();
+        shard.delayed->advance(now, [this, core](delay::DelayedEvent &&event) {
+            if (delay_journal_) delay_journal_->delivered(event.id);
+            try {
+                publish(core, nlohmann::json::parse(event.message));
+            } catch (const nlohmann::json::exception &e) {
+                std::cerr << "delayed event " << event.id << " dropped: " << e.what() << std::endl;
+            }
+        });
+
+        // core 0 keeps ticking to move the window along
+        const bool loads_windows = core == 0 && delay_journal_;
+        if (loads_windows) load_next_window(now);
+        if (loads_windows || !shard.delayed->empty()) arm_delay_timer(core);
+    }
+
+    void Broker::load_next_window(std::uint64_t now_ms) {
+        if (window_loading_ || now_ms < window_retry_at_ms_) return;
+
+        const auto window = static_cast<std::uint64_t>(std::chrono::milliseconds(delays_.window).count());
+        std::uint64_t until;
+        std::uint64_t below_id;
+        {
+            const std::lock_guard lock(delay_mutex_);
+            if (memory_horizon_ms_ == loaded_until_ms_) {
+                if (now_ms + window / 2 < loaded_until_ms_) return;
+                // From here on events due before the new horizon stay in memory. Those already
+                // left out all have an id below the watermark and come from the store.
+                memory_horizon_ms_ = std::max(loaded_until_ms_, now_ms) + window;
+                window_below_id_ = next_delay_id_;
+            }
+            // else a failed load is retried with the same horizon and watermark
+            until = memory_horizon_ms_;
+            below_id = window_below_id_;
+        }
+
+        window_loading_ = true;
+        delay_journal_->load(loaded_until_ms_, until, below_id,
+                             [this, until](std::vector<delay::DelayedEvent> &&events, bool ok) {
+                                 adapter_.post(0, [this, until, ok, events = std::move(events)]() mutable {
+                                     window_loading_ = false;
+                                     if (!ok) {
+                                         window_retry_at_ms_ = unix_ms() + 1000;
+                                         return;
+                                     }
+                                     for (delay::DelayedEvent &event: events) {
+                                         schedule_delayed(0, std::move(event));
+                                     }
+                                     loaded_until_ms_ = until;
+                                 });
+                             });
+    }
+
+    void Broker::flush(std::size_t core) {
+        shards_[core].flush_scheduled = false;
+        const bool complete = mesh_.flush(core, [this](std::size_t to) {
+            adapter_.post(to, [this, to]() {
+                mesh_.drain(to, [this, to](const std::shared_ptr<const Event> &event) {
+                    deliver(to, *event);
+                });
+            });
+        });
+        if (!complete) {
+            // a receiving core is behind; try again after it had a chance to drain
+            shards_[core].flush_scheduled = true;
+            adapter_.post(core, [this, core]() { flush(core); });
+        }
+    }
+
+    void Broker::publish_batch(ConnectionId connection, nlohmann::json &&message) {
+        const std::string producer = string_or_empty(message, "producer");
+        // a negative sequence would otherwise wrap around to just below 2^64
+        const auto given = message.find("sequence");
+        const std::uint64_t sequence = given != message.end() && given->is_number_unsigned()
+                                           ? given->get<std::uint64_t>()
+                                           : 0;
+        const auto events = message.find("events");
+        if (producer.empty() || sequence == 0 || events == message.end() || !events->is_array()) {
+            return reply_error(connection, "bad_request", "publish_batch requires producer, sequence and events");
+        }
+        // Checked before the sequence is taken: a batch is published whole or not at all.
+        for (const nlohmann::json &event: *events) {
+            if (event.is_object() && !valid_delay(event)) {
+                return reply_error(connection, "bad_request", "deliver_at and delay_ms must be integers");
+            }
+        }
+
+        bool duplicate = false;
+        {
+            const std::lock_guard lock(producers_mutex_);
+            const auto [last, inserted] = producer_sequences_.try_emplace(producer, Producer{sequence, {}});
+            if (inserted) {
+                producer_recency_.push_front(producer);
+                last->second.recency = producer_recency_.begin();
+                if (producer_sequences_.size() > kMaxProducers) {
+                    producer_sequences_.erase(producer_recency_.back());
+                    producer_recency_.pop_back();
+                }
+            } else {
+                producer_recency_.splice(producer_recency_.begin(), producer_recency_, last->second.recency);
+                if (sequence <= last->second.sequence) {
+                    duplicate = true;
+                } else if (sequence != last->second.sequence + 1) {
+                    const std::uint64_t expected = last->second.sequence + 1;
+                    adapter_.send(connection, nlohmann::json{
+                                      {"type", "error"},
+                                      {"code", "out_of_sequence"},
+                                      {"message", "Batch sequence gap"},
+                                      {"expected", expected}
+                                  }.dump(), Lane::Control);
+                    return;
+                } else {
+                    last->second.sequence = sequence;
+                }
+            }
+        }
+
+        if (!duplicate) {
+            const std::size_t core = adapter_.core_of(connection);
+            for (nlohmann::json &event: *events) {
+                if (event.is_object() && !delay(core, event)) publish(core, std::move(event));
+            }
+        }
+        adapter_.send(connection, nlohmann::json{
+                          {"type", "ack"},
+                          {"producer", producer},
+                          {"sequence", sequence},
+                          {"duplicate", duplicate}
+                      }.dump(), Lane::Control);
+    }
+
+    void Broker::deliver(std::size_t core, const Event &event) {
+        Shard &shard = shards_[core];
+        const nlohmann::json &payload = payload_of(event.message);
+
+        shard.matched.clear();
+        shard.subscriptions.match(event.topic, payload, shard.matched);
+        for (const Subscription *subscription: shard.matched) {
+            if (subscription->mode == DeliveryMode::Conflated) {
+                const std::string key = conflation_key(*subscription, event.message);
+                if (!key.empty()) {
+                    adapter_.send_conflated(subscription->connection,
+                                            std::to_string(subscription->id) + ':' + key, event.frame());
+                    continue;
+                }
+            }
+            adapter_.send(subscription->connection, event.frame());
+        }
+
+        const auto groups = shard.groups.find(event.topic);
+        if (groups != shard.groups.end()) {
+            deliver_to_groups(core, event, groups->second);
+        }
+    }
+
+    void Broker::deliver_to_groups(std::size_t core, const Event &event, std::vector<GroupShard> &groups) {
+        const std::size_t cores = shards_.size();
+        const std::string entity_id = string_or_empty(event.message, "entity_id");
+        const std::string &frame = event.frame();
+
+        for (GroupShard &group: groups) {
+            const std::uint32_t index = consumer::partition_of(entity_id, group.partitions);
+            if (index % cores != core) continue;
+
+            Partition &partition = group.owned[index / cores];
+            const std::uint64_t offset = partition.next_offset++;
+            // the shared frame with the group fields spliced in before its closing brace
+            std::string grouped;
+            grouped.reserve(frame.size() + group.frame_suffix.size() + 40);
+            grouped.append(frame, 0, frame.size() - 1)
+                    .append(group.frame_suffix)
+                    .append(std::to_string(index))
+                    .append(",\"offset\":")
+                    .append(std::to_string(offset))
+                    .push_back('}');
+
+            if (partition.owner != 0) adapter_.send(partition.owner, grouped);
+            partition.uncommitted.emplace_back(offset, std::move(grouped));
+            if (partition.uncommitted.size() > kMaxUncommitted) partition.uncommitted.pop_front();
+        }
+    }
+
+    void Broker::subscribe(ConnectionId connection, const nlohmann::json &message) {
+        Subscription subscription;
+        subscription.connection = connection;
+        subscription.topic = string_or_empty(message, "topic");
+        if (subscription.topic.empty()) {
+            return reply_error(connection, "bad_request", "subscribe requires a topic");
+        }
+
+        const std::string mode = string_or_empty(message, "mode");
+        if (mode == "conflated") {
+            subscription.mode = DeliveryMode::Conflated;
+        } else if (!mode.empty() && mode != "all") {
+            return reply_error(connection, "bad_request", "Unknown delivery mode '" + mode + "'");
+        }
+
+        std::string key = string_or_empty(message, "conflation_key");
+        if (!key.empty() && key.front() != '/') key.insert(key.begin(), '/');
+        try {
+            // reject malformed pointers up front instead of on every publish
+            [[maybe_unused]] const nlohmann::json::json_pointer pointer(key);
+        } catch (const nlohmann::json::exception &e) {
+            return reply_error(connection, "bad_request", e.what());
+        }
+        subscription.conflation_key = std::move(key);
+
+        try {
+            subscription.filter = filter::parse_filter(message.value("filter", nlohmann::json()));
+        } catch (const filter::FilterError &e) {
+            return reply_error(connection, "bad_request", e.what());
+        }
+
+        const std::string topic = subscription.topic;
+        const SubscriptionId id = shards_[adapter_.core_of(connection)].subscriptions.add(std::move(subscription));
+        adapter_.send(connection, nlohmann::json{
+                          {"type", "subscribed"},
+                          {"subscription", id},
+                          {"topic", topic}
+                      }.dump(), Lane::Control);
+    }
+
+    void Broker::unsubscribe(ConnectionId connection, const nlohmann::json &message) {
+        const SubscriptionId id = message.value("subscription", SubscriptionId{0});
+        if (!shards_[adapter_.core_of(connection)].subscriptions.remove(connection, id)) {
+            return reply_error(connection, "not_found", "No such subscription");
+        }
+        adapter_.send(connection, nlohmann::json{
+                          {"type", "unsubscribed"},
+                          {"subscription", id}
+                      }.dump(), Lane::Control);
+    }
+
+    void Broker::join(ConnectionId connection, const nlohmann::json &message) {
+        GroupKey key{string_or_empty(message, "group"), string_or_empty(message, "topic")};
+        if (key.first.empty() || key.second.empty()) {
+            return reply_error(connection, "bad_request", "join requires a group and a topic");
+        }
+        const std::uint32_t partitions = message.value("partitions", std::uint32_t{0});
+        if (partitions > 4096) {
+            return reply_error(connection, "bad_request", "A group has at most 4096 partitions");
+        }
+
+        const std::lock_guard lock(groups_mutex_);
+        auto group = groups_.find(key);
+        if (group == groups_.end()) {
+            group = groups_.emplace(key, consumer::GroupMembership(partitions != 0 ? partitions : kDefaultPartitions))
+                    .first;
+        } else if (partitions != 0 && partitions != group->second.partitions()) {
+            return reply_error(connection, "bad_request",
+                               "The group has " + std::to_string(group->second.partitions()) + " partitions");
+        }
+        if (!group->second.join(connection)) {
+            return reply_error(connection, "bad_request", "Already a member of this group");
+        }
+        member_of_[connection].push_back(key);
+        rebalance_locked(key, group->second);
+    }
+
+    void Broker::leave(ConnectionId connection, const nlohmann::json &message) {
+        const GroupKey key{string_or_empty(message, "group"), string_or_empty(message, "topic")};
+
+        const std::lock_guard lock(groups_mutex_);
+        const auto member = member_of_.find(connection);
+        if (member == member_of_.end()) {
+            return reply_error(connection, "not_found", "Not a member of this group");
+        }
+        const auto joined = std::find(member->second.begin(), member->second.end(), key);
+        if (joined == member->second.end()) {
+            return reply_error(connection, "not_found", "Not a member of this group");
+        }
+        member->second.erase(joined);
+        if (member->second.empty()) member_of_.erase(member);
+
+        leave_locked(connection, key);
+        adapter_.send(connection, nlohmann::json{
+                          {"type", "left"},
+                          {"group", key.first},
+                          {"topic", key.second}
+                      }.dump(), Lane::Control);
+    }
+
+    void Broker::leave_locked(ConnectionId connection, const GroupKey &key) {
+        const auto group = groups_.find(key);
+        if (group == groups_.end() || !group->second.leave(connection)) return;
+        rebalance_locked(key, group->second);
+        if (group->second.empty()) {
+            groups_.erase(group);
+            announced_.erase(key);
+        }
+    }
+
+    void Broker::rebalance_locked(const GroupKey &key, const consumer::GroupMembership &membership) {
+        if (auto committed = offsets_.cached(key.first, key.second)) {
+            return announce_locked(key, membership, std::move(*committed));
+        }
+        // The first rebalance of a group waits for its committed offsets, which the committer
+        // reads off the event loop. By then the group may have moved on; announce what it is now.
+        offsets_.load(key.first, key.second, [this, key](const consumer::OffsetCommitter::Offsets &committed) {
+            const std::lock_guard lock(groups_mutex_);
+            const auto group = groups_.find(key);
+            if (group == groups_.end()) return;
+            const auto announced = announced_.find(key);
+            if (announced != announced_.end() && announced->second >= group->second.generation()) return;
+            announce_locked(key, group->second, committed);
+        });
+    }
+
+    void Broker::announce_locked(const GroupKey &key, const consumer::GroupMembership &membership,
+                                 std::unordered_map<std::uint32_t, std::uint64_t> committed_offsets) {
+        announced_[key] = membership.generation();
+        const auto committed = std::make_shared<const std::unordered_map<std::uint32_t, std::uint64_t> >(
+            std::move(committed_offsets));
+        const auto owners = std::make_shared<const std::vector<ConnectionId> >(membership.owners());
+        const std::uint32_t partitions = membership.partitions();
+        const std::uint64_t generation = membership.generation();
+
+        // Members hear of the assignment before the cores start sending them its events.
+        for (const consumer::MemberId member: membership.members()) {
+            adapter_.send(member, nlohmann::json{
+                              {"type", "assignment"},
+                              {"group", key.first},
+                              {"topic", key.second},
+                              {"generation", generation},
+                              {"partitions", membership.partitions_of(member)}
+                          }.dump(), Lane::Control);
+        }
+
+        for (std::size_t core = 0; core < shards_.size(); ++core) {
+            adapter_.post(core, [this, core, key, partitions, generation, owners, committed]() {
+                apply_assignment(core, key, partitions, generation, *owners, *committed);
+            }, Lane::Control);
+        }
+    }
+
+    void Broker::apply_assignment(std::size_t core, const GroupKey &key, std::uint32_t partitions,
+                                  std::uint64_t generation, const std::vector<ConnectionId> &owners,
+                                  const std::unordered_map<std::uint32_t, std::uint64_t> &committed) {
+        Shard &shard = shards_[core];
+        const std::size_t cores = shards_.size();
+        auto topic = shard.groups.find(key.second);
+        auto group = topic == shard.groups.end()
+                         ? std::vector<GroupShard>::iterator{}
+                         : std::find_if(topic->second.begin(), topic->second.end(), [&key](const GroupShard &g) {
+                             return g.group == key.first;
+                         });
+        const bool found = topic != shard.groups.end() && group != topic->second.end();
+
+        if (std::all_of(owners.begin(), owners.end(), [](ConnectionId owner) { return owner == 0; })) {
+            // The last member left. If it comes back, offsets continue after the delivered ones
+            // rather than the committed ones, which would number some events a second time.
+            if (found) {
+                const auto [left, inserted] = shard.left_at.try_emplace(key);
+                if (inserted) {
+                    shard.left_recency.push_front(key);
+                    left->second.recency = shard.left_recency.begin();
+                } else {
+                    shard.left_recency.splice(shard.left_recency.begin(), shard.left_recency,
+                                              left->second.recency);
+                }
+                left->second.next_offsets.clear();
+                for (const Partition &partition: group->owned) {
+                    left->second.next_offsets.push_back(partition.next_offset);
+                }
+                if (shard.left_at.size() > kMaxLeftGroups) {
+                    shard.left_at.erase(shard.left_recency.back());
+                    shard.left_recency.pop_back();
+                }
+                topic->second.erase(group);
+                if (topic->second.empty()) shard.groups.erase(topic);
+            }
+            return;
+        }
+
+        if (!found) {
+            GroupShard created;
+            created.group = key.first;
+            created.partitions = partitions;
+            created.frame_suffix = ",\"group\":" + nlohmann::json(key.first).dump() + ",\"partition\":";
+            created.owned.resize(partitions > core ? (partitions - core + cores - 1) / cores : 0);
+            const auto left = shard.left_at.find(key);
+            for (std::size_t i = 0; i < created.owned.size(); ++i) {
+                Partition &partition = created.owned[i];
+                const auto last = committed.find(static_cast<std::uint32_t>(core + i * cores));
+                if (last != committed.end()) {
+                    partition.committed = last->second;
+                    partition.next_offset = last->second + 1;
+                }
+                if (left != shard.left_at.end() && i < left->second.next_offsets.size()) {
+                    partition.next_offset = std::max(partition.next_offset, left->second.next_offsets[i]);
+                }
+            }
+            if (left != shard.left_at.end()) {
+                shard.left_recency.erase(left->second.recency);
+                shard.left_at.erase(left);
+            }
+            auto &groups = shard.groups[key.second];
+            groups.push_back(std::move(created));
+            group = std::prev(groups.end());
+        }
+
+        if (generation <= group->generation) return;
+        group->generation = generation;
+        for (std::size_t i = 0; i < group->owned.size(); ++i) {
+            Partition &partition = group->owned[i];
+            const ConnectionId owner = owners[core + i * cores];
+            if (partition.owner == owner) continue;
+            partition.owner = owner;
+            // the new owner picks up where the last commit left off
+            for (const auto &[offset, frame]: partition.uncommitted) {
+                adapter_.send(owner, frame);
+            }
+        }
+    }
+
+    Broker::GroupShard *Broker::find_group(Shard &shard, const GroupKey &key) {
+        const auto topic = shard.groups.find(key.second);
+        if (topic == shard.groups.end()) return nullptr;
+        for (GroupShard &group: topic->second) {
+            if (group.group == key.first) return &group;
+        }
+        return nullptr;
+    }
+
+    void Broker::commit(ConnectionId connection, const nlohmann::json &message) {
+        const GroupKey key{string_or_empty(message, "group"), string_or_empty(message, "topic")};
+        const auto offsets = message.find("offsets");
+        if (key.first.empty() || key.second.empty() || offsets == message.end() || !offsets->is_array()) {
+            return reply_error(connection, "bad_request", "commit requires a group, a topic and offsets");
+        }
+
+        // one hop to each core owning some of the partitions
+        const std::size_t cores = shards_.size();
+        std::vector<std::vector<std::pair<std::uint32_t, std::uint64_t> > > by_core(cores);
+        for (const nlohmann::json &entry: *offsets) {
+            const auto partition = entry.at("partition").get<std::uint32_t>();
+            by_core[partition % cores].emplace_back(partition, entry.at("offset").get<std::uint64_t>());
+        }
+        for (std::size_t core = 0; core < cores; ++core) {
+            if (by_core[core].empty()) continue;
+            adapter_.post(core, [this, core, connection, key, committed = std::move(by_core[core])]() {
+                apply_commits(core, connection, key, committed);
+            }, Lane::Control);
+        }
+    }
+
+    void Broker::apply_commits(std::size_t core, ConnectionId connection, const GroupKey &key,
+                               const std::vector<std::pair<std::uint32_t, std::uint64_t> > &offsets) {
+        GroupShard *group = find_group(shards_[core], key);
+        if (group == nullptr) {
+            return reply_error(connection, "not_found", "No such group");
+        }
+
+        for (const auto &[index, offset]: offsets) {
+            if (index >= group->partitions) {
+                reply_error(connection, "not_found", "No partition " + std::to_string(index));
+                continue;
+            }
+            Partition &partition = group->owned[index / shards_.size()];
+            if (partition.owner != connection) {
+                // typically a commit that crossed a rebalance
+                reply_error(connection, "not_owner", "Partition " + std::to_string(index) + " is not assigned to you");
+                continue;
+            }
+            if (offset >= partition.next_offset) {
+                reply_error(connection, "bad_request", "Offset " + std::to_string(offset) + " was not delivered");
+                continue;
+            }
+            if (offset <= partition.committed) continue;
+
+            partition.committed = offset;
+            while (!partition.uncommitted.empty() && partition.uncommitted.front().first <= offset) {
+                partition.uncommitted.pop_front();
+            }
+            offsets_.commit(key.first, key.second, index, offset);
+        }
+    }
+
+    void Broker::reply_error(ConnectionId connection, const std::string &code, const std::string &detail) {
+        adapter_.send(connection, nlohmann::json{
+                          {"type", "error"},
+                          {"code", code},
+                          {"message", detail}
+                      }.dump(), Lane::Control);
+    }
+
+    void Broker::set_recommendations(RecommendationEngine *engine) {
+        recommendations_ = engine;
+    }
+
+    void Broker::set_recommendation_cache(reco::RecommendationCache *cache) {
+        if (recommendations_ == nullptr) {
+            throw std::logic_error("set_recommendation_cache() needs set_recommendations() first");
+        }
+        recommendation_cache_ = cache;
+        if (cache == nullptr) return recommendations_->set_on_applied(nullptr);
+        // Not on publish: until the engine applied the event, a recompute would only cache
+        // the user's old recommendations again.
+        recommendations_->set_on_applied([cache](std::string_view user) { cache->invalidate(user); });
+    }
+
+    void Broker::set_trending(trending::TrendingTracker *tracker) {
+        trending_ = tracker;
+    }
+
+    void Broker::set_user_histories(reco::UserHistoryStore *store) {
+        user_histories_ = store;
+    }
+
+    void Broker::similar_items(ConnectionId connection, const nlohmann::json &message) {
+        if (!recommendations_) {
+            return reply_error(connection, "not_enabled", "Recommendations are not enabled on this broker");
+        }
+        const std::string item = string_or_empty(message, "item");
+        if (item.empty()) return reply_error(connection, "bad_request", "similar_items requires an item");
+
+        const std::size_t k = std::min(message.value("k", std::size_t{10}), kMaxRecommendations);
+        nlohmann::json items = nlohmann::json::array();
+        for (const reco::ScoredItem &scored: recommendations_->similar_items(item, k)) {
+            items.push_back({{"item", scored.item}, {"score", scored.score}});
+        }
+        adapter_.send(connection, nlohmann::json{
+                          {"type", "similar_items"},
+                          {"item", item},
+                          {"items", std::move(items)}
+                      }.dump(), Lane::Control);
+    }
+
+    void Broker::recommend(ConnectionId connection, const nlohmann::json &message) {
+        if (!recommendations_) {
+            return reply_error(connection, "not_enabled", "Recommendations are not enabled on this broker");
+        }
+        const std::string user = string_or_empty(message, "user");
+        if (user.empty()) return reply_error(connection, "bad_request", "recommend requires a user");
+
+        const std::size_t k = std::min(message.value("k", std::size_t{10}), kMaxRecommendations);
+        const std::string context = string_or_empty(message, "context");
+        if (context.size() > kMaxContextBytes) {
+            return reply_error(connection, "bad_request",
+                               "recommend context exceeds " + std::to_string(kMaxContextBytes) + " bytes");
+        }
+        // A miss another request is computing waits for it here, on this core, for no longer
+        // than computing it would take.
+        const auto compute = [this, &user, k]() { return recommendations_->recommend(user, k); };
+        const reco::RecommendationCache::Result recommended =
+                recommendation_cache_
+                    ? recommendation_cache_->get(user, std::to_string(k) + ':' + context,
+                                                 recommendations_->model_version(), compute)
+                    : std::make_shared<const std::vector<reco::ScoredItem> >(compute());
+
+        nlohmann::json items = nlohmann::json::array();
+        for (const reco::ScoredItem &scored: *recommended) {
+            items.push_back({{"item", scored.item}, {"score", scored.score}});
+        }
+        adapter_.send(connection, nlohmann::json{
+                          {"type", "recommendations"},
+                          {"user", user},
+                          {"context", context},
+                          {"items", std::move(items)}
+                      }.dump(), Lane::Control);
+    }
+
+    void Broker::top_trending(ConnectionId connection, const nlohmann::json &message) {
+        if (!trending_) {
+            return reply_error(connection, "not_enabled", "Trending is not enabled on this broker");
+        }
+        const std::string window = string_or_empty(message, "window");
+        const std::string event_type = string_or_empty(message, "event_type");
+        const std::string category = string_or_empty(message, "category");
+
+        nlohmann::json items = nlohmann::json::array();
+        try {
+            for (const trending::TrendingItem &counted: trending_->top(event_type, category, window,
+                                                                        message.value("k", std::size_t{10}))) {
+                items.push_back({{"item", counted.item}, {"count", counted.count}});
+            }
+        } catch (const std::invalid_argument &e) {
+            return reply_error(connection, "bad_request", e.what());
+        }
+        adapter_.send(connection, nlohmann::json{
+                          {"type", "trending"},
+                          {"window", window},
+                          {"event_type", event_type},
+                          {"category", category},
+                          {"items", std::move(items)}
+                      }.dump(), Lane::Control);
+    }
+
+    void Broker::recent_interactions(ConnectionId connection, const nlohmann::json &message) {
+        if (!user_histories_) {
+            return reply_error(connection, "not_enabled", "User histories are not enabled on this broker");
+        }
+        const std::string user = string_or_empty(message, "user");
+        if (user.empty()) return reply_error(connection, "bad_request", "recent requires a user");
+
+        nlohmann::json items = nlohmann::json::array();
+        const std::size_t n = message.value("n", std::size_t{10});
+        for (const reco::RecentInteraction &interaction: user_histories_->recent(user, n)) {
+            items.push_back({
+                {"item", interaction.item}, {"event_type", interaction.event_type}, {"at", interaction.at_ms}
+            });
+        }
+        adapter_.send(connection, nlohmann::json{
+                          {"type", "recent"},
+                          {"user", user},
+                          {"items", std::move(items)}
+                      }.dump(), Lane::Control);
+    }
+
+    void Broker::replicate(ConnectionId connection, const nlohmann::json &message) {
+        if (!log_) {
+            return reply_error(connection, "not_enabled", "Replication is not enabled on this broker");
+        }
+        const std::string epoch = string_or_empty(message, "epoch");
+        const std::uint64_t from = message.value("from", std::uint64_t{0});
+        {
+            const std::lock_guard lock(replication_mutex_);
+            // resume where the follower left off if it still can, else start over
+            const std::uint64_t start = log_->start();
+            const std::uint64_t first = epoch == epoch_ && from >= start && from <= log_->end() ? from : start;
+            followers_[connection] = Follower{first};
+            adapter_.send(connection, replicating_frame_locked(first));
+        }
+        pump_follower(connection);
+    }
+
+    void Broker::replica_ack(ConnectionId connection, const nlohmann::json &) {
+        {
+            const std::lock_guard lock(replication_mutex_);
+            const auto follower = followers_.find(connection);
+            if (follower == followers_.end()) return;
+            if (follower->second.in_flight > 0) --follower->second.in_flight;
+        }
+        pump_follower(connection);
+    }
+
+    void Broker::pump_follower(ConnectionId connection) {
+        const std::lock_guard lock(replication_mutex_);
+        const auto it = followers_.find(connection);
+        if (it == followers_.end()) return;
+
+        Follower &follower = it->second;
+        std::vector<replication::ReplicationLog::Entry> events;
+        while (follower.in_flight < replication_.max_in_flight) {
+            events.clear();
+            const std::uint64_t first = log_->read(follower.next, replication_.batch_events,
+                                                   replication_.batch_bytes, events);
+            if (events.empty()) {
+                follower.waiting = true;
+                return;
+            }
+            adapter_.send(connection, replica_frame(first, events));
+            follower.next = first + events.size();
+            ++follower.in_flight;
+        }
+    }
+
+    void Broker::wake_followers() {
+        std::vector<ConnectionId> woken;
+        {
+            const std::lock_guard lock(replication_mutex_);
+            for (auto &[connection, follower]: followers_) {
+                if (!follower.waiting) continue;
+                follower.waiting = false;
+                woken.push_back(connection);
+            }
+        }
+        for (const ConnectionId connection: woken) {
+            adapter_.post(adapter_.core_of(connection), [this, connection]() { pump_follower(connection); });
+        }
+    }
+
+    void Broker::resync_followers() {
+        std::vector<ConnectionId> pumped;
+        {
+            const std::lock_guard lock(replication_mutex_);
+            const std::uint64_t start = log_->start();
+            for (auto &[connection, follower]: followers_) {
+                // in the bulk lane, behind the batches of the old numbering
+                follower.next = start;
+                follower.waiting = false;
+                adapter_.send(connection, replicating_frame_locked(start));
+                pumped.push_back(connection);
+            }
+        }
+        for (const ConnectionId connection: pumped) {
+            adapter_.post(adapter_.core_of(connection), [this, connection]() { pump_follower(connection); });
+        }
+    }
+
+    std::string Broker::replicating_frame_locked(std::uint64_t from) const {
+        return nlohmann::json{
+            {"type", "replicating"},
+            {"epoch", epoch_},
+            {"start", log_->start()},
+            {"end", log_->end()},
+            {"from", from}
+        }.dump();
+    }
+
+    void Broker::connect_upstream() {
+        std::string request;
+        {
+            const std::lock_guard lock(replication_mutex_);
+            request = nlohmann::json{
+                {"op", "replicate"},
+                {"epoch", upstream_epoch_},
+                {"from", upstream_next_}
+            }.dump();
+        }
+        // batches of events compress well, the link asks for permessage-deflate
+        const ConnectionId connection = adapter_.connect(replication_.upstream, ClientOptions{true, ""});
+        upstream_connection_ = connection;
+        adapter_.send(connection, std::move(request), Lane::Control);
+    }
+
+    void Broker::on_upstream(ConnectionId connection, nlohmann::json &&message) {
+        const std::string type = string_or_empty(message, "type");
+        if (type == "replicating") {
+            const std::string epoch = string_or_empty(message, "epoch");
+            const auto from = message.at("from").get<std::uint64_t>();
+            const auto end = message.at("end").get<std::uint64_t>();
+            bool renumbered;
+            {
+                const std::lock_guard lock(replication_mutex_);
+                if (upstream_epoch_.empty()) {
+                    // first sync: the leader's history fills the hot buffer, newer events are published
+                    live_from_ = end;
+                } else if (epoch != upstream_epoch_) {
+                    // the leader numbers from scratch, e.g. after a restart: all it holds is new
+                    live_from_ = from;
+                } else {
+                    if (from > upstream_next_) {
+                        std::cerr << "replication gap: " << from - upstream_next_ << " events lost" << std::endl;
+                    }
+                    live_from_ = std::max(from, upstream_next_);
+                }
+                renumbered = epoch != epoch_;
+                upstream_epoch_ = epoch;
+                epoch_ = epoch;
+                upstream_next_ = from;
+            }
+            if (renumbered || log_->end() != from) log_->reset(from);
+            if (renumbered) resync_followers();
+            return;
+        }
+
+        if (type == "replica") {
+            const auto first = message.at("offset").get<std::uint64_t>();
+            nlohmann::json &events = message.at("events");
+            std::uint64_t next;
+            std::uint64_t live_from;
+            {
+                const std::lock_guard lock(replication_mutex_);
+                next = upstream_next_;
+                live_from = live_from_;
+            }
+            if (first > next) {
+                std::cerr << "replication gap: " << first - next << " events lost" << std::endl;
+                log_->reset(first);
+                next = first;
+            }
+
+            // in order, on the link's core
+            const std::size_t core = adapter_.core_of(connection);
+            bool wake = false;
+            for (std::size_t i = 0; i < events.size(); ++i) {
+                const std::uint64_t offset = first + i;
+                if (offset < next) continue;
+                wake |= log_->append(events[i].dump());
+                if (offset >= live_from && events[i].is_object()) fan_out(core, std::move(events[i]));
+                next = offset + 1;
+            }
+            {
+                const std::lock_guard lock(replication_mutex_);
+                upstream_next_ = next;
+            }
+            if (wake) wake_followers();
+            adapter_.send(connection, nlohmann::json{
+                              {"op", "replica_ack"},
+                              {"offset", next}
+                          }.dump(), Lane::Control);
+            return;
+        }
+
+        std::cerr << "replication: unexpected frame from upstream: " << message.dump() << std::endl;
+    }
+} // namespace beacon
@@ -0,0 +1,246 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/als.h>
+#include <beacon/embedding_matrix.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace beacon {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        // rows per Gram tile: 128 rows of 64 factors is 32 KB, which stays in L1/L2
+        constexpr std::size_t kGramBlock = 128;
+        // rows a thread solves at a time
+        constexpr std::size_t kSolveChunk = 256;
+
+        double seconds_since(Clock::time_point start) {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        /**
+         * Runs work(thread, begin, end) over [0, count) in chunks, on `threads` threads.
+         */
+        template<typename F>
+        void parallel_chunks(std::size_t count, std::size_t chunk, std::size_t threads, F &&work) {
+            std::atomic<std::size_t> next{0};
+            auto run = [&](std::size_t thread) {
+                for (std::size_t begin; (begin = next.fetch_add(chunk, std::memory_order_relaxed)) < count;) {
+                    work(thread, begin, std::min(begin + chunk, count));
+                }
+            };
+            std::vector<std::thread> workers;
+            for (std::size_t thread = 1; thread < threads; ++thread) workers.emplace_back(run, thread);
+            run(0);
+            for (auto &worker: workers) worker.join();
+        }
+
+        std::vector<float> random_factors(std::size_t rows, std::size_t factors, std::uint64_t seed) {
+            std::vector<float> values(rows * factors);
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                std::uint64_t x = seed + 0x9e3779b97f4a7c15ULL * (i + 1);
+                x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+                x ^= x >> 31;
+                values[i] = static_cast<float>(static_cast<double>(x >> 11) * 0x1.0p-53) * 0.01f;
+            }
+            return values;
+        }
+
+        /**
+         * Y'Y of the rows x f row-major `factors`, both triangles. Each block of rows is
+         * transposed into a tile so that entry (a, b) of the block's share is one dot product of
+         * two contiguous columns.
+         */
+        std::vector<float> gram(const std::vector<float> &factors, std::size_t rows, std::size_t f,
+                                std::size_t threads, reco::DotProduct dot) {
+            std::vector<std::vector<double> > partial(threads, std::vector<double>(f * f, 0.0));
+            std::vector<std::vector<float> > tiles(threads, std::vector<float>(f * kGramBlock));
+            parallel_chunks(rows, kGramBlock, threads, [&](std::size_t thread, std::size_t begin, std::size_t end) {
+                float *tile = tiles[thread].data();
+                const std::size_t count = end - begin;
+                for (std::size_t r = 0; r < count; ++r) {
+                    const float *row = factors.data() + (begin + r) * f;
+                    for (std::size_t a = 0; a < f; ++a) tile[a * kGramBlock + r] = row[a];
+                }
+                double *sums = partial[thread].data();
+                for (std::size_t a = 0; a < f; ++a) {
+                    const float *column = tile + a * kGramBlock;
+                    for (std::size_t b = a; b < f; ++b) sums[a * f + b] += dot(column, tile + b * kGramBlock, count);
+                }
+            });
+
+            std::vector<float> result(f * f);
+            for (std::size_t a = 0; a < f; ++a) {
+                for (std::size_t b = a; b < f; ++b) {
+                    double sum = 0.0;
+                    for (const auto &sums: partial) sum += sums[a * f + b];
+                    result[a * f + b] = result[b * f + a] = static_cast<float>(sum);
+                }
+            }
+            return result;
+        }
+
+        /**
+         * Moves each row of `factors` toward the solution of its normal equations by conjugate
+         * gradient, against the fixed `other` side and its Gram matrix.
+         */
+        void solve(const reco::CsrMatrix &matrix, const std::vector<float> &other, const std::vector<float> &gram,
+                   std::vector<float> &factors, const reco::AlsConfig &config, std::size_t threads,
+                   reco::DotProduct dot, reco::ScaledAdd axpy) {
+            const std::size_t f = config.factors;
+            const float lambda = config.regularization;
+            // (Y'Y + lambda I) v plus the observed columns' (c - 1) (y . v) y; Y'Y is symmetric,
+            // so it is applied a column at a time
+            auto apply = [&](const std::uint32_t *columns, const float *weights, std::size_t count, const float *v,
+                             float *out) {
+                for (std::size_t a = 0; a < f; ++a) out[a] = lambda * v[a];
+                for (std::size_t a = 0; a < f; ++a) axpy(v[a], gram.data() + a * f, out, f);
+                for (std::size_t k = 0; k < count; ++k) {
+                    const float *y = other.data() + static_cast<std::size_t>(columns[k]) * f;
+                    axpy(config.alpha * weights[k] * dot(y, v, f), y, out, f);
+                }
+            };
+
+            parallel_chunks(matrix.rows, kSolveChunk, threads, [&](std::size_t, std::size_t begin, std::size_t end) {
+                std::vector<float> r(f), p(f), ap(f);
+                for (std::size_t row = begin; row < end; ++row) {
+                    float *x = factors.data() + row * f;
+                    const std::size_t offset = matrix.offsets[row];
+                    const std::size_t count = matrix.offsets[row + 1] - offset;
+                    const std::uint32_t *columns = matrix.indices.data() + offset;
+                    const float *weights = matrix.values.data() + offset;
+
+                    // r = b - A x, where b sums c y over the observed columns
+                    apply(columns, weights, count, x, ap.data());
+                    for (std::size_t a = 0; a < f; ++a) r[a] = -ap[a];
+                    for (std::size_t k = 0; k < count; ++k) {
+                        const float *y = other.data() + static_cast<std::size_t>(columns[k]) * f;
+                        axpy(1.0f + config.alpha * weights[k], y, r.data(), f);
+                    }
+                    p = r;
+                    float residual = dot(r.data(), r.data(), f);
+                    for (std::size_t step = 0; step < config.cg_steps && residual > 1e-20f; ++step) {
+                        apply(columns, weights, count, p.data(), ap.data());
+                        const float curvature = dot(p.data(), ap.data(), f);
+                        if (!(curvature > 0.0f)) break;
+                        const float move = residual / curvature;
+                        axpy(move, p.data(), x, f);
+                        axpy(-move, ap.data(), r.data(), f);
+                        const float next = dot(r.data(), r.data(), f);
+                        for (std::size_t a = 0; a < f; ++a) p[a] = r[a] + next / residual * p[a];
+                        residual = next;
+                    }
+                }
+            });
+        }
+    } // namespace
+
+    namespace reco {
+        CsrMatrix CsrMatrix::from_triplets(std::size_t rows, std::size_t columns, std::vector<Triplet> triplets) {
+            CsrMatrix matrix;
+            matrix.rows = rows;
+            matrix.columns = columns;
+            matrix.offsets.assign(rows + 1, 0);
+            for (const Triplet &triplet: triplets) {
+                if (triplet.row >= rows || triplet.column >= columns) {
+                    throw std::out_of_range("Triplet outside the matrix");
+                }
+                ++matrix.offsets[triplet.row + 1];
+            }
+            for (std::size_t row = 0; row < rows; ++row) matrix.offsets[row + 1] += matrix.offsets[row];
+
+            // bucket by row, then sort and merge each row
+            std::vector<std::pair<std::uint32_t, float> > entries(triplets.size());
+            std::vector<std::uint64_t> cursor(matrix.offsets.begin(), matrix.offsets.end() - 1);
+            for (const Triplet &triplet: triplets) entries[cursor[triplet.row]++] = {triplet.column, triplet.value};
+            triplets.clear();
+            triplets.shrink_to_fit();
+
+            matrix.indices.reserve(entries.size());
+            matrix.values.reserve(entries.size());
+            std::uint64_t start = 0;
+            for (std::size_t row = 0; row < rows; ++row) {
+                const std::uint64_t end = matrix.offsets[row + 1];
+                std::sort(entries.begin() + static_cast<std::ptrdiff_t>(start),
+                          entries.begin() + static_cast<std::ptrdiff_t>(end));
+                for (std::uint64_t i = start; i < end; ++i) {
+                    if (i > start && entries[i].first == entries[i - 1].first) {
+                        matrix.values.back() += entries[i].second;
+                    } else {
+                        matrix.indices.push_back(entries[i].first);
+                        matrix.values.push_back(entries[i].second);
+                    }
+                }
+                start = end;
+                matrix.offsets[row + 1] = matrix.indices.size();
+            }
+            return matrix;
+        }
+
+        CsrMatrix CsrMatrix::transpose() const {
+            CsrMatrix result;
+            result.rows = columns;
+            result.columns = rows;
+            result.offsets.assign(columns + 1, 0);
+            for (const std::uint32_t column: indices) ++result.offsets[column + 1];
+            for (std::size_t column = 0; column < columns; ++column) {
+                result.offsets[column + 1] += result.offsets[column];
+            }
+            result.indices.resize(indices.size());
+            result.values.resize(values.size());
+            std::vector<std::uint64_t> cursor(result.offsets.begin(), result.offsets.end() - 1);
+            // rows go in ascending, so each transposed row comes out sorted
+            for (std::size_t row = 0; row < rows; ++row) {
+                for (std::uint64_t i = offsets[row]; i < offsets[row + 1]; ++i) {
+                    const std::uint64_t to = cursor[indices[i]]++;
+                    result.indices[to] = static_cast<std::uint32_t>(row);
+                    result.values[to] = values[i];
+                }
+            }
+            return result;
+        }
+
+        AlsModel train_als(const CsrMatrix &user_items, const AlsConfig &config,
+                           const std::function<void(const AlsIteration &)> &on_iteration) {
+            if (config.factors == 0) throw std::invalid_argument("ALS needs at least one factor");
+            const std::size_t threads = config.threads > 0
+                                            ? config.threads
+                                            : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+            const std::size_t f = config.factors;
+            const DotProduct dot = dot_product();
+            const ScaledAdd axpy = scaled_add();
+            const CsrMatrix item_users = user_items.transpose();
+
+            AlsModel model;
+            model.factors = f;
+            model.users = random_factors(user_items.rows, f, config.seed);
+            model.items = random_factors(user_items.columns, f, config.seed + 1);
+
+            for (std::size_t iteration = 1; iteration <= config.iterations; ++iteration) {
+                AlsIteration timings;
+                timings.iteration = iteration;
+                auto start = Clock::now();
+                std::vector<float> fixed = gram(model.items, user_items.columns, f, threads, dot);
+                timings.gram_seconds += seconds_since(start);
+                start = Clock::now();
+                solve(user_items, model.items, fixed, model.users, config, threads, dot, axpy);
+                timings.user_seconds = seconds_since(start);
+
+                start = Clock::now();
+                fixed = gram(model.users, user_items.rows, f, threads, dot);
+                timings.gram_seconds += seconds_since(start);
+                start = Clock::now();
+                solve(item_users, model.users, fixed, model.items, config, threads, dot, axpy);
+                timings.item_seconds = seconds_since(start);
+                if (on_iteration) on_iteration(timings);
+            }
+            return model;
+        }
+    } // namespace reco
+} // namespace beacon
@@ -0,0 +1,109 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/consumer_group.h>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace beacon::consumer {
+    std::uint32_t partition_of(std::string_view key, std::uint32_t partitions) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (const char c: key) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return static_cast<std::uint32_t>(hash % partitions);
+    }
+
+    GroupMembership::GroupMembership(std::uint32_t partitions) : owners_(partitions, 0) {
+        if (partitions == 0) {
+            throw std::invalid_argument("A consumer group needs at least one partition");
+        }
+    }
+
+    bool GroupMembership::join(MemberId member) {
+        if (member == 0 || contains(member)) return false;
+        members_.push_back(member);
+        rebalance();
+        return true;
+    }
+
+    bool GroupMembership::leave(MemberId member) {
+        const auto it = std::find(members_.begin(), members_.end(), member);
+        if (it == members_.end()) return false;
+        members_.erase(it);
+        rebalance();
+        return true;
+    }
+
+    bool GroupMembership::contains(MemberId member) const {
+        return std::find(members_.begin(), members_.end(), member) != members_.end();
+    }
+
+    std::vector<std::uint32_t> GroupMembership::partitions_of(MemberId member) const {
+        std::vector<std::uint32_t> owned;
+        for (std::uint32_t partition = 0; partition < owners_.size(); ++partition) {
+            if (owners_[partition] == member) owned.push_back(partition);
+        }
+        return owned;
+    }
+
+    void GroupMembership::rebalance() {
+        ++generation_;
+        if (members_.empty()) {
+            std::fill(owners_.begin(), owners_.end(), 0);
+            return;
+        }
+
+        // What every remaining member owns now; partitions of departed members are free.
+        std::unordered_map<MemberId, std::uint32_t> held;
+        for (const MemberId member: members_) held[member] = 0;
+        for (MemberId &owner: owners_) {
+            const auto it = held.find(owner);
+            if (it == held.end()) {
+                owner = 0;
+            } else {
+                ++it->second;
+            }
+        }
+
+        // The P % N larger shares go to the members already holding the most, so they
+        // keep what they have.
+        const auto count = static_cast<std::uint32_t>(members_.size());
+        const std::uint32_t share = partitions() / count;
+        std::uint32_t larger = partitions() % count;
+        std::vector<MemberId> by_held = members_;
+        std::stable_sort(by_held.begin(), by_held.end(), [&held](MemberId a, MemberId b) {
+            return held[a] > held[b];
+        });
+        std::unordered_map<MemberId, std::uint32_t> quota;
+        for (const MemberId member: by_held) {
+            quota[member] = share + (larger > 0 ? 1 : 0);
+            if (larger > 0) --larger;
+        }
+
+        // Keep owners within their quota, free the surplus.
+        std::unordered_map<MemberId, std::uint32_t> kept;
+        for (MemberId &owner: owners_) {
+            if (owner == 0) continue;
+            if (kept[owner] < quota[owner]) {
+                ++kept[owner];
+            } else {
+                owner = 0;
+            }
+        }
+
+        // Hand out the free partitions to members below quota, in join order.
+        std::size_t next = 0;
+        for (MemberId &owner: owners_) {
+            if (owner != 0) continue;
+            while (kept[members_[next]] >= quota[members_[next]]) {
+                next = (next + 1) % members_.size();
+            }
+            owner = members_[next];
+            ++kept[owner];
+        }
+    }
+} // namespace beacon::consumer
@@ -0,0 +1,359 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/embedding_matrix.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BEACON_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace beacon {
+    namespace reco {
+        SimdLevel detect_simd() {
+#if defined(BEACON_SIMD_X86)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) return SimdLevel::Avx512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::Avx2;
+            if (__builtin_cpu_supports("sse2")) return SimdLevel::Sse2;
+#endif
+            return SimdLevel::Scalar;
+        }
+
+        SimdLevel parse_simd(const std::string &name) {
+            if (name == "scalar") return SimdLevel::Scalar;
+            if (name == "sse2") return SimdLevel::Sse2;
+            if (name == "avx2") return SimdLevel::Avx2;
+            if (name == "avx512") return SimdLevel::Avx512;
+            throw std::invalid_argument("Unknown instruction set '" + name + "'");
+        }
+
+        const char *simd_name(SimdLevel level) {
+            switch (level) {
+                case SimdLevel::Scalar: return "scalar";
+                case SimdLevel::Sse2: return "sse2";
+                case SimdLevel::Avx2: return "avx2";
+                case SimdLevel::Avx512: return "avx512";
+            }
+            return "scalar";
+        }
+
+        EmbeddingMetric parse_embedding_metric(const std::string &name) {
+            if (name == "dot") return EmbeddingMetric::Dot;
+            if (name == "cosine") return EmbeddingMetric::Cosine;
+            throw std::invalid_argument("Unknown embedding metric '" + name + "'");
+        }
+    } // namespace reco
+
+    namespace {
+        using reco::EmbeddingMatrix;
+        using reco::TopK;
+        constexpr std::size_t kLanes = EmbeddingMatrix::kTileRows;
+
+        /**
+         * Scores tiles [0, tiles) against `query` and offers them to `top`; `scale` multiplies
+         * each row's score.
+         */
+        using Kernel = void (*)(const float *values, const float *scale, const float *query, std::size_t dimension,
+                                std::size_t tiles, TopK &top);
+
+        void score_scalar(const float *values, const float *scale, const float *query, std::size_t dimension,
+                          std::size_t tiles, TopK &top) {
+            for (std::size_t tile = 0; tile < tiles; ++tile) {
+                const float *base = values + tile * dimension * kLanes;
+                float scores[kLanes] = {};
+                for (std::size_t d = 0; d < dimension; ++d) {
+                    for (std::size_t lane = 0; lane < kLanes; ++lane) scores[lane] += query[d] * base[d * kLanes + lane];
+                }
+                for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                    const float score = scores[lane] * scale[tile * kLanes + lane];
+                    if (score > top.threshold()) {
+                        top.offer(score, static_cast<std::uint32_t>(tile * kLanes + lane));
+                    }
+                }
+            }
+        }
+
+#if defined(BEACON_SIMD_X86)
+        // Each kernel keeps four vector accumulators in flight: one tile of four vectors with
+        // SSE2, two tiles of two with AVX2, four tiles of one with AVX-512.
+
+        __attribute__((target("sse2")))
+        void score_sse2(const float *values, const float *scale, const float *query, std::size_t dimension,
+                        std::size_t tiles, TopK &top) {
+            for (std::size_t tile = 0; tile < tiles; ++tile) {
+                const float *base = values + tile * dimension * kLanes;
+                __m128 acc[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+                for (std::size_t d = 0; d < dimension; ++d) {
+                    const __m128 q = _mm_set1_ps(query[d]);
+                    const float *row = base + d * kLanes;
+                    for (int j = 0; j < 4; ++j) acc[j] = _mm_add_ps(acc[j], _mm_mul_ps(q, _mm_load_ps(row + 4 * j)));
+                }
+                const __m128 threshold = _mm_set1_ps(top.threshold());
+                unsigned mask = 0;
+                for (int j = 0; j < 4; ++j) {
+                    acc[j] = _mm_mul_ps(acc[j], _mm_load_ps(scale + tile * kLanes + 4 * j));
+                    mask |= static_cast<unsigned>(_mm_movemask_ps(_mm_cmpgt_ps(acc[j], threshold))) << (4 * j);
+                }
+                if (mask != 0) {
+                    alignas(64) float scores[kLanes];
+                    for (int j = 0; j < 4; ++j) _mm_store_ps(scores + 4 * j, acc[j]);
+                    top.offer_lanes(scores, mask, static_cast<std::uint32_t>(tile * kLanes));
+                }
+            }
+        }
+
+        template<std::size_t N>
+        __attribute__((target("avx2,fma")))
+        inline void tiles_avx2(const float *values, const float *scale, const float *query, std::size_t dimension,
+                               std::size_t tile, TopK &top) {
+            const float *base = values + tile * dimension * kLanes;
+            __m256 acc[2 * N];
+            for (std::size_t j = 0; j < 2 * N; ++j) acc[j] = _mm256_setzero_ps();
+            for (std::size_t d = 0; d < dimension; ++d) {
+                const __m256 q = _mm256_set1_ps(query[d]);
+                for (std::size_t t = 0; t < N; ++t) {
+                    const float *row = base + (t * dimension + d) * kLanes;
+                    acc[2 * t] = _mm256_fmadd_ps(q, _mm256_load_ps(row), acc[2 * t]);
+                    acc[2 * t + 1] = _mm256_fmadd_ps(q, _mm256_load_ps(row + 8), acc[2 * t + 1]);
+                }
+            }
+            for (std::size_t t = 0; t < N; ++t) {
+                const float *tile_scale = scale + (tile + t) * kLanes;
+                const __m256 low = _mm256_mul_ps(acc[2 * t], _mm256_load_ps(tile_scale));
+                const __m256 high = _mm256_mul_ps(acc[2 * t + 1], _mm256_load_ps(tile_scale + 8));
+                const __m256 threshold = _mm256_set1_ps(top.threshold());
+                const unsigned mask =
+                        static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(low, threshold, _CMP_GT_OQ))) |
+                        static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(high, threshold, _CMP_GT_OQ))) << 8;
+                if (mask != 0) {
+                    alignas(64) float scores[kLanes];
+                    _mm256_store_ps(scores, low);
+                    _mm256_store_ps(scores + 8, high);
+                    top.offer_lanes(scores, mask, static_cast<std::uint32_t>((tile + t) * kLanes));
+                }
+            }
+        }
+
+        __attribute__((target("avx2,fma")))
+        void score_avx2(const float *values, const float *scale, const float *query, std::size_t dimension,
+                        std::size_t tiles, TopK &top) {
+            std::size_t tile = 0;
+            for (; tile + 2 <= tiles; tile += 2) tiles_avx2<2>(values, scale, query, dimension, tile, top);
+            for (; tile < tiles; ++tile) tiles_avx2<1>(values, scale, query, dimension, tile, top);
+        }
+
+        template<std::size_t N>
+        __attribute__((target("avx512f")))
+        inline void tiles_avx512(const float *values, const float *scale, const float *query, std::size_t dimension,
+                                 std::size_t tile, TopK &top) {
+            const float *base = values + tile * dimension * kLanes;
+            __m512 acc[N];
+            for (std::size_t t = 0; t < N; ++t) acc[t] = _mm512_setzero_ps();
+            for (std::size_t d = 0; d < dimension; ++d) {
+                const __m512 q = _mm512_set1_ps(query[d]);
+                for (std::size_t t = 0; t < N; ++t) {
+                    acc[t] = _mm512_fmadd_ps(q, _mm512_load_ps(base + (t * dimension + d) * kLanes), acc[t]);
+                }
+            }
+            for (std::size_t t = 0; t < N; ++t) {
+                const __m512 scores = _mm512_mul_ps(acc[t], _mm512_load_ps(scale + (tile + t) * kLanes));
+                const __mmask16 mask = _mm512_cmp_ps_mask(scores, _mm512_set1_ps(top.threshold()), _CMP_GT_OQ);
+                if (mask != 0) {
+                    alignas(64) float lanes[kLanes];
+                    _mm512_store_ps(lanes, scores);
+                    top.offer_lanes(lanes, mask, static_cast<std::uint32_t>((tile + t) * kLanes));
+                }
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        void score_avx512(const float *values, const float *scale, const float *query, std::size_t dimension,
+                          std::size_t tiles, TopK &top) {
+            std::size_t tile = 0;
+            for (; tile + 4 <= tiles; tile += 4) tiles_avx512<4>(values, scale, query, dimension, tile, top);
+            for (; tile < tiles; ++tile) tiles_avx512<1>(values, scale, query, dimension, tile, top);
+        }
+#endif
+
+        float dot_scalar(const float *a, const float *b, std::size_t count) {
+            // independent sums, so the compiler may vectorize without reassociating
+            float sums[8] = {};
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                for (std::size_t j = 0; j < 8; ++j) sums[j] += a[i + j] * b[i + j];
+            }
+            float sum = 0.0f;
+            for (; i < count; ++i) sum += a[i] * b[i];
+            for (const float partial: sums) sum += partial;
+            return sum;
+        }
+
+        void scaled_add_scalar(float a, const float *x, float *y, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) y[i] += a * x[i];
+        }
+
+#if defined(BEACON_SIMD_X86)
+        __attribute__((target("avx2,fma")))
+        void scaled_add_avx2(float a, const float *x, float *y, std::size_t count) {
+            const __m256 scale = _mm256_set1_ps(a);
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                _mm256_storeu_ps(y + i, _mm256_fmadd_ps(scale, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+            }
+            for (; i < count; ++i) y[i] += a * x[i];
+        }
+
+        __attribute__((target("avx512f")))
+        void scaled_add_avx512(float a, const float *x, float *y, std::size_t count) {
+            const __m512 scale = _mm512_set1_ps(a);
+            std::size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                _mm512_storeu_ps(y + i, _mm512_fmadd_ps(scale, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+            }
+            if (i < count) {
+                const __mmask16 tail = static_cast<__mmask16>((1u << (count - i)) - 1);
+                _mm512_mask_storeu_ps(y + i, tail, _mm512_fmadd_ps(scale, _mm512_maskz_loadu_ps(tail, x + i),
+                                                                   _mm512_maskz_loadu_ps(tail, y + i)));
+            }
+        }
+
+        __attribute__((target("avx2,fma")))
+        float dot_avx2(const float *a, const float *b, std::size_t count) {
+            __m256 low = _mm256_setzero_ps();
+            __m256 high = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                low = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), low);
+                high = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), high);
+            }
+            const __m256 both = _mm256_add_ps(low, high);
+            __m128 sum = _mm_add_ps(_mm256_castps256_ps128(both), _mm256_extractf128_ps(both, 1));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+            float result = _mm_cvtss_f32(sum);
+            for (; i < count; ++i) result += a[i] * b[i];
+            return result;
+        }
+
+        __attribute__((target("avx512f")))
+        float dot_avx512(const float *a, const float *b, std::size_t count) {
+            __m512 sum = _mm512_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                sum = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum);
+            }
+            if (i < count) {
+                const __mmask16 tail = static_cast<__mmask16>((1u << (count - i)) - 1);
+                sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(tail, a + i), _mm512_maskz_loadu_ps(tail, b + i), sum);
+            }
+            // GCC 12's reduction and lane extraction intrinsics trip -Wuninitialized
+            alignas(64) float lanes[16];
+            _mm512_store_ps(lanes, sum);
+            float result = 0.0f;
+            for (const float lane: lanes) result += lane;
+            return result;
+        }
+#endif
+
+        Kernel kernel_for(reco::SimdLevel level) {
+            switch (level) {
+#if defined(BEACON_SIMD_X86)
+                case reco::SimdLevel::Avx512: return score_avx512;
+                case reco::SimdLevel::Avx2: return score_avx2;
+                case reco::SimdLevel::Sse2: return score_sse2;
+#endif
+                default: return score_scalar;
+            }
+        }
+    } // namespace
+
+    namespace reco {
+        DotProduct dot_product(SimdLevel level) {
+            switch (std::min(level, detect_simd())) {
+#if defined(BEACON_SIMD_X86)
+                case SimdLevel::Avx512: return dot_avx512;
+                case SimdLevel::Avx2: return dot_avx2;
+#endif
+                default: return dot_scalar;
+            }
+        }
+
+        ScaledAdd scaled_add(SimdLevel level) {
+            switch (std::min(level, detect_simd())) {
+#if defined(BEACON_SIMD_X86)
+                case SimdLevel::Avx512: return scaled_add_avx512;
+                case SimdLevel::Avx2: return scaled_add_avx2;
+#endif
+                default: return scaled_add_scalar;
+            }
+        }
+
+        EmbeddingMatrix::EmbeddingMatrix(std::size_t dimension, SimdLevel simd) : dimension_(dimension),
+            simd_(SimdLevel::Scalar) {
+            set_simd(simd);
+        }
+
+        void EmbeddingMatrix::set_simd(SimdLevel simd) {
+            simd_ = std::min(simd, detect_simd());
+        }
+
+        void EmbeddingMatrix::set(std::uint32_t row, const float *values) {
+            const std::size_t tile = row / kTileRows;
+            const std::size_t lane = row % kTileRows;
+            if (row >= present_.size()) {
+                const std::size_t tiles = tile + 1;
+                tiles_.resize(tiles * dimension_ * kTileRows, 0.0f);
+                present_.resize(tiles * kTileRows, std::numeric_limits<float>::quiet_NaN());
+                inverse_norms_.resize(tiles * kTileRows, std::numeric_limits<float>::quiet_NaN());
+            }
+            if (!contains(row)) ++size_;
+
+            double norm2 = 0.0;
+            float *base = tiles_.data() + tile * dimension_ * kTileRows + lane;
+            for (std::size_t d = 0; d < dimension_; ++d) {
+                base[d * kTileRows] = values[d];
+                norm2 += static_cast<double>(values[d]) * values[d];
+            }
+            present_[row] = 1.0f;
+            // a zero vector is similar to nothing
+            inverse_norms_[row] = norm2 > 0.0 ? static_cast<float>(1.0 / std::sqrt(norm2)) : 0.0f;
+        }
+
+        bool EmbeddingMatrix::contains(std::uint32_t row) const {
+            return row < present_.size() && !std::isnan(present_[row]);
+        }
+
+        std::vector<float> EmbeddingMatrix::row(std::uint32_t row) const {
+            if (!contains(row)) return {};
+            std::vector<float> values(dimension_);
+            const float *base = tiles_.data() + (row / kTileRows) * dimension_ * kTileRows + row % kTileRows;
+            for (std::size_t d = 0; d < dimension_; ++d) values[d] = base[d * kTileRows];
+            return values;
+        }
+
+        std::vector<std::pair<float, std::uint32_t> > EmbeddingMatrix::top_k(const float *query, std::size_t k,
+                                                                             EmbeddingMetric metric) const {
+            if (k == 0 || size_ == 0) return {};
+            std::vector<float> normalized(query, query + dimension_);
+            if (metric == EmbeddingMetric::Cosine) {
+                double norm2 = 0.0;
+                for (const float value: normalized) norm2 += static_cast<double>(value) * value;
+                if (!(norm2 > 0.0)) return {};
+                const auto inverse = static_cast<float>(1.0 / std::sqrt(norm2));
+                for (float &value: normalized) value *= inverse;
+            }
+
+            TopK top(k);
+            kernel_for(simd_)(tiles_.data(),
+                              metric == EmbeddingMetric::Cosine ? inverse_norms_.data() : present_.data(),
+                              normalized.data(), dimension_, present_.size() / kTileRows, top);
+            return top.take();
+        }
+    } // namespace reco
+} // namespace beacon
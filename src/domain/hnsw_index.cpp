@@ -0,0 +1,642 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/hnsw_index.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <queue>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace beacon {
+    namespace {
+        constexpr std::uint32_t kNone = 0xffffffff;
+        constexpr int kMaxLevel = 16;
+        constexpr char kMagic[8] = {'B', 'H', 'N', 'S', 'W', '\0', '\0', '\1'};
+
+        // (score, node)
+        using Scored = std::pair<float, std::uint32_t>;
+
+        struct Node {
+            // guards links, which other inserts extend and prune
+            std::mutex mutex;
+            std::uint32_t label = 0;
+            int level = 0;
+            std::atomic<bool> deleted{false};
+            std::vector<std::vector<std::uint32_t> > links;
+        };
+
+        /**
+         * A visit mark per node for one search at a time, cleared by bumping the epoch.
+         */
+        struct Visited {
+            std::vector<std::uint16_t> marks;
+            std::uint16_t epoch = 0;
+
+            void reset(std::size_t nodes) {
+                if (marks.size() < nodes) marks.resize(nodes);
+                if (++epoch == 0) {
+                    std::fill(marks.begin(), marks.end(), 0);
+                    epoch = 1;
+                }
+            }
+
+            /**
+             * Marks `node`; false if it already was.
+             */
+            bool visit(std::uint32_t node) {
+                if (node >= marks.size()) marks.resize(std::max<std::size_t>(node + 1, marks.size() * 2));
+                if (marks[node] == epoch) return false;
+                marks[node] = epoch;
+                return true;
+            }
+        };
+
+        std::uint64_t splitmix64(std::uint64_t x) {
+            x += 0x9e3779b97f4a7c15ULL;
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+
+        void normalize(float *values, std::size_t count) {
+            double norm2 = 0.0;
+            for (std::size_t i = 0; i < count; ++i) norm2 += static_cast<double>(values[i]) * values[i];
+            if (!(norm2 > 0.0)) return;
+            const auto inverse = static_cast<float>(1.0 / std::sqrt(norm2));
+            for (std::size_t i = 0; i < count; ++i) values[i] *= inverse;
+        }
+
+        template<typename T>
+        void put(std::ostream &out, const T &value) {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        template<typename T>
+        T get(std::istream &in) {
+            T value{};
+            in.read(reinterpret_cast<char *>(&value), sizeof(value));
+            if (!in) throw std::runtime_error("Truncated HNSW index");
+            return value;
+        }
+    } // namespace
+
+    namespace reco {
+        struct HnswIndex::Impl {
+            static constexpr unsigned kSegmentBits = 12;
+            static constexpr std::size_t kSegmentSize = std::size_t{1} << kSegmentBits;
+            static constexpr std::size_t kSegments = std::size_t{1} << 16;
+
+            // tombstones tolerated before compaction_due() considers the live count
+            static constexpr std::size_t kMinCompaction = 64;
+
+            struct Segment {
+                std::unique_ptr<Node[]> nodes;
+                std::unique_ptr<float[]> values;
+            };
+
+            /**
+             * A Visited borrowed from the pool for the length of one search.
+             */
+            class VisitedLease {
+            public:
+                explicit VisitedLease(const Impl &impl) : impl_(impl) {
+                    {
+                        const std::lock_guard lock(impl_.pool_mutex);
+                        if (!impl_.pool.empty()) {
+                            visited_ = std::move(impl_.pool.back());
+                            impl_.pool.pop_back();
+                        }
+                    }
+                    if (!visited_) visited_ = std::make_unique<Visited>();
+                    visited_->reset(impl_.next.load(std::memory_order_relaxed));
+                }
+
+                ~VisitedLease() {
+                    const std::lock_guard lock(impl_.pool_mutex);
+                    impl_.pool.push_back(std::move(visited_));
+                }
+
+                VisitedLease(const VisitedLease &) = delete;
+
+                VisitedLease &operator=(const VisitedLease &) = delete;
+
+                Visited *operator->() const {
+                    return visited_.get();
+                }
+
+            private:
+                const Impl &impl_;
+                std::unique_ptr<Visited> visited_;
+            };
+
+            explicit Impl(HnswConfig config)
+                : config(config), segments(new std::atomic<Segment *>[kSegments]), dot(dot_product()) {
+                if (this->config.dimension == 0) throw std::invalid_argument("HNSW index needs a dimension");
+                this->config.m = std::max<std::size_t>(this->config.m, 2);
+                this->config.ef_construction = std::max(this->config.ef_construction, this->config.m);
+                level_scale = 1.0 / std::log(static_cast<double>(this->config.m));
+                for (std::size_t i = 0; i < kSegments; ++i) segments[i].store(nullptr, std::memory_order_relaxed);
+            }
+
+            std::size_t max_links(int level) const {
+                return level == 0 ? 2 * config.m : config.m;
+            }
+
+            Node &node(std::uint32_t id) const {
+                return segments[id >> kSegmentBits].load(std::memory_order_acquire)->nodes[id & (kSegmentSize - 1)];
+            }
+
+            float *values(std::uint32_t id) const {
+                return segments[id >> kSegmentBits].load(std::memory_order_acquire)->values.get() +
+                       (id & (kSegmentSize - 1)) * config.dimension;
+            }
+
+            float score(const float *query, std::uint32_t id) const {
+                return dot(query, values(id), config.dimension);
+            }
+
+            /**
+             * A new node id, with room for it.
+             */
+            std::uint32_t allocate() {
+                const std::uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+                const std::size_t segment = id >> kSegmentBits;
+                if (segment >= kSegments) throw std::length_error("HNSW index is full");
+                if (segments[segment].load(std::memory_order_acquire) == nullptr) {
+                    const std::lock_guard lock(grow_mutex);
+                    if (segments[segment].load(std::memory_order_relaxed) == nullptr) {
+                        auto created = std::make_unique<Segment>();
+                        created->nodes = std::make_unique<Node[]>(kSegmentSize);
+                        created->values = std::make_unique<float[]>(kSegmentSize * config.dimension);
+                        segments[segment].store(created.get(), std::memory_order_release);
+                        owned.push_back(std::move(created));
+                    }
+                }
+                return id;
+            }
+
+            /**
+             * Geometric in m, and a function of the id so that a serial build is repeatable.
+             */
+            int random_level(std::uint32_t id) const {
+                const std::uint64_t bits = splitmix64(config.seed ^ (static_cast<std::uint64_t>(id) << 20));
+                const double unit = (static_cast<double>(bits >> 11) + 0.5) * 0x1.0p-53;
+                return std::min(kMaxLevel, static_cast<int>(-std::log(unit) * level_scale));
+            }
+
+            void copy_links(std::uint32_t id, int level, std::vector<std::uint32_t> &out) const {
+                Node &linked = node(id);
+                const std::lock_guard lock(linked.mutex);
+                out.assign(linked.links[level].begin(), linked.links[level].end());
+            }
+
+            /**
+             * Walks to the best-scoring node reachable on `level`, one improvement at a time.
+             */
+            Scored greedy(const float *query, Scored current, int level) const {
+                std::vector<std::uint32_t> links;
+                for (bool moved = true; moved;) {
+                    moved = false;
+                    copy_links(current.second, level, links);
+                    for (const std::uint32_t id: links) {
+                        const float s = score(query, id);
+                        if (s > current.first) {
+                            current = {s, id};
+                            moved = true;
+                        }
+                    }
+                }
+                return current;
+            }
+
+            bool deleted(std::uint32_t id) const {
+                return node(id).deleted.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * The ef best nodes on `level` reachable from `entries`, best first. With
+             * `live_only`, tombstones are walked through but take none of the ef places.
+             */
+            std::vector<Scored> search_layer(const float *query, const std::vector<Scored> &entries, std::size_t ef,
+                                             int level, bool live_only = false) const {
+                const VisitedLease visited(*this);
+                std::priority_queue<Scored> candidates;
+                std::priority_queue<Scored, std::vector<Scored>, std::greater<> > results;
+                for (const Scored &entry: entries) {
+                    if (!visited->visit(entry.second)) continue;
+                    candidates.push(entry);
+                    if (live_only && deleted(entry.second)) continue;
+                    results.push(entry);
+                    if (results.size() > ef) results.pop();
+                }
+
+                std::vector<std::uint32_t> links;
+                while (!candidates.empty()) {
+                    const Scored best = candidates.top();
+                    if (results.size() >= ef && best.first < results.top().first) break;
+                    candidates.pop();
+                    copy_links(best.second, level, links);
+                    // the vectors are scattered; start fetching them all before scoring the first
+                    for (const std::uint32_t id: links) __builtin_prefetch(values(id));
+                    for (const std::uint32_t id: links) {
+                        if (!visited->visit(id)) continue;
+                        const float s = score(query, id);
+                        if (results.size() < ef || s > results.top().first) {
+                            candidates.emplace(s, id);
+                            if (live_only && deleted(id)) continue;
+                            results.emplace(s, id);
+                            if (results.size() > ef) results.pop();
+                        }
+                    }
+                }
+
+                std::vector<Scored> found(results.size());
+                for (auto it = found.rbegin(); it != found.rend(); ++it) {
+                    *it = results.top();
+                    results.pop();
+                }
+                return found;
+            }
+
+            /**
+             * Up to `count` of `candidates` (best first), skipping any closer to one already
+             * kept than to the target, so that links spread out instead of clustering.
+             */
+            std::vector<std::uint32_t> select(const std::vector<Scored> &candidates, std::size_t count) const {
+                std::vector<std::uint32_t> kept;
+                kept.reserve(count);
+                for (const auto &[s, id]: candidates) {
+                    if (kept.size() >= count) break;
+                    const float *candidate = values(id);
+                    const bool diverse = std::none_of(kept.begin(), kept.end(), [&](std::uint32_t other) {
+                        return dot(candidate, values(other), config.dimension) > s;
+                    });
+                    if (diverse) kept.push_back(id);
+                }
+                return kept;
+            }
+
+            /**
+             * Links each of `neighbors` back to `id` on `level`, pruning lists that overflow.
+             */
+            void connect(std::uint32_t id, int level, const std::vector<std::uint32_t> &neighbors) {
+                const float *added = values(id);
+                std::vector<Scored> candidates;
+                for (const std::uint32_t neighbor: neighbors) {
+                    Node &other = node(neighbor);
+                    const std::lock_guard lock(other.mutex);
+                    std::vector<std::uint32_t> &links = other.links[level];
+                    if (std::find(links.begin(), links.end(), id) != links.end()) continue;
+                    if (links.size() < max_links(level)) {
+                        links.push_back(id);
+                        continue;
+                    }
+                    const float *base = values(neighbor);
+                    candidates.clear();
+                    candidates.emplace_back(dot(base, added, config.dimension), id);
+                    for (const std::uint32_t linked: links) {
+                        candidates.emplace_back(dot(base, values(linked), config.dimension), linked);
+                    }
+                    std::sort(candidates.begin(), candidates.end(), std::greater<>());
+                    links = select(candidates, max_links(level));
+                }
+            }
+
+            void add(std::uint32_t label, const float *input) {
+                const std::shared_lock structure(structure_mutex);
+                const std::uint32_t id = allocate();
+                float *stored = values(id);
+                std::memcpy(stored, input, config.dimension * sizeof(float));
+                if (config.metric == EmbeddingMetric::Cosine) normalize(stored, config.dimension);
+
+                const int level = random_level(id);
+                Node &added = node(id);
+                {
+                    const std::lock_guard lock(added.mutex);
+                    added.label = label;
+                    added.level = level;
+                    added.links.resize(static_cast<std::size_t>(level) + 1);
+                }
+
+                // an insert that will raise the top layer keeps others from doing so meanwhile
+                std::unique_lock top(top_mutex, std::defer_lock);
+                std::uint32_t entry_point;
+                int top_level;
+                {
+                    const std::lock_guard lock(entry_mutex);
+                    entry_point = entry;
+                    top_level = max_level;
+                }
+                if (level > top_level) {
+                    top.lock();
+                    const std::lock_guard lock(entry_mutex);
+                    entry_point = entry;
+                    top_level = max_level;
+                    if (level <= top_level) top.unlock();
+                }
+
+                if (entry_point != kNone) {
+                    Scored current{score(stored, entry_point), entry_point};
+                    for (int l = top_level; l > level; --l) current = greedy(stored, current, l);
+                    std::vector<Scored> entries{current};
+                    for (int l = std::min(level, top_level); l >= 0; --l) {
+                        std::vector<Scored> found = search_layer(stored, entries, config.ef_construction, l);
+                        std::erase_if(found, [id](const Scored &scored) { return scored.second == id; });
+                        const std::vector<std::uint32_t> selected = select(found, config.m);
+                        {
+                            const std::lock_guard lock(added.mutex);
+                            added.links[static_cast<std::size_t>(l)] = selected;
+                        }
+                        connect(id, l, selected);
+                        if (!found.empty()) entries = std::move(found);
+                    }
+                }
+                if (level > top_level) {
+                    const std::lock_guard lock(entry_mutex);
+                    entry = id;
+                    max_level = level;
+                }
+
+                const std::lock_guard lock(labels_mutex);
+                const auto [known, inserted] = nodes_by_label.try_emplace(label, id);
+                if (!inserted) {
+                    node(known->second).deleted.store(true, std::memory_order_relaxed);
+                    known->second = id;
+                    ++tombstones;
+                }
+            }
+
+            /**
+             * Whether tombstones outnumber the live nodes, so that rebuilding without them
+             * costs each replaced label no more than one insert.
+             */
+            bool compaction_due() const {
+                const std::lock_guard lock(labels_mutex);
+                return tombstones >= kMinCompaction && tombstones > nodes_by_label.size();
+            }
+
+            /**
+             * Rebuilds the graph from the live nodes, in the order they were added, and
+             * frees the tombstones; excludes add() and search() while it runs.
+             */
+            void compact() {
+                const std::unique_lock structure(structure_mutex);
+                if (!compaction_due()) return;
+                std::vector<std::pair<std::uint32_t, std::uint32_t> > live; // (node, label)
+                {
+                    const std::lock_guard lock(labels_mutex);
+                    live.reserve(nodes_by_label.size());
+                    for (const auto &[label, id]: nodes_by_label) live.emplace_back(id, label);
+                }
+                std::sort(live.begin(), live.end());
+                Impl rebuilt(config);
+                for (const auto &[id, label]: live) rebuilt.add(label, values(id));
+
+                // the old graph leaves with `rebuilt`
+                segments.swap(rebuilt.segments);
+                owned.swap(rebuilt.owned);
+                next.store(rebuilt.next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                {
+                    const std::lock_guard lock(entry_mutex);
+                    entry = rebuilt.entry;
+                    max_level = rebuilt.max_level;
+                }
+                const std::lock_guard lock(labels_mutex);
+                nodes_by_label.swap(rebuilt.nodes_by_label);
+                tombstones = 0;
+            }
+
+            HnswConfig config;
+            double level_scale = 1.0;
+            std::unique_ptr<std::atomic<Segment *>[]> segments;
+            std::vector<std::unique_ptr<Segment> > owned;
+            std::mutex grow_mutex;
+            std::atomic<std::uint32_t> next{0};
+            DotProduct dot;
+
+            // add() and search() shared, save() and relabel() exclusive
+            mutable std::shared_mutex structure_mutex;
+            std::mutex top_mutex;
+            mutable std::mutex entry_mutex;
+            std::uint32_t entry = kNone;
+            int max_level = -1;
+
+            mutable std::mutex labels_mutex;
+            std::unordered_map<std::uint32_t, std::uint32_t> nodes_by_label;
+            // replaced nodes still in the graph
+            std::size_t tombstones = 0;
+
+            mutable std::mutex pool_mutex;
+            mutable std::vector<std::unique_ptr<Visited> > pool;
+        };
+
+        HnswIndex::HnswIndex(HnswConfig config) : impl_(std::make_unique<Impl>(config)) {
+        }
+
+        HnswIndex::~HnswIndex() = default;
+
+        const HnswConfig &HnswIndex::config() const {
+            return impl_->config;
+        }
+
+        void HnswIndex::add(std::uint32_t label, const float *values) {
+            impl_->add(label, values);
+            if (impl_->compaction_due()) impl_->compact();
+        }
+
+        void HnswIndex::add_all(const std::vector<std::uint32_t> &labels, const float *values, std::size_t threads) {
+            std::atomic<std::size_t> next{0};
+            std::exception_ptr failure;
+            std::mutex failure_mutex;
+            auto work = [&]() {
+                try {
+                    for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < labels.size();) {
+                        impl_->add(labels[i], values + i * impl_->config.dimension);
+                    }
+                } catch (...) {
+                    const std::lock_guard lock(failure_mutex);
+                    if (!failure) failure = std::current_exception();
+                    next.store(labels.size(), std::memory_order_relaxed);
+                }
+            };
+            std::vector<std::thread> workers;
+            for (std::size_t i = 1; i < threads; ++i) workers.emplace_back(work);
+            work();
+            for (auto &worker: workers) worker.join();
+            if (failure) std::rethrow_exception(failure);
+            if (impl_->compaction_due()) impl_->compact();
+        }
+
+        std::vector<std::pair<float, std::uint32_t> > HnswIndex::search(const float *query, std::size_t k,
+                                                                        std::size_t ef) const {
+            if (k == 0) return {};
+            const std::shared_lock structure(impl_->structure_mutex);
+            std::uint32_t entry_point;
+            int top_level;
+            {
+                const std::lock_guard lock(impl_->entry_mutex);
+                entry_point = impl_->entry;
+                top_level = impl_->max_level;
+            }
+            if (entry_point == kNone) return {};
+
+            std::vector<float> normalized(query, query + impl_->config.dimension);
+            if (impl_->config.metric == EmbeddingMetric::Cosine) normalize(normalized.data(), normalized.size());
+
+            Scored current{impl_->score(normalized.data(), entry_point), entry_point};
+            for (int level = top_level; level > 0; --level) current = impl_->greedy(normalized.data(), current, level);
+            const std::vector<Scored> found = impl_->search_layer(
+                normalized.data(), {current}, std::max({ef == 0 ? impl_->config.ef_search : ef, k}), 0, true);
+
+            std::vector<std::pair<float, std::uint32_t> > result;
+            result.reserve(std::min(k, found.size()));
+            for (const auto &[score, id]: found) {
+                if (result.size() == k) break;
+                result.emplace_back(score, impl_->node(id).label);
+            }
+            return result;
+        }
+
+        std::vector<float> HnswIndex::vector(std::uint32_t label) const {
+            const std::shared_lock structure(impl_->structure_mutex);
+            std::uint32_t id;
+            {
+                const std::lock_guard lock(impl_->labels_mutex);
+                const auto known = impl_->nodes_by_label.find(label);
+                if (known == impl_->nodes_by_label.end()) return {};
+                id = known->second;
+            }
+            const float *values = impl_->values(id);
+            return {values, values + impl_->config.dimension};
+        }
+
+        std::size_t HnswIndex::size() const {
+            const std::lock_guard lock(impl_->labels_mutex);
+            return impl_->nodes_by_label.size();
+        }
+
+        void HnswIndex::relabel(const std::function<std::uint32_t(std::uint32_t)> &rename) {
+            const std::unique_lock structure(impl_->structure_mutex);
+            const std::lock_guard lock(impl_->labels_mutex);
+            std::unordered_map<std::uint32_t, std::uint32_t> renamed;
+            renamed.reserve(impl_->nodes_by_label.size());
+            for (const auto &[label, id]: impl_->nodes_by_label) {
+                Node &live = impl_->node(id);
+                live.label = rename(label);
+                renamed[live.label] = id;
+            }
+            impl_->nodes_by_label.swap(renamed);
+        }
+
+        void HnswIndex::save(std::ostream &out) const {
+            const std::unique_lock structure(impl_->structure_mutex);
+            const HnswConfig &config = impl_->config;
+            out.write(kMagic, sizeof(kMagic));
+            put<std::uint64_t>(out, config.dimension);
+            put<std::uint32_t>(out, static_cast<std::uint32_t>(config.metric));
+            put<std::uint64_t>(out, config.m);
+            put<std::uint64_t>(out, config.ef_construction);
+            put<std::uint64_t>(out, config.ef_search);
+            put<std::uint64_t>(out, config.seed);
+
+            const std::uint32_t count = impl_->next.load(std::memory_order_relaxed);
+            put<std::uint32_t>(out, count);
+            put<std::uint32_t>(out, impl_->entry);
+            put<std::int32_t>(out, impl_->max_level);
+            for (std::uint32_t id = 0; id < count; ++id) {
+                const Node &saved = impl_->node(id);
+                put<std::uint32_t>(out, saved.label);
+                put<std::int32_t>(out, saved.level);
+                put<std::uint8_t>(out, saved.deleted.load(std::memory_order_relaxed) ? 1 : 0);
+                out.write(reinterpret_cast<const char *>(impl_->values(id)),
+                          static_cast<std::streamsize>(config.dimension * sizeof(float)));
+                for (const std::vector<std::uint32_t> &links: saved.links) {
+                    put<std::uint32_t>(out, static_cast<std::uint32_t>(links.size()));
+                    out.write(reinterpret_cast<const char *>(links.data()),
+                              static_cast<std::streamsize>(links.size() * sizeof(std::uint32_t)));
+                }
+            }
+        }
+
+        std::unique_ptr<HnswIndex> HnswIndex::load(std::istream &in) {
+            char magic[sizeof(kMagic)];
+            in.read(magic, sizeof(magic));
+            if (!in || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) throw std::runtime_error("Not an HNSW index");
+
+            HnswConfig config;
+            config.dimension = get<std::uint64_t>(in);
+            const auto metric = get<std::uint32_t>(in);
+            config.m = get<std::uint64_t>(in);
+            config.ef_construction = get<std::uint64_t>(in);
+            config.ef_search = get<std::uint64_t>(in);
+            config.seed = get<std::uint64_t>(in);
+            if (config.dimension == 0 || config.dimension > (1u << 16) || metric > 1 || config.m > (1u << 16)) {
+                throw std::runtime_error("Corrupt HNSW index header");
+            }
+            config.metric = static_cast<EmbeddingMetric>(metric);
+
+            auto index = std::make_unique<HnswIndex>(config);
+            Impl &impl = *index->impl_;
+            const auto count = get<std::uint32_t>(in);
+            const auto entry = get<std::uint32_t>(in);
+            const auto max_level = get<std::int32_t>(in);
+            if ((entry == kNone) != (count == 0) || (entry != kNone && entry >= count) || max_level < -1 ||
+                max_level > kMaxLevel) {
+                throw std::runtime_error("Corrupt HNSW index header");
+            }
+            for (std::uint32_t i = 0; i < count; ++i) {
+                const std::uint32_t id = impl.allocate();
+                Node &loaded = impl.node(id);
+                loaded.label = get<std::uint32_t>(in);
+                loaded.level = get<std::int32_t>(in);
+                loaded.deleted.store(get<std::uint8_t>(in) != 0, std::memory_order_relaxed);
+                if (loaded.level < 0 || loaded.level > max_level) throw std::runtime_error("Corrupt HNSW node");
+                in.read(reinterpret_cast<char *>(impl.values(id)),
+                        static_cast<std::streamsize>(config.dimension * sizeof(float)));
+                loaded.links.resize(static_cast<std::size_t>(loaded.level) + 1);
+                for (int level = 0; level <= loaded.level; ++level) {
+                    const auto size = get<std::uint32_t>(in);
+                    if (size > impl.max_links(level)) throw std::runtime_error("Corrupt HNSW node");
+                    std::vector<std::uint32_t> &links = loaded.links[static_cast<std::size_t>(level)];
+                    links.resize(size);
+                    in.read(reinterpret_cast<char *>(links.data()),
+                            static_cast<std::streamsize>(size * sizeof(std::uint32_t)));
+                    if (!in) throw std::runtime_error("Truncated HNSW index");
+                    if (std::any_of(links.begin(), links.end(), [count](std::uint32_t link) { return link >= count; })) {
+                        throw std::runtime_error("Corrupt HNSW node");
+                    }
+                }
+                if (loaded.deleted.load(std::memory_order_relaxed)) {
+                    ++impl.tombstones;
+                } else {
+                    impl.nodes_by_label[loaded.label] = id;
+                }
+            }
+            // a search follows links on a layer into nodes it takes to be on that layer
+            for (std::uint32_t id = 0; id < count; ++id) {
+                const Node &loaded = impl.node(id);
+                for (std::size_t level = 0; level < loaded.links.size(); ++level) {
+                    for (const std::uint32_t link: loaded.links[level]) {
+                        if (static_cast<std::size_t>(impl.node(link).level) < level) {
+                            throw std::runtime_error("Corrupt HNSW node");
+                        }
+                    }
+                }
+            }
+            if (entry != kNone && impl.node(entry).level != max_level) throw std::runtime_error("Corrupt HNSW header");
+            impl.entry = entry;
+            impl.max_level = max_level;
+            return index;
+        }
+    } // namespace reco
+} // namespace beacon
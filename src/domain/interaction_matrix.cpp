@@ -0,0 +1,382 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/interaction_matrix.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace beacon {
+    namespace reco {
+        namespace {
+            using Entries = std::vector<std::pair<std::uint32_t, float> >;
+
+            /**
+             * Appends a row's entries, ascending by column, to `bytes`; returns its scale.
+             */
+            float encode(const Entries &entries, std::vector<std::uint8_t> &bytes) {
+                float largest = 0.0f;
+                for (const auto &[column, value]: entries) largest = std::max(largest, value);
+                const float scale = largest / 255.0f;
+                std::uint32_t previous = 0;
+                for (const auto &[column, value]: entries) {
+                    for (std::uint32_t gap = column - previous; ; gap >>= 7) {
+                        if (gap < 0x80) {
+                            bytes.push_back(static_cast<std::uint8_t>(gap));
+                            break;
+                        }
+                        bytes.push_back(static_cast<std::uint8_t>(gap | 0x80));
+                    }
+                    previous = column;
+                    const float code = std::round(value / scale);
+                    bytes.push_back(static_cast<std::uint8_t>(std::clamp(code, 1.0f, 255.0f)));
+                }
+                return scale;
+            }
+
+            /**
+             * Sorts by row then column and sums repeated pairs, swapping rows and columns first
+             * if `transposed`.
+             */
+            std::vector<Triplet> combined(std::vector<Triplet> triplets, bool transposed) {
+                if (transposed) {
+                    for (Triplet &triplet: triplets) std::swap(triplet.row, triplet.column);
+                }
+                std::sort(triplets.begin(), triplets.end(), [](const Triplet &a, const Triplet &b) {
+                    return a.row != b.row ? a.row < b.row : a.column < b.column;
+                });
+                std::size_t kept = 0;
+                for (std::size_t i = 0; i < triplets.size(); ++i) {
+                    if (kept > 0 && triplets[kept - 1].row == triplets[i].row &&
+                        triplets[kept - 1].column == triplets[i].column) {
+                        triplets[kept - 1].value += triplets[i].value;
+                    } else {
+                        triplets[kept++] = triplets[i];
+                    }
+                }
+                triplets.resize(kept);
+                return triplets;
+            }
+
+            /**
+             * Two runs' worth of triplets, each sorted by row then column, as one, summing the
+             * pairs both hold.
+             */
+            std::vector<Triplet> summed(const std::vector<Triplet> &older, const std::vector<Triplet> &newer) {
+                std::vector<Triplet> both;
+                both.reserve(older.size() + newer.size());
+                std::size_t i = 0;
+                std::size_t j = 0;
+                while (i < older.size() || j < newer.size()) {
+                    if (j == newer.size() || (i < older.size() && (older[i].row != newer[j].row
+                                                                       ? older[i].row < newer[j].row
+                                                                       : older[i].column < newer[j].column))) {
+                        both.push_back(older[i++]);
+                    } else if (i == older.size() || older[i].row != newer[j].row ||
+                               older[i].column != newer[j].column) {
+                        both.push_back(newer[j++]);
+                    } else {
+                        both.push_back(Triplet{older[i].row, older[i].column, older[i].value + newer[j].value});
+                        ++i;
+                        ++j;
+                    }
+                }
+                return both;
+            }
+
+            /**
+             * Adds the delta's entries on line `line` (as rows if `by_row`, else as columns)
+             * to `entries`, keeping them sorted.
+             */
+            void add_pending(Entries &entries, const std::vector<Triplet> &delta, std::uint32_t line, bool by_row) {
+                for (const Triplet &triplet: delta) {
+                    if ((by_row ? triplet.row : triplet.column) != line) continue;
+                    const std::uint32_t other = by_row ? triplet.column : triplet.row;
+                    const auto at = std::lower_bound(entries.begin(), entries.end(), other,
+                                                     [](const auto &entry, std::uint32_t key) {
+                                                         return entry.first < key;
+                                                     });
+                    if (at != entries.end() && at->first == other) at->second += triplet.value;
+                    else entries.insert(at, {other, triplet.value});
+                }
+            }
+        } // namespace
+
+        PackedCsrMatrix PackedCsrMatrix::pack(const CsrMatrix &matrix) {
+            PackedCsrMatrix packed;
+            packed.rows_ = matrix.rows;
+            packed.columns_ = matrix.columns;
+            packed.nonzeros_ = matrix.nonzeros();
+            packed.offsets_.reserve(matrix.rows + 1);
+            packed.scales_.reserve(matrix.rows);
+            packed.bytes_.reserve(matrix.nonzeros() * 2);
+            Entries entries;
+            for (std::size_t row = 0; row < matrix.rows; ++row) {
+                entries.clear();
+                for (std::uint64_t i = matrix.offsets[row]; i < matrix.offsets[row + 1]; ++i) {
+                    entries.emplace_back(matrix.indices[i], matrix.values[i]);
+                }
+                packed.scales_.push_back(encode(entries, packed.bytes_));
+                packed.offsets_.push_back(packed.bytes_.size());
+            }
+            return packed;
+        }
+
+        CsrMatrix PackedCsrMatrix::unpack() const {
+            CsrMatrix matrix;
+            matrix.rows = rows_;
+            matrix.columns = columns_;
+            matrix.offsets.reserve(rows_ + 1);
+            matrix.indices.reserve(nonzeros_);
+            matrix.values.reserve(nonzeros_);
+            for (std::size_t row = 0; row < rows_; ++row) {
+                for_each(row, [&matrix](std::uint32_t column, float value) {
+                    matrix.indices.push_back(column);
+                    matrix.values.push_back(value);
+                });
+                matrix.offsets.push_back(matrix.indices.size());
+            }
+            return matrix;
+        }
+
+        PackedCsrMatrix PackedCsrMatrix::merge(const std::vector<Triplet> &triplets, std::size_t rows,
+                                               std::size_t columns) const {
+            PackedCsrMatrix merged;
+            merged.rows_ = std::max(rows_, rows);
+            merged.columns_ = std::max(columns_, columns);
+            for (const Triplet &triplet: triplets) {
+                merged.rows_ = std::max<std::size_t>(merged.rows_, triplet.row + std::size_t{1});
+                merged.columns_ = std::max<std::size_t>(merged.columns_, triplet.column + std::size_t{1});
+            }
+            merged.offsets_.reserve(merged.rows_ + 1);
+            merged.scales_.reserve(merged.rows_);
+            merged.bytes_.reserve(bytes_.size() + triplets.size() * 2);
+
+            merged.nonzeros_ = nonzeros_;
+            Entries entries;
+            std::size_t next = 0;
+            for (std::size_t row = 0; row < merged.rows_; ++row) {
+                const std::size_t first = next;
+                while (next < triplets.size() && triplets[next].row == row) ++next;
+                if (first == next) {
+                    if (row < rows_) {
+                        merged.bytes_.insert(merged.bytes_.end(),
+                                             bytes_.begin() + static_cast<std::ptrdiff_t>(offsets_[row]),
+                                             bytes_.begin() + static_cast<std::ptrdiff_t>(offsets_[row + 1]));
+                    }
+                    merged.scales_.push_back(row < rows_ ? scales_[row] : 0.0f);
+                    merged.offsets_.push_back(merged.bytes_.size());
+                    continue;
+                }
+                entries.clear();
+                for_each(row, [&entries](std::uint32_t column, float value) { entries.emplace_back(column, value); });
+                // both sides sorted by column: sum the shared ones, append the rest and merge
+                const std::size_t existing = entries.size();
+                for (std::size_t i = first, at = 0; i < next; ++i) {
+                    while (at < existing && entries[at].first < triplets[i].column) ++at;
+                    if (at < existing && entries[at].first == triplets[i].column) {
+                        entries[at].second += triplets[i].value;
+                    } else {
+                        entries.emplace_back(triplets[i].column, triplets[i].value);
+                    }
+                }
+                std::inplace_merge(entries.begin(), entries.begin() + static_cast<std::ptrdiff_t>(existing),
+                                   entries.end());
+                merged.nonzeros_ += entries.size() - existing;
+                merged.scales_.push_back(encode(entries, merged.bytes_));
+                merged.offsets_.push_back(merged.bytes_.size());
+            }
+            return merged;
+        }
+
+        std::size_t PackedCsrMatrix::memory_bytes() const {
+            return offsets_.capacity() * sizeof(std::uint64_t) + scales_.capacity() * sizeof(float) +
+                   bytes_.capacity();
+        }
+
+        InteractionMatrix::InteractionMatrix(std::size_t merge_every, std::size_t max_entries)
+            : merge_every_(merge_every), max_entries_(max_entries), state_(std::make_shared<const State>()) {
+        }
+
+        bool InteractionMatrix::add(std::uint32_t row, std::uint32_t column, float value) {
+            if (!(value > 0.0f) || !std::isfinite(value)) {
+                throw std::invalid_argument("Interaction weight must be positive, got " + std::to_string(value));
+            }
+            const std::lock_guard lock(mutex_);
+            delta_.push_back(Triplet{row, column, value});
+            return delta_.size() >= merge_every_;
+        }
+
+        void InteractionMatrix::merge() {
+            const std::lock_guard merging(merge_mutex_);
+            std::shared_ptr<const State> state;
+            {
+                const std::lock_guard lock(mutex_);
+                if (delta_.empty()) return;
+                merging_.swap(delta_);
+                state = state_;
+            }
+            auto run = std::make_shared<Run>();
+            run->by_row = combined(merging_, false);
+            run->by_column = combined(merging_, true);
+            auto next = std::make_shared<State>(*state);
+            next->runs.push_back(std::move(run));
+            {
+                const std::lock_guard lock(mutex_);
+                state_ = next;
+                merging_.clear();
+            }
+
+            while (next->runs.size() >= 2) {
+                const Run &newer = *next->runs.back();
+                const Run &older = *next->runs[next->runs.size() - 2];
+                if (newer.by_row.size() * 2 < older.by_row.size()) break;
+                auto both = std::make_shared<Run>();
+                both->by_row = summed(older.by_row, newer.by_row);
+                both->by_column = summed(older.by_column, newer.by_column);
+                auto after = std::make_shared<State>(*next);
+                after->runs.pop_back();
+                after->runs.back() = std::move(both);
+                next = std::move(after);
+                const std::lock_guard lock(mutex_);
+                state_ = next;
+            }
+
+            // the oldest run goes into the newest generation, or starts one if that is full
+            const std::size_t generation_entries = max_entries_ == 0
+                                                       ? std::numeric_limits<std::size_t>::max()
+                                                       : std::max<std::size_t>(max_entries_ / 4, 1);
+            const bool fresh = next->generations.empty() ||
+                               next->generations.back()->rows.nonzeros() >= generation_entries;
+            const std::size_t into = fresh ? 0 : next->generations.back()->rows.nonzeros();
+            if (next->runs.empty() || next->runs.front()->by_row.size() < into / 8) return;
+            const Run &oldest = *next->runs.front();
+            const Packed empty;
+            const Packed &base = fresh ? empty : *next->generations.back();
+            auto folded = std::make_shared<Packed>();
+            folded->rows = base.rows.merge(oldest.by_row, 0, 0);
+            folded->columns = base.columns.merge(oldest.by_column, folded->rows.columns(), folded->rows.rows());
+            auto after = std::make_shared<State>(*next);
+            after->runs.erase(after->runs.begin());
+            if (fresh) after->generations.push_back(std::move(folded));
+            else after->generations.back() = std::move(folded);
+            if (max_entries_ > 0) {
+                std::size_t entries = 0;
+                for (const auto &generation: after->generations) entries += generation->rows.nonzeros();
+                for (const auto &kept: after->runs) entries += kept->by_row.size();
+                while (after->generations.size() > 1 && entries > max_entries_) {
+                    entries -= after->generations.front()->rows.nonzeros();
+                    after->generations.erase(after->generations.begin());
+                }
+            }
+            const std::lock_guard lock(mutex_);
+            state_ = std::move(after);
+        }
+
+        std::vector<std::pair<std::uint32_t, float> > InteractionMatrix::line(std::uint32_t line, bool by_row) const {
+            Entries entries;
+            std::shared_ptr<const State> state;
+            std::vector<Triplet> pending;
+            {
+                const std::lock_guard lock(mutex_);
+                state = state_;
+                for (const std::vector<Triplet> *delta: {&merging_, &delta_}) {
+                    for (const Triplet &triplet: *delta) {
+                        if ((by_row ? triplet.row : triplet.column) == line) pending.push_back(triplet);
+                    }
+                }
+            }
+            for (const auto &generation: state->generations) {
+                (by_row ? generation->rows : generation->columns).for_each(line, [&entries](std::uint32_t other,
+                                                                                            float value) {
+                    entries.emplace_back(other, value);
+                });
+            }
+            for (const auto &run: state->runs) {
+                const std::vector<Triplet> &sorted = by_row ? run->by_row : run->by_column;
+                auto at = std::lower_bound(sorted.begin(), sorted.end(), line, [](const Triplet &triplet,
+                                                                                 std::uint32_t key) {
+                    return triplet.row < key;
+                });
+                for (; at != sorted.end() && at->row == line; ++at) entries.emplace_back(at->column, at->value);
+            }
+            // a pair may sit in several generations and runs
+            std::sort(entries.begin(), entries.end());
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < entries.size(); ++i) {
+                if (kept > 0 && entries[kept - 1].first == entries[i].first) entries[kept - 1].second += entries[i].second;
+                else entries[kept++] = entries[i];
+            }
+            entries.resize(kept);
+            add_pending(entries, pending, line, by_row);
+            return entries;
+        }
+
+        std::vector<std::pair<std::uint32_t, float> > InteractionMatrix::row(std::uint32_t row) const {
+            return line(row, true);
+        }
+
+        std::vector<std::pair<std::uint32_t, float> > InteractionMatrix::column(std::uint32_t column) const {
+            return line(column, false);
+        }
+
+        CsrMatrix InteractionMatrix::to_csr(std::size_t rows, std::size_t columns) const {
+            std::shared_ptr<const State> state;
+            std::vector<Triplet> triplets;
+            {
+                const std::lock_guard lock(mutex_);
+                state = state_;
+                triplets = merging_;
+                triplets.insert(triplets.end(), delta_.begin(), delta_.end());
+            }
+            for (const auto &generation: state->generations) {
+                rows = std::max(rows, generation->rows.rows());
+                columns = std::max({columns, generation->rows.columns(), generation->columns.rows()});
+                for (std::size_t row = 0; row < generation->rows.rows(); ++row) {
+                    generation->rows.for_each(row, [&triplets, row](std::uint32_t column, float value) {
+                        triplets.push_back(Triplet{static_cast<std::uint32_t>(row), column, value});
+                    });
+                }
+            }
+            for (const auto &run: state->runs) triplets.insert(triplets.end(), run->by_row.begin(), run->by_row.end());
+            for (const Triplet &triplet: triplets) {
+                rows = std::max<std::size_t>(rows, triplet.row + std::size_t{1});
+                columns = std::max<std::size_t>(columns, triplet.column + std::size_t{1});
+            }
+            return CsrMatrix::from_triplets(rows, columns, std::move(triplets));
+        }
+
+        std::size_t InteractionMatrix::nonzeros() const {
+            const std::lock_guard lock(mutex_);
+            std::size_t entries = 0;
+            for (const auto &generation: state_->generations) entries += generation->rows.nonzeros();
+            for (const auto &run: state_->runs) entries += run->by_row.size();
+            return entries;
+        }
+
+        std::size_t InteractionMatrix::pending() const {
+            const std::lock_guard lock(mutex_);
+            return delta_.size() + merging_.size();
+        }
+
+        std::size_t InteractionMatrix::generations() const {
+            const std::lock_guard lock(mutex_);
+            return state_->generations.size();
+        }
+
+        std::size_t InteractionMatrix::memory_bytes() const {
+            const std::lock_guard lock(mutex_);
+            std::size_t bytes = (delta_.capacity() + merging_.capacity()) * sizeof(Triplet);
+            for (const auto &generation: state_->generations) {
+                bytes += generation->rows.memory_bytes() + generation->columns.memory_bytes();
+            }
+            for (const auto &run: state_->runs) {
+                bytes += (run->by_row.capacity() + run->by_column.capacity()) * sizeof(Triplet);
+            }
+            return bytes;
+        }
+    } // namespace reco
+} // namespace beacon
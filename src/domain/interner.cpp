@@ -0,0 +1,431 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/interner.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace beacon {
+    namespace {
+        constexpr unsigned kShardBits = 6;
+        constexpr std::size_t kShards = std::size_t{1} << kShardBits;
+        constexpr std::uint32_t kEmpty = 0xffffffffu;
+        constexpr std::size_t kChunkBytes = std::size_t{1} << 18;
+        // segment s of the reverse table holds ids [kFirstSegment * (2^s - 1), kFirstSegment *
+        // (2^(s + 1) - 1)), so 23 of them cover every uint32
+        constexpr std::size_t kFirstSegment = 1024;
+        constexpr std::size_t kSegments = 23;
+        constexpr char kMagic[8] = {'B', 'I', 'N', 'T', 'E', 'R', 'N', '\1'};
+        // an id's references: whether intern() pinned it, whether its bytes are its own
+        // allocation rather than the arena's, and how many acquire() took
+        constexpr std::uint32_t kPinned = 0x80000000u;
+        constexpr std::uint32_t kLoose = 0x40000000u;
+        constexpr std::uint32_t kCount = kLoose - 1;
+
+        // data is null and refs 0 while the id is free
+        struct Entry {
+            const char *data;
+            std::uint32_t length;
+            std::uint32_t refs;
+        };
+
+        // the low 32 bits of the hash pick the slot and spare most string comparisons
+        struct Slot {
+            std::uint32_t hash;
+            std::uint32_t id;
+        };
+
+        std::uint64_t hash_of(std::string_view name) {
+            // std::hash may be weak in the high bits that pick the shard, so mix it
+            std::uint64_t x = std::hash<std::string_view>{}(name);
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+
+        std::size_t segment_of(std::uint32_t id) {
+            return static_cast<std::size_t>(std::bit_width(id / kFirstSegment + 1)) - 1;
+        }
+
+        std::size_t segment_start(std::size_t segment) {
+            return kFirstSegment * ((std::size_t{1} << segment) - 1);
+        }
+    } // namespace
+
+    struct Interner::Impl {
+        struct alignas(64) Shard {
+            mutable std::shared_mutex mutex;
+            std::vector<Slot> slots = std::vector<Slot>(16, Slot{0, kEmpty});
+            std::size_t used = 0;
+        };
+
+        std::array<Shard, kShards> shards;
+        std::array<std::atomic<Entry *>, kSegments> segments{};
+        std::atomic<std::uint32_t> size{0};
+
+        // hands out ids; guards everything below
+        mutable std::mutex arena_mutex;
+        std::array<std::unique_ptr<Entry[]>, kSegments> owned_segments;
+        std::vector<std::unique_ptr<char[]> > chunks;
+        char *cursor = nullptr;
+        std::size_t left = 0;
+        std::size_t arena_bytes = 0;
+        // ids of released names, handed out again first, and the bytes of names outside the arena
+        std::vector<std::uint32_t> free_ids;
+        std::size_t loose_bytes = 0;
+
+        ~Impl() {
+            const std::uint32_t count = size.load(std::memory_order_relaxed);
+            for (std::uint32_t id = 0; id < count; ++id) {
+                const Entry &held = entry(id);
+                if (held.refs & kLoose) delete[] held.data;
+            }
+        }
+
+        static Shard &shard_of(std::array<Shard, kShards> &all, std::uint64_t hash) {
+            return all[hash >> (64 - kShardBits)];
+        }
+
+        Entry &entry(std::uint32_t id) const {
+            const std::size_t segment = segment_of(id);
+            return segments[segment].load(std::memory_order_acquire)[id - segment_start(segment)];
+        }
+
+        /**
+         * Counts a reference to `id`, or pins it; the caller holds its shard's lock.
+         */
+        void hold(std::uint32_t id, bool pin) const {
+            std::atomic_ref<std::uint32_t> refs(entry(id).refs);
+            if (!pin) {
+                refs.fetch_add(1, std::memory_order_relaxed);
+            } else if (!(refs.load(std::memory_order_relaxed) & kPinned)) {
+                refs.fetch_or(kPinned, std::memory_order_relaxed);
+            }
+        }
+
+        std::uint32_t get(std::string_view name, const std::function<void(std::uint32_t)> &created, bool pin);
+
+        std::string_view name(std::uint32_t id) const {
+            const Entry &found = entry(id);
+            return {found.data, found.length};
+        }
+
+        std::optional<std::uint32_t> lookup(const Shard &shard, std::uint64_t hash, std::string_view name) const {
+            const auto low = static_cast<std::uint32_t>(hash);
+            const std::size_t mask = shard.slots.size() - 1;
+            for (std::size_t i = low & mask;; i = (i + 1) & mask) {
+                const Slot &slot = shard.slots[i];
+                if (slot.id == kEmpty) return std::nullopt;
+                if (slot.hash == low && this->name(slot.id) == name) return slot.id;
+            }
+        }
+
+        /**
+         * Adds a slot; the caller holds the shard's lock exclusively.
+         */
+        static void insert(Shard &shard, std::uint64_t hash, std::uint32_t id) {
+            if ((shard.used + 1) * 10 > shard.slots.size() * 7) {
+                std::vector<Slot> grown(shard.slots.size() * 2, Slot{0, kEmpty});
+                const std::size_t mask = grown.size() - 1;
+                for (const Slot &slot: shard.slots) {
+                    if (slot.id == kEmpty) continue;
+                    std::size_t i = slot.hash & mask;
+                    while (grown[i].id != kEmpty) i = (i + 1) & mask;
+                    grown[i] = slot;
+                }
+                shard.slots = std::move(grown);
+            }
+            const auto low = static_cast<std::uint32_t>(hash);
+            const std::size_t mask = shard.slots.size() - 1;
+            std::size_t i = low & mask;
+            while (shard.slots[i].id != kEmpty) i = (i + 1) & mask;
+            shard.slots[i] = Slot{low, id};
+            ++shard.used;
+        }
+
+        /**
+         * Removes `id`'s slot, shifting back the slots that probed past it; the caller holds
+         * the shard's lock exclusively.
+         */
+        static void erase(Shard &shard, std::uint64_t hash, std::uint32_t id) {
+            const std::size_t mask = shard.slots.size() - 1;
+            std::size_t hole = static_cast<std::uint32_t>(hash) & mask;
+            while (shard.slots[hole].id != id) hole = (hole + 1) & mask;
+            for (std::size_t i = (hole + 1) & mask; shard.slots[i].id != kEmpty; i = (i + 1) & mask) {
+                // a slot may fill the hole unless its home lies after the hole, up to it
+                const std::size_t home = shard.slots[i].hash & mask;
+                if (((i - home) & mask) >= ((i - hole) & mask)) {
+                    shard.slots[hole] = shard.slots[i];
+                    hole = i;
+                }
+            }
+            shard.slots[hole] = Slot{0, kEmpty};
+            --shard.used;
+        }
+
+        /**
+         * Makes room for `id` in the reverse table; under arena_mutex.
+         */
+        void ensure_segment(std::uint32_t id) {
+            const std::size_t segment = segment_of(id);
+            if (owned_segments[segment]) return;
+            owned_segments[segment] = std::make_unique<Entry[]>(kFirstSegment << segment);
+            segments[segment].store(owned_segments[segment].get(), std::memory_order_release);
+        }
+
+        /**
+         * Copies `name` into the arena; under arena_mutex.
+         */
+        const char *store(std::string_view name) {
+            if (name.size() > kChunkBytes / 4) {
+                // a long string gets a chunk of its own rather than wasting the rest of the current one
+                chunks.push_back(std::make_unique<char[]>(name.size()));
+                arena_bytes += name.size();
+                std::memcpy(chunks.back().get(), name.data(), name.size());
+                return chunks.back().get();
+            }
+            if (name.size() > left) {
+                chunks.push_back(std::make_unique<char[]>(kChunkBytes));
+                arena_bytes += kChunkBytes;
+                cursor = chunks.back().get();
+                left = kChunkBytes;
+            }
+            char *stored = cursor;
+            if (!name.empty()) std::memcpy(stored, name.data(), name.size());
+            cursor += name.size();
+            left -= name.size();
+            return stored;
+        }
+
+        /**
+         * Copies `name` to an allocation of its own, which release() can free; under
+         * arena_mutex.
+         */
+        const char *store_loose(std::string_view name) {
+            char *stored = new char[std::max<std::size_t>(name.size(), 1)];
+            if (!name.empty()) std::memcpy(stored, name.data(), name.size());
+            loose_bytes += name.size();
+            return stored;
+        }
+
+        /**
+         * Drops every name; under arena_mutex with no other user, and no name acquired.
+         */
+        void clear() {
+            for (Shard &shard: shards) {
+                shard.slots.assign(16, Slot{0, kEmpty});
+                shard.used = 0;
+            }
+            for (std::size_t segment = 0; segment < kSegments; ++segment) {
+                segments[segment].store(nullptr, std::memory_order_relaxed);
+                owned_segments[segment].reset();
+            }
+            chunks.clear();
+            cursor = nullptr;
+            left = 0;
+            arena_bytes = 0;
+            free_ids.clear();
+            size.store(0, std::memory_order_release);
+        }
+    };
+
+    Interner::Interner() : impl_(std::make_unique<Impl>()) {
+    }
+
+    Interner::~Interner() = default;
+
+    std::uint32_t Interner::Impl::get(std::string_view name, const std::function<void(std::uint32_t)> &created,
+                                      bool pin) {
+        const std::uint64_t hash = hash_of(name);
+        Shard &shard = shard_of(shards, hash);
+        {
+            const std::shared_lock lock(shard.mutex);
+            if (const auto known = lookup(shard, hash, name)) {
+                hold(*known, pin);
+                return *known;
+            }
+        }
+        const std::unique_lock lock(shard.mutex);
+        if (const auto known = lookup(shard, hash, name)) {
+            hold(*known, pin);
+            return *known;
+        }
+        std::uint32_t id;
+        {
+            const std::lock_guard arena(arena_mutex);
+            const std::uint32_t count = size.load(std::memory_order_relaxed);
+            if (!free_ids.empty()) {
+                id = free_ids.back();
+                free_ids.pop_back();
+            } else {
+                id = count;
+                if (id == kEmpty) throw std::length_error("Interner is full");
+                ensure_segment(id);
+            }
+            Entry &created_entry = owned_segments[segment_of(id)][id - segment_start(segment_of(id))];
+            created_entry = pin
+                                ? Entry{store(name), static_cast<std::uint32_t>(name.size()), kPinned}
+                                : Entry{store_loose(name), static_cast<std::uint32_t>(name.size()), kLoose | 1};
+            // whatever `created` sets up for the id is in place before size() shows it
+            if (created) created(id);
+            if (id == count) size.store(id + 1, std::memory_order_release);
+        }
+        insert(shard, hash, id);
+        return id;
+    }
+
+    std::uint32_t Interner::intern(std::string_view name, const std::function<void(std::uint32_t)> &created) {
+        return impl_->get(name, created, true);
+    }
+
+    std::uint32_t Interner::acquire(std::string_view name, const std::function<void(std::uint32_t)> &created) {
+        return impl_->get(name, created, false);
+    }
+
+    bool Interner::release(std::uint32_t id) {
+        Entry &held = impl_->entry(id);
+        std::atomic_ref<std::uint32_t> refs(held.refs);
+        // not the last reference: no lock needed
+        for (std::uint32_t current = refs.load(std::memory_order_relaxed);
+             (current & kPinned) || (current & kCount) > 1;) {
+            // released, so that this holder's reads come before whoever frees the name
+            if (refs.compare_exchange_weak(current, current - 1, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+                return false;
+            }
+        }
+        // Maybe the last: decided under the shard's lock, which acquire() takes to add one.
+        const std::string_view name(held.data, held.length);
+        const std::uint64_t hash = hash_of(name);
+        Impl::Shard &shard = Impl::shard_of(impl_->shards, hash);
+        const std::unique_lock lock(shard.mutex);
+        if (((refs.fetch_sub(1, std::memory_order_acq_rel) - 1) & ~kLoose) != 0) return false;
+        Impl::erase(shard, hash, id);
+        const std::lock_guard arena(impl_->arena_mutex);
+        delete[] held.data;
+        impl_->loose_bytes -= held.length;
+        held = Entry{nullptr, 0, 0};
+        impl_->free_ids.push_back(id);
+        return true;
+    }
+
+    std::optional<std::uint32_t> Interner::find(std::string_view name) const {
+        const std::uint64_t hash = hash_of(name);
+        const Impl::Shard &shard = impl_->shards[hash >> (64 - kShardBits)];
+        const std::shared_lock lock(shard.mutex);
+        return impl_->lookup(shard, hash, name);
+    }
+
+    std::string_view Interner::name(std::uint32_t id) const {
+        return impl_->name(id);
+    }
+
+    std::size_t Interner::size() const {
+        return impl_->size.load(std::memory_order_acquire);
+    }
+
+    std::size_t Interner::names() const {
+        const std::lock_guard arena(impl_->arena_mutex);
+        return impl_->size.load(std::memory_order_relaxed) - impl_->free_ids.size();
+    }
+
+    std::size_t Interner::memory_bytes() const {
+        std::size_t bytes = 0;
+        for (const Impl::Shard &shard: impl_->shards) {
+            const std::shared_lock lock(shard.mutex);
+            bytes += shard.slots.capacity() * sizeof(Slot);
+        }
+        const std::lock_guard arena(impl_->arena_mutex);
+        bytes += impl_->arena_bytes + impl_->loose_bytes + impl_->free_ids.capacity() * sizeof(std::uint32_t);
+        for (std::size_t segment = 0; segment < kSegments; ++segment) {
+            if (impl_->owned_segments[segment]) bytes += (kFirstSegment << segment) * sizeof(Entry);
+        }
+        return bytes;
+    }
+
+    // A snapshot: the magic, the number of ids, each name's length in id order (kEmpty for a
+    // free id), then all of their bytes back to back.
+    void Interner::snapshot(std::ostream &out) const {
+        const std::lock_guard arena(impl_->arena_mutex);
+        const std::uint32_t count = impl_->size.load(std::memory_order_relaxed);
+        std::vector<std::uint32_t> lengths(count);
+        for (std::uint32_t id = 0; id < count; ++id) {
+            Entry &held = impl_->entry(id);
+            const bool free = std::atomic_ref<std::uint32_t>(held.refs).load(std::memory_order_relaxed) == 0;
+            lengths[id] = free ? kEmpty : held.length;
+        }
+        out.write(kMagic, sizeof(kMagic));
+        out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char *>(lengths.data()),
+                  static_cast<std::streamsize>(lengths.size() * sizeof(std::uint32_t)));
+        for (std::uint32_t id = 0; id < count; ++id) {
+            if (lengths[id] != kEmpty) out.write(impl_->entry(id).data, static_cast<std::streamsize>(lengths[id]));
+        }
+    }
+
+    void Interner::restore(std::istream &in) {
+        char magic[sizeof(kMagic)] = {};
+        std::uint32_t count = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char *>(&count), sizeof(count));
+        if (!in || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || count == kEmpty) {
+            throw std::runtime_error("Not an interner snapshot");
+        }
+        std::vector<std::uint32_t> lengths;
+        std::uint64_t total = 0;
+        // grown as read, so that a corrupt count fails at the end of the stream, not in new
+        for (std::uint32_t id = 0; id < count && in; ++id) {
+            std::uint32_t length = 0;
+            in.read(reinterpret_cast<char *>(&length), sizeof(length));
+            lengths.push_back(length);
+            if (length != kEmpty) total += length;
+        }
+        std::string bytes;
+        if (in && total <= (std::uint64_t{1} << 40)) {
+            bytes.resize(static_cast<std::size_t>(total));
+            in.read(bytes.data(), static_cast<std::streamsize>(total));
+        }
+        if (!in) throw std::runtime_error("Truncated interner snapshot");
+
+        const std::lock_guard arena(impl_->arena_mutex);
+        if (impl_->size.load(std::memory_order_relaxed) != 0) {
+            throw std::runtime_error("Cannot restore into an interner in use");
+        }
+        auto chunk = std::make_unique<char[]>(std::max<std::size_t>(bytes.size(), 1));
+        std::memcpy(chunk.get(), bytes.data(), bytes.size());
+        const char *cursor = chunk.get();
+        impl_->arena_bytes = bytes.size();
+        impl_->chunks.push_back(std::move(chunk));
+        for (std::uint32_t id = 0; id < count; ++id) {
+            impl_->ensure_segment(id);
+            Entry &restored = impl_->owned_segments[segment_of(id)][id - segment_start(segment_of(id))];
+            if (lengths[id] == kEmpty) {
+                restored = Entry{nullptr, 0, 0};
+                impl_->free_ids.push_back(id);
+                continue;
+            }
+            const std::string_view name(cursor, lengths[id]);
+            cursor += lengths[id];
+            restored = Entry{name.data(), lengths[id], kPinned};
+            const std::uint64_t hash = hash_of(name);
+            Impl::Shard &shard = Impl::shard_of(impl_->shards, hash);
+            if (impl_->lookup(shard, hash, name)) {
+                impl_->clear();
+                throw std::runtime_error("Interner snapshot repeats a name");
+            }
+            Impl::insert(shard, hash, id);
+        }
+        impl_->size.store(count, std::memory_order_release);
+    }
+} // namespace beacon
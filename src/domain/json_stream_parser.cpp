@@ -0,0 +1,470 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/json_stream_parser.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+
+namespace beacon::json_stream {
+    namespace {
+        bool is_whitespace(char c) {
+            return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        }
+
+        bool is_digit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        int hex_value(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        /**
+         * Checks the JSON number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+         */
+        bool valid_number(const std::string &text) {
+            std::size_t i = 0;
+            const std::size_t n = text.size();
+            if (i < n && text[i] == '-') ++i;
+            if (i == n) return false;
+            if (text[i] == '0') {
+                ++i;
+            } else if (is_digit(text[i])) {
+                while (i < n && is_digit(text[i])) ++i;
+            } else {
+                return false;
+            }
+            if (i < n && text[i] == '.') {
+                const std::size_t start = ++i;
+                while (i < n && is_digit(text[i])) ++i;
+                if (i == start) return false;
+            }
+            if (i < n && (text[i] == 'e' || text[i] == 'E')) {
+                ++i;
+                if (i < n && (text[i] == '+' || text[i] == '-')) ++i;
+                const std::size_t start = i;
+                while (i < n && is_digit(text[i])) ++i;
+                if (i == start) return false;
+            }
+            return i == n;
+        }
+    } // namespace
+
+    JsonStreamParser::JsonStreamParser(SaxHandler &handler, std::size_t max_depth)
+        : handler_(handler), max_depth_(max_depth) {
+    }
+
+    bool JsonStreamParser::feed(std::string_view chunk) {
+        if (failed_) return false;
+
+        const std::size_t n = chunk.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            if (state_ == State::String && utf8_remaining_ == 0 && high_surrogate_ == 0) {
+                // fast path: copy runs of plain ASCII string content in one go
+                std::size_t end = i;
+                while (end < n) {
+                    const auto c = static_cast<unsigned char>(chunk[end]);
+                    if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) break;
+                    ++end;
+                }
+                token_.append(chunk.data() + i, end - i);
+                offset_ += end - i;
+                i = end;
+                if (i == n) break;
+            }
+
+            if (!step(chunk[i])) return false;
+            ++offset_;
+        }
+        return true;
+    }
+
+    bool JsonStreamParser::finish() {
+        if (failed_) return false;
+        if (state_ == State::Number && !end_number()) return false;
+        if (state_ != State::Done) return fail("unexpected end of input");
+        return true;
+    }
+
+    void JsonStreamParser::reset() {
+        state_ = State::Value;
+        containers_.clear();
+        string_is_key_ = false;
+        token_.clear();
+        literal_ = nullptr;
+        literal_pos_ = 0;
+        unicode_ = 0;
+        unicode_digits_ = 0;
+        high_surrogate_ = 0;
+        utf8_remaining_ = 0;
+        utf8_lower_ = 0x80;
+        utf8_upper_ = 0xBF;
+        offset_ = 0;
+        failed_ = false;
+        error_.clear();
+    }
+
+    bool JsonStreamParser::fail(std::string message) {
+        failed_ = true;
+        error_ = std::move(message);
+        if (!error_.empty()) error_ += " at byte " + std::to_string(offset_);
+        return false;
+    }
+
+    bool JsonStreamParser::step(char c) {
+        switch (state_) {
+            case State::Value:
+                if (is_whitespace(c)) return true;
+                return begin_value(c);
+
+            case State::FirstKeyOrEnd:
+                if (is_whitespace(c)) return true;
+                if (c == '}') {
+                    containers_.pop_back();
+                    if (!handler_.end_object()) return fail("");
+                    return end_value();
+                }
+                [[fallthrough]];
+            case State::Key:
+                if (is_whitespace(c)) return true;
+                if (c != '"') return fail("expected object key");
+                string_is_key_ = true;
+                token_.clear();
+                state_ = State::String;
+                return true;
+
+            case State::Colon:
+                if (is_whitespace(c)) return true;
+                if (c != ':') return fail("expected ':'");
+                state_ = State::Value;
+                return true;
+
+            case State::FirstValueOrEnd:
+                if (is_whitespace(c)) return true;
+                if (c == ']') {
+                    containers_.pop_back();
+                    if (!handler_.end_array()) return fail("");
+                    return end_value();
+                }
+                return begin_value(c);
+
+            case State::CommaOrEnd:
+                if (is_whitespace(c)) return true;
+                if (c == ',') {
+                    state_ = containers_.back() == '{' ? State::Key : State::Value;
+                    return true;
+                }
+                if (c == '}' && containers_.back() == '{') {
+                    containers_.pop_back();
+                    if (!handler_.end_object()) return fail("");
+                    return end_value();
+                }
+                if (c == ']' && containers_.back() == '[') {
+                    containers_.pop_back();
+                    if (!handler_.end_array()) return fail("");
+                    return end_value();
+                }
+                return fail("expected ',' or end of container");
+
+            case State::String:
+                if (high_surrogate_ != 0 && c != '\\') return fail("unpaired UTF-16 surrogate");
+                if (c == '"') return end_string();
+                if (c == '\\') {
+                    if (utf8_remaining_ != 0) return fail("invalid UTF-8");
+                    state_ = State::Escape;
+                    return true;
+                }
+                if (static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+                return string_byte(static_cast<unsigned char>(c));
+
+            case State::Escape:
+                if (high_surrogate_ != 0 && c != 'u') return fail("unpaired UTF-16 surrogate");
+                state_ = State::String;
+                switch (c) {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        token_ += c;
+                        return true;
+                    case 'b':
+                        token_ += '\b';
+                        return true;
+                    case 'f':
+                        token_ += '\f';
+                        return true;
+                    case 'n':
+                        token_ += '\n';
+                        return true;
+                    case 'r':
+                        token_ += '\r';
+                        return true;
+                    case 't':
+                        token_ += '\t';
+                        return true;
+                    case 'u':
+                        unicode_ = 0;
+                        unicode_digits_ = 0;
+                        state_ = State::Unicode;
+                        return true;
+                    default:
+                        return fail("invalid escape");
+                }
+
+            case State::Unicode: {
+                const int digit = hex_value(c);
+                if (digit < 0) return fail("invalid \\u escape");
+                unicode_ = (unicode_ << 4) | static_cast<std::uint32_t>(digit);
+                if (++unicode_digits_ < 4) return true;
+
+                state_ = State::String;
+                if (high_surrogate_ != 0) {
+                    if (unicode_ < 0xDC00 || unicode_ > 0xDFFF) return fail("unpaired UTF-16 surrogate");
+                    const std::uint32_t code_point = 0x10000 + ((high_surrogate_ - 0xD800) << 10) + (unicode_ - 0xDC00);
+                    high_surrogate_ = 0;
+                    return append_code_point(code_point);
+                }
+                if (unicode_ >= 0xD800 && unicode_ <= 0xDBFF) {
+                    high_surrogate_ = unicode_;
+                    return true;
+                }
+                if (unicode_ >= 0xDC00 && unicode_ <= 0xDFFF) return fail("unpaired UTF-16 surrogate");
+                return append_code_point(unicode_);
+            }
+
+            case State::Number:
+                if (is_digit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+                    token_ += c;
+                    return true;
+                }
+                // the delimiter belongs to the enclosing structure
+                return end_number() && step(c);
+
+            case State::Literal:
+                if (c != literal_[literal_pos_]) return fail("invalid literal");
+                if (literal_[++literal_pos_] != '\0') return true;
+                if (literal_[0] == 'n') {
+                    if (!handler_.null()) return fail("");
+                } else if (!handler_.boolean(literal_[0] == 't')) {
+                    return fail("");
+                }
+                return end_value();
+
+            case State::Done:
+                if (is_whitespace(c)) return true;
+                return fail("unexpected data after JSON value");
+        }
+        return fail("invalid parser state");
+    }
+
+    bool JsonStreamParser::begin_value(char c) {
+        switch (c) {
+            case '{':
+                if (containers_.size() >= max_depth_) return fail("nesting too deep");
+                containers_.push_back('{');
+                if (!handler_.start_object()) return fail("");
+                state_ = State::FirstKeyOrEnd;
+                return true;
+            case '[':
+                if (containers_.size() >= max_depth_) return fail("nesting too deep");
+                containers_.push_back('[');
+                if (!handler_.start_array()) return fail("");
+                state_ = State::FirstValueOrEnd;
+                return true;
+            case '"':
+                string_is_key_ = false;
+                token_.clear();
+                state_ = State::String;
+                return true;
+            case 't':
+                literal_ = "true";
+                break;
+            case 'f':
+                literal_ = "false";
+                break;
+            case 'n':
+                literal_ = "null";
+                break;
+            default:
+                if (c == '-' || is_digit(c)) {
+                    token_.assign(1, c);
+                    state_ = State::Number;
+                    return true;
+                }
+                return fail("unexpected character");
+        }
+        literal_pos_ = 1;
+        state_ = State::Literal;
+        return true;
+    }
+
+    bool JsonStreamParser::end_value() {
+        state_ = containers_.empty() ? State::Done : State::CommaOrEnd;
+        return true;
+    }
+
+    bool JsonStreamParser::end_string() {
+        if (utf8_remaining_ != 0) return fail("invalid UTF-8");
+        if (string_is_key_) {
+            if (!handler_.key(token_)) return fail("");
+            state_ = State::Colon;
+            return true;
+        }
+        if (!handler_.string(token_)) return fail("");
+        return end_value();
+    }
+
+    bool JsonStreamParser::end_number() {
+        if (!valid_number(token_)) return fail("invalid number");
+
+        const bool integral = token_.find_first_of(".eE") == std::string::npos;
+        if (integral) {
+            errno = 0;
+            if (token_[0] == '-') {
+                const long long value = std::strtoll(token_.c_str(), nullptr, 10);
+                if (errno != ERANGE) return handler_.number_integer(value) ? end_value() : fail("");
+            } else {
+                const unsigned long long value = std::strtoull(token_.c_str(), nullptr, 10);
+                if (errno != ERANGE) return handler_.number_unsigned(value) ? end_value() : fail("");
+            }
+        }
+
+        // Too large for an integer, or not one. Like nlohmann::json, reject what overflows a double.
+        const double value = std::strtod(token_.c_str(), nullptr);
+        if (!std::isfinite(value)) return fail("number overflow");
+        if (!handler_.number_float(value)) return fail("");
+        return end_value();
+    }
+
+    bool JsonStreamParser::string_byte(unsigned char c) {
+        if (utf8_remaining_ > 0) {
+            if (c < utf8_lower_ || c > utf8_upper_) return fail("invalid UTF-8");
+            --utf8_remaining_;
+            utf8_lower_ = 0x80;
+            utf8_upper_ = 0xBF;
+        } else if (c >= 0x80) {
+            // lead byte: number of continuation bytes and the range of the first one
+            if (c >= 0xC2 && c <= 0xDF) {
+                utf8_remaining_ = 1;
+            } else if (c == 0xE0) {
+                utf8_remaining_ = 2;
+                utf8_lower_ = 0xA0;
+            } else if (c == 0xED) {
+                utf8_remaining_ = 2;
+                utf8_upper_ = 0x9F;
+            } else if (c >= 0xE1 && c <= 0xEF) {
+                utf8_remaining_ = 2;
+            } else if (c == 0xF0) {
+                utf8_remaining_ = 3;
+                utf8_lower_ = 0x90;
+            } else if (c >= 0xF1 && c <= 0xF3) {
+                utf8_remaining_ = 3;
+            } else if (c == 0xF4) {
+                utf8_remaining_ = 3;
+                utf8_upper_ = 0x8F;
+            } else {
+                return fail("invalid UTF-8");
+            }
+        }
+        token_ += static_cast<char>(c);
+        return true;
+    }
+
+    bool JsonStreamParser::append_code_point(std::uint32_t code_point) {
+        if (code_point < 0x80) {
+            token_ += static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+            token_ += static_cast<char>(0xC0 | (code_point >> 6));
+            token_ += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else if (code_point < 0x10000) {
+            token_ += static_cast<char>(0xE0 | (code_point >> 12));
+            token_ += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            token_ += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else {
+            token_ += static_cast<char>(0xF0 | (code_point >> 18));
+            token_ += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            token_ += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            token_ += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        return true;
+    }
+
+    nlohmann::json *DomBuilder::put(nlohmann::json value) {
+        if (stack_.empty()) {
+            root_ = std::move(value);
+            return &root_;
+        }
+        nlohmann::json &top = *stack_.back();
+        if (top.is_array()) {
+            top.push_back(std::move(value));
+            return &top.back();
+        }
+        *object_element_ = std::move(value);
+        return object_element_;
+    }
+
+    bool DomBuilder::null() {
+        put(nullptr);
+        return true;
+    }
+
+    bool DomBuilder::boolean(bool value) {
+        put(value);
+        return true;
+    }
+
+    bool DomBuilder::number_integer(std::int64_t value) {
+        put(value);
+        return true;
+    }
+
+    bool DomBuilder::number_unsigned(std::uint64_t value) {
+        put(value);
+        return true;
+    }
+
+    bool DomBuilder::number_float(double value) {
+        put(value);
+        return true;
+    }
+
+    bool DomBuilder::string(std::string &value) {
+        put(std::move(value));
+        return true;
+    }
+
+    bool DomBuilder::start_object() {
+        stack_.push_back(put(nlohmann::json::object()));
+        return true;
+    }
+
+    bool DomBuilder::key(std::string &value) {
+        object_element_ = &(*stack_.back())[value];
+        return true;
+    }
+
+    bool DomBuilder::end_object() {
+        stack_.pop_back();
+        return true;
+    }
+
+    bool DomBuilder::start_array() {
+        stack_.push_back(put(nlohmann::json::array()));
+        return true;
+    }
+
+    bool DomBuilder::end_array() {
+        stack_.pop_back();
+        return true;
+    }
+
+    void DomBuilder::reset() {
+        root_ = nlohmann::json();
+        stack_.clear();
+        object_element_ = nullptr;
+    }
+} // namespace beacon::json_stream
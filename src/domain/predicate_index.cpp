@@ -0,0 +1,408 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/predicate_index.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace beacon::filter {
+    namespace {
+        std::string to_pointer(const std::string &field) {
+            std::string pointer = (!field.empty() && field.front() == '/') ? field : "/" + field;
+            try {
+                [[maybe_unused]] const nlohmann::json::json_pointer parsed(pointer);
+            } catch (const nlohmann::json::exception &e) {
+                throw FilterError("Invalid field '" + field + "': " + e.what());
+            }
+            return pointer;
+        }
+
+        std::string required_key(const std::string &field, const nlohmann::json &value) {
+            std::string key = value_key(value);
+            if (key.empty()) {
+                throw FilterError("Field '" + field + "' can only be compared with scalar values");
+            }
+            return key;
+        }
+
+        Predicate range(const std::string &pointer, PredicateKind kind, const std::string &field,
+                        const nlohmann::json &bound) {
+            if (!bound.is_number()) {
+                throw FilterError("Range bound on field '" + field + "' must be a number");
+            }
+            Predicate predicate;
+            predicate.field = pointer;
+            predicate.kind = kind;
+            predicate.bound = bound.get<double>();
+            return predicate;
+        }
+
+        void insert_sorted(std::vector<std::pair<double, PredicateIndex::Slot> > &bounds, double bound,
+                           PredicateIndex::Slot slot) {
+            const std::pair<double, PredicateIndex::Slot> entry{bound, slot};
+            bounds.insert(std::upper_bound(bounds.begin(), bounds.end(), entry), entry);
+        }
+
+        void erase_sorted(std::vector<std::pair<double, PredicateIndex::Slot> > &bounds, double bound,
+                          PredicateIndex::Slot slot) {
+            const std::pair<double, PredicateIndex::Slot> entry{bound, slot};
+            const auto it = std::lower_bound(bounds.begin(), bounds.end(), entry);
+            if (it != bounds.end() && *it == entry) bounds.erase(it);
+        }
+    } // namespace
+
+    Filter parse_filter(const nlohmann::json &spec) {
+        Filter filter;
+        if (spec.is_null()) return filter;
+        if (!spec.is_object()) throw FilterError("Filter must be an object");
+
+        for (const auto &[field, condition]: spec.items()) {
+            const std::string pointer = to_pointer(field);
+
+            if (!condition.is_object()) {
+                filter.push_back(Predicate{pointer, PredicateKind::Equals, {required_key(field, condition)}, 0.0});
+                continue;
+            }
+
+            if (condition.empty()) throw FilterError("Empty condition on field '" + field + "'");
+            for (const auto &[op, operand]: condition.items()) {
+                if (op == "eq") {
+                    filter.push_back(Predicate{pointer, PredicateKind::Equals, {required_key(field, operand)}, 0.0});
+                } else if (op == "in") {
+                    if (!operand.is_array() || operand.empty()) {
+                        throw FilterError("'in' on field '" + field + "' needs a non-empty array");
+                    }
+                    Predicate predicate{pointer, PredicateKind::Equals, {}, 0.0};
+                    for (const auto &value: operand) {
+                        predicate.keys.push_back(required_key(field, value));
+                    }
+                    // duplicate values would count the predicate twice
+                    std::sort(predicate.keys.begin(), predicate.keys.end());
+                    predicate.keys.erase(std::unique(predicate.keys.begin(), predicate.keys.end()),
+                                         predicate.keys.end());
+                    filter.push_back(std::move(predicate));
+                } else if (op == "gt") {
+                    filter.push_back(range(pointer, PredicateKind::Greater, field, operand));
+                } else if (op == "gte") {
+                    filter.push_back(range(pointer, PredicateKind::GreaterEqual, field, operand));
+                } else if (op == "lt") {
+                    filter.push_back(range(pointer, PredicateKind::Less, field, operand));
+                } else if (op == "lte") {
+                    filter.push_back(range(pointer, PredicateKind::LessEqual, field, operand));
+                } else {
+                    throw FilterError("Unknown operator '" + op + "' on field '" + field + "'");
+                }
+            }
+        }
+        return filter;
+    }
+
+    bool evaluate(const Filter &filter, const nlohmann::json &payload) {
+        for (const Predicate &predicate: filter) {
+            const nlohmann::json::json_pointer pointer(predicate.field);
+            if (!payload.is_object() || !payload.contains(pointer)) return false;
+            const nlohmann::json &value = payload.at(pointer);
+
+            if (predicate.kind == PredicateKind::Equals) {
+                const std::string key = value_key(value);
+                if (std::find(predicate.keys.begin(), predicate.keys.end(), key) == predicate.keys.end()) return false;
+                continue;
+            }
+
+            if (!value.is_number()) return false;
+            const double x = value.get<double>();
+            switch (predicate.kind) {
+                case PredicateKind::Greater:
+                    if (!(x > predicate.bound)) return false;
+                    break;
+                case PredicateKind::GreaterEqual:
+                    if (!(x >= predicate.bound)) return false;
+                    break;
+                case PredicateKind::Less:
+                    if (!(x < predicate.bound)) return false;
+                    break;
+                case PredicateKind::LessEqual:
+                    if (!(x <= predicate.bound)) return false;
+                    break;
+                case PredicateKind::Equals:
+                    break;
+            }
+        }
+        return true;
+    }
+
+    std::string value_key(const nlohmann::json &value) {
+        switch (value.type()) {
+            case nlohmann::json::value_t::string:
+                return "s" + value.get_ref<const std::string &>();
+            case nlohmann::json::value_t::boolean:
+                return value.get<bool>() ? "b1" : "b0";
+            case nlohmann::json::value_t::null:
+                return "z";
+            // Integers by their exact digits, which a double loses past 2^53; a float only
+            // when it is not an integer itself.
+            case nlohmann::json::value_t::number_integer:
+                return "i" + std::to_string(value.get<std::int64_t>());
+            case nlohmann::json::value_t::number_unsigned:
+                return "i" + std::to_string(value.get<std::uint64_t>());
+            case nlohmann::json::value_t::number_float: {
+                const double number = value.get<double>();
+                // -0.0 folds into 0 here too
+                if (number == std::trunc(number) && number >= -0x1p63 && number < 0x1p63) {
+                    return "i" + std::to_string(static_cast<std::int64_t>(number));
+                }
+                if (number == std::trunc(number) && number >= 0.0 && number < 0x1p64) {
+                    return "i" + std::to_string(static_cast<std::uint64_t>(number));
+                }
+                std::string key(1 + sizeof(double), 'n');
+                std::memcpy(key.data() + 1, &number, sizeof(double));
+                return key;
+            }
+            default:
+                return "";
+        }
+    }
+
+    void PredicateIndex::add(Slot slot, const Filter &filter) {
+        if (slot >= entries_.size()) {
+            entries_.resize(slot + 1);
+            hits_.resize(slot + 1, 0);
+            stamps_.resize(slot + 1, 0);
+        }
+        Entry &entry = entries_[slot];
+        entry = Entry{};
+        entry.live = true;
+        stamps_[slot] = 0;
+
+        if (filter.empty()) {
+            unfiltered_.push_back(slot);
+            return;
+        }
+
+        // The access predicate is the equality with the fewest values: plain eq before IN.
+        const Predicate *access = nullptr;
+        for (const Predicate &predicate: filter) {
+            if (predicate.kind == PredicateKind::Equals &&
+                (access == nullptr || predicate.keys.size() < access->keys.size())) {
+                access = &predicate;
+            }
+        }
+
+        for (const Predicate &predicate: filter) {
+            const FieldId field = field_id(predicate.field);
+            if (&predicate == access) {
+                entry.access_field = field;
+                entry.access_keys = predicate.keys;
+                for (const std::string &key: predicate.keys) fields_[field].access[key].push_back(slot);
+                continue;
+            }
+
+            entry.conditions.push_back(Condition{field, predicate.kind, predicate.keys, predicate.bound});
+            if (access != nullptr) continue;
+
+            entry.counted = true;
+            Field &f = fields_[field];
+            switch (predicate.kind) {
+                case PredicateKind::Greater:
+                    insert_sorted(f.greater, predicate.bound, slot);
+                    break;
+                case PredicateKind::GreaterEqual:
+                    insert_sorted(f.greater_equal, predicate.bound, slot);
+                    break;
+                case PredicateKind::Less:
+                    insert_sorted(f.less, predicate.bound, slot);
+                    break;
+                case PredicateKind::LessEqual:
+                    insert_sorted(f.less_equal, predicate.bound, slot);
+                    break;
+                case PredicateKind::Equals:
+                    break;
+            }
+        }
+    }
+
+    void PredicateIndex::remove(Slot slot) {
+        if (slot >= entries_.size() || !entries_[slot].live) return;
+        Entry &entry = entries_[slot];
+
+        if (entry.conditions.empty() && entry.access_keys.empty()) {
+            unfiltered_.erase(std::remove(unfiltered_.begin(), unfiltered_.end(), slot), unfiltered_.end());
+        }
+
+        if (!entry.access_keys.empty()) {
+            auto &access = fields_[entry.access_field].access;
+            for (const std::string &key: entry.access_keys) {
+                const auto bucket = access.find(key);
+                if (bucket == access.end()) continue;
+                auto &slots = bucket->second;
+                const auto pos = std::find(slots.begin(), slots.end(), slot);
+                if (pos != slots.end()) {
+                    *pos = slots.back();
+                    slots.pop_back();
+                }
+                if (slots.empty()) access.erase(bucket);
+            }
+            release_field(entry.access_field);
+        }
+
+        for (const Condition &condition: entry.conditions) {
+            if (entry.counted) {
+                Field &f = fields_[condition.field];
+                switch (condition.kind) {
+                    case PredicateKind::Greater:
+                        erase_sorted(f.greater, condition.bound, slot);
+                        break;
+                    case PredicateKind::GreaterEqual:
+                        erase_sorted(f.greater_equal, condition.bound, slot);
+                        break;
+                    case PredicateKind::Less:
+                        erase_sorted(f.less, condition.bound, slot);
+                        break;
+                    case PredicateKind::LessEqual:
+                        erase_sorted(f.less_equal, condition.bound, slot);
+                        break;
+                    case PredicateKind::Equals:
+                        break;
+                }
+            }
+            release_field(condition.field);
+        }
+        entry = Entry{};
+    }
+
+    void PredicateIndex::match(const nlohmann::json &payload, std::vector<Slot> &out) {
+        out.insert(out.end(), unfiltered_.begin(), unfiltered_.end());
+        if (field_ids_.empty() || !payload.is_object()) return;
+
+        // Resolve every indexed field once; candidates below only read the cached values.
+        values_.resize(fields_.size());
+        value_keys_.resize(fields_.size());
+        for (const FieldId id: live_fields_) {
+            const Field &field = fields_[id];
+            values_[id] = payload.contains(field.pointer) ? &payload.at(field.pointer) : nullptr;
+            if (values_[id] != nullptr) value_keys_[id] = value_key(*values_[id]);
+        }
+
+        if (++epoch_ == 0) {
+            // the epoch wrapped, stale stamps could collide with it
+            std::fill(stamps_.begin(), stamps_.end(), 0);
+            epoch_ = 1;
+        }
+
+        for (const FieldId id: live_fields_) {
+            const nlohmann::json *value = values_[id];
+            if (value == nullptr) continue;
+            const Field &field = fields_[id];
+
+            if (!field.access.empty()) {
+                const auto bucket = field.access.find(value_keys_[id]);
+                if (bucket != field.access.end()) {
+                    for (const Slot slot: bucket->second) {
+                        const auto &conditions = entries_[slot].conditions;
+                        if (std::all_of(conditions.begin(), conditions.end(),
+                                        [this](const Condition &c) { return holds(c); })) {
+                            out.push_back(slot);
+                        }
+                    }
+                }
+            }
+
+            if (!value->is_number()) continue;
+            const double x = value->get<double>();
+
+            // Every bound array is sorted ascending, so the satisfied entries form a prefix or a suffix.
+            for (auto it = field.greater.begin(); it != field.greater.end() && it->first < x; ++it) {
+                hit(it->second, out);
+            }
+            for (auto it = field.greater_equal.begin(); it != field.greater_equal.end() && it->first <= x; ++it) {
+                hit(it->second, out);
+            }
+            const auto above = std::partition_point(field.less.begin(), field.less.end(),
+                                                    [x](const auto &entry) { return entry.first <= x; });
+            for (auto it = above; it != field.less.end(); ++it) {
+                hit(it->second, out);
+            }
+            const auto at_or_above = std::partition_point(field.less_equal.begin(), field.less_equal.end(),
+                                                          [x](const auto &entry) { return entry.first < x; });
+            for (auto it = at_or_above; it != field.less_equal.end(); ++it) {
+                hit(it->second, out);
+            }
+        }
+    }
+
+    PredicateIndex::FieldId PredicateIndex::field_id(const std::string &pointer) {
+        if (const auto known = field_ids_.find(pointer); known != field_ids_.end()) {
+            ++fields_[known->second].refs;
+            return known->second;
+        }
+
+        nlohmann::json::json_pointer parsed(pointer);
+        FieldId id;
+        if (free_fields_.empty()) {
+            id = static_cast<FieldId>(fields_.size());
+            fields_.emplace_back();
+        } else {
+            id = free_fields_.back();
+            free_fields_.pop_back();
+        }
+        Field &field = fields_[id];
+        field.name = pointer;
+        field.pointer = std::move(parsed);
+        field.refs = 1;
+        field.live = live_fields_.size();
+        live_fields_.push_back(id);
+        field_ids_.emplace(pointer, id);
+        return id;
+    }
+
+    void PredicateIndex::release_field(FieldId field) {
+        Field &f = fields_[field];
+        if (--f.refs > 0) return;
+
+        // Unreferenced: match stops resolving it and the next new field takes its id.
+        field_ids_.erase(f.name);
+        const FieldId moved = live_fields_.back();
+        live_fields_[f.live] = moved;
+        fields_[moved].live = f.live;
+        live_fields_.pop_back();
+        f = Field();
+        free_fields_.push_back(field);
+    }
+
+    bool PredicateIndex::holds(const Condition &condition) const {
+        const nlohmann::json *value = values_[condition.field];
+        if (value == nullptr) return false;
+
+        if (condition.kind == PredicateKind::Equals) {
+            const std::string &key = value_keys_[condition.field];
+            return std::find(condition.keys.begin(), condition.keys.end(), key) != condition.keys.end();
+        }
+
+        if (!value->is_number()) return false;
+        const double x = value->get<double>();
+        switch (condition.kind) {
+            case PredicateKind::Greater:
+                return x > condition.bound;
+            case PredicateKind::GreaterEqual:
+                return x >= condition.bound;
+            case PredicateKind::Less:
+                return x < condition.bound;
+            case PredicateKind::LessEqual:
+                return x <= condition.bound;
+            case PredicateKind::Equals:
+                break;
+        }
+        return false;
+    }
+
+    void PredicateIndex::hit(Slot slot, std::vector<Slot> &out) {
+        if (stamps_[slot] != epoch_) {
+            stamps_[slot] = epoch_;
+            hits_[slot] = 0;
+        }
+        if (++hits_[slot] == entries_[slot].conditions.size()) out.push_back(slot);
+    }
+} // namespace beacon::filter
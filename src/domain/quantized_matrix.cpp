@@ -0,0 +1,544 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/quantized_matrix.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BEACON_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace beacon {
+    namespace {
+        using reco::TopK;
+        constexpr std::size_t kLanes = reco::EmbeddingMatrix::kTileRows;
+        constexpr std::size_t kIterations = 10;
+        constexpr std::size_t kCentroids = 256;
+
+        /**
+         * The nearest of a subspace's centroids to `values`. The codebook is laid out value-major
+         * (value d of centroid c at d * kCentroids + c), so with the centroids' squared norms
+         * each value takes one SIMD pass over all 256 distances, as |c|^2 - 2 v.c.
+         */
+        std::size_t nearest_centroid(const float *codebook, const float *norms, const float *values,
+                                     std::size_t width, reco::ScaledAdd scaled_add) {
+            alignas(64) float distances[kCentroids];
+            std::copy_n(norms, kCentroids, distances);
+            for (std::size_t d = 0; d < width; ++d) {
+                scaled_add(-2.0f * values[d], codebook + d * kCentroids, distances, kCentroids);
+            }
+            // the minimum over independent lanes first, since a running argmin mispredicts
+            float lanes[16];
+            std::copy_n(distances, 16, lanes);
+            for (std::size_t c = 16; c < kCentroids; c += 16) {
+                for (std::size_t lane = 0; lane < 16; ++lane) lanes[lane] = std::min(lanes[lane], distances[c + lane]);
+            }
+            const float best = *std::min_element(lanes, lanes + 16);
+            return static_cast<std::size_t>(std::find(distances, distances + kCentroids, best) - distances);
+        }
+
+        void centroid_norms(const float *codebook, std::size_t width, float *norms) {
+            std::fill_n(norms, kCentroids, 0.0f);
+            for (std::size_t d = 0; d < width; ++d) {
+                const float *column = codebook + d * kCentroids;
+                for (std::size_t c = 0; c < kCentroids; ++c) norms[c] += column[c] * column[c];
+            }
+        }
+
+        /**
+         * Scores Int8 tiles [0, tiles) against the quantized query, two values per int16 pair.
+         */
+        using Int8Kernel = void (*)(const std::int8_t *codes, const float *scale, const std::int16_t *query,
+                                    std::size_t pairs, std::size_t tiles, float query_scale, TopK &top);
+
+        /**
+         * Scores Product tiles [0, tiles) from the query's table of subspace-centroid scores.
+         */
+        using ProductKernel = void (*)(const std::uint8_t *codes, const float *scale, const float *table,
+                                       std::size_t subspaces, std::size_t tiles, TopK &top);
+
+        void offer_tile(const float *scores, std::size_t tile, TopK &top) {
+            for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                if (scores[lane] > top.threshold()) {
+                    top.offer(scores[lane], static_cast<std::uint32_t>(tile * kLanes + lane));
+                }
+            }
+        }
+
+        void int8_scalar(const std::int8_t *codes, const float *scale, const std::int16_t *query, std::size_t pairs,
+                         std::size_t tiles, float query_scale, TopK &top) {
+            for (std::size_t tile = 0; tile < tiles; ++tile) {
+                const std::int8_t *base = codes + tile * pairs * 2 * kLanes;
+                std::int32_t sums[kLanes] = {};
+                for (std::size_t pair = 0; pair < pairs; ++pair) {
+                    const std::int8_t *values = base + pair * 2 * kLanes;
+                    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                        sums[lane] += values[2 * lane] * query[2 * pair] + values[2 * lane + 1] * query[2 * pair + 1];
+                    }
+                }
+                float scores[kLanes];
+                for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                    scores[lane] = static_cast<float>(sums[lane]) * scale[tile * kLanes + lane] * query_scale;
+                }
+                offer_tile(scores, tile, top);
+            }
+        }
+
+        void product_scalar(const std::uint8_t *codes, const float *scale, const float *table, std::size_t subspaces,
+                            std::size_t tiles, TopK &top) {
+            for (std::size_t tile = 0; tile < tiles; ++tile) {
+                const std::uint8_t *base = codes + tile * subspaces * kLanes;
+                float scores[kLanes] = {};
+                for (std::size_t s = 0; s < subspaces; ++s) {
+                    const float *row = table + s * kCentroids;
+                    for (std::size_t lane = 0; lane < kLanes; ++lane) scores[lane] += row[base[s * kLanes + lane]];
+                }
+                for (std::size_t lane = 0; lane < kLanes; ++lane) scores[lane] *= scale[tile * kLanes + lane];
+                offer_tile(scores, tile, top);
+            }
+        }
+
+#if defined(BEACON_SIMD_X86)
+        std::int32_t query_pair(const std::int16_t *query, std::size_t pair) {
+            std::int32_t packed;
+            std::memcpy(&packed, query + 2 * pair, sizeof(packed));
+            return packed;
+        }
+
+        __attribute__((target("avx2")))
+        void offer_avx2(__m256 low, __m256 high, std::size_t tile, TopK &top) {
+            const __m256 threshold = _mm256_set1_ps(top.threshold());
+            const unsigned mask =
+                    static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(low, threshold, _CMP_GT_OQ))) |
+                    static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(high, threshold, _CMP_GT_OQ))) << 8;
+            if (mask != 0) {
+                alignas(64) float scores[kLanes];
+                _mm256_store_ps(scores, low);
+                _mm256_store_ps(scores + 8, high);
+                top.offer_lanes(scores, mask, static_cast<std::uint32_t>(tile * kLanes));
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        void offer_avx512(__m512 scores, std::size_t tile, TopK &top) {
+            const __mmask16 mask = _mm512_cmp_ps_mask(scores, _mm512_set1_ps(top.threshold()), _CMP_GT_OQ);
+            if (mask != 0) {
+                alignas(64) float lanes[kLanes];
+                _mm512_store_ps(lanes, scores);
+                top.offer_lanes(lanes, mask, static_cast<std::uint32_t>(tile * kLanes));
+            }
+        }
+
+        // GCC 12's unmasked widening, conversion and gather intrinsics trip -Wmaybe-uninitialized,
+        // so the AVX-512 kernels use the masked forms with every lane set
+        constexpr __mmask16 kAll = 0xffff;
+
+        // A pair of values for 16 rows is 32 bytes. AVX2 widens each half to 16 int16 and
+        // multiply-adds it against the broadcast query pair into eight int32 sums; AVX-512BW
+        // does the whole pair at once.
+
+        template<std::size_t N>
+        __attribute__((target("avx2")))
+        inline void int8_tiles_avx2(const std::int8_t *codes, const float *scale, const std::int16_t *query,
+                                    std::size_t pairs, std::size_t tile, float query_scale, TopK &top) {
+            const std::int8_t *base = codes + tile * pairs * 2 * kLanes;
+            __m256i acc[2 * N];
+            for (std::size_t j = 0; j < 2 * N; ++j) acc[j] = _mm256_setzero_si256();
+            for (std::size_t pair = 0; pair < pairs; ++pair) {
+                const __m256i q = _mm256_set1_epi32(query_pair(query, pair));
+                for (std::size_t t = 0; t < N; ++t) {
+                    const std::int8_t *values = base + (t * pairs + pair) * 2 * kLanes;
+                    const __m256i low = _mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i *>(values)));
+                    const __m256i high = _mm256_cvtepi8_epi16(
+                        _mm_load_si128(reinterpret_cast<const __m128i *>(values + kLanes)));
+                    acc[2 * t] = _mm256_add_epi32(acc[2 * t], _mm256_madd_epi16(low, q));
+                    acc[2 * t + 1] = _mm256_add_epi32(acc[2 * t + 1], _mm256_madd_epi16(high, q));
+                }
+            }
+            const __m256 factor = _mm256_set1_ps(query_scale);
+            for (std::size_t t = 0; t < N; ++t) {
+                const float *tile_scale = scale + (tile + t) * kLanes;
+                const __m256 low = _mm256_mul_ps(_mm256_load_ps(tile_scale), factor);
+                const __m256 high = _mm256_mul_ps(_mm256_load_ps(tile_scale + 8), factor);
+                offer_avx2(_mm256_mul_ps(_mm256_cvtepi32_ps(acc[2 * t]), low),
+                           _mm256_mul_ps(_mm256_cvtepi32_ps(acc[2 * t + 1]), high), tile + t, top);
+            }
+        }
+
+        __attribute__((target("avx2")))
+        void int8_avx2(const std::int8_t *codes, const float *scale, const std::int16_t *query, std::size_t pairs,
+                       std::size_t tiles, float query_scale, TopK &top) {
+            std::size_t tile = 0;
+            for (; tile + 2 <= tiles; tile += 2) int8_tiles_avx2<2>(codes, scale, query, pairs, tile, query_scale, top);
+            for (; tile < tiles; ++tile) int8_tiles_avx2<1>(codes, scale, query, pairs, tile, query_scale, top);
+        }
+
+        template<std::size_t N>
+        __attribute__((target("avx512f,avx512bw")))
+        inline void int8_tiles_avx512(const std::int8_t *codes, const float *scale, const std::int16_t *query,
+                                      std::size_t pairs, std::size_t tile, float query_scale, TopK &top) {
+            const std::int8_t *base = codes + tile * pairs * 2 * kLanes;
+            __m512i acc[N];
+            for (std::size_t t = 0; t < N; ++t) acc[t] = _mm512_setzero_si512();
+            for (std::size_t pair = 0; pair < pairs; ++pair) {
+                const __m512i q = _mm512_set1_epi32(query_pair(query, pair));
+                for (std::size_t t = 0; t < N; ++t) {
+                    const __m512i values = _mm512_maskz_cvtepi8_epi16(~__mmask32{0}, _mm256_load_si256(
+                        reinterpret_cast<const __m256i *>(base + (t * pairs + pair) * 2 * kLanes)));
+                    acc[t] = _mm512_add_epi32(acc[t], _mm512_madd_epi16(values, q));
+                }
+            }
+            const __m512 factor = _mm512_set1_ps(query_scale);
+            for (std::size_t t = 0; t < N; ++t) {
+                offer_avx512(_mm512_mul_ps(_mm512_maskz_cvtepi32_ps(kAll, acc[t]),
+                                           _mm512_mul_ps(_mm512_load_ps(scale + (tile + t) * kLanes), factor)),
+                             tile + t, top);
+            }
+        }
+
+        __attribute__((target("avx512f,avx512bw")))
+        void int8_avx512(const std::int8_t *codes, const float *scale, const std::int16_t *query, std::size_t pairs,
+                         std::size_t tiles, float query_scale, TopK &top) {
+            std::size_t tile = 0;
+            for (; tile + 4 <= tiles; tile += 4) {
+                int8_tiles_avx512<4>(codes, scale, query, pairs, tile, query_scale, top);
+            }
+            for (; tile < tiles; ++tile) int8_tiles_avx512<1>(codes, scale, query, pairs, tile, query_scale, top);
+        }
+
+        __attribute__((target("avx2")))
+        void product_avx2(const std::uint8_t *codes, const float *scale, const float *table, std::size_t subspaces,
+                          std::size_t tiles, TopK &top) {
+            for (std::size_t tile = 0; tile < tiles; ++tile) {
+                const std::uint8_t *base = codes + tile * subspaces * kLanes;
+                __m256 low = _mm256_setzero_ps();
+                __m256 high = _mm256_setzero_ps();
+                for (std::size_t s = 0; s < subspaces; ++s) {
+                    const std::uint8_t *indices = base + s * kLanes;
+                    const __m256i first = _mm256_cvtepu8_epi32(
+                        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(indices)));
+                    const __m256i second = _mm256_cvtepu8_epi32(
+                        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(indices + 8)));
+                    low = _mm256_add_ps(low, _mm256_i32gather_ps(table + s * kCentroids, first, 4));
+                    high = _mm256_add_ps(high, _mm256_i32gather_ps(table + s * kCentroids, second, 4));
+                }
+                offer_avx2(_mm256_mul_ps(low, _mm256_load_ps(scale + tile * kLanes)),
+                           _mm256_mul_ps(high, _mm256_load_ps(scale + tile * kLanes + 8)), tile, top);
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        void product_avx512(const std::uint8_t *codes, const float *scale, const float *table, std::size_t subspaces,
+                            std::size_t tiles, TopK &top) {
+            for (std::size_t tile = 0; tile < tiles; ++tile) {
+                const std::uint8_t *base = codes + tile * subspaces * kLanes;
+                // two chains, so consecutive gathers overlap
+                __m512 even = _mm512_setzero_ps();
+                __m512 odd = _mm512_setzero_ps();
+                std::size_t s = 0;
+                for (; s + 2 <= subspaces; s += 2) {
+                    const __m512i first = _mm512_maskz_cvtepu8_epi32(kAll,
+                        _mm_load_si128(reinterpret_cast<const __m128i *>(base + s * kLanes)));
+                    const __m512i second = _mm512_maskz_cvtepu8_epi32(kAll,
+                        _mm_load_si128(reinterpret_cast<const __m128i *>(base + (s + 1) * kLanes)));
+                    even = _mm512_add_ps(even, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), kAll, first,
+                                                                        table + s * kCentroids, 4));
+                    odd = _mm512_add_ps(odd, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), kAll, second,
+                                                                      table + (s + 1) * kCentroids, 4));
+                }
+                if (s < subspaces) {
+                    const __m512i last = _mm512_maskz_cvtepu8_epi32(kAll,
+                        _mm_load_si128(reinterpret_cast<const __m128i *>(base + s * kLanes)));
+                    even = _mm512_add_ps(even, _mm512_mask_i32gather_ps(_mm512_setzero_ps(), kAll, last,
+                                                                        table + s * kCentroids, 4));
+                }
+                offer_avx512(_mm512_mul_ps(_mm512_add_ps(even, odd), _mm512_load_ps(scale + tile * kLanes)), tile, top);
+            }
+        }
+#endif
+
+        Int8Kernel int8_kernel(reco::SimdLevel level) {
+#if defined(BEACON_SIMD_X86)
+            if (level == reco::SimdLevel::Avx512 && __builtin_cpu_supports("avx512bw")) return int8_avx512;
+            if (level >= reco::SimdLevel::Avx2) return int8_avx2;
+#endif
+            return int8_scalar;
+        }
+
+        ProductKernel product_kernel(reco::SimdLevel level) {
+            switch (level) {
+#if defined(BEACON_SIMD_X86)
+                case reco::SimdLevel::Avx512: return product_avx512;
+                case reco::SimdLevel::Avx2: return product_avx2;
+#endif
+                default: return product_scalar;
+            }
+        }
+    } // namespace
+
+    namespace reco {
+        Quantization parse_quantization(const std::string &name) {
+            if (name == "none") return Quantization::None;
+            if (name == "int8") return Quantization::Int8;
+            if (name == "pq") return Quantization::Product;
+            throw std::invalid_argument("Unknown quantization '" + name + "'");
+        }
+
+        QuantizedMatrix::QuantizedMatrix(QuantizedConfig config)
+            : config_(config), pending_(config.dimension, config.simd) {
+            if (config_.dimension == 0) throw std::invalid_argument("Quantized vectors need a dimension");
+            if (config_.quantization == Quantization::None) {
+                throw std::invalid_argument("QuantizedMatrix needs a quantization");
+            }
+            if (config_.quantization == Quantization::Product) {
+                if (config_.subspaces == 0) {
+                    config_.subspaces = config_.dimension % 4 == 0 ? config_.dimension / 4 : config_.dimension;
+                }
+                if (config_.dimension % config_.subspaces != 0) {
+                    throw std::invalid_argument(std::to_string(config_.subspaces) + " subspaces do not divide " +
+                                                std::to_string(config_.dimension) + " values");
+                }
+            }
+            config_.train_rows = std::max(config_.train_rows, kCentroids);
+            config_.simd = std::min(config_.simd, detect_simd());
+            scaled_add_ = scaled_add(config_.simd);
+            pairs_ = (config_.dimension + 1) / 2;
+        }
+
+        void QuantizedMatrix::grow(std::uint32_t row) {
+            if (row < dot_scales_.size()) return;
+            const std::size_t rows = (row / kTileRows + 1) * kTileRows;
+            const std::size_t tile_bytes = config_.quantization == Quantization::Int8
+                                               ? pairs_ * 2 * kTileRows
+                                               : config_.subspaces * kTileRows;
+            codes_.resize(rows / kTileRows * tile_bytes, 0);
+            dot_scales_.resize(rows, std::numeric_limits<float>::quiet_NaN());
+            cosine_scales_.resize(rows, std::numeric_limits<float>::quiet_NaN());
+            if (config_.rerank > 0) exact_.resize(rows * config_.dimension, 0.0f);
+        }
+
+        void QuantizedMatrix::set(std::uint32_t row, const float *values) {
+            grow(row);
+            if (config_.rerank > 0) std::copy_n(values, config_.dimension, exact_.begin() + row * config_.dimension);
+            if (!trained()) {
+                pending_.set(row, values);
+                size_ = pending_.size();
+                if (size_ >= config_.train_rows) train();
+                return;
+            }
+            if (!contains(row)) ++size_;
+            encode(row, values);
+        }
+
+        void QuantizedMatrix::encode(std::uint32_t row, const float *values) {
+            const std::size_t dimension = config_.dimension;
+            const std::size_t tile = row / kTileRows;
+            const std::size_t lane = row % kTileRows;
+            double norm2 = 0.0;
+            for (std::size_t d = 0; d < dimension; ++d) norm2 += static_cast<double>(values[d]) * values[d];
+            // a zero vector is similar to nothing
+            const float inverse_norm = norm2 > 0.0 ? static_cast<float>(1.0 / std::sqrt(norm2)) : 0.0f;
+
+            if (config_.quantization == Quantization::Int8) {
+                float largest = 0.0f;
+                for (std::size_t d = 0; d < dimension; ++d) largest = std::max(largest, std::abs(values[d]));
+                const float scale = largest / 127.0f;
+                std::int8_t *base = codes_.data() + tile * pairs_ * 2 * kTileRows + lane * 2;
+                for (std::size_t d = 0; d < dimension; ++d) {
+                    const float code = scale > 0.0f ? std::round(values[d] / scale) : 0.0f;
+                    base[(d / 2) * 2 * kTileRows + d % 2] = static_cast<std::int8_t>(std::clamp(code, -127.0f, 127.0f));
+                }
+                dot_scales_[row] = scale;
+                cosine_scales_[row] = scale * inverse_norm;
+                return;
+            }
+
+            const std::size_t width = dimension / config_.subspaces;
+            auto *base = reinterpret_cast<std::uint8_t *>(codes_.data()) + tile * config_.subspaces * kTileRows + lane;
+            for (std::size_t s = 0; s < config_.subspaces; ++s) {
+                const std::size_t centroid = nearest_centroid(codebooks_.data() + s * kCentroids * width,
+                                                              norms_.data() + s * kCentroids, values + s * width,
+                                                              width, scaled_add_);
+                base[s * kTileRows] = static_cast<std::uint8_t>(centroid);
+            }
+            dot_scales_[row] = 1.0f;
+            cosine_scales_[row] = inverse_norm;
+        }
+
+        void QuantizedMatrix::train() {
+            if (trained() || pending_.size() == 0) return;
+            const std::size_t width = config_.dimension / config_.subspaces;
+            std::vector<std::uint32_t> rows;
+            std::vector<float> samples;
+            rows.reserve(pending_.size());
+            samples.reserve(pending_.size() * config_.dimension);
+            for (std::uint32_t row = 0; row < dot_scales_.size(); ++row) {
+                if (!pending_.contains(row)) continue;
+                const std::vector<float> values = pending_.row(row);
+                rows.push_back(row);
+                samples.insert(samples.end(), values.begin(), values.end());
+            }
+            const std::size_t count = rows.size();
+
+            // Lloyd's k-means per subspace, seeded with distinct samples where there are enough
+            std::vector<std::size_t> order(count);
+            std::iota(order.begin(), order.end(), std::size_t{0});
+            std::shuffle(order.begin(), order.end(), std::mt19937_64(config_.seed));
+            std::vector<float> codebooks(config_.subspaces * kCentroids * width);
+            std::vector<float> norms(config_.subspaces * kCentroids);
+            std::vector<float> slices(count * width);
+            std::vector<std::size_t> assigned(count);
+            std::vector<double> sums(kCentroids * width);
+            std::vector<std::size_t> members(kCentroids);
+            for (std::size_t s = 0; s < config_.subspaces; ++s) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    std::copy_n(samples.data() + i * config_.dimension + s * width, width, slices.data() + i * width);
+                }
+                float *centroids = codebooks.data() + s * kCentroids * width;
+                for (std::size_t c = 0; c < kCentroids; ++c) {
+                    for (std::size_t d = 0; d < width; ++d) {
+                        centroids[d * kCentroids + c] = slices[order[c % count] * width + d];
+                    }
+                }
+                float *centroid_norms_of = norms.data() + s * kCentroids;
+                for (std::size_t iteration = 0; iteration < kIterations; ++iteration) {
+                    centroid_norms(centroids, width, centroid_norms_of);
+                    std::fill(sums.begin(), sums.end(), 0.0);
+                    std::fill(members.begin(), members.end(), 0);
+                    for (std::size_t i = 0; i < count; ++i) {
+                        const float *slice = slices.data() + i * width;
+                        assigned[i] = nearest_centroid(centroids, centroid_norms_of, slice, width, scaled_add_);
+                        ++members[assigned[i]];
+                        for (std::size_t d = 0; d < width; ++d) sums[assigned[i] * width + d] += slice[d];
+                    }
+                    // an empty cluster keeps its centroid
+                    for (std::size_t c = 0; c < kCentroids; ++c) {
+                        if (members[c] == 0) continue;
+                        for (std::size_t d = 0; d < width; ++d) {
+                            centroids[d * kCentroids + c] = static_cast<float>(sums[c * width + d] /
+                                                                               static_cast<double>(members[c]));
+                        }
+                    }
+                }
+                centroid_norms(centroids, width, centroid_norms_of);
+            }
+
+            codebooks_ = std::move(codebooks);
+            norms_ = std::move(norms);
+            for (std::size_t i = 0; i < count; ++i) encode(rows[i], samples.data() + i * config_.dimension);
+            pending_ = EmbeddingMatrix(config_.dimension, config_.simd);
+        }
+
+        bool QuantizedMatrix::contains(std::uint32_t row) const {
+            if (!trained()) return pending_.contains(row);
+            return row < dot_scales_.size() && !std::isnan(dot_scales_[row]);
+        }
+
+        std::vector<float> QuantizedMatrix::row(std::uint32_t row) const {
+            if (!contains(row)) return {};
+            const std::size_t dimension = config_.dimension;
+            if (config_.rerank > 0) {
+                return {exact_.begin() + row * dimension, exact_.begin() + (row + 1) * dimension};
+            }
+            if (!trained()) return pending_.row(row);
+
+            std::vector<float> values(dimension);
+            const std::size_t tile = row / kTileRows;
+            const std::size_t lane = row % kTileRows;
+            if (config_.quantization == Quantization::Int8) {
+                const std::int8_t *base = codes_.data() + tile * pairs_ * 2 * kTileRows + lane * 2;
+                for (std::size_t d = 0; d < dimension; ++d) {
+                    values[d] = static_cast<float>(base[(d / 2) * 2 * kTileRows + d % 2]) * dot_scales_[row];
+                }
+                return values;
+            }
+            const std::size_t width = dimension / config_.subspaces;
+            const auto *base = reinterpret_cast<const std::uint8_t *>(codes_.data()) +
+                               tile * config_.subspaces * kTileRows + lane;
+            for (std::size_t s = 0; s < config_.subspaces; ++s) {
+                const float *codebook = codebooks_.data() + s * kCentroids * width;
+                for (std::size_t d = 0; d < width; ++d) {
+                    values[s * width + d] = codebook[d * kCentroids + base[s * kTileRows]];
+                }
+            }
+            return values;
+        }
+
+        std::size_t QuantizedMatrix::memory_bytes() const {
+            return codes_.capacity() +
+                   (dot_scales_.capacity() + cosine_scales_.capacity() + codebooks_.capacity() + norms_.capacity() +
+                    exact_.capacity()) *
+                   sizeof(float) + pending_.memory_bytes();
+        }
+
+        std::vector<std::pair<float, std::uint32_t> > QuantizedMatrix::top_k(const float *query, std::size_t k,
+                                                                             EmbeddingMetric metric) const {
+            if (k == 0 || size_ == 0) return {};
+            if (!trained()) return pending_.top_k(query, k, metric);
+
+            const std::size_t dimension = config_.dimension;
+            std::vector<float> normalized(query, query + dimension);
+            if (metric == EmbeddingMetric::Cosine) {
+                double norm2 = 0.0;
+                for (const float value: normalized) norm2 += static_cast<double>(value) * value;
+                if (!(norm2 > 0.0)) return {};
+                const auto inverse = static_cast<float>(1.0 / std::sqrt(norm2));
+                for (float &value: normalized) value *= inverse;
+            }
+
+            const std::size_t candidates = config_.rerank > 0 ? k * config_.rerank : k;
+            const float *scale = metric == EmbeddingMetric::Cosine ? cosine_scales_.data() : dot_scales_.data();
+            const std::size_t tiles = dot_scales_.size() / kTileRows;
+            TopK top(candidates);
+            if (config_.quantization == Quantization::Int8) {
+                float largest = 0.0f;
+                for (const float value: normalized) largest = std::max(largest, std::abs(value));
+                const float query_scale = largest / 127.0f;
+                std::vector<std::int16_t> quantized(pairs_ * 2, 0);
+                for (std::size_t d = 0; d < dimension; ++d) {
+                    const float code = query_scale > 0.0f ? std::round(normalized[d] / query_scale) : 0.0f;
+                    quantized[d] = static_cast<std::int16_t>(code);
+                }
+                int8_kernel(config_.simd)(codes_.data(), scale, quantized.data(), pairs_, tiles, query_scale, top);
+            } else {
+                const std::size_t width = dimension / config_.subspaces;
+                std::vector<float> table(config_.subspaces * kCentroids, 0.0f);
+                for (std::size_t s = 0; s < config_.subspaces; ++s) {
+                    float *scores = table.data() + s * kCentroids;
+                    for (std::size_t d = 0; d < width; ++d) {
+                        const float q = normalized[s * width + d];
+                        const float *column = codebooks_.data() + (s * width + d) * kCentroids;
+                        for (std::size_t c = 0; c < kCentroids; ++c) scores[c] += q * column[c];
+                    }
+                }
+                product_kernel(config_.simd)(reinterpret_cast<const std::uint8_t *>(codes_.data()), scale,
+                                             table.data(), config_.subspaces, tiles, top);
+            }
+            std::vector<std::pair<float, std::uint32_t> > result = top.take();
+            if (config_.rerank == 0) return result;
+
+            const DotProduct exact_dot = dot_product(config_.simd);
+            for (auto &[score, row]: result) {
+                const float *values = exact_.data() + static_cast<std::size_t>(row) * dimension;
+                score = exact_dot(values, normalized.data(), dimension);
+                if (metric == EmbeddingMetric::Cosine) {
+                    const float norm2 = exact_dot(values, values, dimension);
+                    score = norm2 > 0.0f ? score / std::sqrt(norm2) : 0.0f;
+                }
+            }
+            std::sort(result.begin(), result.end(), [](const auto &a, const auto &b) {
+                return a.first > b.first || (a.first == b.first && a.second < b.second);
+            });
+            if (result.size() > k) result.resize(k);
+            return result;
+        }
+    } // namespace reco
+} // namespace beacon
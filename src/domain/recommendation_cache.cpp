@@ -0,0 +1,215 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/recommendation_cache.h>
+#include <algorithm>
+#include <cstdlib>
+#include <future>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace beacon {
+    namespace reco {
+        namespace {
+            struct Entry {
+                std::string context;
+                std::uint64_t model_version = 0;
+                RecommendationCache::Result result;
+                RecommendationCache::Clock::time_point computed;
+                // valid while `flight` computes the result
+                std::shared_future<RecommendationCache::Result> pending;
+                std::uint64_t flight = 0;
+            };
+
+            struct UserEntries {
+                std::string user;
+                // most recently used first
+                std::vector<Entry> entries;
+            };
+
+            Entry *find_entry(UserEntries &user, std::string_view context) {
+                for (Entry &entry: user.entries) {
+                    if (entry.context == context) return &entry;
+                }
+                return nullptr;
+            }
+
+            /**
+             * Moves a user's entry to the front, as the most recently used.
+             */
+            Entry *touch(UserEntries &user, Entry *entry) {
+                const auto at = user.entries.begin() + (entry - user.entries.data());
+                std::rotate(user.entries.begin(), at, at + 1);
+                return &user.entries.front();
+            }
+        } // namespace
+
+        struct RecommendationCache::Shard {
+            mutable std::mutex mutex;
+            // most recently used first
+            std::list<UserEntries> users;
+            // keys view the names held by `users`
+            std::unordered_map<std::string_view, std::list<UserEntries>::iterator> index;
+            std::size_t entries = 0;
+            std::uint64_t next_flight = 0;
+
+            UserEntries *find(std::string_view user) {
+                const auto found = index.find(user);
+                return found == index.end() ? nullptr : &*found->second;
+            }
+
+            void erase(std::string_view user) {
+                const auto found = index.find(user);
+                if (found == index.end()) return;
+                const std::list<UserEntries>::iterator at = found->second;
+                entries -= at->entries.size();
+                index.erase(found);
+                users.erase(at);
+            }
+        };
+
+        RecommendationCacheConfig RecommendationCacheConfig::from_env() {
+            RecommendationCacheConfig config;
+            if (const char *shards = std::getenv("BEACON_RECO_CACHE_SHARDS")) {
+                config.shards = std::strtoul(shards, nullptr, 10);
+            }
+            if (const char *entries = std::getenv("BEACON_RECO_CACHE_MAX_ENTRIES")) {
+                config.max_entries = std::strtoul(entries, nullptr, 10);
+            }
+            if (const char *contexts = std::getenv("BEACON_RECO_CACHE_MAX_CONTEXTS")) {
+                config.max_contexts = std::strtoul(contexts, nullptr, 10);
+            }
+            if (const char *soft = std::getenv("BEACON_RECO_CACHE_SOFT_TTL_MS")) {
+                config.soft_ttl = std::chrono::milliseconds(std::strtoul(soft, nullptr, 10));
+            }
+            if (const char *hard = std::getenv("BEACON_RECO_CACHE_HARD_TTL_MS")) {
+                config.hard_ttl = std::chrono::milliseconds(std::strtoul(hard, nullptr, 10));
+            }
+            return config;
+        }
+
+        RecommendationCache::RecommendationCache(RecommendationCacheConfig config) : config_(std::move(config)) {
+            if (config_.shards == 0) throw std::invalid_argument("Recommendation cache needs at least one shard");
+            if (config_.soft_ttl > config_.hard_ttl) {
+                throw std::invalid_argument("Recommendation cache soft TTL cannot exceed its hard TTL");
+            }
+            shard_entries_ = std::max<std::size_t>(1, config_.max_entries / config_.shards);
+            user_entries_ = std::clamp<std::size_t>(config_.max_contexts, 1, shard_entries_);
+            shards_ = std::make_unique<Shard[]>(config_.shards);
+        }
+
+        RecommendationCache::~RecommendationCache() = default;
+
+        RecommendationCache::Shard &RecommendationCache::shard_of(std::string_view user) const {
+            return shards_[std::hash<std::string_view>{}(user) % config_.shards];
+        }
+
+        RecommendationCache::Result RecommendationCache::get(std::string_view user, std::string_view context,
+                                                             std::uint64_t model_version, const Compute &compute,
+                                                             Clock::time_point now) {
+            Shard &shard = shard_of(user);
+            std::promise<Result> promise;
+            std::uint64_t flight;
+            {
+                std::unique_lock lock(shard.mutex);
+                const auto found = shard.index.find(user);
+                if (found != shard.index.end()) {
+                    shard.users.splice(shard.users.begin(), shard.users, found->second);
+                } else {
+                    shard.users.push_front(UserEntries{std::string(user), {}});
+                    shard.index.emplace(shard.users.front().user, shard.users.begin());
+                }
+                UserEntries &entries = shard.users.front();
+                Entry *entry = find_entry(entries, context);
+                if (entry) entry = touch(entries, entry);
+                if (entry && entry->model_version == model_version) {
+                    const Clock::duration age = now - entry->computed;
+                    if (entry->result && age < config_.soft_ttl) {
+                        hits_.fetch_add(1, std::memory_order_relaxed);
+                        return entry->result;
+                    }
+                    if (entry->result && age < config_.hard_ttl && entry->pending.valid()) {
+                        stale_hits_.fetch_add(1, std::memory_order_relaxed);
+                        return entry->result;
+                    }
+                    if (entry->pending.valid()) {
+                        coalesced_.fetch_add(1, std::memory_order_relaxed);
+                        const std::shared_future<Result> pending = entry->pending;
+                        lock.unlock();
+                        return pending.get();
+                    }
+                }
+                if (!entry) {
+                    // The context comes from the client, so the user's least recently used
+                    // one makes room; a computation still running for it goes unkept.
+                    if (entries.entries.size() >= user_entries_) {
+                        entries.entries.pop_back();
+                        --shard.entries;
+                    }
+                    entries.entries.insert(entries.entries.begin(),
+                                           Entry{std::string(context), model_version, {}, {}, {}, 0});
+                    entry = &entries.entries.front();
+                    ++shard.entries;
+                } else if (entry->model_version != model_version) {
+                    entry->model_version = model_version;
+                    entry->result.reset();
+                }
+                misses_.fetch_add(1, std::memory_order_relaxed);
+                flight = ++shard.next_flight;
+                entry->flight = flight;
+                entry->pending = promise.get_future().share();
+                while (shard.entries > shard_entries_ && shard.users.size() > 1) {
+                    shard.erase(shard.users.back().user);
+                }
+            }
+
+            // only the computation that is still the entry's own may settle it
+            const auto settle = [&](const Result &result) {
+                const std::lock_guard lock(shard.mutex);
+                UserEntries *entries = shard.find(user);
+                Entry *entry = entries ? find_entry(*entries, context) : nullptr;
+                if (!entry || entry->flight != flight) return;
+                entry->pending = {};
+                if (!result) return;
+                entry->result = result;
+                entry->computed = now;
+            };
+            Result result;
+            try {
+                result = std::make_shared<const std::vector<ScoredItem> >(compute());
+            } catch (...) {
+                settle(nullptr);
+                promise.set_exception(std::current_exception());
+                throw;
+            }
+            settle(result);
+            promise.set_value(result);
+            return result;
+        }
+
+        void RecommendationCache::invalidate(std::string_view user) {
+            Shard &shard = shard_of(user);
+            const std::lock_guard lock(shard.mutex);
+            if (!shard.find(user)) return;
+            shard.erase(user);
+            invalidations_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        RecommendationCacheStats RecommendationCache::stats() const {
+            RecommendationCacheStats stats;
+            stats.hits = hits_.load(std::memory_order_relaxed);
+            stats.stale_hits = stale_hits_.load(std::memory_order_relaxed);
+            stats.misses = misses_.load(std::memory_order_relaxed);
+            stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+            stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < config_.shards; ++i) {
+                const std::lock_guard lock(shards_[i].mutex);
+                stats.entries += shards_[i].entries;
+            }
+            return stats;
+        }
+    } // namespace reco
+} // namespace beacon
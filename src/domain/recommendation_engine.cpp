@@ -3,10 +3,1341 @@
 //
 
 #include <beacon/recommendation_engine.h>
-#include <iostream>
+#include <beacon/interaction_matrix.h>
+#include <beacon/interner.h>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 
 namespace beacon {
-    void RecommendationEngine::run() {
-        std::cout << "RecommendationEngine start" << std::endl;
+    namespace reco {
+        Similarity parse_similarity(const std::string &name) {
+            if (name == "cosine") return Similarity::Cosine;
+            if (name == "jaccard") return Similarity::Jaccard;
+            if (name == "llr") return Similarity::LogLikelihood;
+            throw std::invalid_argument("Unknown similarity '" + name + "'");
+        }
+    } // namespace reco
+
+    namespace {
+        /**
+         * Keeps the k best of (score, item) candidates, best first; ties go to the lower id.
+         */
+        void keep_best(std::vector<std::pair<float, std::uint32_t> > &candidates, std::size_t k) {
+            auto better = [](const auto &a, const auto &b) {
+                return a.first > b.first || (a.first == b.first && a.second < b.second);
+            };
+            if (candidates.size() > k) {
+                std::nth_element(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(k),
+                                 candidates.end(), better);
+                candidates.resize(k);
+            }
+            std::sort(candidates.begin(), candidates.end(), better);
+        }
+
+        // Decaying weights are kept in forward form (Cormode et al., "Forward decay"): a weight
+        // w seen at time t is stored as w * 2^((t - origin) / half_life), so that sums of them
+        // decay alike and one factor, 2^((origin - now) / half_life), turns any of them into
+        // its value now. To keep stored values in range the origin moves up kEpochHalfLives
+        // half-lives at a time; a value is carried into the latest epoch when it is next
+        // written, and values of different epochs are brought to one when they meet.
+        constexpr int kEpochHalfLives = 32;
+
+        /**
+         * `value`, stored in the scale of epoch `from`, in that of epoch `to`; `power` is 2 for
+         * products of two weights.
+         */
+        double rebase(double value, std::uint32_t from, std::uint32_t to, int power) {
+            return std::ldexp(value, power * kEpochHalfLives * (static_cast<int>(from) - static_cast<int>(to)));
+        }
+
+        /**
+         * One row of the co-occurrence matrix, keyed by the other item: open addressing with
+         * linear probing and backward-shift deletion, 12 bytes a cell at up to 3/4 load.
+         */
+        class CooccurrenceRow {
+        public:
+            static constexpr std::uint32_t kEmpty = 0xffffffffu;
+
+            struct Cell {
+                std::uint32_t item = kEmpty;
+                std::uint32_t shared = 0;
+                float dot = 0.0f;
+            };
+
+            Cell &upsert(std::uint32_t item, bool &created) {
+                if ((size_ + 1) * 4 > cells_.size() * 3) grow();
+                std::size_t at = home(item);
+                while (cells_[at].item != kEmpty && cells_[at].item != item) at = (at + 1) & mask();
+                created = cells_[at].item == kEmpty;
+                if (created) {
+                    cells_[at].item = item;
+                    ++size_;
+                }
+                return cells_[at];
+            }
+
+            const Cell *find(std::uint32_t item) const {
+                if (cells_.empty()) return nullptr;
+                for (std::size_t at = home(item); cells_[at].item != kEmpty; at = (at + 1) & mask()) {
+                    if (cells_[at].item == item) return &cells_[at];
+                }
+                return nullptr;
+            }
+
+            void erase(Cell &cell) {
+                std::size_t hole = static_cast<std::size_t>(&cell - cells_.data());
+                for (std::size_t at = (hole + 1) & mask(); cells_[at].item != kEmpty; at = (at + 1) & mask()) {
+                    // a cell moves into the hole unless its home lies between the hole and it
+                    if (((at - home(cells_[at].item)) & mask()) >= ((at - hole) & mask())) {
+                        cells_[hole] = cells_[at];
+                        hole = at;
+                    }
+                }
+                cells_[hole] = Cell{};
+                --size_;
+            }
+
+            template<typename F>
+            void for_each(F &&visit) const {
+                for (const Cell &cell: cells_) {
+                    if (cell.item != kEmpty) visit(cell);
+                }
+            }
+
+            template<typename F>
+            void for_each(F &&visit) {
+                for (Cell &cell: cells_) {
+                    if (cell.item != kEmpty) visit(cell);
+                }
+            }
+
+            std::size_t size() const {
+                return size_;
+            }
+
+        private:
+            std::size_t mask() const {
+                return cells_.size() - 1;
+            }
+
+            std::size_t home(std::uint32_t item) const {
+                // Fibonacci hashing: the top bits of the product are well mixed
+                return static_cast<std::size_t>((item * 0x9E3779B97F4A7C15ULL) >> shift_);
+            }
+
+            void grow() {
+                std::vector<Cell> old = std::move(cells_);
+                const std::size_t capacity = std::max<std::size_t>(old.size() * 2, 8);
+                cells_.assign(capacity, Cell{});
+                shift_ = 64 - std::countr_zero(capacity);
+                for (const Cell &cell: old) {
+                    if (cell.item == kEmpty) continue;
+                    std::size_t at = home(cell.item);
+                    while (cells_[at].item != kEmpty) at = (at + 1) & mask();
+                    cells_[at] = cell;
+                }
+            }
+
+            std::vector<Cell> cells_;
+            std::size_t size_ = 0;
+            int shift_ = 64;
+        };
+
+        struct Neighbor {
+            std::uint32_t item;
+            std::uint32_t shared;
+            float dot;
+            // when last written; queries rescore
+            float score;
+        };
+
+        /**
+         * An item's statistics, co-occurrence row and neighbor list. The thread owning the
+         * item writes all of it; others read the statistics, and the neighbor list under the
+         * item's stripe lock.
+         *
+         * norm2, popularity and the dot products in the row and the neighbor list are in the
+         * scale of `epoch`. The owner moves it on under the stripe lock, flagging it with
+         * kRescaling meanwhile so that readers of the statistics can tell a torn read.
+         */
+        struct ItemState {
+            static constexpr std::uint32_t kRescaling = 0x80000000u;
+
+            std::atomic<std::uint32_t> users{0};
+            std::atomic<double> norm2{0.0};
+            // summed weights
+            std::atomic<double> popularity{0.0};
+            std::atomic<std::uint32_t> epoch{0};
+            CooccurrenceRow row;
+            std::vector<Neighbor> neighbors; // best first
+            bool dirty = false;
+        };
+
+        /**
+         * Item states by id in fixed segments, so a state never moves once it exists and the
+         * table can grow while others read it.
+         */
+        class ItemTable {
+        public:
+            static constexpr unsigned kSegmentBits = 12;
+            static constexpr std::size_t kSegments = std::size_t{1} << 16;
+
+            ItemTable() : segments_(new std::atomic<ItemState *>[kSegments]) {
+                for (std::size_t i = 0; i < kSegments; ++i) segments_[i].store(nullptr, std::memory_order_relaxed);
+            }
+
+            ItemState &operator[](std::uint32_t id) const {
+                return segments_[id >> kSegmentBits].load(std::memory_order_acquire)[id & ((1u << kSegmentBits) - 1)];
+            }
+
+            /**
+             * Makes room for `id`; callers are serialized.
+             */
+            void ensure(std::uint32_t id) {
+                const std::size_t segment = id >> kSegmentBits;
+                if (segment >= kSegments) throw std::length_error("too many items");
+                if (segments_[segment].load(std::memory_order_relaxed) != nullptr) return;
+                owned_.push_back(std::make_unique<ItemState[]>(std::size_t{1} << kSegmentBits));
+                segments_[segment].store(owned_.back().get(), std::memory_order_release);
+            }
+
+        private:
+            std::unique_ptr<std::atomic<ItemState *>[]> segments_;
+            std::vector<std::unique_ptr<ItemState[]> > owned_;
+        };
+    } // namespace
+
+    struct RecommendationEngine::Impl {
+        // ids are interned by the thread that queues it
+        struct Interaction {
+            std::uint32_t user;
+            std::uint32_t item;
+            float weight;
+            // seconds since the decay origin
+            double at;
+        };
+
+        // a change to cell (row, column), or to item `row`'s statistics if column is kStats
+        // or its popularity if kPopularity, in the scale of `epoch`
+        struct Delta {
+            std::uint32_t row;
+            std::uint32_t column;
+            std::int32_t shared;
+            float dot;
+            std::uint32_t epoch;
+        };
+
+        static constexpr std::uint32_t kStats = CooccurrenceRow::kEmpty;
+        static constexpr std::uint32_t kPopularity = kStats - 1;
+
+        // a user's items with their weights in the scale of `epoch`, least recently touched first
+        struct History {
+            std::vector<std::pair<std::uint32_t, float> > items;
+            std::uint32_t epoch = 0;
+        };
+
+        /**
+         * One update thread: the users and items whose id hashes to it, and its inbox.
+         */
+        struct Shard {
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::vector<Interaction> interactions;
+            std::vector<Delta> deltas;
+            std::size_t delta_batches = 0;
+            bool refresh_all = false;
+
+            // read by queries under histories_mutex, written by the shard's thread only
+            std::mutex histories_mutex;
+            std::vector<History> histories; // by user id / shards.size()
+
+            // the shard's thread only
+            std::deque<std::uint32_t> dirty;
+            std::uint32_t sweep_next = 0;
+            std::vector<std::vector<Delta> > outboxes;
+            // what is written is brought to this epoch first
+            std::uint32_t epoch = 0;
+
+            std::thread thread;
+        };
+
+        explicit Impl(RecommendationConfig config)
+            : config(std::move(config)),
+              user_items(this->config.interaction_merge_every, this->config.interaction_max_entries),
+              embeddings(this->config.embedding_dimension, this->config.simd.value_or(reco::detect_simd())) {
+            if (this->config.embedding_dimension > 0 && this->config.hnsw_m > 0) {
+                reco::HnswConfig index;
+                index.dimension = this->config.embedding_dimension;
+                index.metric = this->config.embedding_metric;
+                index.m = this->config.hnsw_m;
+                index.ef_construction = this->config.hnsw_ef_construction;
+                index.ef_search = this->config.hnsw_ef_search;
+                hnsw = std::make_unique<reco::HnswIndex>(index);
+            } else if (this->config.embedding_dimension > 0) {
+                quantized = make_quantized();
+            }
+            this->config.update_threads = std::max<std::size_t>(this->config.update_threads, 1);
+            this->config.max_user_items = std::max<std::size_t>(this->config.max_user_items, 1);
+            this->config.min_support = std::max<std::uint32_t>(this->config.min_support, 1);
+            for (std::size_t i = 0; i < this->config.update_threads; ++i) {
+                shards.push_back(std::make_unique<Shard>());
+                shards.back()->outboxes.resize(this->config.update_threads);
+                shards.back()->sweep_next = static_cast<std::uint32_t>(i);
+            }
+            for (std::size_t i = 0; i < shards.size(); ++i) {
+                shards[i]->thread = std::thread([this, i]() { run(i); });
+            }
+            merger = std::thread([this]() { merge_interactions(); });
+        }
+
+        ~Impl() {
+            stopping = true;
+            for (auto &shard: shards) {
+                // taken so that no thread is between checking the flag and waiting
+                { const std::lock_guard lock(shard->mutex); }
+                shard->wake.notify_all();
+            }
+            for (auto &shard: shards) shard->thread.join();
+            { const std::lock_guard lock(merge_mutex); }
+            merge_wake.notify_all();
+            merger.join();
+        }
+
+        std::size_t owner_of_item(std::uint32_t item) const {
+            return item % shards.size();
+        }
+
+        std::size_t owner_of_user(std::uint32_t user) const {
+            return user % shards.size();
+        }
+
+        /**
+         * A copy of the user's history; empty if there is none.
+         */
+        History history_of(std::uint32_t user) const {
+            Shard &shard = *shards[owner_of_user(user)];
+            const std::size_t slot = user / shards.size();
+            const std::lock_guard lock(shard.histories_mutex);
+            return slot < shard.histories.size() ? shard.histories[slot] : History{};
+        }
+
+        std::mutex &stripe(std::uint32_t item) const {
+            return stripes[item % stripes.size()];
+        }
+
+        double seconds(std::chrono::system_clock::time_point at) const {
+            return std::chrono::duration<double>(at - origin).count();
+        }
+
+        std::uint32_t epoch_at(double at) const {
+            if (!(config.decay_half_life > 0.0) || at <= 0.0) return 0;
+            return static_cast<std::uint32_t>(std::min(at / config.decay_half_life / kEpochHalfLives, 1e9));
+        }
+
+        /**
+         * Forward factor of a weight seen at `at`, in the scale of epoch `epoch`.
+         */
+        double boost(double at, std::uint32_t epoch) const {
+            if (!(config.decay_half_life > 0.0)) return 1.0;
+            return std::exp2(at / config.decay_half_life - static_cast<double>(epoch) * kEpochHalfLives);
+        }
+
+        /**
+         * What a weight stored in the scale of epoch `epoch` is worth now.
+         */
+        double decay_now(std::uint32_t epoch) const {
+            return 1.0 / boost(seconds(std::chrono::system_clock::now()), epoch);
+        }
+
+        struct Statistics {
+            double norm2;
+            double popularity;
+            std::uint32_t epoch;
+        };
+
+        /**
+         * An item's norm and popularity, read from any thread.
+         */
+        static Statistics statistics(const ItemState &state) {
+            while (true) {
+                const std::uint32_t epoch = state.epoch.load(std::memory_order_acquire);
+                if (epoch & ItemState::kRescaling) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                const Statistics read{
+                    state.norm2.load(std::memory_order_relaxed), state.popularity.load(std::memory_order_relaxed), epoch
+                };
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (state.epoch.load(std::memory_order_relaxed) == epoch) return read;
+            }
+        }
+
+        /**
+         * Carries an item's decaying values into epoch `to`; by its owner.
+         */
+        void rebase_item(std::uint32_t item, std::uint32_t to) {
+            ItemState &state = items[item];
+            const std::uint32_t from = state.epoch.load(std::memory_order_relaxed);
+            if (from >= to) return;
+            {
+                const std::lock_guard lock(stripe(item));
+                state.epoch.store(from | ItemState::kRescaling, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                state.norm2.store(rebase(state.norm2.load(std::memory_order_relaxed), from, to, 2),
+                                  std::memory_order_relaxed);
+                state.popularity.store(rebase(state.popularity.load(std::memory_order_relaxed), from, to, 1),
+                                       std::memory_order_relaxed);
+                for (Neighbor &neighbor: state.neighbors) {
+                    neighbor.dot = static_cast<float>(rebase(neighbor.dot, from, to, 2));
+                }
+                state.epoch.store(to, std::memory_order_release);
+            }
+            state.row.for_each([from, to](CooccurrenceRow::Cell &cell) {
+                cell.dot = static_cast<float>(rebase(cell.dot, from, to, 2));
+            });
+        }
+
+        /**
+         * Similarity of a pair under the current item statistics, `dot` being in the scale of
+         * `epoch`; zero if it does not count.
+         */
+        float score(std::uint32_t a, std::uint32_t b, std::uint32_t shared, float dot, std::uint32_t epoch) const {
+            if (shared < config.min_support) return 0.0f;
+            const ItemState &first = items[a];
+            const ItemState &second = items[b];
+            switch (config.similarity) {
+                case reco::Similarity::Cosine: {
+                    const Statistics x = statistics(first);
+                    const Statistics y = statistics(second);
+                    return static_cast<float>(reco::cosine(
+                        dot, std::sqrt(std::max(0.0, rebase(x.norm2, x.epoch, epoch, 2))),
+                        std::sqrt(std::max(0.0, rebase(y.norm2, y.epoch, epoch, 2)))));
+                }
+                case reco::Similarity::Jaccard:
+                    return static_cast<float>(reco::jaccard(shared, first.users.load(std::memory_order_relaxed),
+                                                            second.users.load(std::memory_order_relaxed)));
+                case reco::Similarity::LogLikelihood: {
+                    // counts read from different threads can be momentarily inconsistent
+                    const std::uint64_t users_a = std::max<std::uint64_t>(first.users.load(std::memory_order_relaxed), shared);
+                    const std::uint64_t users_b = std::max<std::uint64_t>(second.users.load(std::memory_order_relaxed), shared);
+                    const std::uint64_t total = std::max<std::uint64_t>(user_count.load(std::memory_order_relaxed),
+                                                                        users_a + users_b - shared);
+                    return static_cast<float>(1.0 - 1.0 / (1.0 + reco::log_likelihood_ratio(
+                                                               shared, users_a, users_b, total)));
+                }
+            }
+            return 0.0f;
+        }
+
+        void enqueue(std::string_view user, std::string_view item, float weight,
+                     std::chrono::system_clock::time_point at) {
+            // one NaN would reach the norms and dot products of the item for good
+            if (!(weight > 0.0f) || !std::isfinite(weight)) {
+                throw std::invalid_argument("Interaction weight must be positive and finite, got " +
+                                            std::to_string(weight));
+            }
+            if (queued.fetch_add(1, std::memory_order_relaxed) >= config.max_queued) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            const Interaction interaction{
+                users.intern(user, [this](std::uint32_t) { user_count.fetch_add(1, std::memory_order_relaxed); }),
+                intern_item(item), weight, seconds(at)
+            };
+            // the epoch moves on before anything in it is queued
+            const std::uint32_t reached = epoch_at(interaction.at);
+            for (std::uint32_t current = epoch.load(std::memory_order_relaxed); current < reached;) {
+                epoch.compare_exchange_weak(current, reached, std::memory_order_release, std::memory_order_relaxed);
+            }
+            pending.fetch_add(1, std::memory_order_relaxed);
+            Shard &shard = *shards[owner_of_user(interaction.user)];
+            bool was_empty;
+            {
+                const std::lock_guard lock(shard.mutex);
+                was_empty = shard.interactions.empty();
+                shard.interactions.push_back(interaction);
+            }
+            if (was_empty) shard.wake.notify_one();
+        }
+
+        /**
+         * Marks `count` units of queued work as done.
+         */
+        void done(std::int64_t count) {
+            if (count == 0) return;
+            if (pending.fetch_sub(count, std::memory_order_acq_rel) == count) {
+                const std::lock_guard lock(idle_mutex);
+                idle.notify_all();
+            }
+        }
+
+        void run(std::size_t index);
+
+        /**
+         * The merger thread: merges user_items whenever an update thread finds its delta full,
+         * so that no update thread waits on a merge.
+         */
+        void merge_interactions() {
+            while (true) {
+                {
+                    std::unique_lock lock(merge_mutex);
+                    merge_wake.wait(lock, [this]() {
+                        return stopping || merge_due.load(std::memory_order_relaxed);
+                    });
+                    if (stopping) return;
+                }
+                merge_due.store(false, std::memory_order_relaxed);
+                user_items.merge();
+            }
+        }
+
+        void apply_interaction(Shard &shard, const Interaction &interaction);
+
+        void emit(Shard &shard, std::uint32_t row, std::uint32_t column, std::int32_t shared, float dot) {
+            shard.outboxes[owner_of_item(row)].push_back(Delta{row, column, shared, dot, shard.epoch});
+        }
+
+        void send_outboxes(Shard &shard);
+
+        void apply_delta(Shard &shard, const Delta &delta);
+
+        void update_neighbor(std::uint32_t row, std::uint32_t column, std::uint32_t shared, float dot, float score,
+                             Shard &shard);
+
+        void mark_dirty(Shard &shard, std::uint32_t item);
+
+        /**
+         * Recomputes an item's neighbor list from its row. Returns the cells scanned.
+         */
+        std::size_t refresh(std::uint32_t item);
+
+        RecommendationConfig config;
+        std::vector<std::unique_ptr<Shard> > shards;
+        beacon::Interner users;
+        beacon::Interner item_names;
+        // the latest interactions, by user id and item id
+        reco::InteractionMatrix user_items;
+        ItemTable items;
+        mutable std::array<std::mutex, 1024> stripes;
+
+        // Rows and labels are item ids. With an HNSW index, embeddings live there alone and
+        // the mutex only keeps load_embeddings() and train_factors() from swapping it under a
+        // reader.
+        mutable std::shared_mutex embeddings_mutex;
+        reco::EmbeddingMatrix embeddings;
+        // set when embeddings are quantized, which then live there instead
+        std::unique_ptr<reco::QuantizedMatrix> quantized;
+        std::unique_ptr<reco::HnswIndex> hnsw;
+        // the last train_factors()' users, row-major by user id
+        std::vector<float> user_factors;
+        std::size_t factor_users = 0;
+
+        void check_embedding(const std::vector<float> &embedding) const {
+            if (config.embedding_dimension == 0 || embedding.size() != config.embedding_dimension) {
+                throw std::invalid_argument("Embedding has " + std::to_string(embedding.size()) + " values, expected " +
+                                            std::to_string(config.embedding_dimension));
+            }
+        }
+
+        std::uint32_t intern_item(std::string_view item) {
+            return item_names.intern(item, [this](std::uint32_t created) { items.ensure(created); });
+        }
+
+        std::unique_ptr<reco::QuantizedMatrix> make_quantized() const {
+            if (config.embedding_quantization == reco::Quantization::None) return nullptr;
+            reco::QuantizedConfig matrix;
+            matrix.dimension = config.embedding_dimension;
+            matrix.quantization = config.embedding_quantization;
+            matrix.subspaces = config.embedding_pq_subspaces;
+            matrix.rerank = config.embedding_rerank;
+            matrix.simd = config.simd.value_or(reco::detect_simd());
+            return std::make_unique<reco::QuantizedMatrix>(matrix);
+        }
+
+        std::vector<std::pair<float, std::uint32_t> > top_embeddings(const float *query, std::size_t k) const {
+            if (hnsw) return hnsw->search(query, k);
+            if (quantized) return quantized->top_k(query, k, config.embedding_metric);
+            return embeddings.top_k(query, k, config.embedding_metric);
+        }
+
+        std::vector<float> embedding(std::uint32_t item) const {
+            if (hnsw) return hnsw->vector(item);
+            if (quantized) return quantized->row(item);
+            return embeddings.row(item);
+        }
+
+        std::size_t embedding_count() const {
+            if (hnsw) return hnsw->size();
+            if (quantized) return quantized->size();
+            return embeddings.size();
+        }
+
+        std::atomic<std::size_t> queued{0};
+        std::atomic<std::uint64_t> applied{0};
+        std::atomic<std::uint64_t> dropped{0};
+        std::atomic<std::uint64_t> user_count{0};
+        std::atomic<std::int64_t> cooccurrences{0};
+        std::atomic<std::uint64_t> version{0};
+
+        // decaying weights are stored relative to origin + epoch * kEpochHalfLives half-lives
+        const std::chrono::system_clock::time_point origin = std::chrono::system_clock::now();
+        std::atomic<std::uint32_t> epoch{0};
+
+        // queued interactions, delta batches, dirty lists and full refreshes not yet done
+        std::atomic<std::int64_t> pending{0};
+        std::mutex idle_mutex;
+        std::condition_variable idle;
+
+        std::atomic<bool> stopping{false};
+        std::function<void(std::string_view)> on_applied;
+
+        std::atomic<bool> merge_due{false};
+        std::mutex merge_mutex;
+        std::condition_variable merge_wake;
+        std::thread merger;
+    };
+
+    void RecommendationEngine::Impl::run(std::size_t index) {
+        Shard &shard = *shards[index];
+        std::vector<Interaction> interactions;
+        std::vector<Delta> deltas;
+        while (true) {
+            std::size_t batches;
+            bool refresh_all;
+            {
+                std::unique_lock lock(shard.mutex);
+                shard.wake.wait(lock, [&]() {
+                    return stopping || !shard.interactions.empty() || !shard.deltas.empty() || shard.refresh_all ||
+                           !shard.dirty.empty();
+                });
+                if (stopping) return;
+                interactions.swap(shard.interactions);
+                deltas.swap(shard.deltas);
+                batches = std::exchange(shard.delta_batches, 0);
+                refresh_all = std::exchange(shard.refresh_all, false);
+            }
+            // no sooner: the epoch of all that was just taken is at most this
+            shard.epoch = epoch.load(std::memory_order_acquire);
+
+            if (!interactions.empty()) {
+                for (const Interaction &interaction: interactions) apply_interaction(shard, interaction);
+                // the deltas are pending before the interactions stop being
+                send_outboxes(shard);
+                if (on_applied) {
+                    for (std::size_t i = 0; i < interactions.size(); ++i) {
+                        const std::uint32_t user = interactions[i].user;
+                        if (i == 0 || interactions[i - 1].user != user) on_applied(users.name(user));
+                    }
+                }
+                queued.fetch_sub(interactions.size(), std::memory_order_relaxed);
+                applied.fetch_add(interactions.size(), std::memory_order_relaxed);
+                done(static_cast<std::int64_t>(interactions.size()));
+                interactions.clear();
+            }
+
+            const std::size_t updated = deltas.size();
+            for (const Delta &delta: deltas) apply_delta(shard, delta);
+            deltas.clear();
+            done(static_cast<std::int64_t>(batches));
+
+            if (refresh_all) {
+                const auto count = static_cast<std::uint32_t>(item_names.size());
+                for (std::uint32_t item = static_cast<std::uint32_t>(index); item < count;
+                     item += static_cast<std::uint32_t>(shards.size())) {
+                    refresh(item);
+                }
+                done(1);
+            }
+
+            std::size_t spent = 0;
+            while (!shard.dirty.empty()) {
+                const std::uint32_t item = shard.dirty.front();
+                if (spent > 0 && spent + items[item].row.size() > config.refresh_budget) break;
+                shard.dirty.pop_front();
+                items[item].dirty = false;
+                spent += refresh(item) + 1;
+                done(1);
+            }
+
+            // A list also goes stale when its neighbors' statistics move, which nothing tracks.
+            // Sweeping the shard's items round robin, scanning as many cells as the batch
+            // updated, brings every list up to date eventually at no more than twice the cost.
+            const auto count = static_cast<std::uint32_t>(item_names.size());
+            for (std::size_t swept = 0; swept < updated && count > index;) {
+                if (shard.sweep_next >= count) shard.sweep_next = static_cast<std::uint32_t>(index);
+                swept += refresh(shard.sweep_next) + 1;
+                shard.sweep_next += static_cast<std::uint32_t>(shards.size());
+            }
+        }
+    }
+
+    void RecommendationEngine::Impl::apply_interaction(Shard &shard, const Interaction &interaction) {
+        const std::uint32_t item = interaction.item;
+        const std::size_t slot = interaction.user / shards.size();
+        if (user_items.add(interaction.user, item, interaction.weight) &&
+            !merge_due.exchange(true, std::memory_order_relaxed)) {
+            { const std::lock_guard lock(merge_mutex); }
+            merge_wake.notify_one();
+        }
+
+        const std::lock_guard lock(shard.histories_mutex);
+        if (slot >= shard.histories.size()) shard.histories.resize(slot + 1);
+        History &entry = shard.histories[slot];
+        if (entry.epoch < shard.epoch) {
+            for (auto &[other, other_weight]: entry.items) {
+                other_weight = static_cast<float>(rebase(other_weight, entry.epoch, shard.epoch, 1));
+            }
+            entry.epoch = shard.epoch;
+        }
+        const float weight = static_cast<float>(interaction.weight * boost(interaction.at, shard.epoch));
+        emit(shard, item, kPopularity, 0, weight);
+        std::vector<std::pair<std::uint32_t, float> > &history = entry.items;
+        const auto touched = std::find_if(history.begin(), history.end(),
+                                          [item](const auto &entry) { return entry.first == item; });
+        if (touched != history.end()) {
+            // more weight on a known item: only the dot products move
+            const float before = touched->second;
+            touched->second += weight;
+            emit(shard, item, kStats, 0, touched->second * touched->second - before * before);
+            for (const auto &[other, other_weight]: history) {
+                if (other == item) continue;
+                emit(shard, item, other, 0, weight * other_weight);
+                emit(shard, other, item, 0, weight * other_weight);
+            }
+            // most recently touched goes last
+            std::rotate(touched, touched + 1, history.end());
+            return;
+        }
+
+        if (history.size() == config.max_user_items) {
+            const auto [evicted, evicted_weight] = history.front();
+            history.erase(history.begin());
+            emit(shard, evicted, kStats, -1, -evicted_weight * evicted_weight);
+            for (const auto &[other, other_weight]: history) {
+                emit(shard, evicted, other, -1, -evicted_weight * other_weight);
+                emit(shard, other, evicted, -1, -evicted_weight * other_weight);
+            }
+        }
+        // the item's statistics reach its row ahead of its cells
+        emit(shard, item, kStats, 1, weight * weight);
+        for (const auto &[other, other_weight]: history) {
+            emit(shard, item, other, 1, weight * other_weight);
+            emit(shard, other, item, 1, weight * other_weight);
+        }
+        history.emplace_back(item, weight);
+    }
+
+    void RecommendationEngine::Impl::send_outboxes(Shard &shard) {
+        for (std::size_t to = 0; to < shards.size(); ++to) {
+            std::vector<Delta> &outbox = shard.outboxes[to];
+            if (outbox.empty()) continue;
+            pending.fetch_add(1, std::memory_order_relaxed);
+            Shard &target = *shards[to];
+            {
+                const std::lock_guard lock(target.mutex);
+                if (target.deltas.empty()) {
+                    target.deltas.swap(outbox);
+                } else {
+                    target.deltas.insert(target.deltas.end(), outbox.begin(), outbox.end());
+                }
+                ++target.delta_batches;
+            }
+            target.wake.notify_one();
+            outbox.clear();
+        }
+    }
+
+    void RecommendationEngine::Impl::apply_delta(Shard &shard, const Delta &delta) {
+        ItemState &state = items[delta.row];
+        rebase_item(delta.row, std::max(shard.epoch, delta.epoch));
+        const std::uint32_t epoch = state.epoch.load(std::memory_order_relaxed);
+        if (delta.column == kPopularity) {
+            state.popularity.store(state.popularity.load(std::memory_order_relaxed) +
+                                   rebase(delta.dot, delta.epoch, epoch, 1), std::memory_order_relaxed);
+            return;
+        }
+        const auto dot_delta = static_cast<float>(rebase(delta.dot, delta.epoch, epoch, 2));
+        if (delta.column == kStats) {
+            state.users.store(state.users.load(std::memory_order_relaxed) + delta.shared, std::memory_order_relaxed);
+            state.norm2.store(state.norm2.load(std::memory_order_relaxed) + dot_delta, std::memory_order_relaxed);
+            // a cosine list keeps its order when the item's own norm moves, the others do not
+            if (config.similarity != reco::Similarity::Cosine) mark_dirty(shard, delta.row);
+            return;
+        }
+
+        bool created;
+        CooccurrenceRow::Cell &cell = state.row.upsert(delta.column, created);
+        if (created) cooccurrences.fetch_add(1, std::memory_order_relaxed);
+        cell.shared += delta.shared;
+        cell.dot += dot_delta;
+        const std::uint32_t shared = cell.shared;
+        const float dot = cell.dot;
+        if (shared == 0) {
+            state.row.erase(cell);
+            cooccurrences.fetch_sub(1, std::memory_order_relaxed);
+        }
+        update_neighbor(delta.row, delta.column, shared, dot, score(delta.row, delta.column, shared, dot, epoch),
+                        shard);
+    }
+
+    void RecommendationEngine::Impl::update_neighbor(std::uint32_t row, std::uint32_t column, std::uint32_t shared,
+                                                     float dot, float score, Shard &shard) {
+        auto better = [](const Neighbor &a, const Neighbor &b) {
+            return a.score > b.score || (a.score == b.score && a.item < b.item);
+        };
+        const Neighbor entry{column, shared, dot, score};
+        // the other item's statistics may still be on their way, so a pair that counts is kept
+        // even if it scores nothing yet
+        const bool counts = shared >= config.min_support;
+        const std::size_t limit = config.neighbors;
+        bool lost_candidate = false;
+        {
+            const std::lock_guard lock(stripe(row));
+            std::vector<Neighbor> &neighbors = items[row].neighbors;
+            const auto found = std::find_if(neighbors.begin(), neighbors.end(),
+                                            [column](const Neighbor &n) { return n.item == column; });
+            const bool full = neighbors.size() >= limit;
+            if (found != neighbors.end()) {
+                neighbors.erase(found);
+                // an item outside a full list may now beat whatever comes last
+                if (!counts) {
+                    lost_candidate = full;
+                } else {
+                    const auto at = std::lower_bound(neighbors.begin(), neighbors.end(), entry, better);
+                    lost_candidate = full && at == neighbors.end();
+                    neighbors.insert(at, entry);
+                }
+            } else if (counts && limit > 0 && (!full || better(entry, neighbors.back()))) {
+                neighbors.insert(std::lower_bound(neighbors.begin(), neighbors.end(), entry, better), entry);
+                if (neighbors.size() > limit) neighbors.pop_back();
+            }
+        }
+        if (lost_candidate) mark_dirty(shard, row);
+    }
+
+    void RecommendationEngine::Impl::mark_dirty(Shard &shard, std::uint32_t item) {
+        ItemState &state = items[item];
+        if (state.dirty) return;
+        state.dirty = true;
+        pending.fetch_add(1, std::memory_order_relaxed);
+        shard.dirty.push_back(item);
+    }
+
+    std::size_t RecommendationEngine::Impl::refresh(std::uint32_t item) {
+        ItemState &state = items[item];
+        const std::uint32_t epoch = state.epoch.load(std::memory_order_relaxed);
+        std::vector<std::pair<float, std::uint32_t> > candidates;
+        candidates.reserve(state.row.size());
+        std::as_const(state.row).for_each([&](const CooccurrenceRow::Cell &cell) {
+            // kept even at zero, like in update_neighbor()
+            if (cell.shared >= config.min_support) {
+                candidates.emplace_back(score(item, cell.item, cell.shared, cell.dot, epoch), cell.item);
+            }
+        });
+        keep_best(candidates, config.neighbors);
+
+        std::vector<Neighbor> neighbors;
+        neighbors.reserve(candidates.size());
+        for (const auto &[similarity, other]: candidates) {
+            const CooccurrenceRow::Cell *cell = state.row.find(other);
+            neighbors.push_back(Neighbor{other, cell->shared, cell->dot, similarity});
+        }
+        {
+            const std::lock_guard lock(stripe(item));
+            state.neighbors.swap(neighbors);
+        }
+        return state.row.size();
+    }
+
+    RecommendationConfig RecommendationConfig::from_env() {
+        RecommendationConfig config;
+        if (const char *similarity = std::getenv("BEACON_RECO_SIMILARITY")) {
+            config.similarity = reco::parse_similarity(similarity);
+        }
+        if (const char *neighbors = std::getenv("BEACON_RECO_NEIGHBORS")) {
+            config.neighbors = std::strtoul(neighbors, nullptr, 10);
+        }
+        if (const char *items = std::getenv("BEACON_RECO_MAX_USER_ITEMS")) {
+            config.max_user_items = std::max(1UL, std::strtoul(items, nullptr, 10));
+        }
+        if (const char *support = std::getenv("BEACON_RECO_MIN_SUPPORT")) {
+            config.min_support = static_cast<std::uint32_t>(std::max(1UL, std::strtoul(support, nullptr, 10)));
+        }
+        if (const char *field = std::getenv("BEACON_RECO_USER_FIELD")) {
+            config.user_field = field;
+        }
+        if (const char *weights = std::getenv("BEACON_RECO_EVENT_WEIGHTS")) {
+            config.event_weights.clear();
+            std::istringstream entries(weights);
+            std::string entry;
+            while (std::getline(entries, entry, ',')) {
+                const auto equals = entry.find('=');
+                if (equals == std::string::npos) continue;
+                config.event_weights[entry.substr(0, equals)] = static_cast<float>(std::atof(entry.c_str() + equals + 1));
+            }
+        }
+        if (const char *threads = std::getenv("BEACON_RECO_THREADS")) {
+            config.update_threads = std::max(1UL, std::strtoul(threads, nullptr, 10));
+        }
+        if (const char *queued = std::getenv("BEACON_RECO_MAX_QUEUED")) {
+            config.max_queued = std::strtoul(queued, nullptr, 10);
+        }
+        if (const char *budget = std::getenv("BEACON_RECO_REFRESH_BUDGET")) {
+            config.refresh_budget = std::strtoul(budget, nullptr, 10);
+        }
+        if (const char *dimension = std::getenv("BEACON_RECO_EMBEDDING_DIM")) {
+            config.embedding_dimension = std::strtoul(dimension, nullptr, 10);
+        }
+        if (const char *metric = std::getenv("BEACON_RECO_EMBEDDING_METRIC")) {
+            config.embedding_metric = reco::parse_embedding_metric(metric);
+        }
+        if (const char *simd = std::getenv("BEACON_RECO_SIMD")) {
+            if (std::string(simd) != "auto") config.simd = reco::parse_simd(simd);
+        }
+        if (const char *m = std::getenv("BEACON_RECO_HNSW_M")) {
+            config.hnsw_m = std::strtoul(m, nullptr, 10);
+        }
+        if (const char *ef = std::getenv("BEACON_RECO_HNSW_EF_CONSTRUCTION")) {
+            config.hnsw_ef_construction = std::strtoul(ef, nullptr, 10);
+        }
+        if (const char *ef = std::getenv("BEACON_RECO_HNSW_EF_SEARCH")) {
+            config.hnsw_ef_search = std::strtoul(ef, nullptr, 10);
+        }
+        if (const char *quantization = std::getenv("BEACON_RECO_EMBEDDING_QUANTIZATION")) {
+            config.embedding_quantization = reco::parse_quantization(quantization);
+        }
+        if (const char *subspaces = std::getenv("BEACON_RECO_EMBEDDING_PQ_SUBSPACES")) {
+            config.embedding_pq_subspaces = std::strtoul(subspaces, nullptr, 10);
+        }
+        if (const char *rerank = std::getenv("BEACON_RECO_EMBEDDING_RERANK")) {
+            config.embedding_rerank = std::strtoul(rerank, nullptr, 10);
+        }
+        if (const char *half_life = std::getenv("BEACON_RECO_DECAY_HALF_LIFE")) {
+            config.decay_half_life = std::max(0.0, std::atof(half_life));
+        }
+        if (const char *merge = std::getenv("BEACON_RECO_INTERACTION_MERGE")) {
+            config.interaction_merge_every = std::max<std::size_t>(std::strtoul(merge, nullptr, 10), 1);
+        }
+        if (const char *entries = std::getenv("BEACON_RECO_INTERACTION_MAX_ENTRIES")) {
+            config.interaction_max_entries = std::strtoul(entries, nullptr, 10);
+        }
+        return config;
+    }
+
+    RecommendationEngine::RecommendationEngine(RecommendationConfig config)
+        : impl_(std::make_unique<Impl>(std::move(config))) {
+    }
+
+    RecommendationEngine::~RecommendationEngine() = default;
+
+    bool RecommendationEngine::observe(const nlohmann::json &event) {
+        const auto type = event.find("event_type");
+        if (type == event.end() || !type->is_string()) return false;
+        const auto weight = impl_->config.event_weights.find(type->get_ref<const std::string &>());
+        if (weight == impl_->config.event_weights.end()) return false;
+
+        const auto item = event.find("entity_id");
+        const auto payload = event.find("payload");
+        if (item == event.end() || !item->is_string() || payload == event.end() || !payload->is_object()) {
+            return false;
+        }
+        const auto user = payload->find(impl_->config.user_field);
+        if (user == payload->end() || user->is_null()) return false;
+
+        float strength = weight->second;
+        const auto rating = payload->find(impl_->config.rating_field);
+        if (rating != payload->end() && rating->is_number()) strength *= rating->get<float>();
+        if (!(strength > 0.0f) || !std::isfinite(strength)) return false;
+
+        if (user->is_string()) {
+            add_interaction(user->get_ref<const std::string &>(), item->get_ref<const std::string &>(), strength);
+        } else {
+            add_interaction(user->dump(), item->get_ref<const std::string &>(), strength);
+        }
+        return true;
+    }
+
+    void RecommendationEngine::add_interaction(std::string_view user, std::string_view item, float weight) {
+        impl_->enqueue(user, item, weight, std::chrono::system_clock::now());
+    }
+
+    void RecommendationEngine::add_interaction(std::string_view user, std::string_view item, float weight,
+                                               std::chrono::system_clock::time_point at) {
+        impl_->enqueue(user, item, weight, at);
+    }
+
+    void RecommendationEngine::flush() {
+        std::unique_lock lock(impl_->idle_mutex);
+        impl_->idle.wait(lock, [this]() { return impl_->pending.load(std::memory_order_acquire) == 0; });
+    }
+
+    void RecommendationEngine::set_on_applied(std::function<void(std::string_view user)> applied) {
+        impl_->on_applied = std::move(applied);
+    }
+
+    void RecommendationEngine::rebuild() {
+        for (auto &shard: impl_->shards) {
+            impl_->pending.fetch_add(1, std::memory_order_relaxed);
+            {
+                const std::lock_guard lock(shard->mutex);
+                shard->refresh_all = true;
+            }
+            shard->wake.notify_one();
+        }
+        impl_->version.fetch_add(1, std::memory_order_relaxed);
+        flush();
+    }
+
+    std::vector<reco::ScoredItem> RecommendationEngine::similar_items(const std::string &item, std::size_t k) const {
+        const std::optional<std::uint32_t> id = impl_->item_names.find(item);
+        if (!id) return {};
+
+        std::vector<Neighbor> neighbors;
+        std::uint32_t epoch;
+        {
+            const std::lock_guard lock(impl_->stripe(*id));
+            neighbors = impl_->items[*id].neighbors;
+            epoch = impl_->items[*id].epoch.load(std::memory_order_relaxed);
+        }
+        std::vector<std::pair<float, std::uint32_t> > candidates;
+        candidates.reserve(neighbors.size());
+        for (const Neighbor &neighbor: neighbors) {
+            const float score = impl_->score(*id, neighbor.item, neighbor.shared, neighbor.dot, epoch);
+            if (score > 0.0f) candidates.emplace_back(score, neighbor.item);
+        }
+        keep_best(candidates, k);
+
+        std::vector<reco::ScoredItem> result;
+        result.reserve(candidates.size());
+        for (const auto &[score, other]: candidates) {
+            result.push_back({std::string(impl_->item_names.name(other)), score});
+        }
+        return result;
+    }
+
+    std::vector<reco::ScoredItem> RecommendationEngine::popular(std::size_t k) const {
+        const std::size_t count = impl_->item_names.size();
+        const double now = impl_->seconds(std::chrono::system_clock::now());
+        std::vector<std::pair<float, std::uint32_t> > candidates;
+        candidates.reserve(count);
+        for (std::uint32_t item = 0; item < count; ++item) {
+            const Impl::Statistics statistics = Impl::statistics(impl_->items[item]);
+            const auto popularity = static_cast<float>(statistics.popularity / impl_->boost(now, statistics.epoch));
+            if (popularity > 0.0f) candidates.emplace_back(popularity, item);
+        }
+        keep_best(candidates, k);
+
+        std::vector<reco::ScoredItem> result;
+        result.reserve(candidates.size());
+        for (const auto &[score, item]: candidates) {
+            result.push_back({std::string(impl_->item_names.name(item)), score});
+        }
+        return result;
+    }
+
+    std::vector<reco::ScoredItem> RecommendationEngine::recommend(const std::string &user, std::size_t k) const {
+        const std::optional<std::uint32_t> id = impl_->users.find(user);
+        if (!id) return {};
+        const Impl::History history = impl_->history_of(*id);
+        if (history.items.empty()) return {};
+
+        // the history's weights as they are now
+        const auto now = static_cast<float>(impl_->decay_now(history.epoch));
+        std::unordered_map<std::uint32_t, float> scores;
+        std::vector<Neighbor> neighbors;
+        for (const auto &[item, weight]: history.items) {
+            std::uint32_t epoch;
+            {
+                const std::lock_guard lock(impl_->stripe(item));
+                neighbors = impl_->items[item].neighbors;
+                epoch = impl_->items[item].epoch.load(std::memory_order_relaxed);
+            }
+            for (const Neighbor &neighbor: neighbors) {
+                scores[neighbor.item] += weight * now *
+                        impl_->score(item, neighbor.item, neighbor.shared, neighbor.dot, epoch);
+            }
+        }
+        for (const auto &[item, weight]: history.items) scores.erase(item);
+
+        std::vector<std::pair<float, std::uint32_t> > candidates;
+        candidates.reserve(scores.size());
+        for (const auto &[item, score]: scores) {
+            if (score > 0.0f) candidates.emplace_back(score, item);
+        }
+        keep_best(candidates, k);
+
+        std::vector<reco::ScoredItem> result;
+        result.reserve(candidates.size());
+        for (const auto &[score, item]: candidates) {
+            result.push_back({std::string(impl_->item_names.name(item)), score});
+        }
+        return result;
+    }
+
+    void RecommendationEngine::set_embedding(const std::string &item, const std::vector<float> &embedding) {
+        impl_->check_embedding(embedding);
+        const std::uint32_t id = impl_->intern_item(item);
+        if (impl_->hnsw) {
+            const std::shared_lock lock(impl_->embeddings_mutex);
+            impl_->hnsw->add(id, embedding.data());
+            return;
+        }
+        const std::unique_lock lock(impl_->embeddings_mutex);
+        if (impl_->quantized) impl_->quantized->set(id, embedding.data());
+        else impl_->embeddings.set(id, embedding.data());
+    }
+
+    void RecommendationEngine::set_embeddings(
+        const std::vector<std::pair<std::string, std::vector<float> > > &embeddings, std::size_t threads) {
+        for (const auto &[item, embedding]: embeddings) impl_->check_embedding(embedding);
+        if (!impl_->hnsw) {
+            for (const auto &[item, embedding]: embeddings) set_embedding(item, embedding);
+            return;
+        }
+        std::vector<std::uint32_t> labels;
+        std::vector<float> values;
+        labels.reserve(embeddings.size());
+        values.reserve(embeddings.size() * impl_->config.embedding_dimension);
+        for (const auto &[item, embedding]: embeddings) {
+            labels.push_back(impl_->intern_item(item));
+            values.insert(values.end(), embedding.begin(), embedding.end());
+        }
+        const std::shared_lock lock(impl_->embeddings_mutex);
+        impl_->hnsw->add_all(labels, values.data(), threads);
+    }
+
+    std::vector<reco::ScoredItem> RecommendationEngine::similar_by_embedding(const std::string &item,
+                                                                             std::size_t k) const {
+        const std::optional<std::uint32_t> id = impl_->item_names.find(item);
+        if (!id || k == 0) return {};
+        std::vector<std::pair<float, std::uint32_t> > top;
+        {
+            const std::shared_lock lock(impl_->embeddings_mutex);
+            const std::vector<float> query = impl_->embedding(*id);
+            if (query.empty()) return {};
+            // the item itself is among the best
+            top = impl_->top_embeddings(query.data(), k + 1);
+        }
+        std::erase_if(top, [&id](const auto &scored) { return scored.second == *id; });
+        if (top.size() > k) top.resize(k);
+
+        std::vector<reco::ScoredItem> result;
+        result.reserve(top.size());
+        for (const auto &[score, other]: top) result.push_back({std::string(impl_->item_names.name(other)), score});
+        return result;
+    }
+
+    std::vector<reco::ScoredItem> RecommendationEngine::nearest(const std::vector<float> &query, std::size_t k) const {
+        if (query.size() != impl_->config.embedding_dimension) return {};
+        std::vector<std::pair<float, std::uint32_t> > top;
+        {
+            const std::shared_lock lock(impl_->embeddings_mutex);
+            top = impl_->top_embeddings(query.data(), k);
+        }
+        std::vector<reco::ScoredItem> result;
+        result.reserve(top.size());
+        for (const auto &[score, item]: top) result.push_back({std::string(impl_->item_names.name(item)), score});
+        return result;
+    }
+
+    // An embeddings file: the number of item names, each as a length and its bytes, ids in
+    // order, then the index, whose labels are those ids.
+    void RecommendationEngine::save_embeddings(const std::string &path) const {
+        const std::shared_lock lock(impl_->embeddings_mutex);
+        if (!impl_->hnsw) throw std::runtime_error("Embeddings are not indexed by HNSW");
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        const auto names = static_cast<std::uint32_t>(impl_->item_names.size());
+        out.write(reinterpret_cast<const char *>(&names), sizeof(names));
+        for (std::uint32_t id = 0; id < names; ++id) {
+            const std::string_view name = impl_->item_names.name(id);
+            const auto length = static_cast<std::uint32_t>(name.size());
+            out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+            out.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+        impl_->hnsw->save(out);
+        out.flush();
+        if (!out) throw std::runtime_error("Cannot write embeddings to " + path);
+    }
+
+    void RecommendationEngine::load_embeddings(const std::string &path) {
+        // an engine configured for brute force search keeps it
+        if (impl_->config.hnsw_m == 0) throw std::runtime_error("Embeddings are not indexed by HNSW");
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot open embeddings file " + path);
+        std::uint32_t names = 0;
+        in.read(reinterpret_cast<char *>(&names), sizeof(names));
+        std::vector<std::string> items;
+        for (std::uint32_t i = 0; in && i < names; ++i) {
+            std::uint32_t length = 0;
+            in.read(reinterpret_cast<char *>(&length), sizeof(length));
+            if (!in) break;
+            if (length > (1u << 20)) throw std::runtime_error("Corrupt item name in embeddings file " + path);
+            std::string name(length, '\0');
+            in.read(name.data(), static_cast<std::streamsize>(length));
+            items.push_back(std::move(name));
+        }
+        if (!in) throw std::runtime_error("Truncated embeddings file " + path);
+
+        std::unique_ptr<reco::HnswIndex> index = reco::HnswIndex::load(in);
+        if (index->config().dimension != impl_->config.embedding_dimension) {
+            throw std::runtime_error("Embeddings in " + path + " have " + std::to_string(index->config().dimension) +
+                                     " values, expected " + std::to_string(impl_->config.embedding_dimension));
+        }
+        // a label without a name would be some other item here, or none
+        bool unnamed = false;
+        index->relabel([&unnamed, &items](std::uint32_t label) {
+            unnamed = unnamed || label >= items.size();
+            return label;
+        });
+        if (unnamed) throw std::runtime_error("Embeddings in " + path + " have labels without item names");
+        // item ids in this process are whatever order items were first seen in
+        std::vector<std::uint32_t> ids;
+        ids.reserve(items.size());
+        for (const std::string &item: items) ids.push_back(impl_->intern_item(item));
+        index->relabel([&ids](std::uint32_t label) { return ids[label]; });
+
+        const std::unique_lock lock(impl_->embeddings_mutex);
+        impl_->hnsw = std::move(index);
+    }
+
+    // An ids file: the users' interner snapshot, then the items'.
+    void RecommendationEngine::save_ids(const std::string &path) const {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        impl_->users.snapshot(out);
+        impl_->item_names.snapshot(out);
+        out.flush();
+        if (!out) throw std::runtime_error("Cannot write ids to " + path);
+    }
+
+    void RecommendationEngine::load_ids(const std::string &path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("Cannot open ids file " + path);
+        if (impl_->users.size() != 0 || impl_->item_names.size() != 0) {
+            throw std::runtime_error("Ids were handed out before loading " + path);
+        }
+        impl_->users.restore(in);
+        impl_->user_count.store(impl_->users.size(), std::memory_order_relaxed);
+        impl_->item_names.restore(in);
+        for (std::uint32_t item = 0; item < impl_->item_names.size(); ++item) impl_->items.ensure(item);
+    }
+
+    std::vector<reco::AlsIteration> RecommendationEngine::train_factors(const reco::AlsConfig &config) {
+        const std::size_t f = impl_->config.embedding_dimension;
+        if (f == 0 || config.factors != f) {
+            throw std::invalid_argument("ALS needs " + std::to_string(f) + " factors, got " +
+                                        std::to_string(config.factors));
+        }
+        // ids in the matrix were handed out before they got there
+        const std::size_t user_count = impl_->users.size();
+        const std::size_t item_count = impl_->item_names.size();
+        const reco::CsrMatrix user_items = impl_->user_items.to_csr(user_count, item_count);
+
+        std::vector<reco::AlsIteration> iterations;
+        reco::AlsModel model = reco::train_als(user_items, config, [&iterations](const reco::AlsIteration &it) {
+            iterations.push_back(it);
+        });
+
+        // items nobody has interacted with keep no embedding rather than random factors
+        std::vector<bool> seen(item_count, false);
+        for (const std::uint32_t item: user_items.indices) seen[item] = true;
+        std::vector<std::uint32_t> labels;
+        std::vector<float> values;
+        for (std::uint32_t item = 0; item < item_count; ++item) {
+            if (!seen[item]) continue;
+            labels.push_back(item);
+            values.insert(values.end(), model.items.begin() + static_cast<std::ptrdiff_t>(item * f),
+                          model.items.begin() + static_cast<std::ptrdiff_t>((item + 1) * f));
+        }
+        std::unique_ptr<reco::HnswIndex> index;
+        std::unique_ptr<reco::QuantizedMatrix> quantized = impl_->make_quantized();
+        reco::EmbeddingMatrix matrix(f, impl_->config.simd.value_or(reco::detect_simd()));
+        if (impl_->config.hnsw_m > 0) {
+            reco::HnswConfig hnsw;
+            hnsw.dimension = f;
+            hnsw.metric = impl_->config.embedding_metric;
+            hnsw.m = impl_->config.hnsw_m;
+            hnsw.ef_construction = impl_->config.hnsw_ef_construction;
+            hnsw.ef_search = impl_->config.hnsw_ef_search;
+            index = std::make_unique<reco::HnswIndex>(hnsw);
+            index->add_all(labels, values.data(), config.threads > 0
+                                                      ? config.threads
+                                                      : std::max(1u, std::thread::hardware_concurrency()));
+        } else if (quantized) {
+            for (std::size_t i = 0; i < labels.size(); ++i) quantized->set(labels[i], values.data() + i * f);
+            quantized->train();
+        } else {
+            for (std::size_t i = 0; i < labels.size(); ++i) matrix.set(labels[i], values.data() + i * f);
+        }
+
+        const std::unique_lock lock(impl_->embeddings_mutex);
+        if (index) impl_->hnsw = std::move(index);
+        else if (quantized) impl_->quantized = std::move(quantized);
+        else impl_->embeddings = std::move(matrix);
+        impl_->user_factors = std::move(model.users);
+        impl_->factor_users = user_count;
+        return iterations;
+    }
+
+    std::vector<reco::ScoredItem> RecommendationEngine::recommend_by_factors(const std::string &user,
+                                                                             std::size_t k) const {
+        const std::optional<std::uint32_t> id = impl_->users.find(user);
+        if (!id || k == 0) return {};
+        const Impl::History history = impl_->history_of(*id);
+        std::vector<std::pair<float, std::uint32_t> > top;
+        {
+            const std::shared_lock lock(impl_->embeddings_mutex);
+            if (*id >= impl_->factor_users) return {};
+            const std::size_t f = impl_->config.embedding_dimension;
+            // enough to fill k once the user's own items are dropped
+            top = impl_->top_embeddings(impl_->user_factors.data() + *id * f, k + history.items.size());
+        }
+        std::erase_if(top, [&history](const auto &scored) {
+            return std::any_of(history.items.begin(), history.items.end(),
+                               [&scored](const auto &entry) { return entry.first == scored.second; });
+        });
+        if (top.size() > k) top.resize(k);
+
+        std::vector<reco::ScoredItem> result;
+        result.reserve(top.size());
+        for (const auto &[score, item]: top) result.push_back({std::string(impl_->item_names.name(item)), score});
+        return result;
+    }
+
+    RecommendationStats RecommendationEngine::stats() const {
+        RecommendationStats stats;
+        stats.interactions = impl_->applied.load(std::memory_order_relaxed);
+        stats.dropped = impl_->dropped.load(std::memory_order_relaxed);
+        stats.users = impl_->users.size();
+        stats.items = impl_->item_names.size();
+        stats.cooccurrences = static_cast<std::size_t>(std::max<std::int64_t>(
+            impl_->cooccurrences.load(std::memory_order_relaxed), 0));
+        stats.model_version = impl_->version.load(std::memory_order_relaxed);
+        {
+            const std::shared_lock lock(impl_->embeddings_mutex);
+            stats.embeddings = impl_->embedding_count();
+        }
+        stats.interaction_bytes = impl_->user_items.memory_bytes();
+        return stats;
+    }
+
+    std::uint64_t RecommendationEngine::model_version() const {
+        return impl_->version.load(std::memory_order_relaxed);
     }
-}
\ No newline at end of file
+} // namespace beacon
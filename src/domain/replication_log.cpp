@@ -0,0 +1,89 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/replication_log.h>
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace beacon::replication {
+    ReplicationConfig ReplicationConfig::from_env() {
+        ReplicationConfig config;
+        if (const char *upstream = std::getenv("BEACON_REPLICATE_FROM")) {
+            config.upstream = upstream;
+            config.log_events = 100000;
+        }
+        if (const char *events = std::getenv("BEACON_REPLICATION_LOG_EVENTS")) {
+            config.log_events = std::strtoul(events, nullptr, 10);
+        }
+        if (const char *bytes = std::getenv("BEACON_REPLICATION_LOG_BYTES")) {
+            config.log_bytes = std::strtoul(bytes, nullptr, 10);
+        }
+        if (const char *events = std::getenv("BEACON_REPLICATION_BATCH_EVENTS")) {
+            config.batch_events = std::max(1UL, std::strtoul(events, nullptr, 10));
+        }
+        if (const char *bytes = std::getenv("BEACON_REPLICATION_BATCH_BYTES")) {
+            config.batch_bytes = std::max(1UL, std::strtoul(bytes, nullptr, 10));
+        }
+        if (const char *in_flight = std::getenv("BEACON_REPLICATION_IN_FLIGHT")) {
+            config.max_in_flight = std::max(1UL, std::strtoul(in_flight, nullptr, 10));
+        }
+        return config;
+    }
+
+    ReplicationLog::ReplicationLog(std::size_t max_events, std::size_t max_bytes)
+        : max_events_(std::max<std::size_t>(max_events, 1)), max_bytes_(max_bytes) {
+    }
+
+    bool ReplicationLog::append(std::string message) {
+        const std::lock_guard lock(mutex_);
+        bytes_ += message.size();
+        entries_.push_back(std::make_shared<const std::string>(std::move(message)));
+        trim_locked();
+        return std::exchange(waited_for_, false);
+    }
+
+    void ReplicationLog::reset(std::uint64_t offset) {
+        const std::lock_guard lock(mutex_);
+        entries_.clear();
+        bytes_ = 0;
+        start_ = offset;
+    }
+
+    std::uint64_t ReplicationLog::read(std::uint64_t from, std::size_t max_events, std::size_t max_bytes,
+                                       std::vector<Entry> &out) {
+        const std::lock_guard lock(mutex_);
+        const std::uint64_t end = start_ + entries_.size();
+        if (from < start_ || from > end) from = start_;
+
+        std::size_t bytes = 0;
+        for (std::uint64_t offset = from; offset < end && out.size() < max_events; ++offset) {
+            const Entry &entry = entries_[offset - start_];
+            if (!out.empty() && bytes + entry->size() > max_bytes) break;
+            bytes += entry->size();
+            out.push_back(entry);
+        }
+        if (out.empty()) waited_for_ = true;
+        return from;
+    }
+
+    std::uint64_t ReplicationLog::start() const {
+        const std::lock_guard lock(mutex_);
+        return start_;
+    }
+
+    std::uint64_t ReplicationLog::end() const {
+        const std::lock_guard lock(mutex_);
+        return start_ + entries_.size();
+    }
+
+    void ReplicationLog::trim_locked() {
+        // the newest event stays, however large
+        while (entries_.size() > 1 && (entries_.size() > max_events_ || bytes_ > max_bytes_)) {
+            bytes_ -= entries_.front()->size();
+            entries_.pop_front();
+            ++start_;
+        }
+    }
+} // namespace beacon::replication
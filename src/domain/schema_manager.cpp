@@ -3,10 +3,81 @@
 //
 
 #include <beacon/schema_manager.h>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 
 namespace beacon {
     void SchemaManager::load() {
         std::cout << "SchemaManager loading..." << std::endl;
+
+        const char *path = std::getenv("BEACON_SCHEMAS");
+        if (path == nullptr) return;
+
+        std::ifstream file(path);
+        if (!file) throw SchemaError(std::string("cannot open schema file ") + path);
+
+        const nlohmann::json document = nlohmann::json::parse(file, nullptr, false);
+        if (document.is_discarded() || !document.is_object()) {
+            throw SchemaError(std::string("schema file ") + path + " is not a JSON object");
+        }
+        for (const auto &[topic, definition]: document.items()) {
+            auto schema = build(definition);
+            // schemas are named after their topic unless the definition says otherwise
+            if (schema->name().empty()) schema->set_identity(topic, schema->version());
+            add(topic, std::move(schema));
+        }
+        std::cout << "Loaded " << schemas_.size() << " schemas" << std::endl;
+    }
+
+    void SchemaManager::add(const std::string &topic,
+                            std::shared_ptr<const validation::AbstractSchemaValidator> schema) {
+        schemas_[topic] = std::move(schema);
+    }
+
+    const validation::AbstractSchemaValidator *SchemaManager::find(const std::string &topic) const {
+        const auto it = schemas_.find(topic);
+        return it == schemas_.end() ? nullptr : it->second.get();
+    }
+
+    std::shared_ptr<validation::AbstractSchemaValidator> SchemaManager::build(const nlohmann::json &definition) {
+        const auto fields = definition.find("fields");
+        if (!definition.is_object() || fields == definition.end() || !fields->is_object()) {
+            throw SchemaError("schema definition needs a \"fields\" object");
+        }
+
+        auto schema = std::make_shared<validation::AbstractSchemaValidator>();
+        try {
+            schema->set_identity(definition.value("name", ""), definition.value("version", 1));
+        } catch (const nlohmann::json::exception &e) {
+            throw SchemaError(std::string("schema name/version: ") + e.what());
+        }
+        for (const auto &[name, spec]: fields->items()) {
+            if (!spec.is_object()) throw SchemaError("field '" + name + "' must be an object");
+
+            try {
+                auto field = schema->field(name);
+                if (!spec.value("required", true)) field.optional();
+
+                const std::string type = spec.value("type", "");
+                if (type == "string") field.is_string();
+                else if (type == "non_empty_string") field.is_non_empty_string();
+                else if (type == "integer") field.is_integer();
+                else if (type == "boolean") field.is_boolean();
+                else if (type == "array") field.is_array();
+                else if (type == "object") field.is_object();
+                else if (!type.empty()) throw SchemaError("field '" + name + "' has unknown type '" + type + "'");
+
+                if (spec.contains("min_length")) field.min_length(spec.at("min_length").get<std::size_t>());
+                if (spec.contains("max_length")) field.max_length(spec.at("max_length").get<std::size_t>());
+                if (spec.contains("pattern")) field.matches_regex(spec.at("pattern").get<std::string>());
+                if (spec.contains("min")) field.min_integer(spec.at("min").get<int>());
+                if (spec.contains("max")) field.max_integer(spec.at("max").get<int>());
+                field.done();
+            } catch (const nlohmann::json::exception &e) {
+                throw SchemaError("field '" + name + "': " + e.what());
+            }
+        }
+        return schema;
     }
-} // namespace beacon
\ No newline at end of file
+} // namespace beacon
@@ -0,0 +1,170 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/streaming_validator.h>
+
+namespace beacon::validation {
+    StreamingEventValidator::StreamingEventValidator(SchemaLookup lookup) : lookup_(std::move(lookup)) {
+    }
+
+    bool StreamingEventValidator::null() {
+        return dom_.null() && value_done();
+    }
+
+    bool StreamingEventValidator::boolean(bool value) {
+        return dom_.boolean(value) && value_done();
+    }
+
+    bool StreamingEventValidator::number_integer(std::int64_t value) {
+        return dom_.number_integer(value) && value_done();
+    }
+
+    bool StreamingEventValidator::number_unsigned(std::uint64_t value) {
+        return dom_.number_unsigned(value) && value_done();
+    }
+
+    bool StreamingEventValidator::number_float(double value) {
+        return dom_.number_float(value) && value_done();
+    }
+
+    bool StreamingEventValidator::string(std::string &value) {
+        if (depth_ == 1 && root_key_ == "op") root_op_ = value;
+        return dom_.string(value) && value_done();
+    }
+
+    bool StreamingEventValidator::start_object() {
+        ++depth_;
+        if (batch_ && depth_ == kBatchEventDepth) {
+            // next element of the "events" array
+            schema_ = nullptr;
+            event_key_.clear();
+            ++event_index_;
+        }
+        return dom_.start_object();
+    }
+
+    bool StreamingEventValidator::key(std::string &value) {
+        if (depth_ == 1) root_key_ = value;
+        if (depth_ == event_depth_) {
+            event_key_ = value;
+        } else if (depth_ == event_depth_ + 1 && event_key_ == "payload") {
+            payload_key_ = value;
+        }
+        return dom_.key(value);
+    }
+
+    bool StreamingEventValidator::end_object() {
+        --depth_;
+        if (!dom_.end_object()) return false;
+        if (batch_ && depth_ == kBatchEventDepth - 1 && root_key_ == "events") return event_done();
+        return value_done();
+    }
+
+    bool StreamingEventValidator::start_array() {
+        ++depth_;
+        // an "events" array ahead of "op" is taken for a batch until finish() learns otherwise
+        if (depth_ == 2 && root_key_ == "events" && (root_op_.empty() || root_op_ == "publish_batch")) {
+            batch_ = true;
+            event_depth_ = kBatchEventDepth;
+        }
+        return dom_.start_array();
+    }
+
+    bool StreamingEventValidator::end_array() {
+        --depth_;
+        return dom_.end_array() && value_done();
+    }
+
+    bool StreamingEventValidator::finish() {
+        if (!result_) return false;
+        const std::string op = dom_.result().value("op", "");
+        // events of a batch were checked one by one as they ended
+        if (batch_ && op == "publish_batch") return true;
+        if (op != "publish") return true;
+        if (batch_) {
+            // "events" came first and skipped the checks of the root event's fields
+            batch_ = false;
+            event_depth_ = 1;
+            schema_ = nullptr;
+            if (dom_.result().contains("topic") && !resolve_schema()) return false;
+        }
+        return event_done();
+    }
+
+    void StreamingEventValidator::reset() {
+        dom_.reset();
+        schema_ = nullptr;
+        depth_ = 0;
+        event_depth_ = 1;
+        batch_ = false;
+        event_index_ = -1;
+        root_key_.clear();
+        root_op_.clear();
+        event_key_.clear();
+        payload_key_.clear();
+        result_ = ValidationResult::ok();
+    }
+
+    std::string StreamingEventValidator::topic() const {
+        const nlohmann::json &root = dom_.result();
+        const nlohmann::json *event = &root;
+        if (batch_) {
+            const auto events = root.find("events");
+            if (events == root.end() || !events->is_array() || events->empty()) return "";
+            event = &events->back();
+        }
+        const auto topic = event->find("topic");
+        return topic != event->end() && topic->is_string() ? topic->get<std::string>() : "";
+    }
+
+    nlohmann::json &StreamingEventValidator::current_event() {
+        return batch_ ? dom_.result()["events"].back() : dom_.result();
+    }
+
+    std::string StreamingEventValidator::payload_path() const {
+        return batch_ ? "events[" + std::to_string(event_index_) + "].payload" : "payload";
+    }
+
+    bool StreamingEventValidator::value_done() {
+        // depth_ is the depth of the container the completed value sits in
+        if (depth_ == event_depth_ && event_key_ == "topic") return resolve_schema();
+        if (depth_ != event_depth_ + 1 || event_key_ != "payload" || schema_ == nullptr) return true;
+
+        const nlohmann::json &payload = current_event()["payload"];
+        if (!payload.is_object()) return true;
+        result_ = schema_->validate_field(payload_key_, payload[payload_key_]).prepend_path(payload_path());
+        return static_cast<bool>(result_);
+    }
+
+    bool StreamingEventValidator::event_done() {
+        if (schema_ == nullptr) return true;
+
+        const nlohmann::json &event = current_event();
+        const auto payload = event.find("payload");
+        if (payload == event.end()) {
+            result_ = ValidationResult::fail("Missing payload", payload_path());
+        } else {
+            result_ = schema_->validate_required(*payload).prepend_path(payload_path());
+        }
+        return static_cast<bool>(result_);
+    }
+
+    bool StreamingEventValidator::resolve_schema() {
+        const nlohmann::json &event = current_event();
+        const nlohmann::json &topic = event["topic"];
+        if (!lookup_ || !topic.is_string()) return true;
+
+        schema_ = lookup_(topic.get_ref<const std::string &>());
+        if (schema_ == nullptr) return true;
+
+        // catch up on payload fields that preceded the topic
+        const auto payload = event.find("payload");
+        if (payload == event.end() || !payload->is_object()) return true;
+        for (const auto &[name, value]: payload->items()) {
+            result_ = schema_->validate_field(name, value).prepend_path(payload_path());
+            if (!result_) return false;
+        }
+        return true;
+    }
+} // namespace beacon::validation
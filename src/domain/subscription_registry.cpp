@@ -0,0 +1,73 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/subscription_registry.h>
+#include <algorithm>
+
+namespace beacon {
+    SubscriptionId SubscriptionRegistry::add(Subscription subscription) {
+        const SubscriptionId id = next_id_++;
+        subscription.id = id;
+
+        Topic &topic = by_topic_[subscription.topic];
+        Slot slot;
+        if (topic.free_slots.empty()) {
+            slot = static_cast<Slot>(topic.slots.size());
+            topic.slots.emplace_back();
+        } else {
+            slot = topic.free_slots.back();
+            topic.free_slots.pop_back();
+        }
+
+        topic.index.add(slot, subscription.filter);
+        ++topic.live;
+        locations_.emplace(id, Location{subscription.topic, slot});
+        by_connection_[subscription.connection].push_back(id);
+        topic.slots[slot] = std::move(subscription);
+        return id;
+    }
+
+    bool SubscriptionRegistry::remove(std::uint64_t connection, SubscriptionId id) {
+        const auto location = locations_.find(id);
+        if (location == locations_.end()) return false;
+
+        const auto topic_it = by_topic_.find(location->second.topic);
+        Topic &topic = topic_it->second;
+        Subscription &subscription = topic.slots[location->second.slot];
+        if (subscription.connection != connection) return false;
+
+        topic.index.remove(location->second.slot);
+        subscription = Subscription{};
+        topic.free_slots.push_back(location->second.slot);
+        if (--topic.live == 0) by_topic_.erase(topic_it);
+        locations_.erase(location);
+
+        auto &owned = by_connection_[connection];
+        owned.erase(std::remove(owned.begin(), owned.end(), id), owned.end());
+        if (owned.empty()) by_connection_.erase(connection);
+        return true;
+    }
+
+    void SubscriptionRegistry::remove_connection(std::uint64_t connection) {
+        const auto it = by_connection_.find(connection);
+        if (it == by_connection_.end()) return;
+
+        const std::vector<SubscriptionId> owned = it->second;
+        for (const SubscriptionId id: owned) {
+            remove(connection, id);
+        }
+    }
+
+    void SubscriptionRegistry::match(const std::string &topic, const nlohmann::json &payload,
+                                     std::vector<const Subscription *> &out) {
+        const auto it = by_topic_.find(topic);
+        if (it == by_topic_.end()) return;
+
+        matched_slots_.clear();
+        it->second.index.match(payload, matched_slots_);
+        for (const Slot slot: matched_slots_) {
+            out.push_back(&it->second.slots[slot]);
+        }
+    }
+} // namespace beacon
@@ -0,0 +1,481 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/trending.h>
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace beacon::trending {
+    namespace {
+        constexpr std::int64_t kNone = std::numeric_limits<std::int64_t>::min();
+
+        std::uint64_t hash_of(std::string_view item) {
+            // the sketch rows index by both halves of the hash, so mix it
+            std::uint64_t x = std::hash<std::string_view>{}(item);
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+
+        std::int64_t bucket_of(Clock::time_point at, Clock::duration span) {
+            const std::int64_t ticks = at.time_since_epoch().count();
+            const std::int64_t width = span.count();
+            return ticks / width - (ticks % width < 0 ? 1 : 0);
+        }
+
+        /**
+         * "90s", "5m", "1h" or "7d"; zero if malformed.
+         */
+        Clock::duration parse_span(const std::string &name) {
+            char *end = nullptr;
+            const unsigned long amount = std::strtoul(name.c_str(), &end, 10);
+            if (end == name.c_str() || end + 1 != name.c_str() + name.size()) return Clock::duration::zero();
+            switch (*end) {
+                case 's':
+                    return std::chrono::seconds(amount);
+                case 'm':
+                    return std::chrono::minutes(amount);
+                case 'h':
+                    return std::chrono::hours(amount);
+                case 'd':
+                    return std::chrono::hours(24 * amount);
+                default:
+                    return Clock::duration::zero();
+            }
+        }
+    } // namespace
+
+    TrendingConfig TrendingConfig::from_env() {
+        TrendingConfig config;
+        if (const char *windows = std::getenv("BEACON_TRENDING_WINDOWS")) {
+            std::vector<Window> parsed;
+            std::istringstream entries(windows);
+            std::string entry;
+            while (std::getline(entries, entry, ',')) {
+                const auto equals = entry.find('=');
+                if (equals == std::string::npos) continue;
+                const std::string name = entry.substr(0, equals);
+                const Clock::duration span = parse_span(name);
+                const unsigned long buckets = std::strtoul(entry.c_str() + equals + 1, nullptr, 10);
+                if (span <= Clock::duration::zero() || buckets == 0) continue;
+                parsed.push_back(Window{name, span, buckets});
+            }
+            if (!parsed.empty()) config.windows = std::move(parsed);
+        }
+        if (const char *width = std::getenv("BEACON_TRENDING_SKETCH_WIDTH")) {
+            config.sketch_width = std::max<std::size_t>(1, std::strtoul(width, nullptr, 10));
+        }
+        if (const char *depth = std::getenv("BEACON_TRENDING_SKETCH_DEPTH")) {
+            config.sketch_depth = std::max<std::size_t>(1, std::strtoul(depth, nullptr, 10));
+        }
+        if (const char *heavy = std::getenv("BEACON_TRENDING_HEAVY_HITTERS")) {
+            config.heavy_hitters = std::strtoul(heavy, nullptr, 10);
+        }
+        if (const char *streams = std::getenv("BEACON_TRENDING_MAX_STREAMS")) {
+            config.max_streams = std::strtoul(streams, nullptr, 10);
+        }
+        if (const char *field = std::getenv("BEACON_TRENDING_CATEGORY_FIELD")) {
+            config.category_field = field;
+        }
+        return config;
+    }
+
+    CountMinSketch::CountMinSketch(std::size_t width, std::size_t depth)
+        : depth_(std::clamp<std::size_t>(depth, 1, kLine)), lane_(kLine / depth_) {
+        const std::size_t lines = std::bit_ceil(std::max<std::size_t>(width * depth_ / kLine, 1));
+        lines_mask_ = lines - 1;
+        counters_.assign(lines * kLine, 0);
+    }
+
+    void CountMinSketch::add(std::uint64_t hash, std::uint32_t count) {
+        std::uint32_t *line = counters_.data() + (hash & lines_mask_) * kLine;
+        // the high half picks the counter in each row's lane, the low half the line
+        std::uint64_t pick = hash >> 32;
+        for (std::size_t row = 0; row < depth_; ++row, pick = pick * 0x9e3779b97f4a7c15ULL >> 7) {
+            line[row * lane_ + pick % lane_] += count;
+        }
+    }
+
+    std::uint32_t CountMinSketch::estimate(std::uint64_t hash) const {
+        const std::uint32_t *line = counters_.data() + (hash & lines_mask_) * kLine;
+        std::uint64_t pick = hash >> 32;
+        std::uint32_t least = std::numeric_limits<std::uint32_t>::max();
+        for (std::size_t row = 0; row < depth_; ++row, pick = pick * 0x9e3779b97f4a7c15ULL >> 7) {
+            least = std::min(least, line[row * lane_ + pick % lane_]);
+        }
+        return least;
+    }
+
+    void CountMinSketch::add(const CountMinSketch &other) {
+        for (std::size_t i = 0; i < counters_.size(); ++i) counters_[i] += other.counters_[i];
+    }
+
+    void CountMinSketch::subtract(const CountMinSketch &other) {
+        for (std::size_t i = 0; i < counters_.size(); ++i) counters_[i] -= other.counters_[i];
+    }
+
+    void CountMinSketch::clear() {
+        std::fill(counters_.begin(), counters_.end(), 0);
+    }
+
+    SpaceSaving::SpaceSaving(std::size_t capacity)
+        : capacity_(capacity), slots_(std::bit_ceil(std::max<std::size_t>(capacity * 2, 2)), kEmpty) {
+        entries_.reserve(capacity);
+        heap_.reserve(capacity);
+        places_.reserve(capacity);
+    }
+
+    std::size_t SpaceSaving::find(std::string_view item, std::uint64_t hash) const {
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            if (slots_[slot] == kEmpty) return slot;
+            const Entry &entry = entries_[slots_[slot]];
+            if (entry.hash == hash && entry.item == item) return slot;
+        }
+    }
+
+    void SpaceSaving::erase_slot(std::size_t slot) {
+        // backward shift: pull later entries of the probe run into the hole where they belong
+        const std::size_t mask = slots_.size() - 1;
+        for (std::size_t next = slot;;) {
+            slots_[slot] = kEmpty;
+            while (true) {
+                next = (next + 1) & mask;
+                if (slots_[next] == kEmpty) return;
+                const std::size_t home = entries_[slots_[next]].hash & mask;
+                const bool stays = slot <= next ? slot < home && home <= next : slot < home || home <= next;
+                if (!stays) break;
+            }
+            slots_[slot] = slots_[next];
+            slot = next;
+        }
+    }
+
+    void SpaceSaving::add(std::string_view item, std::uint64_t hash, std::uint32_t count) {
+        if (capacity_ == 0) return;
+        const std::size_t slot = find(item, hash);
+        if (slots_[slot] != kEmpty) {
+            entries_[slots_[slot]].count += count;
+            sift_down(places_[slots_[slot]]);
+            return;
+        }
+        if (entries_.size() < capacity_) {
+            const auto id = static_cast<std::uint32_t>(entries_.size());
+            entries_.push_back(Entry{std::string(item), hash, count, 0});
+            slots_[slot] = id;
+            heap_.push_back(id);
+            places_.push_back(id);
+            sift_up(id);
+            return;
+        }
+        const std::uint32_t id = heap_[0];
+        Entry &entry = entries_[id];
+        erase_slot(find(entry.item, entry.hash));
+        entry.item.assign(item);
+        entry.hash = hash;
+        entry.error = entry.count;
+        entry.count += count;
+        slots_[find(item, hash)] = id;
+        sift_down(0);
+    }
+
+    void SpaceSaving::sift_up(std::size_t at) {
+        const std::uint32_t id = heap_[at];
+        const std::uint32_t count = entries_[id].count;
+        while (at > 0) {
+            const std::size_t parent = (at - 1) / 2;
+            if (entries_[heap_[parent]].count <= count) break;
+            heap_[at] = heap_[parent];
+            places_[heap_[at]] = static_cast<std::uint32_t>(at);
+            at = parent;
+        }
+        heap_[at] = id;
+        places_[id] = static_cast<std::uint32_t>(at);
+    }
+
+    void SpaceSaving::sift_down(std::size_t at) {
+        const std::uint32_t id = heap_[at];
+        const std::uint32_t count = entries_[id].count;
+        while (true) {
+            std::size_t child = 2 * at + 1;
+            if (child >= heap_.size()) break;
+            if (child + 1 < heap_.size() && entries_[heap_[child + 1]].count < entries_[heap_[child]].count) ++child;
+            if (entries_[heap_[child]].count >= count) break;
+            heap_[at] = heap_[child];
+            places_[heap_[at]] = static_cast<std::uint32_t>(at);
+            at = child;
+        }
+        heap_[at] = id;
+        places_[id] = static_cast<std::uint32_t>(at);
+    }
+
+    void SpaceSaving::clear() {
+        if (!entries_.empty()) std::fill(slots_.begin(), slots_.end(), kEmpty);
+        entries_.clear();
+        heap_.clear();
+        places_.clear();
+    }
+
+    std::size_t SpaceSaving::memory_bytes() const {
+        std::size_t bytes = entries_.capacity() * sizeof(Entry) +
+                            (heap_.capacity() + places_.capacity() + slots_.capacity()) * sizeof(std::uint32_t);
+        for (const Entry &entry: entries_) {
+            if (entry.item.capacity() > std::string().capacity()) bytes += entry.item.capacity() + 1;
+        }
+        return bytes;
+    }
+
+    struct TrendingTracker::Stream {
+        struct Bucket {
+            std::int64_t index = kNone;
+            CountMinSketch sketch;
+            SpaceSaving heavy;
+        };
+
+        struct Candidate {
+            std::string item;
+            std::uint64_t hash;
+        };
+
+        // one window
+        struct Ring {
+            Clock::duration bucket_span;
+            std::vector<Bucket> buckets;
+            // sum of the buckets' sketches
+            CountMinSketch total;
+            std::int64_t latest = kNone;
+            // best heavy hitters of the buckets before `latest`, as of when it became latest
+            std::vector<Candidate> settled;
+            std::int64_t settled_at = kNone;
+        };
+
+        std::mutex mutex;
+        std::vector<Ring> rings;
+
+        explicit Stream(const TrendingConfig &config) {
+            rings.reserve(config.windows.size());
+            for (const Window &window: config.windows) {
+                Ring ring{
+                    window.span / static_cast<Clock::rep>(window.buckets), {},
+                    CountMinSketch(config.sketch_width, config.sketch_depth), kNone, {}, kNone
+                };
+                ring.buckets.reserve(window.buckets);
+                for (std::size_t i = 0; i < window.buckets; ++i) {
+                    ring.buckets.push_back(Bucket{
+                        kNone, CountMinSketch(config.sketch_width, config.sketch_depth),
+                        SpaceSaving(config.heavy_hitters)
+                    });
+                }
+                rings.push_back(std::move(ring));
+            }
+        }
+
+        /**
+         * Slides the window to end with bucket `index`, dropping those that fall out of it.
+         */
+        static void advance(Ring &ring, std::int64_t index) {
+            if (ring.latest != kNone && index <= ring.latest) return;
+            const auto count = static_cast<std::int64_t>(ring.buckets.size());
+            const bool all = ring.latest == kNone || index - ring.latest >= count;
+            for (Bucket &bucket: ring.buckets) {
+                if (bucket.index == kNone || (!all && bucket.index > index - count)) continue;
+                if (!all) ring.total.subtract(bucket.sketch);
+                bucket.index = kNone;
+                bucket.sketch.clear();
+                bucket.heavy.clear();
+            }
+            if (all) ring.total.clear();
+            ring.latest = index;
+        }
+
+        static Bucket &slot(Ring &ring, std::int64_t index) {
+            const auto count = static_cast<std::int64_t>(ring.buckets.size());
+            return ring.buckets[static_cast<std::size_t>((index % count + count) % count)];
+        }
+
+        static void add(Ring &ring, std::string_view item, std::uint64_t hash, Clock::time_point at,
+                        std::uint32_t count) {
+            const std::int64_t index = bucket_of(at, ring.bucket_span);
+            advance(ring, index);
+            if (index <= ring.latest - static_cast<std::int64_t>(ring.buckets.size())) return;
+            // what is left in the window is in distinct slots, so this one holds `index` or nothing
+            Bucket &bucket = slot(ring, index);
+            bucket.index = index;
+            bucket.sketch.add(hash, count);
+            bucket.heavy.add(item, hash, count);
+            ring.total.add(hash, count);
+        }
+
+        static std::vector<TrendingItem> top(Ring &ring, Clock::time_point now, std::size_t k, std::size_t keep) {
+            advance(ring, bucket_of(now, ring.bucket_span));
+            if (ring.latest == kNone) return {};
+
+            std::vector<std::pair<std::uint32_t, const Candidate *> > ranked;
+            if (ring.settled_at != ring.latest) {
+                std::vector<Candidate> merged;
+                for (const Bucket &bucket: ring.buckets) {
+                    if (bucket.index == kNone || bucket.index == ring.latest) continue;
+                    for (const SpaceSaving::Entry &entry: bucket.heavy.entries()) {
+                        merged.push_back(Candidate{entry.item, entry.hash});
+                    }
+                }
+                std::sort(merged.begin(), merged.end(), [](const Candidate &a, const Candidate &b) {
+                    return a.item < b.item;
+                });
+                merged.erase(std::unique(merged.begin(), merged.end(), [](const Candidate &a, const Candidate &b) {
+                    return a.item == b.item;
+                }), merged.end());
+                ranked.reserve(merged.size());
+                for (const Candidate &candidate: merged) {
+                    ranked.emplace_back(ring.total.estimate(candidate.hash), &candidate);
+                }
+                const std::size_t kept = std::min(keep, ranked.size());
+                std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(kept), ranked.end(),
+                                  [](const auto &a, const auto &b) { return a.first > b.first; });
+                ring.settled.clear();
+                for (std::size_t i = 0; i < kept; ++i) ring.settled.push_back(*ranked[i].second);
+                ring.settled_at = ring.latest;
+                ranked.clear();
+            }
+
+            std::vector<std::pair<std::uint32_t, std::string_view> > scored;
+            scored.reserve(ring.settled.size() + keep);
+            for (const Candidate &candidate: ring.settled) {
+                scored.emplace_back(ring.total.estimate(candidate.hash), candidate.item);
+            }
+            const Bucket &current = slot(ring, ring.latest);
+            if (current.index == ring.latest) {
+                for (const SpaceSaving::Entry &entry: current.heavy.entries()) {
+                    scored.emplace_back(ring.total.estimate(entry.hash), entry.item);
+                }
+            }
+            // one item may be both settled and current
+            std::sort(scored.begin(), scored.end(), [](const auto &a, const auto &b) { return a.second < b.second; });
+            scored.erase(std::unique(scored.begin(), scored.end(), [](const auto &a, const auto &b) {
+                return a.second == b.second;
+            }), scored.end());
+            const std::size_t kept = std::min(k, scored.size());
+            std::partial_sort(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(kept), scored.end(),
+                              [](const auto &a, const auto &b) {
+                                  return a.first != b.first ? a.first > b.first : a.second < b.second;
+                              });
+            std::vector<TrendingItem> result;
+            result.reserve(kept);
+            for (std::size_t i = 0; i < kept; ++i) result.push_back({std::string(scored[i].second), scored[i].first});
+            return result;
+        }
+
+        std::size_t memory_bytes() const {
+            std::size_t bytes = sizeof(Stream);
+            for (const Ring &ring: rings) {
+                bytes += ring.total.memory_bytes();
+                for (const Bucket &bucket: ring.buckets) {
+                    bytes += sizeof(Bucket) + bucket.sketch.memory_bytes() + bucket.heavy.memory_bytes();
+                }
+                for (const Candidate &candidate: ring.settled) bytes += sizeof(Candidate) + candidate.item.capacity();
+            }
+            return bytes;
+        }
+    };
+
+    TrendingTracker::TrendingTracker(TrendingConfig config) : config_(std::move(config)) {
+        if (config_.windows.empty()) throw std::invalid_argument("Trending needs at least one window");
+        for (const Window &window: config_.windows) {
+            if (window.buckets == 0 || window.span < Clock::duration(static_cast<Clock::rep>(window.buckets))) {
+                throw std::invalid_argument("Trending window '" + window.name + "' has no room for its buckets");
+            }
+        }
+    }
+
+    TrendingTracker::~TrendingTracker() = default;
+
+    TrendingTracker::Stream *TrendingTracker::stream(std::string_view event_type, std::string_view category,
+                                                     bool create) {
+        // types and categories are names: a NUL cannot be part of either
+        thread_local std::string key;
+        key.assign(event_type);
+        key.push_back('\0');
+        key.append(category);
+        {
+            const std::shared_lock lock(streams_mutex_);
+            if (const auto found = streams_.find(key); found != streams_.end()) return found->second.get();
+            if (!create || streams_.size() >= config_.max_streams) return nullptr;
+        }
+        const std::unique_lock lock(streams_mutex_);
+        auto &stream = streams_[key];
+        if (!stream) {
+            if (streams_.size() > config_.max_streams) {
+                streams_.erase(key);
+                return nullptr;
+            }
+            stream = std::make_unique<Stream>(config_);
+        }
+        return stream.get();
+    }
+
+    bool TrendingTracker::observe(const nlohmann::json &event) {
+        const auto type = event.find("event_type");
+        const auto item = event.find("entity_id");
+        if (type == event.end() || !type->is_string() || item == event.end() || !item->is_string()) return false;
+
+        std::string category;
+        if (const auto payload = event.find("payload"); payload != event.end() && payload->is_object()) {
+            const auto field = payload->find(config_.category_field);
+            if (field != payload->end() && field->is_string()) category = field->get<std::string>();
+            else if (field != payload->end() && field->is_number()) category = field->dump();
+        }
+        add(type->get_ref<const std::string &>(), category, item->get_ref<const std::string &>());
+        return true;
+    }
+
+    void TrendingTracker::add(std::string_view event_type, std::string_view category, std::string_view item,
+                              Clock::time_point at, std::uint32_t count) {
+        const std::uint64_t hash = hash_of(item);
+        const auto count_in = [&](std::string_view type, std::string_view of) {
+            Stream *counted = stream(type, of, true);
+            if (counted == nullptr) return;
+            const std::lock_guard lock(counted->mutex);
+            for (Stream::Ring &ring: counted->rings) Stream::add(ring, item, hash, at, count);
+        };
+        count_in({}, {});
+        if (!event_type.empty()) count_in(event_type, {});
+        if (!category.empty()) {
+            count_in({}, category);
+            if (!event_type.empty()) count_in(event_type, category);
+        }
+    }
+
+    std::vector<TrendingItem> TrendingTracker::top(std::string_view event_type, std::string_view category,
+                                                   std::string_view window, std::size_t k, Clock::time_point now) {
+        const auto found = std::find_if(config_.windows.begin(), config_.windows.end(),
+                                        [window](const Window &candidate) { return candidate.name == window; });
+        if (found == config_.windows.end()) {
+            throw std::invalid_argument("Unknown trending window '" + std::string(window) + "'");
+        }
+        Stream *counted = stream(event_type, category, false);
+        if (counted == nullptr || k == 0) return {};
+        const std::lock_guard lock(counted->mutex);
+        return Stream::top(counted->rings[static_cast<std::size_t>(found - config_.windows.begin())], now, k,
+                           config_.heavy_hitters);
+    }
+
+    std::size_t TrendingTracker::streams() const {
+        const std::shared_lock lock(streams_mutex_);
+        return streams_.size();
+    }
+
+    std::size_t TrendingTracker::memory_bytes() const {
+        const std::shared_lock lock(streams_mutex_);
+        std::size_t bytes = 0;
+        for (const auto &[key, stream]: streams_) {
+            const std::lock_guard guard(stream->mutex);
+            bytes += key.capacity() + stream->memory_bytes();
+        }
+        return bytes;
+    }
+} // namespace beacon::trending
@@ -0,0 +1,302 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+
+#include <beacon/user_history.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace beacon {
+    namespace reco {
+        namespace {
+            constexpr std::uint32_t kNone = 0xffffffffu;
+            // the interner's table entry, hash slot and allocation, and a ring index node
+            constexpr std::size_t kNameOverhead = 16 + 2 * 8 + 16 + 5 * sizeof(void *);
+
+            struct Entry {
+                std::uint32_t item;
+                std::uint32_t type;
+                std::uint64_t at_ms;
+            };
+
+            // a user's ring and its place in the stripe's activity list
+            struct Ring {
+                // interned id of the user, kNone while the ring is free
+                std::uint32_t user = kNone;
+                // where the next interaction goes, and how many are held
+                std::uint32_t head = 0;
+                std::uint32_t size = 0;
+                // towards the more and the less recently active
+                std::uint32_t newer = kNone;
+                std::uint32_t older = kNone;
+            };
+
+            // ids come in runs shared by users, items and event types, so they are mixed first
+            std::size_t stripe_of(std::uint32_t id, std::size_t stripes) {
+                return static_cast<std::size_t>((id * 0x9e3779b97f4a7c15ULL) >> 32) % stripes;
+            }
+
+            std::uint64_t now_ms() {
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count());
+            }
+        } // namespace
+
+        struct UserHistoryStore::Stripe {
+            mutable std::mutex mutex;
+            // ring by user id
+            std::unordered_map<std::uint32_t, std::uint32_t> ring_of;
+            std::vector<Ring> rings;
+            // rings.size() * capacity, ring r's at r * capacity
+            std::vector<Entry> entries;
+            std::vector<std::uint32_t> free_rings;
+            std::uint32_t newest = kNone;
+            std::uint32_t oldest = kNone;
+            // rings reserved, counted against the stripe's share of max_bytes
+            std::size_t bytes = 0;
+
+            void unlink(std::uint32_t at) {
+                Ring &ring = rings[at];
+                (ring.newer == kNone ? newest : rings[ring.newer].older) = ring.older;
+                (ring.older == kNone ? oldest : rings[ring.older].newer) = ring.newer;
+                ring.newer = ring.older = kNone;
+            }
+
+            void push_newest(std::uint32_t at) {
+                Ring &ring = rings[at];
+                ring.older = newest;
+                ring.newer = kNone;
+                if (newest != kNone) rings[newest].newer = at;
+                newest = at;
+                if (oldest == kNone) oldest = at;
+            }
+        };
+
+        UserHistoryConfig UserHistoryConfig::from_env() {
+            UserHistoryConfig config;
+            if (const char *capacity = std::getenv("BEACON_USER_HISTORY_CAPACITY")) {
+                config.capacity = std::strtoul(capacity, nullptr, 10);
+            }
+            if (const char *megabytes = std::getenv("BEACON_USER_HISTORY_MAX_MB")) {
+                config.max_bytes = std::strtoul(megabytes, nullptr, 10) << 20;
+            }
+            if (const char *stripes = std::getenv("BEACON_USER_HISTORY_STRIPES")) {
+                config.stripes = std::strtoul(stripes, nullptr, 10);
+            }
+            if (const char *field = std::getenv("BEACON_USER_HISTORY_USER_FIELD")) {
+                config.user_field = field;
+            }
+            if (const char *hours = std::getenv("BEACON_USER_HISTORY_LOOKBACK_HOURS")) {
+                config.lookback = std::chrono::hours(std::strtoul(hours, nullptr, 10));
+            }
+            return config;
+        }
+
+        UserHistoryStore::UserHistoryStore(UserHistoryConfig config) : config_(std::move(config)) {
+            if (config_.capacity == 0 || config_.capacity > kNone) {
+                throw std::invalid_argument("User history capacity must be positive");
+            }
+            if (config_.stripes == 0) throw std::invalid_argument("User history needs at least one stripe");
+            share_ = config_.max_bytes / config_.stripes;
+            max_rings_ = std::min<std::size_t>(kNone - 1, share_ / ring_bytes(config_.capacity));
+            if (max_rings_ == 0) {
+                throw std::invalid_argument("User history max_bytes cannot hold a ring per stripe");
+            }
+            stripes_ = std::make_unique<Stripe[]>(config_.stripes);
+        }
+
+        UserHistoryStore::~UserHistoryStore() = default;
+
+        bool UserHistoryStore::observe(const nlohmann::json &event) {
+            const auto item = event.find("entity_id");
+            const auto payload = event.find("payload");
+            if (item == event.end() || !item->is_string() || payload == event.end() || !payload->is_object()) {
+                return false;
+            }
+            const auto user = payload->find(config_.user_field);
+            if (user == payload->end() || user->is_null()) return false;
+            const auto type = event.find("event_type");
+            const std::string_view event_type = type != event.end() && type->is_string()
+                                                    ? std::string_view(type->get_ref<const std::string &>())
+                                                    : std::string_view();
+            if (user->is_string()) {
+                add(user->get_ref<const std::string &>(), item->get_ref<const std::string &>(), event_type, now_ms());
+            } else {
+                add(user->dump(), item->get_ref<const std::string &>(), event_type, now_ms());
+            }
+            return true;
+        }
+
+        std::uint32_t UserHistoryStore::acquire(std::string_view name) {
+            return names_.acquire(name, [this, name](std::uint32_t) {
+                name_bytes_.fetch_add(name_bytes(name), std::memory_order_relaxed);
+            });
+        }
+
+        void UserHistoryStore::release(std::uint32_t id) {
+            const std::size_t bytes = name_bytes(names_.name(id));
+            if (names_.release(id)) name_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        std::size_t UserHistoryStore::held(const Stripe &stripe) const {
+            return stripe.bytes + name_bytes_.load(std::memory_order_relaxed) / config_.stripes;
+        }
+
+        // drops the least recently active user and the names only it referred to
+        void UserHistoryStore::evict_oldest(Stripe &stripe) {
+            const std::uint32_t at = stripe.oldest;
+            Ring &ring = stripe.rings[at];
+            const Entry *entries = stripe.entries.data() + at * config_.capacity;
+            for (std::size_t i = 1; i <= ring.size; ++i) {
+                const Entry &entry = entries[(ring.head + config_.capacity - i) % config_.capacity];
+                release(entry.item);
+                release(entry.type);
+            }
+            stripe.ring_of.erase(ring.user);
+            release(ring.user);
+            stripe.unlink(at);
+            stripe.rings[at] = Ring{};
+            stripe.free_rings.push_back(at);
+            evicted_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void UserHistoryStore::add(std::string_view user, std::string_view item, std::string_view event_type,
+                                   std::uint64_t at_ms) {
+            // held before making room, so that evicting other users cannot drop them
+            const std::uint32_t user_id = acquire(user);
+            const Entry entry{acquire(item), acquire(event_type), at_ms};
+            Stripe &stripe = stripes_[stripe_of(user_id, config_.stripes)];
+            const std::lock_guard lock(stripe.mutex);
+
+            std::uint32_t at;
+            if (const auto found = stripe.ring_of.find(user_id); found != stripe.ring_of.end()) {
+                at = found->second;
+                // the ring holds the user already
+                release(user_id);
+                if (stripe.newest != at) {
+                    stripe.unlink(at);
+                    stripe.push_newest(at);
+                }
+            } else {
+                const std::size_t ring = ring_bytes(config_.capacity);
+                const auto needed = [&]() {
+                    const bool reserved = !stripe.free_rings.empty() || stripe.rings.size() < stripe.rings.capacity();
+                    return reserved ? 0 : ring;
+                };
+                while (stripe.oldest != kNone && held(stripe) + needed() > share_) evict_oldest(stripe);
+                if (!stripe.free_rings.empty()) {
+                    at = stripe.free_rings.back();
+                    stripe.free_rings.pop_back();
+                } else {
+                    at = static_cast<std::uint32_t>(stripe.rings.size());
+                    // Grown by hand, and counted once reserved, so that the cap holds for capacity
+                    // too; doubling at most, and into no more than half of what is left for names.
+                    if (stripe.rings.size() == stripe.rings.capacity()) {
+                        const std::size_t left = share_ > held(stripe) ? share_ - held(stripe) : 0;
+                        const std::size_t more = std::max<std::size_t>(
+                            1, std::min(stripe.rings.size(), left / ring / 2));
+                        const std::size_t grown = std::min(max_rings_, stripe.rings.size() + more);
+                        const std::size_t before = stripe.rings.capacity();
+                        stripe.rings.reserve(grown);
+                        stripe.entries.reserve(grown * config_.capacity);
+                        stripe.bytes += (stripe.rings.capacity() - before) * ring;
+                    }
+                    stripe.rings.emplace_back();
+                    stripe.entries.resize(stripe.entries.size() + config_.capacity);
+                }
+                stripe.rings[at].user = user_id;
+                stripe.ring_of.emplace(user_id, at);
+                stripe.push_newest(at);
+            }
+            // new item or event type names may still take the stripe past its share
+            while (held(stripe) > share_ && stripe.oldest != at) evict_oldest(stripe);
+
+            Ring &ring = stripe.rings[at];
+            Entry &replaced = stripe.entries[at * config_.capacity + ring.head];
+            if (ring.size == config_.capacity) {
+                release(replaced.item);
+                release(replaced.type);
+            }
+            replaced = entry;
+            ring.head = static_cast<std::uint32_t>((ring.head + 1) % config_.capacity);
+            ring.size = std::min<std::uint32_t>(ring.size + 1, static_cast<std::uint32_t>(config_.capacity));
+        }
+
+        std::vector<RecentInteraction> UserHistoryStore::recent(std::string_view user, std::size_t n) const {
+            if (n == 0) return {};
+            const std::optional<std::uint32_t> id = names_.find(user);
+            if (!id) return {};
+            const Stripe &stripe = stripes_[stripe_of(*id, config_.stripes)];
+
+            // names are held by the stripe's interactions, so they are read under its lock
+            const std::lock_guard lock(stripe.mutex);
+            const auto found = stripe.ring_of.find(*id);
+            if (found == stripe.ring_of.end()) return {};
+            const std::uint32_t at = found->second;
+            const Ring &ring = stripe.rings[at];
+            // the user may have been evicted and the id handed to another since find()
+            if (names_.name(ring.user) != user) return {};
+            const std::size_t count = std::min<std::size_t>(n, ring.size);
+            const Entry *entries = stripe.entries.data() + at * config_.capacity;
+            std::vector<RecentInteraction> result;
+            result.reserve(count);
+            for (std::size_t i = 1; i <= count; ++i) {
+                const Entry &entry = entries[(ring.head + config_.capacity - i) % config_.capacity];
+                result.push_back(RecentInteraction{
+                    std::string(user), std::string(names_.name(entry.item)), std::string(names_.name(entry.type)),
+                    entry.at_ms
+                });
+            }
+            return result;
+        }
+
+        std::size_t UserHistoryStore::warm_start(HistorySource &source) {
+            const auto since = std::chrono::system_clock::now() - config_.lookback;
+            const auto since_ms = std::chrono::duration_cast<std::chrono::milliseconds>(since.time_since_epoch());
+            const std::vector<RecentInteraction> loaded = source.load_recent_interactions(
+                config_.user_field, config_.capacity, max_rings_ * config_.stripes,
+                static_cast<std::uint64_t>(std::max<std::int64_t>(since_ms.count(), 0)));
+            for (const RecentInteraction &interaction: loaded) {
+                add(interaction.user, interaction.item, interaction.event_type, interaction.at_ms);
+            }
+            return loaded.size();
+        }
+
+        std::size_t UserHistoryStore::users() const {
+            std::size_t held = 0;
+            for (std::size_t i = 0; i < config_.stripes; ++i) {
+                const std::lock_guard lock(stripes_[i].mutex);
+                held += stripes_[i].ring_of.size();
+            }
+            return held;
+        }
+
+        std::uint64_t UserHistoryStore::evicted() const {
+            return evicted_.load(std::memory_order_relaxed);
+        }
+
+        std::size_t UserHistoryStore::memory_bytes() const {
+            std::size_t bytes = 0;
+            for (std::size_t i = 0; i < config_.stripes; ++i) {
+                const Stripe &stripe = stripes_[i];
+                const std::lock_guard lock(stripe.mutex);
+                bytes += sizeof(Stripe) + stripe.bytes;
+            }
+            return bytes + name_bytes_.load(std::memory_order_relaxed);
+        }
+
+        std::size_t UserHistoryStore::ring_bytes(std::size_t capacity) {
+            return capacity * sizeof(Entry) + sizeof(Ring);
+        }
+
+        std::size_t UserHistoryStore::name_bytes(std::string_view name) {
+            return name.size() + kNameOverhead;
+        }
+    } // namespace reco
+} // namespace beacon
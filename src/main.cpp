@@ -1,7 +1,151 @@
-// src/main.cpp (tiny stub)
+// src/main.cpp
+#include <beacon/broker.h>
+#include <beacon/schema_manager.h>
+#include <beacon/socket_handoff.h>
+#include <beacon/storage_adapter.h>
+#include <beacon/websocket_adapter.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
 
 int main() {
-    std::cout << "beacon_broker starting (stub)\n";
+    const char *port_env = std::getenv("BEACON_PORT");
+    const auto port = static_cast<std::uint16_t>(port_env ? std::stoi(port_env) : 7070);
+
+    beacon::SchemaManager schemas;
+    schemas.load();
+
+    // one event loop per core by default
+    const char *cores_env = std::getenv("BEACON_CORES");
+    const std::size_t cores = cores_env ? std::stoul(cores_env) : std::max(1u, std::thread::hardware_concurrency());
+
+    beacon::WebSocketAdapter adapter(beacon::ratelimit::RateLimitConfig::from_env(), cores,
+                                     beacon::LaneConfig::from_env());
+    adapter.set_schema_lookup([&schemas](const std::string &topic) { return schemas.find(topic); });
+
+    // Consumer group offsets and delayed events go to Postgres when asked to, otherwise they
+    // last as long as the process. Each gets its own connection, used from its own thread.
+    auto use_postgres = [](const char *var) {
+        const char *value = std::getenv(var);
+        return value != nullptr && std::string(value) == "postgres";
+    };
+    std::unique_ptr<beacon::StorageAdapter> offset_storage;
+    if (use_postgres("BEACON_OFFSET_STORE")) {
+        offset_storage = std::make_unique<beacon::StorageAdapter>();
+    }
+    std::unique_ptr<beacon::StorageAdapter> delay_storage;
+    if (use_postgres("BEACON_DELAY_STORE")) {
+        delay_storage = std::make_unique<beacon::StorageAdapter>();
+    }
+    // Events rejected by their schema are kept in Postgres for debugging, sampled and
+    // capped per schema.
+    std::unique_ptr<beacon::StorageAdapter> dead_letter_storage;
+    std::unique_ptr<beacon::deadletter::DeadLetterSink> dead_letters;
+    if (use_postgres("BEACON_DEAD_LETTER_STORE")) {
+        dead_letter_storage = std::make_unique<beacon::StorageAdapter>();
+        dead_letters = std::make_unique<beacon::deadletter::DeadLetterSink>(
+            *dead_letter_storage, beacon::deadletter::DeadLetterConfig::from_env());
+        adapter.set_dead_letters(dead_letters.get());
+    }
+    // BEACON_REPLICATE_FROM=ws://leader:7070/ makes this broker a follower of another
+    beacon::Broker broker(adapter, offset_storage.get(), delay_storage.get(), beacon::delay::DelayConfig::from_env(),
+                          beacon::replication::ReplicationConfig::from_env());
+
+    // BEACON_RECOMMENDATIONS=on learns item-to-item similarities from the published events
+    // and BEACON_RECO_CACHE=on keeps recommend results until the user's next event
+    std::unique_ptr<beacon::RecommendationEngine> recommendations;
+    std::unique_ptr<beacon::reco::RecommendationCache> recommendation_cache;
+    if (const char *enabled = std::getenv("BEACON_RECOMMENDATIONS"); enabled && std::string(enabled) == "on") {
+        recommendations = std::make_unique<beacon::RecommendationEngine>(beacon::RecommendationConfig::from_env());
+        broker.set_recommendations(recommendations.get());
+        if (const char *cached = std::getenv("BEACON_RECO_CACHE"); cached && std::string(cached) == "on") {
+            recommendation_cache = std::make_unique<beacon::reco::RecommendationCache>(
+                beacon::reco::RecommendationCacheConfig::from_env());
+            broker.set_recommendation_cache(recommendation_cache.get());
+        }
+    }
+    // BEACON_TRENDING=on keeps top items per event type and category over sliding windows
+    std::unique_ptr<beacon::trending::TrendingTracker> trending;
+    if (const char *enabled = std::getenv("BEACON_TRENDING"); enabled && std::string(enabled) == "on") {
+        trending = std::make_unique<beacon::trending::TrendingTracker>(beacon::trending::TrendingConfig::from_env());
+        broker.set_trending(trending.get());
+    }
+    // BEACON_USER_HISTORY=on keeps each user's last interactions in memory, warmed up from
+    // the events table with BEACON_USER_HISTORY_STORE=postgres
+    std::unique_ptr<beacon::reco::UserHistoryStore> user_histories;
+    if (const char *enabled = std::getenv("BEACON_USER_HISTORY"); enabled && std::string(enabled) == "on") {
+        user_histories = std::make_unique<beacon::reco::UserHistoryStore>(beacon::reco::UserHistoryConfig::from_env());
+        if (use_postgres("BEACON_USER_HISTORY_STORE")) {
+            try {
+                beacon::StorageAdapter history_storage;
+                std::cout << "warmed up " << user_histories->warm_start(history_storage) << " interactions\n";
+            } catch (const std::exception &e) {
+                std::cerr << "user history error: " << e.what() << std::endl;
+            }
+        }
+        broker.set_user_histories(user_histories.get());
+    }
+    // BEACON_RECO_IDS_PATH keeps user and item ids across restarts
+    const char *ids_path = std::getenv("BEACON_RECO_IDS_PATH");
+    if (recommendations && ids_path != nullptr && std::filesystem::exists(ids_path)) {
+        try {
+            recommendations->load_ids(ids_path);
+        } catch (const std::exception &e) {
+            std::cerr << "recommendations error: " << e.what() << std::endl;
+        }
+    }
+    // BEACON_RECO_HNSW_PATH keeps the embedding index across restarts
+    const char *hnsw_path = std::getenv("BEACON_RECO_HNSW_PATH");
+    if (recommendations && hnsw_path != nullptr && std::filesystem::exists(hnsw_path)) {
+        try {
+            recommendations->load_embeddings(hnsw_path);
+        } catch (const std::exception &e) {
+            std::cerr << "recommendations error: " << e.what() << std::endl;
+        }
+    }
+
+    // Hot restart: take the listening sockets over from a running broker, if there is one.
+    const char *handoff_path = std::getenv("BEACON_HANDOFF_SOCKET");
+    std::vector<int> inherited;
+    if (handoff_path != nullptr) {
+        inherited = beacon::handoff::take_over(handoff_path);
+    }
+
+    if (inherited.empty()) {
+        adapter.listen(port);
+        std::cout << "beacon_broker listening on port " << port << "\n";
+    } else {
+        for (const int fd: inherited) adapter.adopt(fd);
+        std::cout << "beacon_broker took over " << inherited.size() << " listening sockets\n";
+    }
+
+    if (handoff_path != nullptr) {
+        const char *drain_env = std::getenv("BEACON_DRAIN_TIMEOUT_SECS");
+        adapter.enable_handoff(handoff_path, std::chrono::seconds(drain_env ? std::stoi(drain_env) : 300));
+    }
+
+    adapter.run();
+
+    // A successor that took the sockets over has loaded these files already and writes them
+    // itself; ours would overwrite its files with an older id space.
+    if (adapter.handed_off()) return 0;
+    if (recommendations && hnsw_path != nullptr) {
+        try {
+            recommendations->save_embeddings(hnsw_path);
+        } catch (const std::exception &e) {
+            std::cerr << "recommendations error: " << e.what() << std::endl;
+        }
+    }
+    if (recommendations && ids_path != nullptr) {
+        try {
+            recommendations->save_ids(ids_path);
+        } catch (const std::exception &e) {
+            std::cerr << "recommendations error: " << e.what() << std::endl;
+        }
+    }
     return 0;
-}
\ No newline at end of file
+}
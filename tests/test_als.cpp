@@ -0,0 +1,97 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/als.h>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using beacon::reco::AlsConfig;
+using beacon::reco::AlsIteration;
+using beacon::reco::AlsModel;
+using beacon::reco::CsrMatrix;
+using beacon::reco::Triplet;
+
+namespace {
+    float predict(const AlsModel &model, std::size_t user, std::size_t item) {
+        float sum = 0.0f;
+        for (std::size_t a = 0; a < model.factors; ++a) {
+            sum += model.users[user * model.factors + a] * model.items[item * model.factors + a];
+        }
+        return sum;
+    }
+} // namespace
+
+int main() {
+    {
+        // repeated pairs add up; rows come out sorted, and so do the transposed ones
+        const CsrMatrix matrix = CsrMatrix::from_triplets(3, 4, {{2, 1, 1.0f}, {0, 3, 2.0f}, {0, 1, 1.0f},
+                                                                 {2, 1, 0.5f}, {1, 0, 4.0f}});
+        assert(matrix.nonzeros() == 4);
+        assert((matrix.offsets == std::vector<std::uint64_t>{0, 2, 3, 4}));
+        assert((matrix.indices == std::vector<std::uint32_t>{1, 3, 0, 1}));
+        assert((matrix.values == std::vector<float>{1.0f, 2.0f, 4.0f, 1.5f}));
+
+        const CsrMatrix transposed = matrix.transpose();
+        assert(transposed.rows == 4 && transposed.columns == 3);
+        assert((transposed.offsets == std::vector<std::uint64_t>{0, 1, 3, 3, 4}));
+        assert((transposed.indices == std::vector<std::uint32_t>{1, 0, 2, 0}));
+        assert((transposed.values == std::vector<float>{4.0f, 1.0f, 1.5f, 2.0f}));
+
+        bool rejected = false;
+        try {
+            CsrMatrix::from_triplets(1, 1, {{0, 1, 1.0f}});
+        } catch (const std::out_of_range &) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    {
+        // Two taste groups: users 0-19 use items 0-9, users 20-39 items 10-19, each six of the
+        // ten. Whatever a user has not seen, the best guess is from their own group.
+        std::vector<Triplet> triplets;
+        for (std::uint32_t user = 0; user < 40; ++user) {
+            const std::uint32_t first = user < 20 ? 0 : 10;
+            for (std::uint32_t i = 0; i < 6; ++i) {
+                triplets.push_back({user, first + (user * 3 + i * 7) % 10, 1.0f + static_cast<float>(i % 2)});
+            }
+        }
+        const CsrMatrix user_items = CsrMatrix::from_triplets(40, 20, triplets);
+
+        for (const std::size_t threads: {std::size_t{1}, std::size_t{3}}) {
+            AlsConfig config;
+            config.factors = 8;
+            config.iterations = 10;
+            config.regularization = 0.1f;
+            config.alpha = 10.0f;
+            config.threads = threads;
+            std::vector<AlsIteration> iterations;
+            const AlsModel model = beacon::reco::train_als(user_items, config, [&iterations](const AlsIteration &it) {
+                iterations.push_back(it);
+            });
+            assert(iterations.size() == 10 && iterations.back().iteration == 10);
+            assert(iterations[0].gram_seconds >= 0.0 && iterations[0].user_seconds >= 0.0);
+            assert(model.users.size() == 40 * 8 && model.items.size() == 20 * 8);
+
+            for (std::uint32_t user = 0; user < 40; ++user) {
+                std::vector<bool> seen(20, false);
+                for (std::uint64_t i = user_items.offsets[user]; i < user_items.offsets[user + 1]; ++i) {
+                    seen[user_items.indices[i]] = true;
+                }
+                std::size_t best = 20;
+                for (std::size_t item = 0; item < 20; ++item) {
+                    if (!seen[item] && (best == 20 || predict(model, user, item) > predict(model, user, best))) {
+                        best = item;
+                    }
+                }
+                assert((best < 10) == (user < 20));
+                // what was seen is predicted near 1, the other group well below
+                const float own = predict(model, user, user_items.indices[user_items.offsets[user]]);
+                assert(own > 0.8f && std::abs(predict(model, user, user < 20 ? 15 : 5)) < own / 2.0f);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,511 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/broker.h>
+#include <beacon/producer_client.h>
+#include <arpa/inet.h>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+    int listen_on_loopback() {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        assert(::bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0);
+        assert(::listen(fd, 64) == 0);
+        return fd;
+    }
+
+    std::uint16_t port_of(int fd) {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        assert(::getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) == 0);
+        return ntohs(address.sin_port);
+    }
+
+    /**
+     * A broker on two cores, listening on a loopback port of its own.
+     */
+    struct Server {
+        explicit Server(beacon::replication::ReplicationConfig replication = {},
+                        beacon::ratelimit::RateLimitConfig limits = {})
+            : adapter(limits, 2), broker(adapter, nullptr, nullptr, {}, std::move(replication)) {
+            const int fd = listen_on_loopback();
+            uri = "ws://127.0.0.1:" + std::to_string(port_of(fd)) + "/";
+            adapter.adopt(fd);
+            thread = std::thread([this]() { adapter.run(); });
+        }
+
+        ~Server() {
+            adapter.stop();
+            thread.join();
+        }
+
+        beacon::WebSocketAdapter adapter;
+        beacon::Broker broker;
+        std::string uri;
+        std::thread thread;
+    };
+
+    /**
+     * Frames that arrive on an adapter's thread, waited for on the test's.
+     */
+    class Inbox {
+    public:
+        void push(beacon::ConnectionId connection, nlohmann::json &&frame) {
+            const std::lock_guard lock(mutex_);
+            sender_ = connection;
+            frames_.push_back(std::move(frame));
+            arrived_.notify_all();
+        }
+
+        /**
+         * The connection the latest frame came from.
+         */
+        beacon::ConnectionId sender() {
+            const std::lock_guard lock(mutex_);
+            return sender_;
+        }
+
+        nlohmann::json next() {
+            std::unique_lock lock(mutex_);
+            const bool arrived = arrived_.wait_for(lock, 10s, [this]() { return !frames_.empty(); });
+            assert(arrived);
+            nlohmann::json frame = std::move(frames_.front());
+            frames_.pop_front();
+            return frame;
+        }
+
+        /**
+         * Waits until nothing has arrived for `quiet`, then returns how much is queued.
+         */
+        std::size_t settle(std::chrono::milliseconds quiet) {
+            std::unique_lock lock(mutex_);
+            for (std::size_t seen = frames_.size();;) {
+                arrived_.wait_for(lock, quiet, [&]() { return frames_.size() != seen; });
+                if (frames_.size() == seen) return seen;
+                seen = frames_.size();
+            }
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable arrived_;
+        std::deque<nlohmann::json> frames_;
+        beacon::ConnectionId sender_ = 0;
+    };
+
+    /**
+     * A plain connection to the broker that keeps what it receives.
+     */
+    class Client : public Inbox {
+    public:
+        explicit Client(const std::string &uri) {
+            adapter_.on_message([this](beacon::ConnectionId connection, nlohmann::json &&frame) {
+                push(connection, std::move(frame));
+            });
+            connection_ = adapter_.connect(uri);
+            thread_ = std::thread([this]() { adapter_.run(); });
+        }
+
+        ~Client() {
+            adapter_.stop();
+            thread_.join();
+        }
+
+        void send(const nlohmann::json &message) {
+            adapter_.send(connection_, message.dump());
+        }
+
+    private:
+        beacon::WebSocketAdapter adapter_;
+        beacon::ConnectionId connection_ = 0;
+        std::thread thread_;
+    };
+
+    /**
+     * Stands in for the leader a follower connects to, answering as the test tells it.
+     * `listener` outlives it, so the follower reconnects to the next FakeLeader on it;
+     * destroying one drops the link.
+     */
+    class FakeLeader : public Inbox {
+    public:
+        explicit FakeLeader(int listener) {
+            adapter_.on_message([this](beacon::ConnectionId connection, nlohmann::json &&frame) {
+                push(connection, std::move(frame));
+            });
+            adapter_.adopt(::dup(listener));
+            thread_ = std::thread([this]() { adapter_.run(); });
+        }
+
+        ~FakeLeader() {
+            adapter_.stop();
+            thread_.join();
+        }
+
+        /**
+         * Answers the follower that sent the latest frame.
+         */
+        void send(const nlohmann::json &frame) {
+            adapter_.send(sender(), frame.dump());
+        }
+
+    private:
+        beacon::WebSocketAdapter adapter_;
+        std::thread thread_;
+    };
+
+    nlohmann::json batch(const std::string &producer, std::uint64_t sequence, nlohmann::json events) {
+        return {{"op", "publish_batch"}, {"producer", producer}, {"sequence", sequence}, {"events", std::move(events)}};
+    }
+
+    nlohmann::json event(int n) {
+        return {{"topic", "orders"}, {"entity_id", std::to_string(n)}, {"payload", {{"n", n}}}};
+    }
+
+    void subscribe(Client &client, const std::string &topic) {
+        client.send({{"op", "subscribe"}, {"topic", topic}});
+        assert(client.next()["type"] == "subscribed");
+    }
+
+    /**
+     * How often each "n" reached the subscriber, once it stopped receiving.
+     */
+    std::map<int, int> received(Client &subscriber) {
+        std::map<int, int> counts;
+        for (std::size_t i = subscriber.settle(300ms); i > 0; --i) {
+            ++counts[subscriber.next()["payload"]["n"].get<int>()];
+        }
+        return counts;
+    }
+
+    /**
+     * Reads what a broker replicates to `follower` until `count` events have arrived, and
+     * returns their "n" by offset. `epoch` receives the epoch of the last "replicating".
+     */
+    std::map<std::uint64_t, int> replicated(Client &follower, std::size_t count, std::string &epoch) {
+        std::map<std::uint64_t, int> events;
+        while (events.size() < count) {
+            const nlohmann::json frame = follower.next();
+            if (frame["type"] == "replicating") {
+                epoch = frame["epoch"];
+                continue;
+            }
+            assert(frame["type"] == "replica");
+            std::uint64_t offset = frame["offset"];
+            for (const nlohmann::json &event: frame["events"]) events[offset++] = event["payload"]["n"];
+            follower.send({{"op", "replica_ack"}, {"offset", offset}});
+        }
+        return events;
+    }
+
+    nlohmann::json replicating(const std::string &epoch, std::uint64_t start, std::uint64_t end, std::uint64_t from) {
+        return {{"type", "replicating"}, {"epoch", epoch}, {"start", start}, {"end", end}, {"from", from}};
+    }
+
+    nlohmann::json replica(std::uint64_t offset, nlohmann::json events) {
+        return {{"type", "replica"}, {"offset", offset}, {"events", std::move(events)}};
+    }
+
+    void expect_replicate(Inbox &leader, const std::string &epoch, std::uint64_t from) {
+        const nlohmann::json request = leader.next();
+        assert(request["op"] == "replicate" && request["epoch"] == epoch && request["from"] == from);
+    }
+
+    void expect_ack(Inbox &leader, std::uint64_t offset) {
+        const nlohmann::json ack = leader.next();
+        assert(ack["op"] == "replica_ack" && ack["offset"] == offset);
+    }
+} // namespace
+
+int main() {
+    {
+        // the cache is dropped by the engine, which has to come first
+        Server server;
+        beacon::reco::RecommendationCache cache;
+        bool threw = false;
+        try {
+            server.broker.set_recommendation_cache(&cache);
+        } catch (const std::logic_error &) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    {
+        // recommend results are cached by context
+        beacon::RecommendationEngine engine;
+        beacon::reco::RecommendationCache cache;
+        Server server;
+        server.broker.set_recommendations(&engine);
+        server.broker.set_recommendation_cache(&cache);
+        Client client(server.uri);
+        for (const char *context: {"home", "cart", "home"}) {
+            client.send({{"op", "recommend"}, {"user", "u1"}, {"k", 5}, {"context", context}});
+            const nlohmann::json reply = client.next();
+            assert(reply["type"] == "recommendations" && reply["context"] == context);
+        }
+        // k is capped before it keys the cache, an overlong context is refused
+        client.send({{"op", "recommend"}, {"user", "u1"}, {"k", 1000000}, {"context", "home"}});
+        assert(client.next()["type"] == "recommendations");
+        client.send({{"op", "recommend"}, {"user", "u1"}, {"k", beacon::Broker::kMaxRecommendations}, {"context", "home"}});
+        assert(client.next()["type"] == "recommendations");
+        client.send({
+            {"op", "recommend"}, {"user", "u1"},
+            {"context", std::string(beacon::Broker::kMaxContextBytes + 1, 'x')}
+        });
+        assert(client.next()["code"] == "bad_request");
+        const beacon::reco::RecommendationCacheStats stats = cache.stats();
+        assert(stats.misses == 3 && stats.hits == 2);
+    }
+    {
+        // a retried batch is acknowledged again but published once, one past a gap is refused
+        Server server;
+        Client subscriber(server.uri);
+        subscribe(subscriber, "orders");
+        Client producer(server.uri);
+
+        producer.send(batch("p", 7, nlohmann::json::array({event(1), event(2)})));
+        nlohmann::json ack = producer.next();
+        assert(ack["type"] == "ack" && ack["sequence"] == 7 && ack["duplicate"] == false);
+
+        producer.send(batch("p", 7, nlohmann::json::array({event(1), event(2)})));
+        producer.send(batch("p", 6, nlohmann::json::array({event(0)})));
+        assert(producer.next()["duplicate"] == true);
+        assert(producer.next()["duplicate"] == true);
+
+        producer.send(batch("p", 9, nlohmann::json::array({event(3)})));
+        const nlohmann::json gap = producer.next();
+        assert(gap["type"] == "error" && gap["code"] == "out_of_sequence" && gap["expected"] == 8);
+
+        producer.send(batch("p", 8, nlohmann::json::array({event(3)})));
+        ack = producer.next();
+        assert(ack["sequence"] == 8 && ack["duplicate"] == false);
+
+        // a bad batch takes no sequence
+        producer.send(batch("p", 9, nlohmann::json::array({{{"topic", "orders"}, {"delay_ms", "soon"}}})));
+        assert(producer.next()["code"] == "bad_request");
+        for (const nlohmann::json &sequence: {nlohmann::json(-1), nlohmann::json(9.5), nlohmann::json("9")}) {
+            nlohmann::json malformed = batch("p", 9, nlohmann::json::array({event(3)}));
+            malformed["sequence"] = sequence;
+            producer.send(malformed);
+            assert(producer.next()["code"] == "bad_request");
+        }
+        producer.send(batch("p", 9, nlohmann::json::array()));
+        assert(producer.next()["duplicate"] == false);
+
+        assert((received(subscriber) == std::map<int, int>{{1, 1}, {2, 1}, {3, 1}}));
+    }
+    {
+        // a delayed event arrives when due and says when that was
+        Server server;
+        Client subscriber(server.uri);
+        subscribe(subscriber, "orders");
+        Client producer(server.uri);
+        const auto sent = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        nlohmann::json publish = event(1);
+        publish["op"] = "publish";
+        publish["delay_ms"] = 50;
+        producer.send(publish);
+        const nlohmann::json delivered = subscriber.next();
+        const auto arrived = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        assert(delivered["payload"]["n"] == 1 && !delivered.contains("delay_ms"));
+        assert(delivered["deliver_at"] >= sent + 50 && delivered["deliver_at"] <= arrived);
+    }
+    {
+        // past kMaxProducers the producer that sent a batch least recently is forgotten
+        Server server;
+        Client producer(server.uri);
+        producer.send(batch("p0", 1, nlohmann::json::array()));
+        producer.send(batch("p1", 1, nlohmann::json::array()));
+        producer.send(batch("p0", 2, nlohmann::json::array()));
+        for (std::size_t p = 2; p <= beacon::Broker::kMaxProducers; ++p) {
+            producer.send(batch("p" + std::to_string(p), 1, nlohmann::json::array()));
+        }
+        for (std::size_t i = 0; i < beacon::Broker::kMaxProducers + 2; ++i) {
+            assert(producer.next()["duplicate"] == false);
+        }
+
+        producer.send(batch("p0", 2, nlohmann::json::array()));
+        assert(producer.next()["duplicate"] == true);
+        producer.send(batch("p1", 1, nlohmann::json::array()));
+        assert(producer.next()["duplicate"] == false);
+    }
+    {
+        // ProducerClient numbers its batches and every event is published once
+        Server server;
+        Client subscriber(server.uri);
+        subscribe(subscriber, "orders");
+
+        beacon::ProducerConfig config;
+        config.uri = server.uri;
+        config.producer_id = "client";
+        config.batch_events = 3;
+        beacon::ProducerClient producer(config);
+        for (int n = 0; n < 50; ++n) producer.publish("orders", std::to_string(n), "created", {{"n", n}});
+        assert(producer.flush(10s));
+
+        const beacon::ProducerStats stats = producer.stats();
+        assert(stats.events_acked == 50 && stats.batches_failed == 0);
+        const std::map<int, int> counts = received(subscriber);
+        assert(counts.size() == 50);
+        for (const auto &[n, count]: counts) assert(count == 1);
+    }
+    {
+        // Batches refused by the rate limit are resent, and the ones behind them, refused as out
+        // of sequence, are numbered on from the last ack; none is lost or published twice.
+        beacon::ratelimit::RateLimitConfig limits;
+        limits.connection_messages = {50.0, 2.0};
+        limits.action = beacon::ratelimit::LimitAction::Reject;
+        Server server({}, limits);
+        Client subscriber(server.uri);
+        subscribe(subscriber, "orders");
+
+        beacon::ProducerConfig config;
+        config.uri = server.uri;
+        config.producer_id = "limited";
+        config.batch_events = 1;
+        config.max_in_flight = 4;
+        config.retry_backoff = 10ms;
+        beacon::ProducerClient producer(config);
+        for (int n = 0; n < 30; ++n) producer.publish("orders", std::to_string(n), "created", {{"n", n}});
+        assert(producer.flush(10s));
+
+        const beacon::ProducerStats stats = producer.stats();
+        assert(stats.events_acked == 30 && stats.batches_failed == 0 && stats.retries > 0);
+        const std::map<int, int> counts = received(subscriber);
+        assert(counts.size() == 30);
+        for (const auto &[n, count]: counts) assert(count == 1);
+    }
+    {
+        // a group created again after its last member left numbers on after what it delivered
+        Server server;
+        Client member(server.uri);
+        Client producer(server.uri);
+        const nlohmann::json join = {{"op", "join"}, {"group", "g"}, {"topic", "orders"}, {"partitions", 1}};
+        member.send(join);
+        assert(member.next()["type"] == "assignment");
+        // the cores take the assignment right after its members hear of it
+        std::this_thread::sleep_for(100ms);
+
+        producer.send(batch("p", 1, nlohmann::json::array({event(1), event(2)})));
+        assert(member.next()["offset"] == 1);
+        assert(member.next()["offset"] == 2);
+        member.send({
+            {"op", "commit"}, {"group", "g"}, {"topic", "orders"},
+            {"offsets", nlohmann::json::array({{{"partition", 0}, {"offset", 1}}})}
+        });
+        member.send({{"op", "leave"}, {"group", "g"}, {"topic", "orders"}});
+        assert(member.next()["type"] == "left");
+
+        member.send(join);
+        assert(member.next()["type"] == "assignment");
+        std::this_thread::sleep_for(100ms);
+        producer.send(batch("p", 2, nlohmann::json::array({event(3)})));
+        const nlohmann::json delivered = member.next();
+        assert(delivered["payload"]["n"] == 3 && delivered["offset"] == 3);
+    }
+    {
+        // a follower resumes at its offset in the leader's epoch and starts over in any other
+        beacon::replication::ReplicationConfig replication;
+        replication.log_events = 100;
+        Server leader(replication);
+        Client producer(leader.uri);
+        producer.send(batch("p", 1, nlohmann::json::array({event(1), event(2), event(3)})));
+        assert(producer.next()["type"] == "ack");
+
+        std::string epoch;
+        Client stale(leader.uri);
+        stale.send({{"op", "replicate"}, {"epoch", "stale"}, {"from", 2}});
+        assert((replicated(stale, 3, epoch) == std::map<std::uint64_t, int>{{0, 1}, {1, 2}, {2, 3}}));
+        assert(epoch != "stale");
+
+        Client resumed(leader.uri);
+        resumed.send({{"op", "replicate"}, {"epoch", epoch}, {"from", 2}});
+        assert((replicated(resumed, 1, epoch) == std::map<std::uint64_t, int>{{2, 3}}));
+
+        // a follower broker takes the leader's history without publishing it, then publishes
+        // what follows and passes all of it on under the leader's offsets and epoch
+        replication.upstream = leader.uri;
+        Server follower(replication);
+        Client subscriber(follower.uri);
+        subscribe(subscriber, "orders");
+        Client downstream(follower.uri);
+        downstream.send({{"op", "replicate"}, {"epoch", ""}, {"from", 0}});
+        std::string followed;
+        assert(replicated(downstream, 3, followed).size() == 3);
+        assert(followed == epoch);
+
+        producer.send(batch("p", 2, nlohmann::json::array({event(4)})));
+        assert(producer.next()["type"] == "ack");
+        assert((replicated(downstream, 1, followed) == std::map<std::uint64_t, int>{{3, 4}}));
+        assert((received(subscriber) == std::map<int, int>{{4, 1}}));
+    }
+    {
+        // the follower's side of the link, against a scripted leader that drops it twice
+        const int listener = listen_on_loopback();
+        beacon::replication::ReplicationConfig replication;
+        replication.log_events = 100;
+        replication.upstream = "ws://127.0.0.1:" + std::to_string(port_of(listener)) + "/";
+        replication.retry_backoff = 50ms;
+        auto leader = std::make_unique<FakeLeader>(listener);
+        Server follower(replication);
+        Client subscriber(follower.uri);
+        subscribe(subscriber, "orders");
+
+        expect_replicate(*leader, "", 0);
+        leader->send(replicating("e1", 0, 2, 0));
+        leader->send(replica(0, nlohmann::json::array({event(1), event(2)})));
+        expect_ack(*leader, 2);
+        leader->send(replica(2, nlohmann::json::array({event(3)})));
+        expect_ack(*leader, 3);
+
+        // reconnected mid-stream: it asks to resume and skips what it already has
+        leader = std::make_unique<FakeLeader>(listener);
+        expect_replicate(*leader, "e1", 3);
+        leader->send(replicating("e1", 0, 5, 3));
+        leader->send(replica(2, nlohmann::json::array({event(3), event(4), event(5)})));
+        expect_ack(*leader, 5);
+
+        // a gap: what is missing is lost, the log continues after it
+        leader->send(replica(7, nlohmann::json::array({event(8)})));
+        expect_ack(*leader, 8);
+        Client downstream(follower.uri);
+        downstream.send({{"op", "replicate"}, {"epoch", "e1"}, {"from", 7}});
+        std::string epoch;
+        assert((replicated(downstream, 1, epoch) == std::map<std::uint64_t, int>{{7, 8}}));
+        assert(epoch == "e1");
+
+        // a new epoch: the leader numbers from scratch and all it sends is new, also to
+        // whoever follows the follower
+        leader = std::make_unique<FakeLeader>(listener);
+        expect_replicate(*leader, "e1", 8);
+        leader->send(replicating("e2", 0, 0, 0));
+        leader->send(replica(0, nlohmann::json::array({event(10), event(11)})));
+        expect_ack(*leader, 2);
+        assert((replicated(downstream, 2, epoch) == std::map<std::uint64_t, int>{{0, 10}, {1, 11}}));
+        assert(epoch == "e2");
+
+        assert((received(subscriber) == std::map<int, int>{{3, 1}, {4, 1}, {5, 1}, {8, 1}, {10, 1}, {11, 1}}));
+        leader.reset();
+        ::close(listener);
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/conflating_queue.h>
+#include <cassert>
+#include <string>
+
+int main() {
+    beacon::ConflatingQueue<std::string> queue;
+
+    queue.push("a", "a1");
+    queue.push("b", "b1");
+    queue.push("plain");
+    queue.push("a", "a2"); // replaces a1 in place
+    queue.push("a", "a3");
+    queue.push("plain"); // un-keyed entries are never conflated
+
+    assert(queue.size() == 4);
+    assert(queue.conflated() == 2);
+    assert(queue.pop() == "a3");
+    assert(queue.pop() == "b1");
+
+    // once popped, a key queues again behind the pending entries
+    queue.push("a", "a4");
+    queue.push("b", "b2");
+    assert(queue.pop() == "plain");
+    assert(queue.pop() == "plain");
+    assert(queue.pop() == "a4");
+    queue.push("b", "b3");
+    assert(queue.pop() == "b3");
+    assert(queue.empty());
+
+    // pending entries stay bounded by the number of distinct keys
+    for (int i = 0; i < 100000; ++i) {
+        queue.push("entity-" + std::to_string(i % 16), std::to_string(i));
+    }
+    assert(queue.size() == 16);
+    assert(queue.pop() == "99984");
+    return 0;
+}
@@ -0,0 +1,273 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/consumer_group.h>
+#include <beacon/offset_committer.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace beacon::consumer;
+
+namespace {
+    std::map<MemberId, std::size_t> shares(const GroupMembership &group) {
+        std::map<MemberId, std::size_t> counts;
+        for (const MemberId owner: group.owners()) ++counts[owner];
+        return counts;
+    }
+
+    void assert_balanced(const GroupMembership &group) {
+        const auto counts = shares(group);
+        assert(counts.size() == group.members().size());
+        const std::size_t share = group.partitions() / group.members().size();
+        for (const auto &[member, count]: counts) {
+            assert(group.contains(member));
+            assert(count == share || count == share + 1);
+        }
+    }
+
+    std::size_t moved(const std::vector<MemberId> &before, const std::vector<MemberId> &after) {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < before.size(); ++i) {
+            if (before[i] != after[i]) ++count;
+        }
+        return count;
+    }
+
+    class FakeStore : public OffsetStore {
+    public:
+        std::vector<CommittedOffset> load_offsets(const std::string &group, const std::string &topic) override {
+            const std::lock_guard lock(mutex);
+            ++loads;
+            if (failing_loads) throw std::runtime_error("database down");
+            std::vector<CommittedOffset> found;
+            for (const CommittedOffset &offset: saved) {
+                if (offset.group == group && offset.topic == topic) found.push_back(offset);
+            }
+            return found;
+        }
+
+        void save_offsets(const std::vector<CommittedOffset> &offsets) override {
+            const std::lock_guard lock(mutex);
+            if (failing) throw std::runtime_error("database down");
+            ++batches;
+            for (const CommittedOffset &offset: offsets) {
+                auto it = std::find_if(saved.begin(), saved.end(), [&offset](const CommittedOffset &o) {
+                    return o.group == offset.group && o.topic == offset.topic && o.partition == offset.partition;
+                });
+                if (it == saved.end()) {
+                    saved.push_back(offset);
+                } else {
+                    it->offset = std::max(it->offset, offset.offset);
+                }
+            }
+        }
+
+        std::mutex mutex;
+        std::vector<CommittedOffset> saved;
+        int batches = 0;
+        int loads = 0;
+        bool failing = false;
+        std::atomic<bool> failing_loads = false;
+    };
+} // namespace
+
+int main() {
+    // partitioning is stable and spreads keys
+    {
+        assert(partition_of("user-42", 16) == partition_of("user-42", 16));
+        std::vector<int> hits(16, 0);
+        for (int i = 0; i < 16000; ++i) ++hits[partition_of("user-" + std::to_string(i), 16)];
+        for (const int count: hits) assert(count > 700 && count < 1300);
+    }
+
+    // joins and leaves rebalance evenly and only move what has to move
+    {
+        GroupMembership group(16);
+        assert(std::all_of(group.owners().begin(), group.owners().end(), [](MemberId m) { return m == 0; }));
+
+        assert(group.join(1));
+        assert(!group.join(1));
+        assert(shares(group)[1] == 16);
+
+        auto before = group.owners();
+        assert(group.join(2));
+        assert_balanced(group);
+        assert(moved(before, group.owners()) == 8);
+
+        before = group.owners();
+        assert(group.join(3));
+        assert_balanced(group);
+        // 16 over 3 is 6/5/5: the newcomer takes five, nothing else moves
+        assert(moved(before, group.owners()) == 5);
+        assert(group.partitions_of(3).size() == 5);
+
+        before = group.owners();
+        const auto released = group.partitions_of(2);
+        assert(group.leave(2));
+        assert(!group.leave(2));
+        assert_balanced(group);
+        assert(moved(before, group.owners()) == released.size());
+
+        const std::uint64_t generation = group.generation();
+        assert(group.leave(1));
+        assert(group.leave(3));
+        assert(group.empty());
+        assert(group.generation() == generation + 2);
+        assert(std::all_of(group.owners().begin(), group.owners().end(), [](MemberId m) { return m == 0; }));
+    }
+
+    // more members than partitions leaves some idle
+    {
+        GroupMembership group(2);
+        for (MemberId member = 1; member <= 4; ++member) group.join(member);
+        assert(shares(group).size() == 2);
+        group.leave(group.owners()[0]);
+        assert(std::find(group.owners().begin(), group.owners().end(), 0) == group.owners().end());
+    }
+
+    // commits are kept per partition, never go backwards and are written in batches
+    {
+        FakeStore store;
+        store.saved.push_back({"g", "orders", 3, 40});
+        {
+            OffsetCommitter committer(&store, OffsetCommitConfig{std::chrono::hours(1), 1000});
+            assert(committer.committed("g", "orders").at(3) == 40);
+
+            for (std::uint64_t offset = 1; offset <= 100; ++offset) {
+                committer.commit("g", "orders", 1, offset);
+                committer.commit("g", "orders", 2, offset * 2);
+            }
+            committer.commit("g", "orders", 1, 50);
+            committer.commit("g", "orders", 3, 41);
+            assert(committer.committed("g", "orders").at(1) == 100);
+
+            committer.flush();
+            assert(store.batches == 1);
+            assert(committer.batches_written() == 1);
+            assert(store.load_offsets("g", "orders").size() == 3);
+
+            // a failed write is retried with the next batch
+            store.failing = true;
+            committer.commit("g", "orders", 1, 101);
+            committer.flush();
+            assert(store.batches == 1);
+            store.failing = false;
+            committer.commit("g", "orders", 2, 201);
+            committer.flush();
+            assert(store.batches == 2);
+            for (const CommittedOffset &offset: store.saved) {
+                if (offset.partition == 1) assert(offset.offset == 101);
+                if (offset.partition == 2) assert(offset.offset == 201);
+                if (offset.partition == 3) assert(offset.offset == 41);
+            }
+
+            committer.commit("g", "orders", 1, 102);
+        }
+        // the destructor writes what is left
+        assert(store.batches == 3);
+    }
+
+    // the background writer kicks in once enough partitions are dirty
+    {
+        FakeStore store;
+        OffsetCommitter committer(&store, OffsetCommitConfig{std::chrono::hours(1), 8});
+        for (std::uint32_t partition = 0; partition < 8; ++partition) committer.commit("g", "t", partition, 1);
+        for (int i = 0; i < 1000 && committer.batches_written() == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(committer.batches_written() == 1);
+        assert(store.saved.size() == 8);
+    }
+
+    // load() reads on the background thread, retries a failed read and only then caches
+    {
+        FakeStore store;
+        store.saved.push_back({"g", "t", 0, 9});
+        store.failing_loads = true;
+        OffsetCommitter committer(&store, OffsetCommitConfig{std::chrono::milliseconds(5), 1000});
+        assert(!committer.cached("g", "t"));
+
+        std::mutex mutex;
+        std::condition_variable done;
+        std::vector<OffsetCommitter::Offsets> delivered;
+        const std::thread::id caller = std::this_thread::get_id();
+        {
+            // the caller may hold what the callback takes
+            const std::lock_guard lock(mutex);
+            for (int i = 0; i < 2; ++i) {
+                committer.load("g", "t", [&](const OffsetCommitter::Offsets &offsets) {
+                    assert(std::this_thread::get_id() != caller);
+                    const std::lock_guard callback_lock(mutex);
+                    delivered.push_back(offsets);
+                    done.notify_all();
+                });
+            }
+        }
+        for (int i = 0; i < 1000; ++i) {
+            {
+                const std::lock_guard lock(store.mutex);
+                if (store.loads >= 2) break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        {
+            const std::lock_guard lock(mutex);
+            assert(delivered.empty());
+        }
+        // a failed read is not remembered as "nothing committed"
+        assert(!committer.cached("g", "t"));
+
+        store.failing_loads = false;
+        {
+            std::unique_lock lock(mutex);
+            assert(done.wait_for(lock, std::chrono::seconds(5), [&]() { return delivered.size() == 2; }));
+            for (const OffsetCommitter::Offsets &offsets: delivered) assert(offsets.at(0) == 9);
+        }
+        assert(committer.cached("g", "t")->at(0) == 9);
+        committer.commit("g", "t", 0, 10);
+        assert(committer.cached("g", "t")->at(0) == 10);
+    }
+
+    // committed() does not cache a failed read either
+    {
+        FakeStore store;
+        store.saved.push_back({"g", "t", 1, 4});
+        store.failing_loads = true;
+        OffsetCommitter committer(&store, OffsetCommitConfig{std::chrono::hours(1), 1000});
+        assert(committer.committed("g", "t").empty());
+        store.failing_loads = false;
+        assert(committer.committed("g", "t").at(1) == 4);
+    }
+
+    // without a store offsets stay in memory
+    {
+        OffsetCommitter committer(nullptr);
+        committer.commit("g", "t", 0, 7);
+        committer.flush();
+        assert(committer.committed("g", "t").at(0) == 7);
+        assert(committer.cached("g", "t")->at(0) == 7);
+        assert(committer.batches_written() == 0);
+
+        // load() still calls back off the caller, which may hold what the callback takes
+        std::mutex mutex;
+        std::condition_variable done;
+        bool delivered = false;
+        const std::thread::id caller = std::this_thread::get_id();
+        std::unique_lock lock(mutex);
+        committer.load("g", "t", [&](const OffsetCommitter::Offsets &offsets) {
+            assert(std::this_thread::get_id() != caller && offsets.at(0) == 7);
+            const std::lock_guard callback_lock(mutex);
+            delivered = true;
+            done.notify_all();
+        });
+        assert(done.wait_for(lock, std::chrono::seconds(5), [&]() { return delivered; }));
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/core_mesh.h>
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+int main() {
+    // single producer, single consumer: everything arrives once and in order
+    {
+        beacon::SpscQueue<int> queue(3);
+        assert(queue.capacity() == 4);
+        int value = 0;
+        assert(!queue.try_pop(value));
+        for (int i = 0; i < 4; ++i) assert(queue.try_push(i));
+        int overflow = 99;
+        assert(!queue.try_push(overflow) && overflow == 99);
+
+        beacon::SpscQueue<int> shared(64);
+        constexpr int kCount = 200000;
+        std::thread producer([&shared]() {
+            for (int i = 0; i < kCount; ++i) {
+                int v = i;
+                while (!shared.try_push(v)) std::this_thread::yield();
+            }
+        });
+        for (int expected = 0; expected < kCount;) {
+            if (shared.try_pop(value)) {
+                assert(value == expected);
+                ++expected;
+            }
+        }
+        producer.join();
+    }
+
+    // every core sends to every other core; each pair's values arrive in order
+    {
+        constexpr std::size_t kCores = 3;
+        constexpr int kPerPair = 20000;
+        beacon::CoreMesh<int> mesh(kCores, 4);
+        std::atomic<int> wakes{0};
+
+        std::vector<std::thread> threads;
+        std::vector<int> received(kCores, 0);
+        for (std::size_t core = 0; core < kCores; ++core) {
+            threads.emplace_back([&, core]() {
+                std::vector<int> next(kCores, 0);
+                int sent = 0;
+                bool flushed = true;
+                while (sent < kPerPair || !flushed || received[core] < kPerPair * static_cast<int>(kCores - 1)) {
+                    for (int k = 0; k < 16 && sent < kPerPair; ++k, ++sent) {
+                        for (std::size_t to = 0; to < kCores; ++to) {
+                            // encode the sender so the receiver can check per-pair order
+                            if (to != core) mesh.send(core, to, sent * static_cast<int>(kCores) + static_cast<int>(core));
+                        }
+                    }
+                    flushed = mesh.flush(core, [&wakes](std::size_t) { ++wakes; });
+                    received[core] += static_cast<int>(mesh.drain(core, [&](int &value) {
+                        const std::size_t from = static_cast<std::size_t>(value) % kCores;
+                        assert(value / static_cast<int>(kCores) == next[from]);
+                        ++next[from];
+                    }));
+                }
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        for (const int count: received) assert(count == kPerPair * static_cast<int>(kCores - 1));
+        assert(wakes > 0);
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/dead_letter.h>
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace beacon::deadletter;
+
+namespace {
+    class FakeStore : public DeadLetterStore {
+    public:
+        void store_dead_letters(const std::vector<DeadLetter> &letters) override {
+            const std::lock_guard lock(mutex);
+            ++batches;
+            if (failing) throw std::runtime_error("database down");
+            stored.insert(stored.end(), letters.begin(), letters.end());
+        }
+
+        std::size_t stored_count() {
+            const std::lock_guard lock(mutex);
+            return stored.size();
+        }
+
+        std::mutex mutex;
+        std::vector<DeadLetter> stored;
+        int batches = 0;
+        std::atomic<bool> failing = false;
+    };
+
+    DeadLetter letter(const std::string &schema, int n) {
+        return DeadLetter{schema, 1, "orders", "/id", "required", "{\"n\":" + std::to_string(n) + "}", false};
+    }
+
+    // the sink's writer runs on its own thread; give it a while to catch up
+    template<typename F>
+    bool eventually(F &&done) {
+        for (int i = 0; i < 5000; ++i) {
+            if (done()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+} // namespace
+
+int main() {
+    // every schema is sampled at its own rate, the same way every time
+    {
+        DeadLetterConfig config;
+        config.sample_rate = 0.5;
+        config.schema_sample_rates = {{"quarter", 0.25}, {"none", 0.0}};
+        config.per_schema = {};
+
+        std::vector<bool> first_run;
+        for (int run = 0; run < 2; ++run) {
+            FakeStore store;
+            DeadLetterSink sink(store, config);
+            std::vector<bool> admitted;
+            int quarter = 0, half = 0, none = 0;
+            for (int i = 0; i < 100; ++i) {
+                const bool q = sink.admit("quarter");
+                const bool h = sink.admit("other");
+                const bool n = sink.admit("none");
+                quarter += q;
+                half += h;
+                none += n;
+                admitted.push_back(q);
+            }
+            // exactly the share asked for, evenly spread: every fourth reject
+            assert(quarter == 25 && half == 50 && none == 0);
+            for (std::size_t i = 0; i < admitted.size(); ++i) assert(admitted[i] == (i % 4 == 3));
+            if (run == 0) first_run = admitted;
+            assert(admitted == first_run);
+            assert(sink.stats().sampled_out == 75 + 50 + 100);
+            assert(sink.stats().rate_limited == 0);
+        }
+    }
+
+    // after sampling, each schema is capped by its own token bucket
+    {
+        DeadLetterConfig config;
+        config.per_schema = {0.001, 3.0};
+        FakeStore store;
+        DeadLetterSink sink(store, config);
+        int a = 0, b = 0;
+        for (int i = 0; i < 100; ++i) {
+            a += sink.admit("a");
+            b += sink.admit("b");
+        }
+        assert(a == 3);
+        assert(b == a);
+        assert(sink.stats().rate_limited == static_cast<std::uint64_t>(200 - a - b));
+        assert(sink.stats().sampled_out == 0);
+    }
+
+    // beyond max_queued rejects are dropped and counted; the destructor writes the rest
+    {
+        DeadLetterConfig config;
+        config.max_queued = 5;
+        config.interval = std::chrono::hours(1);
+        FakeStore store;
+        {
+            DeadLetterSink sink(store, config);
+            for (int i = 0; i < 8; ++i) sink.submit(letter("s", i));
+            assert(sink.stats().kept == 5);
+            assert(sink.stats().queue_full == 3);
+        }
+        assert(store.stored.size() == 5);
+        assert(store.stored.front().raw_payload == "{\"n\":0}" && store.stored.back().raw_payload == "{\"n\":4}");
+    }
+
+    // a full batch is written at once; a failed one is dropped, not retried
+    {
+        DeadLetterConfig config;
+        config.batch_size = 2;
+        config.interval = std::chrono::hours(1);
+        FakeStore store;
+        DeadLetterSink sink(store, config);
+        store.failing = true;
+        sink.submit(letter("s", 0));
+        sink.submit(letter("s", 1));
+        assert(eventually([&]() { return sink.stats().write_failed == 2; }));
+
+        store.failing = false;
+        sink.submit(letter("s", 2));
+        sink.submit(letter("s", 3));
+        assert(eventually([&]() { return sink.stats().written == 2; }));
+        assert(store.stored_count() == 2);
+        const std::lock_guard lock(store.mutex);
+        assert(store.batches == 2);
+        assert(store.stored[0].raw_payload == "{\"n\":2}" && store.stored[1].raw_payload == "{\"n\":3}");
+    }
+    return 0;
+}
@@ -0,0 +1,195 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/delay_journal.h>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace beacon::delay;
+
+namespace {
+    class FakeStore : public DelayStore {
+    public:
+        std::vector<DelayedEvent> load_delayed(std::uint64_t after_ms, std::uint64_t until_ms,
+                                               std::uint64_t below_id) override {
+            const std::lock_guard lock(mutex);
+            std::vector<DelayedEvent> found;
+            for (const auto &[id, event]: saved) {
+                if (id < below_id && event.deliver_at_ms > after_ms && event.deliver_at_ms <= until_ms) {
+                    found.push_back(event);
+                }
+            }
+            return found;
+        }
+
+        std::uint64_t max_delayed_id() override {
+            const std::lock_guard lock(mutex);
+            return saved.empty() ? 0 : saved.rbegin()->first;
+        }
+
+        void write_delayed(const std::vector<DelayedEvent> &added,
+                           const std::vector<std::uint64_t> &delivered) override {
+            const std::lock_guard lock(mutex);
+            ++attempts;
+            if (failing) throw std::runtime_error("database down");
+            writes.emplace_back(added.size(), delivered.size());
+            for (const DelayedEvent &event: added) saved[event.id] = event;
+            for (const std::uint64_t id: delivered) saved.erase(id);
+        }
+
+        std::size_t write_count() {
+            const std::lock_guard lock(mutex);
+            return writes.size();
+        }
+
+        std::mutex mutex;
+        std::map<std::uint64_t, DelayedEvent> saved;
+        // added and delivered count of every good write
+        std::vector<std::pair<std::size_t, std::size_t> > writes;
+        int attempts = 0;
+        std::atomic<bool> failing = false;
+    };
+
+    DelayedEvent event(std::uint64_t id, std::uint64_t deliver_at_ms) {
+        return DelayedEvent{id, deliver_at_ms, "{\"id\":" + std::to_string(id) + "}"};
+    }
+
+    // collects what one load passes to its handler
+    struct Result {
+        std::mutex mutex;
+        std::condition_variable done;
+        bool called = false;
+        bool ok = false;
+        std::vector<DelayedEvent> events;
+
+        DelayJournal::LoadHandler handler() {
+            return [this](std::vector<DelayedEvent> &&loaded, bool good) {
+                const std::lock_guard lock(mutex);
+                events = std::move(loaded);
+                ok = good;
+                called = true;
+                done.notify_all();
+            };
+        }
+
+        bool wait(std::chrono::milliseconds timeout) {
+            std::unique_lock lock(mutex);
+            return done.wait_for(lock, timeout, [this]() { return called; });
+        }
+    };
+} // namespace
+
+int main() {
+    // saves and deliveries go out together, one write per batch
+    {
+        FakeStore store;
+        store.saved[1] = event(1, 100);
+        {
+            DelayJournal journal(store, std::chrono::hours(1), 1000);
+            journal.save(event(2, 200));
+            journal.save(event(3, 300));
+            journal.save(event(4, 400));
+            journal.delivered(1);
+            journal.flush();
+            assert(store.writes.size() == 1);
+            assert(store.writes[0] == std::make_pair(std::size_t{3}, std::size_t{1}));
+            assert(store.saved.size() == 3 && !store.saved.contains(1));
+
+            // nothing pending, nothing written
+            journal.flush();
+            assert(store.writes.size() == 1);
+
+            journal.delivered(2);
+        }
+        // the destructor writes what is left
+        assert(store.writes.size() == 2 && !store.saved.contains(2));
+    }
+
+    // the background thread writes as soon as max_pending is reached
+    {
+        FakeStore store;
+        DelayJournal journal(store, std::chrono::hours(1), 4);
+        for (std::uint64_t id = 1; id <= 4; ++id) journal.save(event(id, id * 100));
+        for (int i = 0; i < 1000 && store.write_count() == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(store.write_count() == 1);
+    }
+
+    // an event delivered before it was written is never written, nor deleted
+    {
+        FakeStore store;
+        DelayJournal journal(store, std::chrono::hours(1), 1000);
+        journal.save(event(1, 100));
+        journal.save(event(2, 200));
+        journal.delivered(1);
+        journal.flush();
+        assert(store.writes.size() == 1);
+        assert(store.writes[0] == std::make_pair(std::size_t{1}, std::size_t{0}));
+        assert(!store.saved.contains(1) && store.saved.contains(2));
+
+        journal.save(event(3, 300));
+        journal.delivered(3);
+        journal.flush();
+        assert(store.writes.size() == 1);
+    }
+
+    // a failed write is retried with the next batch
+    {
+        FakeStore store;
+        DelayJournal journal(store, std::chrono::hours(1), 1000);
+        store.saved[1] = event(1, 100);
+        store.failing = true;
+        journal.save(event(2, 200));
+        journal.delivered(1);
+        journal.flush();
+        assert(store.attempts == 1 && store.writes.empty());
+
+        // a delivery of an event still waiting for its retry cancels it
+        journal.save(event(3, 300));
+        journal.delivered(3);
+        store.failing = false;
+        journal.save(event(4, 400));
+        journal.flush();
+        assert(store.writes.size() == 1);
+        assert(store.writes[0] == std::make_pair(std::size_t{2}, std::size_t{1}));
+        assert(store.saved.size() == 2 && store.saved.contains(2) && store.saved.contains(4));
+    }
+
+    // a load sees every save queued before it, in the requested range
+    {
+        FakeStore store;
+        DelayJournal journal(store, std::chrono::hours(1), 1000);
+        journal.save(event(1, 100));
+        journal.save(event(2, 200));
+        journal.save(event(3, 300));
+        journal.save(event(4, 400));
+        journal.delivered(2);
+        Result result;
+        journal.load(100, 400, 4, result.handler());
+        assert(result.wait(std::chrono::seconds(5)));
+        assert(result.ok && result.events.size() == 1 && result.events[0].id == 3);
+        assert(result.events[0].message == "{\"id\":3}");
+    }
+
+    // ...and waits while those saves cannot be written
+    {
+        FakeStore store;
+        store.failing = true;
+        DelayJournal journal(store, std::chrono::milliseconds(5), 1000);
+        journal.save(event(1, 100));
+        Result result;
+        journal.load(0, 1000, 10, result.handler());
+        assert(!result.wait(std::chrono::milliseconds(50)));
+        store.failing = false;
+        assert(result.wait(std::chrono::seconds(5)));
+        assert(result.ok && result.events.size() == 1 && result.events[0].id == 1);
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/embedding_matrix.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using beacon::reco::EmbeddingMatrix;
+using beacon::reco::EmbeddingMetric;
+using beacon::reco::SimdLevel;
+
+namespace {
+    using Scored = std::vector<std::pair<float, std::uint32_t> >;
+
+    // every row scored one at a time in double precision
+    Scored reference(const std::vector<std::vector<float> > &rows, const std::vector<float> &query, std::size_t k,
+                     EmbeddingMetric metric) {
+        auto norm = [](const std::vector<float> &values) {
+            double sum = 0.0;
+            for (const float value: values) sum += static_cast<double>(value) * value;
+            return std::sqrt(sum);
+        };
+        Scored scored;
+        for (std::uint32_t row = 0; row < rows.size(); ++row) {
+            if (rows[row].empty()) continue;
+            double dot = 0.0;
+            for (std::size_t d = 0; d < query.size(); ++d) dot += static_cast<double>(rows[row][d]) * query[d];
+            if (metric == EmbeddingMetric::Cosine) {
+                const double norms = norm(rows[row]) * norm(query);
+                dot = norms > 0.0 ? dot / norms : 0.0;
+            }
+            scored.emplace_back(static_cast<float>(dot), row);
+        }
+        std::sort(scored.begin(), scored.end(), [](const auto &a, const auto &b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        });
+        if (scored.size() > k) scored.resize(k);
+        return scored;
+    }
+} // namespace
+
+int main() {
+    assert(beacon::reco::parse_simd("avx2") == SimdLevel::Avx2);
+    assert(beacon::reco::parse_embedding_metric("dot") == EmbeddingMetric::Dot);
+    // asking for more than the CPU has gets what it has
+    assert(EmbeddingMatrix(4, SimdLevel::Avx512).simd() == beacon::reco::detect_simd());
+
+    {
+        // ties go to the lower row; rows never set and zero vectors are left out
+        EmbeddingMatrix matrix(3, SimdLevel::Scalar);
+        const float a[] = {1.0f, 0.0f, 0.0f};
+        const float b[] = {0.0f, 2.0f, 0.0f};
+        const float zero[] = {0.0f, 0.0f, 0.0f};
+        matrix.set(5, a);
+        matrix.set(2, a);
+        matrix.set(40, b);
+        matrix.set(7, zero);
+        assert(matrix.size() == 4 && matrix.contains(40) && !matrix.contains(3) && !matrix.contains(1000));
+        assert(matrix.row(40) == std::vector<float>(b, b + 3) && matrix.row(3).empty());
+
+        const float query[] = {1.0f, 1.0f, 0.0f};
+        Scored top = matrix.top_k(query, 2, EmbeddingMetric::Dot);
+        assert(top.size() == 2 && top[0].second == 40 && top[0].first == 2.0f && top[1].second == 2);
+        top = matrix.top_k(query, 10, EmbeddingMetric::Cosine);
+        assert(top.size() == 4 && top[0].second == 2 && top[1].second == 5 && top[2].second == 40);
+        assert(top[3].second == 7 && top[3].first == 0.0f);
+        assert(matrix.top_k(zero, 10, EmbeddingMetric::Cosine).empty());
+        assert(matrix.top_k(query, 0, EmbeddingMetric::Dot).empty());
+
+        // setting a row again replaces it
+        matrix.set(40, zero);
+        assert(matrix.size() == 4 && matrix.top_k(query, 1, EmbeddingMetric::Dot)[0].second == 2);
+    }
+
+    {
+        // every kernel the CPU runs agrees with the reference, over ragged sizes and gaps
+        std::mt19937 rng(3);
+        std::normal_distribution<float> value(0.0f, 1.0f);
+        const std::size_t dimensions[] = {1, 7, 16, 33};
+        for (const std::size_t dimension: dimensions) {
+            std::vector<std::vector<float> > rows(1000);
+            EmbeddingMatrix matrix(dimension);
+            for (std::uint32_t row = 0; row < rows.size(); ++row) {
+                if (row % 7 == 3) continue;
+                rows[row].resize(dimension);
+                for (float &v: rows[row]) v = value(rng);
+                matrix.set(row, rows[row].data());
+            }
+            std::vector<float> query(dimension);
+            for (float &v: query) v = value(rng);
+
+            const SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2, SimdLevel::Avx512};
+            const EmbeddingMetric metrics[] = {EmbeddingMetric::Dot, EmbeddingMetric::Cosine};
+            for (const SimdLevel level: levels) {
+                matrix.set_simd(level);
+                for (const EmbeddingMetric metric: metrics) {
+                    for (const std::size_t k: {std::size_t{1}, std::size_t{10}, std::size_t{2000}}) {
+                        const Scored expected = reference(rows, query, k, metric);
+                        const Scored got = matrix.top_k(query.data(), k, metric);
+                        assert(got.size() == expected.size());
+                        for (std::size_t i = 0; i < got.size(); ++i) {
+                            assert(std::abs(got[i].first - expected[i].first) < 1e-4f);
+                            // rounding can swap near ties
+                            assert(got[i].second == expected[i].second ||
+                                   std::abs(got[i].first - got[std::min(i + 1, got.size() - 1)].first) < 1e-4f ||
+                                   std::abs(got[i].first - got[i > 0 ? i - 1 : 0].first) < 1e-4f);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    {
+        // every length around the vector widths, against the scalar loop
+        for (const SimdLevel level: {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+            const beacon::reco::ScaledAdd scaled_add = beacon::reco::scaled_add(level);
+            for (std::size_t count = 0; count <= 40; ++count) {
+                std::vector<float> x(count), y(count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    x[i] = static_cast<float>(i) * 0.5f;
+                    y[i] = 1.0f - static_cast<float>(i);
+                }
+                scaled_add(2.0f, x.data(), y.data(), count);
+                for (std::size_t i = 0; i < count; ++i) assert(y[i] == 1.0f);
+            }
+        }
+    }
+    return 0;
+}
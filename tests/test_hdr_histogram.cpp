@@ -0,0 +1,62 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/hdr_histogram.h>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+using beacon::HdrHistogram;
+
+namespace {
+    bool near(std::uint64_t value, std::uint64_t expected, double tolerance) {
+        return std::abs(static_cast<double>(value) - static_cast<double>(expected)) <=
+               tolerance * static_cast<double>(expected);
+    }
+} // namespace
+
+int main() {
+    HdrHistogram histogram(1, 60'000'000'000ULL, 3);
+    assert(histogram.count() == 0 && histogram.value_at_percentile(50) == 0);
+
+    // small values are exact at three digits
+    for (std::uint64_t v = 1; v <= 1000; ++v) histogram.record(v);
+    assert(histogram.value_at_percentile(50) == 500);
+    assert(histogram.value_at_percentile(99.9) == 999);
+    assert(histogram.value_at_percentile(100) == 1000);
+    assert(histogram.min() == 1 && histogram.max() == 1000);
+    assert(std::abs(histogram.mean() - 500.5) < 1e-9);
+
+    // large values within 0.1%
+    HdrHistogram large(1, 60'000'000'000ULL, 3);
+    for (std::uint64_t v = 1; v <= 1'000'000; ++v) large.record(v * 1000);
+    assert(near(large.value_at_percentile(50), 500'000'000, 0.001));
+    assert(near(large.value_at_percentile(99), 990'000'000, 0.001));
+    assert(near(large.value_at_percentile(99.9), 999'000'000, 0.001));
+    assert(large.value_at_percentile(100) == 1'000'000'000);
+
+    // counts and merging
+    HdrHistogram a(1, 1'000'000, 2);
+    HdrHistogram b(1, 1'000'000, 2);
+    a.record(10, 99);
+    b.record(5000, 1);
+    a.merge(b);
+    assert(a.count() == 100);
+    assert(a.value_at_percentile(99) == 10);
+    assert(near(a.value_at_percentile(99.9), 5000, 0.01));
+    assert(a.max() == 5000);
+
+    // out of range values are clamped
+    a.record(10'000'000);
+    assert(a.max() == 1'000'000);
+
+    // layouts must match
+    bool threw = false;
+    try {
+        a.merge(large);
+    } catch (const std::invalid_argument &) {
+        threw = true;
+    }
+    assert(threw);
+    return 0;
+}
@@ -0,0 +1,167 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/embedding_matrix.h>
+#include <beacon/hnsw_index.h>
+#include <cassert>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using beacon::reco::EmbeddingMatrix;
+using beacon::reco::EmbeddingMetric;
+using beacon::reco::HnswConfig;
+using beacon::reco::HnswIndex;
+
+namespace {
+    constexpr std::size_t kDimension = 24;
+
+    // points around a few dozen centers, the way embeddings cluster
+    std::vector<float> clustered(std::size_t count, std::mt19937 &rng) {
+        std::normal_distribution<float> value(0.0f, 1.0f);
+        std::vector<float> centers(40 * kDimension);
+        for (float &v: centers) v = value(rng);
+        std::uniform_int_distribution<std::size_t> center(0, 39);
+        std::vector<float> points(count * kDimension);
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::size_t c = center(rng);
+            for (std::size_t d = 0; d < kDimension; ++d) {
+                points[i * kDimension + d] = centers[c * kDimension + d] + 0.3f * value(rng);
+            }
+        }
+        return points;
+    }
+
+    bool throws_on_load(const std::string &bytes) {
+        std::istringstream in(bytes);
+        try {
+            HnswIndex::load(in);
+        } catch (const std::runtime_error &) {
+            return true;
+        }
+        return false;
+    }
+} // namespace
+
+int main() {
+    HnswConfig config;
+    config.dimension = kDimension;
+    config.m = 12;
+    config.ef_construction = 100;
+
+    {
+        HnswIndex empty(config);
+        const float query[kDimension] = {1.0f};
+        assert(empty.search(query, 10).empty() && empty.size() == 0);
+    }
+
+    std::mt19937 rng(5);
+    const std::size_t count = 3000;
+    const std::vector<float> points = clustered(count, rng);
+    std::vector<std::uint32_t> labels(count);
+    for (std::uint32_t i = 0; i < count; ++i) labels[i] = i;
+
+    HnswIndex index(config);
+    index.add_all(labels, points.data(), 4);
+    assert(index.size() == count);
+
+    // recall@10 against brute force
+    EmbeddingMatrix exact(kDimension);
+    for (std::uint32_t i = 0; i < count; ++i) exact.set(i, points.data() + i * kDimension);
+    const std::vector<float> queries = clustered(100, rng);
+    auto recall = [&](const HnswIndex &searched, std::size_t ef) {
+        std::size_t hits = 0;
+        for (std::size_t q = 0; q < 100; ++q) {
+            const float *query = queries.data() + q * kDimension;
+            std::unordered_set<std::uint32_t> truth;
+            for (const auto &[score, row]: exact.top_k(query, 10, EmbeddingMetric::Cosine)) truth.insert(row);
+            const auto found = searched.search(query, 10, ef);
+            assert(found.size() == 10);
+            for (std::size_t i = 1; i < found.size(); ++i) assert(found[i - 1].first >= found[i].first);
+            for (const auto &[score, label]: found) hits += truth.count(label);
+        }
+        return static_cast<double>(hits) / 1000.0;
+    };
+    assert(recall(index, 100) >= 0.95);
+    assert(recall(index, 200) >= recall(index, 10) - 0.01);
+
+    {
+        // saved and loaded, it answers the same; relabeled, under the new labels
+        std::stringstream file;
+        index.save(file);
+        const std::string bytes = file.str();
+        std::unique_ptr<HnswIndex> loaded = HnswIndex::load(file);
+        assert(loaded->size() == count && loaded->config().m == 12);
+        for (std::size_t q = 0; q < 10; ++q) {
+            const float *query = queries.data() + q * kDimension;
+            assert(loaded->search(query, 10) == index.search(query, 10));
+        }
+        assert(loaded->vector(7) == index.vector(7) && loaded->vector(7).size() == kDimension);
+        loaded->relabel([](std::uint32_t label) { return label + 10000; });
+        assert(loaded->search(points.data(), 1)[0].second == 10000);
+        assert(loaded->vector(0).empty() && !loaded->vector(10000).empty());
+
+        assert(throws_on_load("not an index at all"));
+        assert(throws_on_load(bytes.substr(0, bytes.size() / 2)));
+        std::string corrupt = bytes;
+        corrupt[8] = 0; // dimension 0
+        corrupt[9] = 0;
+        assert(throws_on_load(corrupt));
+    }
+
+    {
+        // adding a label again replaces its vector; the old one is never returned
+        const float *replacement = points.data() + 1 * kDimension;
+        index.add(0, replacement);
+        assert(index.size() == count);
+        const auto found = index.search(points.data(), 50, 200);
+        for (const auto &[score, label]: found) assert(label != 0 || score > 0.999f);
+        assert(index.vector(0) == index.vector(1));
+    }
+
+    {
+        // labels updated over and over: tombstones neither crowd out results nor pile up
+        HnswIndex updated(config);
+        updated.add_all({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, points.data(), 1);
+        std::stringstream before;
+        updated.save(before);
+        for (std::uint32_t round = 0; round < 100; ++round) {
+            for (std::uint32_t label = 0; label < 10; ++label) {
+                updated.add(label, points.data() + ((round * 10 + label) % count) * kDimension);
+                assert(updated.search(queries.data(), 10, 10).size() == 10);
+            }
+        }
+        assert(updated.size() == 10);
+        const float *last = points.data() + (99 * 10 + 3) * kDimension;
+        assert(updated.search(last, 1)[0].second == 3);
+        std::stringstream after;
+        updated.save(after);
+        // tombstones are at most the live nodes plus the minimum before a rebuild
+        assert(after.str().size() < 10 * before.str().size());
+    }
+
+    {
+        // inserts and searches at the same time
+        HnswIndex live(config);
+        live.add_all({0, 1}, points.data(), 1);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&live, &points, t]() {
+                for (std::uint32_t i = 2 + t; i < 1000; i += 2) live.add(i, points.data() + i * kDimension);
+            });
+            threads.emplace_back([&live, &queries]() {
+                for (std::size_t q = 0; q < 200; ++q) {
+                    const auto found = live.search(queries.data() + (q % 100) * kDimension, 5);
+                    assert(!found.empty() && found.size() <= 5);
+                }
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        assert(live.size() == 1000);
+        assert(live.search(points.data() + 999 * kDimension, 1, 100)[0].second == 999);
+    }
+    return 0;
+}
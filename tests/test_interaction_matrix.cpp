@@ -0,0 +1,160 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/interaction_matrix.h>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using beacon::reco::CsrMatrix;
+using beacon::reco::InteractionMatrix;
+using beacon::reco::PackedCsrMatrix;
+using beacon::reco::Triplet;
+
+namespace {
+    using Dense = std::map<std::pair<std::uint32_t, std::uint32_t>, float>;
+
+    // within the 8-bit codes' error of each row's largest value, per merge
+    bool matches(const CsrMatrix &matrix, const Dense &expected, float merges) {
+        std::map<std::uint32_t, float> largest;
+        for (const auto &[pair, value]: expected) largest[pair.first] = std::max(largest[pair.first], value);
+        if (matrix.nonzeros() != expected.size()) return false;
+        for (std::size_t row = 0; row < matrix.rows; ++row) {
+            for (std::uint64_t i = matrix.offsets[row]; i < matrix.offsets[row + 1]; ++i) {
+                const auto found = expected.find({static_cast<std::uint32_t>(row), matrix.indices[i]});
+                if (found == expected.end()) return false;
+                if (i > matrix.offsets[row] && matrix.indices[i - 1] >= matrix.indices[i]) return false;
+                const float tolerance = merges * largest[static_cast<std::uint32_t>(row)] / 510.0f * 1.01f;
+                if (std::abs(matrix.values[i] - found->second) > tolerance) return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+int main() {
+    {
+        // gaps past one varint byte, values the codes hit exactly, empty rows
+        const CsrMatrix matrix = CsrMatrix::from_triplets(4, 100000, {
+                                                              {0, 3, 255.0f}, {0, 200, 1.0f}, {0, 99999, 128.0f},
+                                                              {2, 0, 0.5f}
+                                                          });
+        const PackedCsrMatrix packed = PackedCsrMatrix::pack(matrix);
+        assert(packed.rows() == 4 && packed.columns() == 100000 && packed.nonzeros() == 4);
+        const CsrMatrix unpacked = packed.unpack();
+        assert(unpacked.offsets == matrix.offsets && unpacked.indices == matrix.indices);
+        assert(unpacked.values == matrix.values);
+        std::vector<std::uint32_t> columns;
+        packed.for_each(0, [&columns](std::uint32_t column, float) { columns.push_back(column); });
+        assert((columns == std::vector<std::uint32_t>{3, 200, 99999}));
+        packed.for_each(7, [](std::uint32_t, float) { assert(false); });
+
+        const PackedCsrMatrix merged = packed.merge({{0, 200, 1.0f}, {1, 5, 2.0f}, {5, 1, 1.0f}}, 0, 0);
+        assert(merged.rows() == 6 && merged.nonzeros() == 6);
+        std::vector<std::pair<std::uint32_t, float> > row;
+        merged.for_each(0, [&row](std::uint32_t column, float value) { row.emplace_back(column, value); });
+        assert(row.size() == 3 && row[1].first == 200 && std::abs(row[1].second - 2.0f) <= 0.5f);
+        assert(merged.unpack().offsets == (std::vector<std::uint64_t>{0, 3, 4, 5, 5, 5, 6}));
+    }
+
+    {
+        // random interactions, merged now and then, read back whole, by row and by column
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<std::uint32_t> user(0, 299);
+        std::uniform_int_distribution<std::uint32_t> item(0, 999);
+        std::uniform_real_distribution<float> weight(0.5f, 5.0f);
+        InteractionMatrix matrix(500);
+        Dense expected;
+        std::size_t merges = 0;
+        for (int i = 0; i < 5000; ++i) {
+            const std::uint32_t u = user(rng);
+            const std::uint32_t v = item(rng);
+            const float w = weight(rng);
+            expected[{u, v}] += w;
+            if (matrix.add(u, v, w)) {
+                matrix.merge();
+                ++merges;
+            }
+        }
+        assert(merges == 10 && matrix.pending() == 0);
+        matrix.add(0, 0, 1.0f);
+        expected[{0, 0}] += 1.0f;
+        assert(matrix.pending() == 1);
+
+        const CsrMatrix csr = matrix.to_csr(400, 2000);
+        assert(csr.rows == 400 && csr.columns == 2000 && csr.offsets.size() == 401);
+        assert(matches(csr, expected, static_cast<float>(merges + 1)));
+        assert(matrix.nonzeros() + 1 >= expected.size());
+        // both orientations packed, with the delta's room, against both unpacked
+        const CsrMatrix rows = matrix.to_csr();
+        assert(matrix.memory_bytes() < (rows.offsets.size() + 1001) * 8 + rows.nonzeros() * 16);
+
+        for (const std::uint32_t u: {0u, 17u, 299u}) {
+            const auto row = matrix.row(u);
+            for (std::size_t i = 0; i < row.size(); ++i) {
+                assert(i == 0 || row[i - 1].first < row[i].first);
+                assert(expected.count({u, row[i].first}) == 1);
+            }
+            std::size_t count = 0;
+            for (const auto &[pair, value]: expected) count += pair.first == u;
+            assert(row.size() == count);
+        }
+        for (const std::uint32_t v: {0u, 500u, 999u}) {
+            const auto column = matrix.column(v);
+            std::size_t count = 0;
+            for (const auto &[pair, value]: expected) count += pair.second == v;
+            assert(column.size() == count);
+            for (std::size_t i = 1; i < column.size(); ++i) assert(column[i - 1].first < column[i].first);
+            for (const auto &[u, value]: column) {
+                assert(std::abs(value - expected[{u, v}]) <= static_cast<float>(merges + 1) * 5.0f);
+            }
+        }
+
+        bool rejected = false;
+        try {
+            matrix.add(1, 1, 0.0f);
+        } catch (const std::invalid_argument &) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    {
+        // adders, a merger and readers at once
+        InteractionMatrix matrix(256);
+        std::vector<std::thread> threads;
+        for (std::uint32_t t = 0; t < 3; ++t) {
+            threads.emplace_back([&matrix, t]() {
+                for (std::uint32_t i = 0; i < 3000; ++i) {
+                    if (matrix.add(t * 1000 + i % 1000, i % 97, 1.0f)) matrix.merge();
+                    if (i % 500 == 0) matrix.row(t * 1000);
+                }
+            });
+        }
+        for (std::thread &thread: threads) thread.join();
+        matrix.merge();
+        const CsrMatrix csr = matrix.to_csr();
+        assert(csr.rows == 3000 && csr.nonzeros() == 9000);
+        for (const float value: csr.values) assert(value == 1.0f);
+    }
+
+    {
+        // past max_entries the oldest generations go, the latest interactions stay
+        InteractionMatrix matrix(100, 1000);
+        for (std::uint32_t u = 0; u < 40; ++u) {
+            for (std::uint32_t v = 0; v < 100; ++v) {
+                if (matrix.add(u, v, 1.0f)) matrix.merge();
+            }
+            assert(matrix.nonzeros() <= 1000 && matrix.generations() <= 5);
+        }
+        assert(matrix.row(0).empty() && matrix.column(7).size() <= 10);
+        assert(matrix.row(39).size() == 100 && matrix.row(39)[5].second == 1.0f);
+        const CsrMatrix csr = matrix.to_csr();
+        assert(csr.rows == 40 && csr.nonzeros() == matrix.nonzeros());
+    }
+    return 0;
+}
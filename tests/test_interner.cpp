@@ -0,0 +1,158 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/interner.h>
+#include <cassert>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using beacon::Interner;
+
+namespace {
+    bool fails_to_restore(Interner &interner, const std::string &bytes) {
+        std::istringstream in(bytes);
+        try {
+            interner.restore(in);
+        } catch (const std::runtime_error &) {
+            return true;
+        }
+        return false;
+    }
+} // namespace
+
+int main() {
+    {
+        Interner interner;
+        std::vector<std::uint32_t> created;
+        const auto record = [&interner, &created](std::uint32_t id) {
+            assert(interner.size() == id);
+            created.push_back(id);
+        };
+        assert(interner.intern("alice", record) == 0);
+        assert(interner.intern("bob", record) == 1);
+        assert(interner.intern("alice", record) == 0);
+        assert(interner.intern("") == 2);
+        assert((created == std::vector<std::uint32_t>{0, 1}));
+        assert(interner.size() == 3 && interner.find("bob") == 1u && !interner.find("carol"));
+        assert(interner.name(0) == "alice" && interner.name(2).empty());
+
+        // strings longer than an arena chunk, and enough names to grow every table
+        const std::string long_name(1 << 20, 'x');
+        assert(interner.intern(long_name) == 3);
+        for (int i = 0; i < 50000; ++i) interner.intern("user-" + std::to_string(i));
+        assert(interner.size() == 50004 && interner.name(3) == long_name);
+        assert(interner.find("user-49999") == 50003u && interner.name(50003) == "user-49999");
+        assert(interner.memory_bytes() > long_name.size());
+
+        std::ostringstream out;
+        interner.snapshot(out);
+        const std::string bytes = out.str();
+        Interner restored;
+        std::istringstream in(bytes);
+        restored.restore(in);
+        assert(restored.size() == interner.size());
+        for (std::uint32_t id = 0; id < restored.size(); ++id) {
+            assert(restored.name(id) == interner.name(id) && restored.find(interner.name(id)) == id);
+        }
+        assert(restored.intern("dave") == 50004);
+
+        // only into an empty interner, and not from a cut or foreign snapshot
+        assert(fails_to_restore(restored, bytes));
+        Interner fresh;
+        assert(fails_to_restore(fresh, bytes.substr(0, bytes.size() - 1)));
+        assert(fails_to_restore(fresh, "not a snapshot"));
+        assert(fresh.size() == 0 && fresh.intern("erin") == 0);
+    }
+
+    {
+        // a snapshot naming a string twice is refused whole
+        Interner one;
+        one.intern("a");
+        one.intern("b");
+        std::ostringstream out;
+        one.snapshot(out);
+        std::string bytes = out.str();
+        bytes[bytes.size() - 1] = 'a';
+        Interner twice;
+        assert(fails_to_restore(twice, bytes));
+        assert(twice.size() == 0 && !twice.find("a") && twice.intern("c") == 0);
+    }
+
+    {
+        // threads racing on overlapping names agree on one dense id per name
+        constexpr int kThreads = 4;
+        constexpr int kNames = 20000;
+        constexpr std::uint32_t kUnseen = 0xffffffffu;
+        Interner interner;
+        std::vector<std::vector<std::uint32_t> > seen(kThreads, std::vector<std::uint32_t>(kNames, kUnseen));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&interner, &seen, t]() {
+                for (int i = 0; i < kNames; ++i) {
+                    const int name = (i * (t + 1)) % kNames;
+                    seen[t][name] = interner.intern("item-" + std::to_string(name));
+                    assert(interner.name(seen[t][name]) == "item-" + std::to_string(name));
+                }
+            });
+        }
+        for (std::thread &thread: threads) thread.join();
+        assert(interner.size() == kNames);
+        std::set<std::uint32_t> ids(seen[0].begin(), seen[0].end());
+        assert(ids.size() == kNames && *ids.rbegin() == kNames - 1);
+        for (int t = 1; t < kThreads; ++t) {
+            for (int name = 0; name < kNames; ++name) {
+                assert(seen[t][name] == kUnseen || seen[t][name] == seen[0][name]);
+            }
+        }
+    }
+
+    {
+        // a released name is gone and its id handed out again, unless it was pinned
+        Interner interner;
+        assert(interner.acquire("a") == 0 && interner.acquire("b") == 1 && interner.acquire("a") == 0);
+        assert(!interner.release(0) && interner.name(0) == "a");
+        assert(interner.release(0) && !interner.find("a") && interner.names() == 1);
+        assert(interner.acquire("c") == 0 && interner.name(0) == "c" && interner.size() == 2);
+        assert(interner.intern("b") == 1 && !interner.release(1) && interner.find("b") == 1u);
+        const std::size_t held = interner.memory_bytes();
+        for (int i = 0; i < 100000; ++i) {
+            const std::uint32_t id = interner.acquire("name-" + std::to_string(i));
+            assert(id == 2 && interner.release(id));
+        }
+        assert(interner.size() == 3 && interner.memory_bytes() == held);
+
+        // free ids stay free across a snapshot
+        interner.release(0);
+        std::ostringstream out;
+        interner.snapshot(out);
+        Interner restored;
+        std::istringstream in(out.str());
+        restored.restore(in);
+        assert(restored.size() == 3 && restored.names() == 1 && restored.find("b") == 1u && !restored.find("c"));
+        assert(restored.acquire("d") != 1 && restored.acquire("e") != 1 && restored.size() == 3);
+    }
+
+    {
+        // names acquired and released from many threads, colliding in shards
+        constexpr int kThreads = 4;
+        Interner interner;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&interner, t]() {
+                for (int i = 0; i < 20000; ++i) {
+                    const std::string name = "n-" + std::to_string((i + t) % 50);
+                    const std::uint32_t id = interner.acquire(name);
+                    assert(interner.name(id) == name);
+                    interner.release(id);
+                }
+            });
+        }
+        for (std::thread &thread: threads) thread.join();
+        assert(interner.names() == 0 && interner.size() <= 50 * kThreads);
+    }
+    return 0;
+}
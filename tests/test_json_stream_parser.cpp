@@ -0,0 +1,191 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/json_stream_parser.h>
+#include <beacon/schema_manager.h>
+#include <beacon/streaming_validator.h>
+#include <cassert>
+#include <random>
+#include <string>
+
+namespace {
+    using beacon::json_stream::DomBuilder;
+    using beacon::json_stream::JsonStreamParser;
+
+    nlohmann::json random_value(std::mt19937 &rng, int depth) {
+        switch (rng() % (depth > 3 ? 5 : 7)) {
+            case 0: return nullptr;
+            case 1: return rng() % 2 == 0;
+            case 2: return static_cast<std::int64_t>(rng()) - (1LL << 31);
+            case 3: return std::ldexp(static_cast<double>(rng()), -static_cast<int>(rng() % 40));
+            case 4: {
+                std::string s;
+                const char alphabet[] = "ab \"\\/\n\t\x01";
+                for (std::size_t i = rng() % 6; i > 0; --i) s += alphabet[rng() % (sizeof(alphabet) - 1)];
+                if (rng() % 3 == 0) s += "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80"; // é € 😀
+                return s;
+            }
+            case 5: {
+                nlohmann::json array = nlohmann::json::array();
+                for (std::size_t i = rng() % 4; i > 0; --i) array.push_back(random_value(rng, depth + 1));
+                return array;
+            }
+            default: {
+                nlohmann::json object = nlohmann::json::object();
+                for (std::size_t i = rng() % 4; i > 0; --i) {
+                    object["k" + std::to_string(rng() % 8)] = random_value(rng, depth + 1);
+                }
+                return object;
+            }
+        }
+    }
+
+    /**
+     * Parses `text` fed in chunks of `chunk` bytes.
+     */
+    bool parse_chunked(const std::string &text, std::size_t chunk, nlohmann::json &out) {
+        DomBuilder dom;
+        JsonStreamParser parser(dom);
+        for (std::size_t i = 0; i < text.size(); i += chunk) {
+            if (!parser.feed(std::string_view(text).substr(i, chunk))) return false;
+        }
+        if (!parser.finish()) return false;
+        out = std::move(dom.result());
+        return true;
+    }
+
+    bool rejects(const std::string &text) {
+        nlohmann::json ignored;
+        return !parse_chunked(text, 1, ignored) && !parse_chunked(text, text.size() + 1, ignored);
+    }
+}
+
+int main() {
+    // every document survives being split at any position
+    std::mt19937 rng(42);
+    for (int round = 0; round < 300; ++round) {
+        const nlohmann::json expected = random_value(rng, 0);
+        const std::string text = expected.dump(round % 2 == 0 ? -1 : 2);
+        for (std::size_t chunk = 1; chunk <= text.size(); chunk += 1 + chunk / 4) {
+            nlohmann::json parsed;
+            assert(parse_chunked(text, chunk, parsed));
+            assert(parsed == expected);
+        }
+    }
+
+    // escapes, surrogate pairs and large numbers
+    nlohmann::json parsed;
+    assert(parse_chunked(R"(["\u00e9\ud83d\ude00\n", 18446744073709551615, -9223372036854775808, 1e300, 0.5e-3, )"
+                         R"(18446744073709551616, 1e-400])", 3, parsed));
+    assert(parsed[0] == "\xc3\xa9\xf0\x9f\x98\x80\n");
+    assert(parsed[1] == 18446744073709551615ULL);
+    assert(parsed[2] == INT64_MIN);
+    assert(parsed[4] == 0.5e-3);
+    assert(parsed[5] == 18446744073709551616.0 && parsed[6] == 0.0);
+    assert(parse_chunked(" 12 ", 1, parsed) && parsed == 12);
+
+    for (const char *bad: {
+             "", "{", "[1,]", "{\"a\" 1}", "{\"a\":1,}", "01", "-", "1.", "1e", "+1", "tru", "nul1",
+             "\"abc", "\"\x01\"", "\"\\x\"", "\"\\ud83d\"", "\"\\ude00\"", "\"\xc0\xaf\"",
+             "\"\xed\xa0\x80\"", "\"\xe2\x82\"", "\"\xf4\x90\x80\x80\"", "[1] 2", "{\"a\":1]", "[}",
+             // numbers that overflow a double, as nlohmann::json rejects them
+             "1e923", "-1e400", "[1.8e308]"
+         }) {
+        assert(rejects(bad));
+    }
+    assert(rejects("1" + std::string(400, '0')));
+
+    // the first bad byte stops the parser, whatever follows is not looked at
+    {
+        DomBuilder dom;
+        JsonStreamParser parser(dom);
+        assert(parser.feed(R"({"op":"publish","payload":{"a":[1,2,)"));
+        assert(!parser.feed("}garbage"));
+        assert(parser.offset() == 36); // the stray "}"
+        assert(!parser.error().empty());
+        assert(!parser.feed("more"));
+    }
+    {
+        DomBuilder dom;
+        JsonStreamParser parser(dom, 4);
+        assert(parser.feed("[[[["));
+        assert(!parser.feed("["));
+    }
+
+    // payload fields are validated as soon as they are complete
+    beacon::SchemaManager schemas;
+    schemas.add("orders", beacon::SchemaManager::build({
+                    {"fields", {
+                        {"id", {{"type", "non_empty_string"}}},
+                        {"qty", {{"type", "integer"}, {"min", 1}}},
+                        {"note", {{"type", "string"}, {"required", false}}}
+                    }}
+                }));
+    beacon::validation::StreamingEventValidator validator(
+        [&schemas](const std::string &topic) { return schemas.find(topic); });
+    JsonStreamParser parser(validator);
+
+    assert(!parser.feed(R"({"op":"publish","topic":"orders","payload":{"qty":0,"id":")"));
+    assert(parser.error().empty());
+    assert(!validator.result());
+    assert(validator.result().path == "payload.qty");
+
+    // the topic may follow the payload
+    parser.reset();
+    validator.reset();
+    assert(parser.feed(R"({"op":"publish","payload":{"id":"","qty":3},)"));
+    assert(!parser.feed(R"("topic":"orders"})"));
+    assert(validator.result().path == "payload.id");
+
+    // required fields can only be checked at the end
+    parser.reset();
+    validator.reset();
+    assert(parser.feed(R"({"op":"publish","topic":"orders","payload":{"id":"x"}})"));
+    assert(parser.finish());
+    assert(!validator.finish());
+    assert(validator.result().error_message == "Missing required field 'qty'");
+
+    parser.reset();
+    validator.reset();
+    assert(parser.feed(R"({"op":"publish","topic":"orders","payload":{"id":"x","qty":2,"extra":[]}})"));
+    assert(parser.finish() && validator.finish());
+    assert(validator.message()["payload"]["qty"] == 2);
+
+    // batches are checked event by event
+    parser.reset();
+    validator.reset();
+    assert(parser.feed(R"({"op":"publish_batch","producer":"p","sequence":1,"events":[)"
+                       R"({"topic":"orders","payload":{"id":"a","qty":1}},{"topic":"other","payload":{}},)"));
+    assert(!parser.feed(R"({"payload":{"qty":-1},"topic":"orders"},)"));
+    assert(validator.result().path == "events[2].payload.qty");
+
+    parser.reset();
+    validator.reset();
+    assert(!parser.feed(R"({"op":"publish_batch","events":[{"topic":"orders","payload":{"id":"a"}},)"));
+    assert(validator.result().path == "events[0].payload");
+
+    // "events" makes a batch of publish_batch only; a publish is still checked as one event
+    parser.reset();
+    validator.reset();
+    assert(!parser.feed(R"({"op":"publish","topic":"orders","events":[],"payload":{"qty":"bypassed"}})"));
+    assert(validator.result().path == "payload.qty");
+
+    parser.reset();
+    validator.reset();
+    assert(parser.feed(R"({"events":[],"op":"publish","topic":"orders","payload":{"qty":"bypassed"}})"));
+    assert(parser.finish());
+    assert(!validator.finish());
+    assert(validator.result().path == "payload.qty");
+
+    parser.reset();
+    validator.reset();
+    assert(parser.feed(R"({"events":[{"topic":"orders","payload":{"id":"a","qty":1}}],"op":"publish_batch"})"));
+    assert(parser.finish() && validator.finish());
+
+    // topics without a schema are not validated
+    parser.reset();
+    validator.reset();
+    assert(parser.feed(R"({"op":"publish","topic":"other","payload":{"qty":"many"}})"));
+    assert(parser.finish() && validator.finish());
+    return 0;
+}
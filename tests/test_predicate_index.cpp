@@ -0,0 +1,147 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/predicate_index.h>
+#include <beacon/subscription_registry.h>
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <string>
+
+using beacon::filter::Filter;
+using beacon::filter::FilterError;
+using beacon::filter::PredicateIndex;
+using nlohmann::json;
+
+namespace {
+    json random_filter(std::mt19937 &rng) {
+        std::uniform_int_distribution<int> pick(0, 5);
+        json spec = json::object();
+        if (pick(rng) < 3) spec["region"] = "r" + std::to_string(pick(rng));
+        if (pick(rng) < 2) spec["tier"] = json{{"in", {pick(rng), pick(rng), 2.0}}};
+        const int range = pick(rng);
+        if (range == 0) spec["price"] = json{{"gte", pick(rng) * 10}, {"lt", pick(rng) * 20}};
+        if (range == 1) spec["price"] = json{{"gt", pick(rng) * 10}};
+        if (range == 2) spec["/nested/score"] = json{{"lte", pick(rng)}};
+        return spec;
+    }
+
+    json random_payload(std::mt19937 &rng) {
+        std::uniform_int_distribution<int> pick(0, 5);
+        json payload = {
+            {"region", "r" + std::to_string(pick(rng))},
+            {"tier", pick(rng)},
+            {"price", pick(rng) * 15 + 0.5}
+        };
+        if (pick(rng) < 4) payload["nested"] = {{"score", pick(rng)}};
+        return payload;
+    }
+} // namespace
+
+int main() {
+    // parsing
+    {
+        const Filter filter = beacon::filter::parse_filter(json::parse(
+            R"({"region":"eu","tier":{"in":["gold","silver","gold"]},"price":{"gte":10,"lt":20}})"));
+        assert(filter.size() == 4);
+        assert(beacon::filter::evaluate(filter, json::parse(R"({"region":"eu","tier":"gold","price":10})")));
+        assert(!beacon::filter::evaluate(filter, json::parse(R"({"region":"eu","tier":"gold","price":20})")));
+        assert(beacon::filter::value_key(json(5)) == beacon::filter::value_key(json(5.0)));
+        assert(beacon::filter::value_key(json(-5)) == beacon::filter::value_key(json(-5.0)));
+        assert(beacon::filter::value_key(json(0)) == beacon::filter::value_key(json(-0.0)));
+        assert(beacon::filter::value_key(json(5)) != beacon::filter::value_key(json(5.5)));
+        // ids past 2^53 stay apart
+        const Filter id = beacon::filter::parse_filter(json::parse(R"({"id":9007199254740993})"));
+        assert(beacon::filter::evaluate(id, json::parse(R"({"id":9007199254740993})")));
+        assert(!beacon::filter::evaluate(id, json::parse(R"({"id":9007199254740992})")));
+        assert(beacon::filter::value_key(json(std::uint64_t{18446744073709551615u})) !=
+               beacon::filter::value_key(json(std::uint64_t{18446744073709551614u})));
+
+        bool threw = false;
+        try {
+            beacon::filter::parse_filter(json::parse(R"({"price":{"gte":"ten"}})"));
+        } catch (const FilterError &) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    // the index agrees with direct evaluation while subscriptions come and go
+    {
+        std::mt19937 rng(42);
+        PredicateIndex index;
+        std::vector<Filter> filters;
+        std::vector<bool> live;
+        for (PredicateIndex::Slot slot = 0; slot < 2000; ++slot) {
+            filters.push_back(beacon::filter::parse_filter(random_filter(rng)));
+            index.add(slot, filters.back());
+            live.push_back(true);
+        }
+        for (PredicateIndex::Slot slot = 0; slot < 2000; slot += 3) {
+            index.remove(slot);
+            live[slot] = false;
+        }
+
+        std::vector<PredicateIndex::Slot> matched;
+        for (int i = 0; i < 500; ++i) {
+            const json payload = random_payload(rng);
+            matched.clear();
+            index.match(payload, matched);
+            std::sort(matched.begin(), matched.end());
+
+            std::vector<PredicateIndex::Slot> expected;
+            for (PredicateIndex::Slot slot = 0; slot < filters.size(); ++slot) {
+                if (live[slot] && beacon::filter::evaluate(filters[slot], payload)) expected.push_back(slot);
+            }
+            assert(matched == expected);
+        }
+    }
+
+    // fields nobody filters on any more are reused rather than piling up
+    {
+        PredicateIndex index;
+        index.add(0, beacon::filter::parse_filter(json{{"region", "eu"}}));
+        for (int i = 0; i < 1000; ++i) {
+            index.add(1, beacon::filter::parse_filter(json{{"f" + std::to_string(i), {{"gt", 1}}}}));
+            index.remove(1);
+        }
+        assert(index.field_ids() == 2);
+
+        index.add(1, beacon::filter::parse_filter(json{{"f7", {{"gt", 1}}}, {"region", "us"}}));
+        index.remove(0);
+        std::vector<PredicateIndex::Slot> matched;
+        index.match(json{{"region", "eu"}, {"f7", 5}, {"f8", 5}}, matched);
+        assert(matched.empty());
+        index.match(json{{"region", "us"}, {"f7", 5}}, matched);
+        assert((matched == std::vector<PredicateIndex::Slot>{1}));
+        assert(index.field_ids() == 2);
+    }
+
+    // registry slots are reused after removal and never leak matches
+    {
+        beacon::SubscriptionRegistry registry;
+        beacon::Subscription eu;
+        eu.connection = 1;
+        eu.topic = "orders";
+        eu.filter = beacon::filter::parse_filter(json{{"region", "eu"}});
+        const auto eu_id = registry.add(eu);
+
+        beacon::Subscription all;
+        all.connection = 2;
+        all.topic = "orders";
+        registry.add(all);
+
+        std::vector<const beacon::Subscription *> out;
+        registry.match("orders", json{{"region", "us"}}, out);
+        assert(out.size() == 1 && out[0]->connection == 2);
+
+        assert(!registry.remove(2, eu_id));
+        assert(registry.remove(1, eu_id));
+        registry.remove_connection(2);
+        assert(registry.size() == 0);
+        out.clear();
+        registry.match("orders", json{{"region", "eu"}}, out);
+        assert(out.empty());
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/priority_lanes.h>
+#include <cassert>
+#include <string>
+
+using beacon::Lane;
+using beacon::LaneScheduler;
+
+namespace {
+    std::string serve(LaneScheduler &lanes, int control, int bulk) {
+        std::string order;
+        while (control > 0 || bulk > 0) {
+            if (lanes.next(control > 0, bulk > 0) == Lane::Control) {
+                order += 'c';
+                --control;
+            } else {
+                order += 'b';
+                --bulk;
+            }
+        }
+        return order;
+    }
+} // namespace
+
+int main() {
+    // both busy: control first, in runs of control_weight per bulk_weight
+    LaneScheduler lanes(3, 1);
+    assert(serve(lanes, 7, 4) == "cccbcccbcbb");
+
+    // an idle lane leaves its share to the other
+    LaneScheduler bulk_only(3, 1);
+    assert(serve(bulk_only, 0, 5) == "bbbbb");
+    assert(serve(bulk_only, 2, 0) == "cc");
+
+    // a control item arriving behind a bulk backlog waits for bulk_weight items at most
+    LaneScheduler backlog(1, 2);
+    assert(serve(backlog, 0, 3) == "bbb");
+    assert(serve(backlog, 2, 5) == "cbbcbbb");
+
+    // zero weights are raised to one
+    LaneScheduler zero(0, 0);
+    assert(serve(zero, 2, 2) == "cbcb");
+    return 0;
+}
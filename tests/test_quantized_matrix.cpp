@@ -0,0 +1,162 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/quantized_matrix.h>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+using beacon::reco::EmbeddingMatrix;
+using beacon::reco::EmbeddingMetric;
+using beacon::reco::QuantizedConfig;
+using beacon::reco::QuantizedMatrix;
+using beacon::reco::Quantization;
+using beacon::reco::SimdLevel;
+
+namespace {
+    using Scored = std::vector<std::pair<float, std::uint32_t> >;
+
+    double recall(const Scored &expected, const Scored &got) {
+        std::set<std::uint32_t> wanted;
+        for (const auto &[score, row]: expected) wanted.insert(row);
+        std::size_t hits = 0;
+        for (const auto &[score, row]: got) hits += wanted.count(row);
+        return static_cast<double>(hits) / static_cast<double>(expected.size());
+    }
+
+    bool rejects(const QuantizedConfig &config) {
+        try {
+            QuantizedMatrix matrix(config);
+        } catch (const std::invalid_argument &) {
+            return true;
+        }
+        return false;
+    }
+} // namespace
+
+int main() {
+    assert(beacon::reco::parse_quantization("none") == Quantization::None);
+    assert(beacon::reco::parse_quantization("int8") == Quantization::Int8);
+    assert(beacon::reco::parse_quantization("pq") == Quantization::Product);
+    {
+        QuantizedConfig config;
+        assert(rejects(config));
+        config.dimension = 8;
+        config.quantization = Quantization::None;
+        assert(rejects(config));
+        config.quantization = Quantization::Product;
+        config.subspaces = 3;
+        assert(rejects(config));
+        config.subspaces = 0;
+        assert(QuantizedMatrix(config).config().subspaces == 2);
+    }
+
+    {
+        // values that are whole multiples of the scale come back exactly, odd dimension too
+        QuantizedConfig config;
+        config.dimension = 3;
+        QuantizedMatrix matrix(config);
+        const float a[] = {127.0f, 0.0f, -1.0f};
+        const float b[] = {0.0f, 2.0f, 0.0f};
+        matrix.set(5, a);
+        matrix.set(40, b);
+        assert(matrix.size() == 2 && matrix.contains(5) && !matrix.contains(6) && !matrix.contains(100));
+        assert((matrix.row(5) == std::vector<float>{127.0f, 0.0f, -1.0f}));
+        assert(matrix.row(6).empty());
+
+        const float query[] = {0.0f, 1.0f, 0.0f};
+        const Scored top = matrix.top_k(query, 5, EmbeddingMetric::Dot);
+        assert(top.size() == 2 && top[0].second == 40 && std::abs(top[0].first - 2.0f) < 1e-5f);
+        const Scored cosine = matrix.top_k(query, 1, EmbeddingMetric::Cosine);
+        assert(cosine.size() == 1 && cosine[0].second == 40 && std::abs(cosine[0].first - 1.0f) < 1e-5f);
+    }
+
+    {
+        // against float32 on random vectors, with every kernel
+        constexpr std::size_t kRows = 3000;
+        constexpr std::size_t kDimension = 32;
+        constexpr std::size_t k = 10;
+        std::mt19937 rng(7);
+        std::normal_distribution<float> value(0.0f, 1.0f);
+        std::vector<float> rows(kRows * kDimension);
+        for (float &v: rows) v = value(rng);
+        EmbeddingMatrix exact(kDimension);
+        for (std::uint32_t row = 0; row < kRows; ++row) exact.set(row, rows.data() + row * kDimension);
+        std::vector<std::vector<float> > queries(20, std::vector<float>(kDimension));
+        for (auto &query: queries) {
+            for (float &v: query) v = value(rng);
+        }
+
+        for (const EmbeddingMetric metric: {EmbeddingMetric::Dot, EmbeddingMetric::Cosine}) {
+            std::vector<Scored> reference;
+            for (const SimdLevel level: {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+                QuantizedConfig config;
+                config.dimension = kDimension;
+                config.simd = level;
+                QuantizedMatrix matrix(config);
+                for (std::uint32_t row = 0; row < kRows; ++row) matrix.set(row, rows.data() + row * kDimension);
+                assert(matrix.memory_bytes() * 3 < exact.memory_bytes());
+
+                double total = 0.0;
+                for (std::size_t q = 0; q < queries.size(); ++q) {
+                    const Scored got = matrix.top_k(queries[q].data(), k, metric);
+                    assert(got.size() == k);
+                    total += recall(exact.top_k(queries[q].data(), k, metric), got);
+                    // every kernel sums the same integers
+                    if (reference.size() <= q) reference.push_back(got);
+                    for (std::size_t i = 0; i < k; ++i) {
+                        const float difference = std::abs(got[i].first - reference[q][i].first);
+                        assert(difference <= 1e-5f * std::abs(got[i].first) + 1e-6f);
+                    }
+                }
+                assert(total / static_cast<double>(queries.size()) >= 0.8);
+            }
+        }
+
+        for (const SimdLevel level: {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+            QuantizedConfig config;
+            config.dimension = kDimension;
+            config.quantization = Quantization::Product;
+            config.train_rows = 1000;
+            config.simd = level;
+            QuantizedMatrix plain(config);
+            config.rerank = 4;
+            QuantizedMatrix reranked(config);
+            EmbeddingMatrix before(kDimension);
+            for (std::uint32_t row = 0; row < kRows; ++row) {
+                plain.set(row, rows.data() + row * kDimension);
+                reranked.set(row, rows.data() + row * kDimension);
+                if (row < 999) before.set(row, rows.data() + row * kDimension);
+                // scored exactly until the codebooks are trained
+                if (row == 998) {
+                    assert(!plain.trained());
+                    const Scored got = plain.top_k(queries[0].data(), k, EmbeddingMetric::Dot);
+                    const Scored expected = before.top_k(queries[0].data(), k, EmbeddingMetric::Dot);
+                    assert(got.size() == k && recall(expected, got) == 1.0);
+                    assert(std::abs(got[0].first - expected[0].first) < 1e-4f);
+                }
+            }
+            assert(plain.trained() && plain.size() == kRows && plain.row(17).size() == kDimension);
+            assert(plain.memory_bytes() * 4 < exact.memory_bytes());
+            assert(reranked.row(17) == exact.row(17));
+
+            double coded = 0.0;
+            double rescored = 0.0;
+            for (const auto &query: queries) {
+                const Scored expected = exact.top_k(query.data(), k, EmbeddingMetric::Dot);
+                coded += recall(expected, plain.top_k(query.data(), k, EmbeddingMetric::Dot));
+                const Scored got = reranked.top_k(query.data(), k, EmbeddingMetric::Dot);
+                rescored += recall(expected, got);
+                // re-ranked scores are the float32 ones
+                assert(std::abs(got[0].first - expected[0].first) < 1e-4f || got[0].second != expected[0].second);
+            }
+            coded /= static_cast<double>(queries.size());
+            rescored /= static_cast<double>(queries.size());
+            assert(coded >= 0.3 && rescored >= 0.8 && rescored >= coded);
+        }
+    }
+    return 0;
+}
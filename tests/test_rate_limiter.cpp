@@ -0,0 +1,114 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/rate_limiter.h>
+#include <atomic>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace beacon::ratelimit;
+
+static constexpr std::int64_t kSecond = 1'000'000'000;
+
+int main() {
+    // burst of 10, then refused until a token is refilled
+    {
+        TokenBucket bucket(Limit{100.0, 10.0});
+        std::int64_t retry = 0;
+        for (int i = 0; i < 10; ++i) assert(bucket.try_acquire(1, kSecond, retry));
+        assert(!bucket.try_acquire(1, kSecond, retry));
+        assert(retry == kSecond / 100);
+        assert(bucket.try_acquire(1, kSecond + retry, retry));
+    }
+
+    // oversized requests pass on a full bucket and leave it in debt
+    {
+        TokenBucket bucket(Limit{1000.0, 100.0});
+        std::int64_t retry = 0;
+        assert(bucket.try_acquire(500, kSecond, retry));
+        assert(!bucket.try_acquire(1, kSecond, retry));
+        assert(retry > 0);
+    }
+
+    // disabled buckets admit everything
+    {
+        TokenBucket bucket(Limit{});
+        std::int64_t retry = 0;
+        for (int i = 0; i < 1000; ++i) assert(bucket.try_acquire(1'000'000, 0, retry));
+    }
+
+    // a refused tenant check refunds the connection bucket
+    {
+        RateLimitConfig config;
+        config.connection_messages = Limit{1.0, 2.0};
+        auto tenant = std::make_shared<RateLimiter>(Limit{10.0, 1.0}, Limit{});
+        ConnectionRateLimiter limiter(config, tenant);
+        const auto now = Clock::now();
+        assert(limiter.admit(64, now));
+        assert(!limiter.admit(64, now)); // tenant exhausted
+        assert(limiter.admit(64, now + std::chrono::milliseconds(100)));
+        assert(!limiter.admit(64, now + std::chrono::milliseconds(200))); // connection exhausted
+    }
+
+    // a streamed message is charged once, its bytes fragment by fragment
+    {
+        RateLimitConfig config;
+        config.connection_messages = Limit{1.0, 1.0};
+        config.connection_bytes = Limit{100.0, 100.0};
+        ConnectionRateLimiter limiter(config, nullptr);
+        const auto now = Clock::now();
+        assert(limiter.admit_message(now));
+        assert(limiter.admit_bytes(60, now));
+        assert(!limiter.admit_bytes(60, now)); // bytes exhausted, the message stays charged
+        assert(limiter.admit_bytes(60, now + std::chrono::milliseconds(600)));
+        assert(!limiter.admit_message(now + std::chrono::milliseconds(600)));
+        assert(limiter.admit_bytes(0, now + std::chrono::milliseconds(600))); // nothing to charge
+    }
+
+    // concurrent acquirers never exceed the burst
+    {
+        TokenBucket bucket(Limit{1.0, 1000.0});
+        std::atomic<int> admitted{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&] {
+                std::int64_t retry = 0;
+                for (int i = 0; i < 1000; ++i) {
+                    if (bucket.try_acquire(1, kSecond, retry)) admitted.fetch_add(1);
+                }
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        assert(admitted.load() == 1000);
+    }
+
+    // tenants share one limiter per key
+    {
+        TenantRateLimiters tenants(Limit{5.0, 5.0}, Limit{});
+        assert(tenants.get("a") == tenants.get("a"));
+        assert(tenants.get("a") != tenants.get("b"));
+        TenantRateLimiters disabled{Limit{}, Limit{}};
+        assert(disabled.get("a") == nullptr);
+    }
+
+    // made-up keys cannot grow the tenants without bound, but a held limiter is never dropped
+    {
+        TenantRateLimiters tenants(Limit{5.0, 5.0}, Limit{}, 3);
+        const auto held = tenants.get("held");
+        const auto recent = tenants.get("recent");
+        for (int i = 0; i < 1000; ++i) tenants.get("random-" + std::to_string(i));
+        assert(tenants.size() == 3);
+        assert(tenants.get("held") == held && tenants.get("recent") == recent);
+
+        // with all of them held none goes, until one is let go
+        auto third = tenants.get("third");
+        const auto fourth = tenants.get("fourth");
+        assert(tenants.size() == 4);
+        third.reset();
+        tenants.get("fifth");
+        assert(tenants.size() == 4 && tenants.get("held") == held);
+    }
+    return 0;
+}
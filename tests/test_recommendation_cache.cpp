@@ -0,0 +1,187 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/recommendation_cache.h>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace beacon::reco;
+using namespace std::chrono_literals;
+
+int main() {
+    {
+        // results by user, context and model version, fresh for the soft TTL
+        RecommendationCacheConfig config;
+        config.soft_ttl = 10s;
+        config.hard_ttl = 60s;
+        RecommendationCache cache(config);
+        const RecommendationCache::Clock::time_point start{};
+        int computed = 0;
+        const auto compute = [&computed]() {
+            ++computed;
+            return std::vector<ScoredItem>{{"i" + std::to_string(computed), 1.0f}};
+        };
+        RecommendationCache::Result result = cache.get("alice", "10", 1, compute, start);
+        assert(computed == 1 && (*result)[0].item == "i1");
+        assert(cache.get("alice", "10", 1, compute, start + 5s) == result && computed == 1);
+        assert((*cache.get("alice", "5", 1, compute, start + 5s))[0].item == "i2");
+        assert((*cache.get("bob", "10", 1, compute, start + 5s))[0].item == "i3");
+        assert(cache.stats().entries == 3);
+
+        // a new model version replaces the result
+        assert((*cache.get("alice", "10", 2, compute, start + 5s))[0].item == "i4");
+        assert((*cache.get("alice", "10", 2, compute, start + 6s))[0].item == "i4");
+        assert(cache.stats().entries == 3);
+
+        // past the soft TTL the next request recomputes; past the hard TTL too
+        assert((*cache.get("bob", "10", 1, compute, start + 20s))[0].item == "i5");
+        assert((*cache.get("bob", "10", 1, compute, start + 25s))[0].item == "i5");
+        assert((*cache.get("bob", "10", 1, compute, start + 120s))[0].item == "i6");
+
+        // a user's event drops all of that user's results and no one else's
+        cache.invalidate("alice");
+        assert(cache.stats().entries == 1);
+        assert((*cache.get("alice", "10", 2, compute, start + 121s))[0].item == "i7");
+        assert((*cache.get("bob", "10", 1, compute, start + 121s))[0].item == "i6");
+        cache.invalidate("nobody");
+
+        const RecommendationCacheStats stats = cache.stats();
+        assert(stats.hits == 4 && stats.misses == 7 && stats.invalidations == 1 && stats.entries == 2);
+    }
+
+    {
+        // a full shard drops its least recently used user
+        RecommendationCacheConfig config;
+        config.shards = 1;
+        config.max_entries = 2;
+        RecommendationCache cache(config);
+        const auto compute = []() { return std::vector<ScoredItem>{{"x", 1.0f}}; };
+        cache.get("u1", "", 0, compute);
+        cache.get("u2", "", 0, compute);
+        cache.get("u1", "", 0, compute);
+        cache.get("u3", "", 0, compute);
+        assert(cache.stats().entries == 2 && cache.stats().hits == 1);
+        cache.get("u1", "", 0, compute);
+        assert(cache.stats().hits == 2);
+        cache.get("u2", "", 0, compute);
+        assert(cache.stats().hits == 2 && cache.stats().misses == 4);
+
+        bool rejected = false;
+        try {
+            config.soft_ttl = config.hard_ttl + 1s;
+            RecommendationCache invalid(config);
+        } catch (const std::invalid_argument &) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    {
+        // a user keeps max_contexts results, dropping the least recently used context
+        RecommendationCacheConfig config;
+        config.shards = 1;
+        config.max_contexts = 2;
+        RecommendationCache cache(config);
+        const auto compute = []() { return std::vector<ScoredItem>{{"x", 1.0f}}; };
+        for (int i = 0; i < 100; ++i) cache.get("flood", std::to_string(i), 0, compute);
+        assert(cache.stats().entries == 2);
+        cache.get("flood", "98", 0, compute);
+        cache.get("flood", "other", 0, compute);
+        cache.get("flood", "98", 0, compute);
+        assert(cache.stats().hits == 2 && cache.stats().entries == 2);
+        cache.get("flood", "99", 0, compute);
+        assert(cache.stats().hits == 2);
+    }
+
+    {
+        // failures reach every waiter and are not cached
+        RecommendationCache cache;
+        bool thrown = false;
+        try {
+            cache.get("alice", "", 0, []() -> std::vector<ScoredItem> { throw std::runtime_error("no model"); });
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(cache.get("alice", "", 0, []() { return std::vector<ScoredItem>(1); })->size() == 1);
+    }
+
+    {
+        // concurrent misses compute once; a stale result is served while it is recomputed
+        RecommendationCacheConfig config;
+        config.soft_ttl = 1s;
+        config.hard_ttl = 60s;
+        RecommendationCache cache(config);
+        const RecommendationCache::Clock::time_point start{};
+        std::atomic<int> computed{0};
+        std::atomic<bool> release{false};
+        const auto slow = [&computed, &release]() {
+            ++computed;
+            while (!release.load()) std::this_thread::yield();
+            return std::vector<ScoredItem>{{"v" + std::to_string(computed.load()), 1.0f}};
+        };
+        std::vector<std::thread> threads;
+        std::vector<std::string> seen(8);
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&, t]() { seen[t] = (*cache.get("alice", "10", 1, slow, start))[0].item; });
+        }
+        while (cache.stats().misses + cache.stats().coalesced < 8) std::this_thread::yield();
+        release = true;
+        for (std::thread &thread: threads) thread.join();
+        threads.clear();
+        assert(computed == 1 && cache.stats().coalesced == 7);
+        for (const std::string &item: seen) assert(item == "v1");
+
+        release = false;
+        std::thread refresher([&]() { seen[0] = (*cache.get("alice", "10", 1, slow, start + 2s))[0].item; });
+        while (computed < 2) std::this_thread::yield();
+        assert((*cache.get("alice", "10", 1, slow, start + 2s))[0].item == "v1");
+        assert(cache.stats().stale_hits == 1);
+        release = true;
+        refresher.join();
+        assert(seen[0] == "v2");
+        assert((*cache.get("alice", "10", 1, slow, start + 2s))[0].item == "v2" && computed == 2);
+    }
+
+    {
+        // wired to an engine, a user's results go once the engine has applied their event
+        beacon::RecommendationEngine engine;
+        RecommendationCache cache;
+        std::mutex mutex;
+        std::set<std::string> applied;
+        engine.set_on_applied([&](std::string_view user) {
+            {
+                const std::lock_guard lock(mutex);
+                applied.emplace(user);
+            }
+            cache.invalidate(user);
+        });
+        engine.add_interaction("u1", "a", 1.0f);
+        engine.add_interaction("u2", "a", 1.0f);
+        engine.add_interaction("u2", "b", 1.0f);
+        engine.flush();
+        {
+            const std::lock_guard lock(mutex);
+            assert((applied == std::set<std::string>{"u1", "u2"}));
+        }
+
+        const auto recommend = [&engine]() { return engine.recommend("u1", 10); };
+        const RecommendationCache::Result before = cache.get("u1", "10", engine.model_version(), recommend);
+        assert(before->size() == 1 && (*before)[0].item == "b");
+        assert(cache.get("u1", "10", engine.model_version(), recommend) == before);
+
+        const std::uint64_t invalidations = cache.stats().invalidations;
+        engine.add_interaction("u1", "b", 1.0f);
+        engine.flush();
+        assert(cache.stats().invalidations > invalidations);
+        assert(cache.get("u1", "10", engine.model_version(), recommend)->empty());
+    }
+    return 0;
+}
@@ -0,0 +1,458 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/recommendation_engine.h>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using beacon::RecommendationConfig;
+using beacon::RecommendationEngine;
+using beacon::reco::ScoredItem;
+using beacon::reco::Similarity;
+
+namespace {
+    bool near(double a, double b) {
+        return std::abs(a - b) < 1e-5;
+    }
+
+    RecommendationConfig with(Similarity similarity) {
+        RecommendationConfig config;
+        config.similarity = similarity;
+        return config;
+    }
+
+    // u1: a b, u2: a b c, u3: c d
+    void add_users(RecommendationEngine &engine) {
+        engine.add_interaction("u1", "a", 1.0f);
+        engine.add_interaction("u1", "b", 1.0f);
+        engine.add_interaction("u2", "a", 1.0f);
+        engine.add_interaction("u2", "b", 1.0f);
+        engine.add_interaction("u2", "c", 1.0f);
+        engine.add_interaction("u3", "c", 1.0f);
+        engine.add_interaction("u3", "d", 1.0f);
+    }
+} // namespace
+
+int main() {
+    assert(beacon::reco::parse_similarity("llr") == Similarity::LogLikelihood);
+    // independent items have no log-likelihood, associated ones do
+    assert(near(beacon::reco::log_likelihood_ratio(1, 2, 2, 4), 0.0));
+    assert(beacon::reco::log_likelihood_ratio(10, 10, 10, 1000) > 50.0);
+    assert(near(beacon::reco::jaccard(1, 2, 2), 1.0 / 3.0));
+
+    {
+        RecommendationEngine engine(with(Similarity::Cosine));
+        add_users(engine);
+        engine.flush();
+
+        std::vector<ScoredItem> similar = engine.similar_items("a", 10);
+        assert(similar.size() == 2);
+        assert(similar[0].item == "b" && near(similar[0].score, 1.0));
+        assert(similar[1].item == "c" && near(similar[1].score, 0.5));
+
+        // ties go to the item seen first
+        similar = engine.similar_items("c", 10);
+        assert(similar.size() == 3);
+        assert(similar[0].item == "d" && near(similar[0].score, 1.0 / std::sqrt(2.0)));
+        assert(similar[1].item == "a" && similar[2].item == "b");
+        assert(engine.similar_items("c", 1).size() == 1);
+        assert(engine.similar_items("unknown", 10).empty());
+
+        // seen items are left out
+        std::vector<ScoredItem> recommended = engine.recommend("u1", 10);
+        assert(recommended.size() == 1 && recommended[0].item == "c" && near(recommended[0].score, 1.0));
+        recommended = engine.recommend("u3", 10);
+        assert(recommended.size() == 2 && recommended[0].item == "a" && recommended[1].item == "b");
+        assert(engine.recommend("nobody", 10).empty());
+
+        const beacon::RecommendationStats stats = engine.stats();
+        assert(stats.interactions == 7 && stats.users == 3 && stats.items == 4);
+        assert(stats.model_version == 0);
+        // a-b, a-c, b-c, c-d, both ways
+        assert(stats.cooccurrences == 8);
+
+        // weights that would poison the scores are refused before they are queued
+        for (const float weight: {0.0f, -1.0f, std::nanf(""), std::numeric_limits<float>::infinity()}) {
+            bool rejected = false;
+            try {
+                engine.add_interaction("u1", "c", weight);
+            } catch (const std::invalid_argument &) {
+                rejected = true;
+            }
+            assert(rejected);
+        }
+        engine.flush();
+        assert(engine.stats().interactions == 7 && near(engine.similar_items("a", 10)[0].score, 1.0));
+    }
+
+    {
+        RecommendationEngine engine(with(Similarity::Jaccard));
+        add_users(engine);
+        engine.flush();
+        const std::vector<ScoredItem> similar = engine.similar_items("a", 10);
+        assert(similar.size() == 2 && near(similar[0].score, 1.0) && near(similar[1].score, 1.0 / 3.0));
+    }
+
+    {
+        RecommendationConfig config = with(Similarity::Cosine);
+        config.min_support = 2;
+        RecommendationEngine engine(config);
+        add_users(engine);
+        engine.flush();
+        const std::vector<ScoredItem> similar = engine.similar_items("a", 10);
+        assert(similar.size() == 1 && similar[0].item == "b");
+        assert(engine.similar_items("d", 10).empty());
+    }
+
+    {
+        // events: entity_id is the item, the payload names the user, a rating scales the weight
+        RecommendationEngine engine(with(Similarity::Cosine));
+        assert(engine.observe({{"event_type", "click"}, {"entity_id", "a"}, {"payload", {{"user_id", "u1"}}}}));
+        assert(engine.observe({{"event_type", "rating"}, {"entity_id", "b"},
+                               {"payload", {{"user_id", 7}, {"rating", 4}}}}));
+        assert(engine.observe({{"event_type", "view"}, {"entity_id", "b"}, {"payload", {{"user_id", "u1"}}}}));
+        assert(!engine.observe({{"event_type", "purchase"}, {"entity_id", "a"}, {"payload", {{"user_id", "u1"}}}}));
+        assert(!engine.observe({{"event_type", "view"}, {"entity_id", "a"}, {"payload", {{"other", "u1"}}}}));
+        assert(!engine.observe({{"event_type", "rating"}, {"entity_id", "a"},
+                                {"payload", {{"user_id", "u1"}, {"rating", 0}}}}));
+        assert(!engine.observe({{"entity_id", "a"}, {"payload", {{"user_id", "u1"}}}}));
+        engine.flush();
+        assert(engine.stats().interactions == 3 && engine.stats().users == 2);
+    }
+
+    {
+        // only a user's most recent items count; touching an item again makes it recent
+        RecommendationConfig config = with(Similarity::Cosine);
+        config.max_user_items = 2;
+        RecommendationEngine engine(config);
+        engine.add_interaction("u1", "x", 1.0f);
+        engine.add_interaction("u1", "y", 1.0f);
+        engine.add_interaction("u1", "x", 1.0f);
+        engine.add_interaction("u1", "z", 1.0f);
+        engine.flush();
+        assert(engine.similar_items("y", 10).empty());
+        const std::vector<ScoredItem> similar = engine.similar_items("x", 10);
+        assert(similar.size() == 1 && similar[0].item == "z");
+        // one user in common and no other: cosine 1, whatever the weights
+        assert(near(similar[0].score, 1.0));
+        // x-y was counted and taken back
+        assert(engine.stats().cooccurrences == 2);
+        engine.rebuild();
+        assert(engine.stats().model_version == 1);
+        assert(engine.similar_items("x", 10).size() == 1);
+    }
+
+    {
+        // Concurrent producers and several update threads end up where one thread applying
+        // the same interactions in order does, and where a full rebuild does.
+        const Similarity similarities[] = {Similarity::Cosine, Similarity::Jaccard, Similarity::LogLikelihood};
+        for (const Similarity similarity: similarities) {
+            RecommendationConfig config = with(similarity);
+            config.max_user_items = 8;
+            config.update_threads = 3;
+            RecommendationEngine live(config);
+            config.update_threads = 1;
+            RecommendationEngine serial(config);
+
+            auto interaction = [](int producer, int i) {
+                const int user = producer * 10 + (i * 3) % 10;
+                const int item = (i * i + producer) % 25;
+                return std::make_tuple("u" + std::to_string(user), "i" + std::to_string(item),
+                                       static_cast<float>(1 + i % 3));
+            };
+            std::vector<std::thread> producers;
+            for (int producer = 0; producer < 4; ++producer) {
+                producers.emplace_back([&live, &interaction, producer]() {
+                    for (int i = 0; i < 500; ++i) {
+                        auto [user, item, weight] = interaction(producer, i);
+                        live.add_interaction(user, item, weight);
+                    }
+                });
+            }
+            for (auto &producer: producers) producer.join();
+            // each producer has users of its own, so every user's interactions keep their order
+            for (int producer = 0; producer < 4; ++producer) {
+                for (int i = 0; i < 500; ++i) {
+                    auto [user, item, weight] = interaction(producer, i);
+                    serial.add_interaction(user, item, weight);
+                }
+            }
+            live.flush();
+            serial.rebuild();
+            assert(live.stats().interactions == 2000 && live.stats().cooccurrences == serial.stats().cooccurrences);
+
+            for (int item = 0; item < 25; ++item) {
+                const std::string name = "i" + std::to_string(item);
+                const std::vector<ScoredItem> expected = serial.similar_items(name, 100);
+                const std::vector<ScoredItem> got = live.similar_items(name, 100);
+                // ids, and so the order of ties, depend on which interaction came first
+                assert(got.size() == expected.size());
+                std::map<std::string, float> scores;
+                for (const ScoredItem &scored: expected) scores[scored.item] = scored.score;
+                for (const ScoredItem &scored: got) {
+                    assert(scores.count(scored.item) == 1 && std::abs(scores[scored.item] - scored.score) < 1e-4);
+                }
+                // a short list is the head of the long one, give or take a pending refresh
+                assert(live.similar_items(name, 3).size() == std::min<std::size_t>(3, got.size()));
+            }
+        }
+    }
+
+    {
+        // beyond max_queued, interactions are dropped rather than queued
+        RecommendationConfig config;
+        config.max_queued = 0;
+        RecommendationEngine engine(config);
+        engine.add_interaction("u1", "a", 1.0f);
+        engine.flush();
+        assert(engine.stats().dropped == 1 && engine.stats().interactions == 0);
+    }
+
+    {
+        // embeddings: searched by brute force, the item itself left out
+        RecommendationConfig config;
+        config.embedding_dimension = 2;
+        config.embedding_metric = beacon::reco::EmbeddingMetric::Cosine;
+        RecommendationEngine engine(config);
+        engine.set_embedding("a", {1.0f, 0.0f});
+        engine.set_embedding("b", {2.0f, 0.2f});
+        engine.set_embedding("c", {0.0f, 1.0f});
+        bool rejected = false;
+        try {
+            engine.set_embedding("d", {1.0f});
+        } catch (const std::invalid_argument &) {
+            rejected = true;
+        }
+        assert(rejected && engine.stats().embeddings == 3);
+
+        const std::vector<ScoredItem> similar = engine.similar_by_embedding("a", 1);
+        assert(similar.size() == 1 && similar[0].item == "b");
+        assert(engine.similar_by_embedding("a", 10).size() == 2);
+        assert(engine.similar_by_embedding("unknown", 10).empty());
+        const std::vector<ScoredItem> nearest = engine.nearest({0.0f, 3.0f}, 1);
+        assert(nearest.size() == 1 && nearest[0].item == "c" && near(nearest[0].score, 1.0));
+        assert(engine.nearest({1.0f}, 1).empty());
+    }
+
+    {
+        // the same through an HNSW index, saved and loaded by an engine that numbers items
+        // differently
+        RecommendationConfig config;
+        config.embedding_dimension = 2;
+        config.hnsw_m = 4;
+        RecommendationEngine engine(config);
+        engine.set_embeddings({{"a", {1.0f, 0.0f}}, {"b", {2.0f, 0.2f}}, {"c", {0.0f, 1.0f}}}, 2);
+        engine.set_embedding("d", {-1.0f, 0.0f});
+        assert(engine.stats().embeddings == 4);
+        assert(engine.similar_by_embedding("a", 1)[0].item == "b");
+        assert(engine.nearest({-1.0f, -0.1f}, 1)[0].item == "d");
+
+        const std::string path = (std::filesystem::temp_directory_path() / "beacon_test_embeddings.bin").string();
+        engine.save_embeddings(path);
+        RecommendationEngine restarted(config);
+        restarted.set_embedding("z", {0.0f, -1.0f});
+        restarted.load_embeddings(path);
+        assert(restarted.stats().embeddings == 4);
+        assert(restarted.similar_by_embedding("a", 1)[0].item == "b");
+        assert(restarted.nearest({0.1f, 1.0f}, 1)[0].item == "c");
+        assert(restarted.similar_by_embedding("z", 1).empty());
+
+        const auto refused = [](RecommendationEngine &target, const std::string &from) {
+            try {
+                target.load_embeddings(from);
+            } catch (const std::runtime_error &) {
+                return true;
+            }
+            return false;
+        };
+        // a brute force engine keeps its backend
+        RecommendationConfig brute = config;
+        brute.hnsw_m = 0;
+        RecommendationEngine unindexed(brute);
+        assert(refused(unindexed, path));
+
+        std::ifstream saved(path, std::ios::binary);
+        const std::string bytes((std::istreambuf_iterator<char>(saved)), std::istreambuf_iterator<char>());
+        saved.close();
+        const auto rewrite = [&path](const std::string &contents) {
+            std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+        };
+        // an oversized name length is corrupt, not the end of the names
+        std::string corrupt = bytes;
+        const std::uint32_t length = 1u << 21;
+        std::memcpy(corrupt.data() + 4, &length, sizeof(length));
+        rewrite(corrupt);
+        assert(refused(restarted, path));
+        // labels past the names would be other items, or none
+        std::string unnamed = bytes;
+        const std::uint32_t names = 1;
+        std::memcpy(unnamed.data(), &names, sizeof(names));
+        unnamed.erase(4 + 5, 3 * 5); // the names of b, c and d
+        rewrite(unnamed);
+        assert(refused(restarted, path));
+        std::filesystem::remove(path);
+
+        assert(refused(restarted, path) && restarted.stats().embeddings == 4);
+    }
+
+    {
+        // int8 embeddings rank like float ones here
+        RecommendationConfig config;
+        config.embedding_dimension = 2;
+        config.embedding_quantization = beacon::reco::Quantization::Int8;
+        RecommendationEngine engine(config);
+        engine.set_embedding("a", {1.0f, 0.0f});
+        engine.set_embedding("b", {2.0f, 0.2f});
+        engine.set_embedding("c", {0.0f, 1.0f});
+        assert(engine.stats().embeddings == 3);
+        const std::vector<ScoredItem> similar = engine.similar_by_embedding("a", 2);
+        assert(similar.size() == 2 && similar[0].item == "b" && similar[1].item == "c");
+        assert(std::abs(similar[0].score - 0.995f) < 0.01f);
+        assert(engine.nearest({0.0f, 3.0f}, 1)[0].item == "c");
+    }
+
+    {
+        // ALS factors from two taste groups recommend within the user's own group
+        RecommendationConfig config;
+        config.embedding_dimension = 8;
+        config.embedding_metric = beacon::reco::EmbeddingMetric::Dot;
+        config.update_threads = 2;
+        RecommendationEngine engine(config);
+        for (int user = 0; user < 40; ++user) {
+            const int first = user < 20 ? 0 : 10;
+            for (int i = 0; i < 6; ++i) {
+                engine.add_interaction("u" + std::to_string(user), "i" + std::to_string(first + (user * 3 + i * 7) % 10),
+                                       1.0f);
+            }
+        }
+        engine.flush();
+        assert(engine.recommend_by_factors("u0", 3).empty());
+
+        beacon::reco::AlsConfig als;
+        als.factors = 4;
+        bool rejected = false;
+        try {
+            engine.train_factors(als);
+        } catch (const std::invalid_argument &) {
+            rejected = true;
+        }
+        assert(rejected);
+
+        als.factors = 8;
+        als.iterations = 10;
+        als.regularization = 0.1f;
+        als.alpha = 10.0f;
+        als.threads = 2;
+        assert(engine.train_factors(als).size() == 10);
+        assert(engine.stats().interaction_bytes > 0);
+        assert(engine.stats().embeddings == 20);
+        for (const std::string user: {"u0", "u7", "u25", "u39"}) {
+            const std::vector<ScoredItem> top = engine.recommend_by_factors(user, 3);
+            assert(top.size() == 3);
+            const int id = std::stoi(user.substr(1));
+            assert((std::stoi(top[0].item.substr(1)) < 10) == (id < 20));
+            for (const ScoredItem &scored: top) {
+                for (int i = 0; i < 6; ++i) {
+                    assert(scored.item != "i" + std::to_string((id < 20 ? 0 : 10) + (id * 3 + i * 7) % 10));
+                }
+            }
+        }
+        assert(engine.recommend_by_factors("unknown", 3).empty());
+    }
+
+    {
+        // ids saved by one engine are handed out again by the next, and only to a fresh one
+        RecommendationEngine engine;
+        engine.add_interaction("u1", "b", 1.0f);
+        engine.add_interaction("u2", "a", 1.0f);
+        engine.add_interaction("u2", "b", 1.0f);
+        engine.flush();
+        const std::string path = (std::filesystem::temp_directory_path() / "beacon_test_ids.bin").string();
+        engine.save_ids(path);
+
+        RecommendationEngine restarted;
+        restarted.load_ids(path);
+        assert(restarted.stats().users == 2 && restarted.stats().items == 2);
+        restarted.add_interaction("u3", "a", 1.0f);
+        restarted.add_interaction("u3", "c", 1.0f);
+        restarted.add_interaction("u2", "a", 1.0f);
+        restarted.add_interaction("u2", "c", 1.0f);
+        restarted.flush();
+        assert(restarted.stats().users == 3 && restarted.stats().items == 3);
+        assert(restarted.similar_items("a", 5).size() == 1 && restarted.similar_items("a", 5)[0].item == "c");
+
+        bool rejected = false;
+        try {
+            restarted.load_ids(path);
+        } catch (const std::runtime_error &) {
+            rejected = true;
+        }
+        std::filesystem::remove(path);
+        assert(rejected && restarted.stats().items == 3);
+    }
+
+    {
+        // weights halve every half-life from when they happened, in popularity, histories and
+        // similarities alike, including across the epochs stored weights are rebased between
+        RecommendationConfig config;
+        config.decay_half_life = 3600.0;
+        RecommendationEngine engine(config);
+        const auto now = std::chrono::system_clock::now();
+        const auto half_lives = [](double n) {
+            return std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::duration<double>(3600.0 * n));
+        };
+        engine.add_interaction("u1", "fresh", 1.0f, now);
+        engine.add_interaction("u2", "hour", 1.0f, now - half_lives(1));
+        engine.add_interaction("u3", "day", 1.0f, now - half_lives(24));
+        engine.add_interaction("u4", "x", 1.0f, now - half_lives(10));
+        engine.add_interaction("u4", "y", 1.0f, now);
+        engine.add_interaction("u5", "x", 1.0f, now);
+        engine.add_interaction("u5", "x2", 1.0f, now);
+        engine.add_interaction("u6", "y", 1.0f, now);
+        engine.add_interaction("u6", "y2", 1.0f, now);
+        engine.flush();
+
+        std::vector<ScoredItem> popular = engine.popular(10);
+        const auto popularity = [&popular](const std::string &item) {
+            for (const ScoredItem &scored: popular) {
+                if (scored.item == item) return scored.score;
+            }
+            return -1.0f;
+        };
+        assert(std::abs(popularity("fresh") - 1.0f) < 1e-3f);
+        assert(std::abs(popularity("hour") - 0.5f) < 1e-3f);
+        assert(popularity("day") > 0.0f && popularity("day") < 1e-6f);
+        assert(popular[0].item == "y" && std::abs(popular[0].score - 2.0f) < 1e-3f);
+
+        const std::vector<ScoredItem> top = engine.recommend("u4", 2);
+        assert(top.size() == 2 && top[0].item == "y2" && top[1].item == "x2");
+        assert(top[1].score < top[0].score / 500.0f);
+
+        // far enough ahead to move the epoch on
+        engine.add_interaction("u7", "a", 1.0f, now);
+        engine.add_interaction("u7", "b", 1.0f, now);
+        engine.add_interaction("u8", "a", 1.0f, now + half_lives(40));
+        engine.add_interaction("u8", "c", 1.0f, now + half_lives(40));
+        engine.flush();
+        const std::vector<ScoredItem> similar = engine.similar_items("a", 2);
+        assert(similar.size() == 2 && similar[0].item == "c" && similar[1].item == "b");
+        assert(std::abs(similar[0].score - 1.0f) < 1e-3f);
+        popular = engine.popular(3);
+        assert(popular.size() == 3 && popular[0].item == "a" && popular[1].item == "c");
+        assert(std::abs(popular[0].score / popular[1].score - 1.0f) < 1e-3f);
+    }
+    return 0;
+}
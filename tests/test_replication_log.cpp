@@ -0,0 +1,63 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/replication_log.h>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using beacon::replication::ReplicationLog;
+
+int main() {
+    ReplicationLog log(4, 1024);
+    std::vector<ReplicationLog::Entry> out;
+
+    // an empty read marks the log as waited for, the next append reports it once
+    assert(log.read(0, 10, 1024, out) == 0);
+    assert(out.empty());
+    assert(log.append("e0"));
+    assert(!log.append("e1"));
+    assert(log.start() == 0 && log.end() == 2);
+
+    assert(log.read(0, 10, 1024, out) == 0);
+    assert(out.size() == 2 && *out[0] == "e0" && *out[1] == "e1");
+
+    // the oldest events go beyond max_events; a dropped offset reads from the start
+    for (int i = 2; i < 7; ++i) log.append("e" + std::to_string(i));
+    assert(log.start() == 3 && log.end() == 7);
+    out.clear();
+    assert(log.read(1, 2, 1024, out) == 3);
+    assert(out.size() == 2 && *out[0] == "e3" && *out[1] == "e4");
+
+    // batches are cut by bytes, but hold at least one event
+    out.clear();
+    assert(log.read(5, 10, 3, out) == 5);
+    assert(out.size() == 1 && *out[0] == "e5");
+    out.clear();
+    assert(log.read(5, 10, 4, out) == 5);
+    assert(out.size() == 2);
+
+    // caught up: nothing to read
+    out.clear();
+    assert(log.read(7, 10, 1024, out) == 7);
+    assert(out.empty());
+    assert(log.append("e7"));
+
+    // and by max_bytes, keeping the newest event however large
+    ReplicationLog small(100, 10);
+    small.append("aaaa");
+    small.append("bbbb");
+    small.append("cccc");
+    assert(small.start() == 1 && small.end() == 3);
+    small.append(std::string(50, 'x'));
+    assert(small.start() == 3 && small.end() == 4);
+
+    // a reset renumbers from the given offset
+    small.reset(100);
+    assert(small.start() == 100 && small.end() == 100);
+    small.append("f");
+    out.clear();
+    assert(small.read(0, 10, 1024, out) == 100);
+    assert(out.size() == 1 && *out[0] == "f");
+    return 0;
+}
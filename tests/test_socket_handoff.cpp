@@ -0,0 +1,189 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/socket_handoff.h>
+#include <beacon/websocket_adapter.h>
+#include <arpa/inet.h>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace beacon::handoff;
+
+namespace {
+    int listen_on_loopback() {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        assert(::bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0);
+        assert(::listen(fd, 8) == 0);
+        return fd;
+    }
+
+    std::uint16_t port_of(int fd) {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        assert(::getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) == 0);
+        return ntohs(address.sin_port);
+    }
+
+    // connects to the port and returns the connection `listener` accepts for it
+    int accept_one(int listener) {
+        const int client = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port_of(listener));
+        assert(::connect(client, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0);
+        const int accepted = ::accept(listener, nullptr, nullptr);
+        ::close(client);
+        return accepted;
+    }
+
+    bool is_open(int fd) {
+        return ::fcntl(fd, F_GETFD) != -1;
+    }
+
+    template<typename F>
+    bool fails(F &&f) {
+        try {
+            f();
+        } catch (const HandoffError &) {
+            return true;
+        }
+        return false;
+    }
+} // namespace
+
+int main() {
+    {
+        // listening sockets cross a socketpair and keep accepting on the other side
+        int pair[2];
+        assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+        const std::vector<int> listeners = {listen_on_loopback(), listen_on_loopback()};
+        send_fds(pair[0], listeners);
+        const std::vector<int> received = receive_fds(pair[1]);
+        assert(received.size() == 2);
+        for (std::size_t i = 0; i < received.size(); ++i) {
+            assert(received[i] != listeners[i] && port_of(received[i]) == port_of(listeners[i]));
+            assert((::fcntl(received[i], F_GETFD) & FD_CLOEXEC) != 0);
+            ::close(listeners[i]);
+            const int accepted = accept_one(received[i]);
+            assert(accepted >= 0);
+            ::close(accepted);
+            ::close(received[i]);
+        }
+        ::close(pair[0]);
+        ::close(pair[1]);
+    }
+
+    {
+        // bad counts are refused before anything is sent
+        int pair[2];
+        assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+        assert(fails([&]() { send_fds(pair[0], {}); }));
+        assert(fails([&]() { send_fds(pair[0], std::vector<int>(kMaxDescriptors + 1, pair[0])); }));
+
+        // a peer that hangs up sends nothing
+        ::close(pair[0]);
+        assert(fails([&]() { receive_fds(pair[1]); }));
+        ::close(pair[1]);
+    }
+
+    {
+        // a count byte without descriptors, or announcing more than came, fails and leaks nothing
+        int pair[2];
+        assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0);
+        const char two = 2;
+        assert(::write(pair[0], &two, 1) == 1);
+        assert(fails([&]() { receive_fds(pair[1]); }));
+
+        const int listener = listen_on_loopback();
+        char three = 3;
+        iovec iov{&three, 1};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &listener, sizeof(int));
+        assert(::sendmsg(pair[0], &msg, 0) == 1);
+        // the descriptor it would have received is the lowest free one; it must be closed again
+        const int probe = ::dup(0);
+        ::close(probe);
+        assert(fails([&]() { receive_fds(pair[1]); }));
+        assert(!is_open(probe));
+        ::close(listener);
+        ::close(pair[0]);
+        ::close(pair[1]);
+    }
+
+    {
+        // the full exchange against a predecessor serving the handoff socket
+        const std::string path = "/tmp/beacon-handoff-test-" + std::to_string(::getpid());
+        assert(take_over(path).empty());
+
+        const int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        ::unlink(path.c_str());
+        assert(::bind(server, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0);
+        assert(::listen(server, 1) == 0);
+        const int listener = listen_on_loopback();
+        char ready = 0;
+        std::thread predecessor([&]() {
+            const int connection = ::accept(server, nullptr, nullptr);
+            char hello = 0;
+            assert(::read(connection, &hello, 1) == 1 && hello == kHello);
+            send_fds(connection, {listener});
+            assert(::read(connection, &ready, 1) == 1);
+            ::close(connection);
+        });
+        const std::vector<int> taken = take_over(path);
+        predecessor.join();
+        assert(ready == kReady && taken.size() == 1 && port_of(taken[0]) == port_of(listener));
+        ::close(listener);
+        const int accepted = accept_one(taken[0]);
+        assert(accepted >= 0);
+        ::close(accepted);
+        ::close(taken[0]);
+        ::close(server);
+        ::unlink(path.c_str());
+    }
+
+    {
+        // an adapter that handed its sockets off says so once run() returns
+        const std::string path = "/tmp/beacon-handoff-adapter-test-" + std::to_string(::getpid());
+        beacon::WebSocketAdapter adapter;
+        adapter.adopt(listen_on_loopback());
+        adapter.enable_handoff(path, std::chrono::seconds(0));
+        assert(!adapter.handed_off());
+        std::thread predecessor([&adapter]() { adapter.run(); });
+        std::vector<int> taken;
+        for (int attempt = 0; taken.empty() && attempt < 100; ++attempt) {
+            taken = take_over(path);
+            if (taken.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        predecessor.join();
+        assert(taken.size() == 1 && adapter.handed_off());
+        ::close(taken[0]);
+        ::unlink(path.c_str());
+    }
+    return 0;
+}
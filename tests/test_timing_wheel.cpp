@@ -0,0 +1,88 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/timing_wheel.h>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using beacon::timing::TimingWheel;
+
+int main() {
+    // timers fire at the first advance past their deadline, never before
+    {
+        std::mt19937_64 rng(7);
+        const std::uint64_t start = 1'700'000'000'000ull;
+        TimingWheel<std::uint64_t> wheel(start, 1);
+        std::vector<std::uint64_t> deadlines;
+        for (std::uint64_t i = 0; i < 20000; ++i) {
+            // spread over a few levels, including ones already due
+            const std::uint64_t deadline = start + rng() % 300000 - 1000;
+            deadlines.push_back(deadline);
+            wheel.schedule(deadline, i);
+        }
+        assert(wheel.size() == deadlines.size());
+
+        std::vector<bool> fired(deadlines.size(), false);
+        std::uint64_t now = start;
+        std::uint64_t previous = start;
+        while (!wheel.empty()) {
+            previous = now;
+            now += 1 + rng() % 97;
+            wheel.advance(now, [&](std::uint64_t id) {
+                assert(!fired[id]);
+                assert(deadlines[id] <= now);
+                assert(deadlines[id] > previous || deadlines[id] <= start);
+                fired[id] = true;
+            });
+        }
+        for (const bool f: fired) assert(f);
+    }
+
+    // deadlines beyond the current block wait in the overflow and still fire on time
+    {
+        const std::uint64_t block = TimingWheel<int>::kBlockTicks;
+        TimingWheel<int> wheel(block - 10, 1);
+        wheel.schedule(block + 5, 1);
+        wheel.schedule(3 * block + 1, 2);
+        wheel.schedule(block - 5, 3);
+
+        std::vector<int> order;
+        auto record = [&order](int value) { order.push_back(value); };
+        wheel.advance(block - 5, record);
+        assert(order == std::vector<int>{3});
+        wheel.advance(block + 4, record);
+        assert(order.size() == 1);
+        wheel.advance(block + 5, record);
+        assert((order == std::vector<int>{3, 1}));
+        wheel.advance(3 * block, record);
+        assert(order.size() == 2);
+        wheel.advance(3 * block + 1, record);
+        assert((order == std::vector<int>{3, 1, 2}));
+        assert(wheel.empty());
+    }
+
+    // coarse ticks round deadlines up, and expired nodes are reused
+    {
+        TimingWheel<std::string> wheel(1000, 10);
+        wheel.schedule(1001, "a");
+        std::vector<std::string> seen;
+        wheel.advance(1009, [&seen](std::string &&value) { seen.push_back(std::move(value)); });
+        assert(seen.empty());
+        wheel.advance(1010, [&seen](std::string &&value) { seen.push_back(std::move(value)); });
+        assert(seen.size() == 1 && seen[0] == "a");
+
+        // a timer scheduled from the callback for a past deadline fires on the next advance
+        wheel.schedule(1020, "b");
+        wheel.advance(1020, [&wheel, &seen](std::string &&value) {
+            seen.push_back(value);
+            if (value == "b") wheel.schedule(0, "c");
+        });
+        wheel.advance(1020, [&seen](std::string &&value) { seen.push_back(std::move(value)); });
+        assert((seen == std::vector<std::string>{"a", "b", "c"}));
+        assert(wheel.now_ms() == 1020);
+    }
+    return 0;
+}
@@ -0,0 +1,158 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/trending.h>
+#include <cassert>
+#include <chrono>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace beacon::trending;
+using namespace std::chrono_literals;
+
+int main() {
+    {
+        // estimates never fall short, and sketches add and subtract exactly
+        CountMinSketch sketch(64, 4);
+        CountMinSketch other(64, 4);
+        std::map<std::uint64_t, std::uint32_t> truth;
+        std::mt19937_64 random(7);
+        for (int i = 0; i < 5000; ++i) {
+            const std::uint64_t hash = random() % 300 * 0x9e3779b97f4a7c15ULL;
+            sketch.add(hash);
+            ++truth[hash];
+        }
+        for (const auto &[hash, count]: truth) assert(sketch.estimate(hash) >= count);
+        other.add(0x1234, 5);
+        sketch.add(other);
+        assert(sketch.estimate(0x1234) >= 5);
+        sketch.subtract(other);
+        for (const auto &[hash, count]: truth) assert(sketch.estimate(hash) >= count);
+        sketch.clear();
+        assert(sketch.estimate(truth.begin()->first) == 0);
+    }
+
+    {
+        // every item counted more than N / capacity times is held, its count within its error
+        SpaceSaving heavy(10);
+        std::map<std::string, std::uint32_t> truth;
+        std::mt19937 random(3);
+        for (int i = 0; i < 20000; ++i) {
+            // a few heavy items over a long tail
+            const int pick = random() % 4 == 0 ? static_cast<int>(random() % 1000) : static_cast<int>(random() % 5);
+            const std::string item = "i" + std::to_string(pick);
+            heavy.add(item, pick);
+            ++truth[item];
+        }
+        assert(heavy.entries().size() == 10);
+        std::uint64_t held = 0;
+        for (const SpaceSaving::Entry &entry: heavy.entries()) {
+            assert(entry.count >= truth[entry.item] && entry.count - entry.error <= truth[entry.item]);
+            held += entry.count;
+        }
+        assert(held == 20000);
+        for (int pick = 0; pick < 5; ++pick) {
+            bool found = false;
+            for (const SpaceSaving::Entry &entry: heavy.entries()) {
+                found = found || entry.item == "i" + std::to_string(pick);
+            }
+            assert(found);
+        }
+        heavy.clear();
+        assert(heavy.entries().empty());
+    }
+
+    {
+        // windows slide a bucket at a time, per event type and category
+        TrendingConfig config;
+        config.windows = {{"1m", 1min, 6}, {"1h", 1h, 6}};
+        TrendingTracker trending(config);
+        const Clock::time_point start{std::chrono::hours(24 * 365 * 50)};
+        for (int i = 0; i < 30; ++i) trending.add("view", "shoes", "boot", start);
+        for (int i = 0; i < 20; ++i) trending.add("view", "hats", "cap", start + 12s);
+        for (int i = 0; i < 10; ++i) trending.add("click", "shoes", "sandal", start + 15s);
+
+        std::vector<TrendingItem> top = trending.top("", "", "1m", 10, start + 20s);
+        assert(top.size() == 3 && top[0].item == "boot" && top[1].item == "cap" && top[2].item == "sandal");
+        assert(top[0].count == 30 && top[1].count == 20 && top[2].count == 10);
+        top = trending.top("view", "", "1m", 10, start + 20s);
+        assert(top.size() == 2 && top[0].item == "boot");
+        top = trending.top("", "shoes", "1m", 1, start + 20s);
+        assert(top.size() == 1 && top[0].item == "boot");
+        top = trending.top("click", "shoes", "1m", 10, start + 20s);
+        assert(top.size() == 1 && top[0].item == "sandal" && top[0].count == 10);
+        assert(trending.top("click", "hats", "1m", 10, start + 20s).empty());
+        assert(trending.streams() == 8);
+
+        // a minute on, the first bucket has left the short window but not the long one
+        for (int i = 0; i < 25; ++i) trending.add("view", "hats", "beanie", start + 65s);
+        top = trending.top("", "", "1m", 10, start + 65s);
+        assert(top.size() == 3 && top[0].item == "beanie" && top[1].item == "cap" && top[2].item == "sandal");
+        top = trending.top("", "", "1h", 10, start + 65s);
+        assert(top.size() == 4 && top[0].item == "boot" && top[1].item == "beanie");
+        // late events count where they belong, and too late ones not at all
+        for (int i = 0; i < 30; ++i) trending.add("view", "hats", "cap", start + 20s);
+        trending.add("view", "hats", "fedora", start - 10min);
+        top = trending.top("", "", "1m", 10, start + 65s);
+        assert(top[0].item == "cap" && top[0].count == 50);
+        top = trending.top("", "", "1h", 10, start + 2h);
+        assert(top.empty());
+        assert(trending.memory_bytes() > 0);
+
+        bool rejected = false;
+        try {
+            trending.top("", "", "1d", 10);
+        } catch (const std::invalid_argument &) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    {
+        // published events count by their type and payload category; streams are capped
+        TrendingConfig config;
+        config.max_streams = 4;
+        TrendingTracker trending(config);
+        assert(trending.observe({{"event_type", "view"}, {"entity_id", "a"}, {"payload", {{"category", "books"}}}}));
+        assert(trending.observe({{"event_type", "view"}, {"entity_id", "b"}, {"payload", {{"category", 7}}}}));
+        assert(!trending.observe({{"entity_id", "a"}}));
+        assert(trending.streams() == 4);
+        assert(trending.top("view", "books", "5m", 5).size() == 1);
+        assert(trending.top("", "", "5m", 5).size() == 2);
+        assert(trending.top("", "7", "5m", 5).empty());
+
+        bool rejected = false;
+        try {
+            config.windows = {{"tiny", Clock::duration(3), 4}};
+            TrendingTracker invalid(config);
+        } catch (const std::invalid_argument &) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    {
+        // counting from several threads at once
+        TrendingTracker trending;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&trending, t]() {
+                for (int i = 0; i < 5000; ++i) {
+                    trending.add(t % 2 == 0 ? "view" : "click", "c" + std::to_string(i % 3),
+                                 "i" + std::to_string(i % 50));
+                    if (i % 500 == 0) trending.top("view", "", "1h", 10);
+                }
+            });
+        }
+        for (std::thread &thread: threads) thread.join();
+        const std::vector<TrendingItem> top = trending.top("", "", "24h", 50);
+        std::uint64_t total = 0;
+        for (const TrendingItem &item: top) total += item.count;
+        assert(top.size() == 50 && total >= 20000);
+    }
+    return 0;
+}
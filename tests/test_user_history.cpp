@@ -0,0 +1,172 @@
+//
+// Created by Henrique on 10/18/2026.
+//
+#include <beacon/user_history.h>
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace beacon::reco;
+
+namespace {
+    class FakeSource : public HistorySource {
+    public:
+        std::vector<RecentInteraction> rows;
+        std::size_t asked_per_user = 0;
+        std::size_t asked_users = 0;
+        std::uint64_t asked_since_ms = 0;
+
+        std::vector<RecentInteraction> load_recent_interactions(const std::string &user_field, std::size_t per_user,
+                                                                std::size_t users, std::uint64_t since_ms) override {
+            assert(user_field == "user_id");
+            asked_per_user = per_user;
+            asked_users = users;
+            asked_since_ms = since_ms;
+            return rows;
+        }
+    };
+
+    std::vector<std::string> items_of(const std::vector<RecentInteraction> &recent) {
+        std::vector<std::string> items;
+        for (const RecentInteraction &interaction: recent) items.push_back(interaction.item);
+        return items;
+    }
+} // namespace
+
+int main() {
+    {
+        // the last `capacity` interactions, most recent first
+        UserHistoryConfig config;
+        config.capacity = 3;
+        UserHistoryStore store(config);
+        store.add("alice", "a", "view", 1);
+        store.add("alice", "b", "click", 2);
+        assert((items_of(store.recent("alice", 10)) == std::vector<std::string>{"b", "a"}));
+        store.add("alice", "c", "view", 3);
+        store.add("alice", "d", "rating", 4);
+        store.add("bob", "a", "", 5);
+        const std::vector<RecentInteraction> recent = store.recent("alice", 10);
+        assert((items_of(recent) == std::vector<std::string>{"d", "c", "b"}));
+        assert(recent[0].user == "alice" && recent[0].event_type == "rating" && recent[0].at_ms == 4);
+        assert((items_of(store.recent("alice", 2)) == std::vector<std::string>{"d", "c"}));
+        assert(store.recent("bob", 5).size() == 1 && store.recent("bob", 5)[0].event_type.empty());
+        assert(store.recent("carol", 5).empty() && store.recent("alice", 0).empty());
+        assert(store.users() == 2 && store.evicted() == 0 && store.memory_bytes() > 0);
+    }
+
+    {
+        // published events are interactions when their payload names the user
+        UserHistoryStore store;
+        assert(store.observe({{"event_type", "view"}, {"entity_id", "a"}, {"payload", {{"user_id", "u1"}}}}));
+        assert(store.observe({{"entity_id", "b"}, {"payload", {{"user_id", 7}}}}));
+        assert(!store.observe({{"event_type", "view"}, {"entity_id", "a"}, {"payload", {{"other", "u1"}}}}));
+        assert(!store.observe({{"event_type", "view"}, {"payload", {{"user_id", "u1"}}}}));
+        assert(store.recent("u1", 5).size() == 1 && store.recent("u1", 5)[0].event_type == "view");
+        assert(store.recent("7", 5).size() == 1 && store.recent("7", 5)[0].item == "b");
+    }
+
+    {
+        // past the cap, the least recently active user of the stripe makes room
+        UserHistoryConfig config;
+        config.capacity = 4;
+        config.stripes = 1;
+        // three rings, three users and three items, and the event type
+        config.max_bytes = 3 * UserHistoryStore::ring_bytes(4) + 3 * UserHistoryStore::name_bytes("u1") +
+                           3 * UserHistoryStore::name_bytes("a") + UserHistoryStore::name_bytes("view");
+        UserHistoryStore store(config);
+        store.add("u1", "a", "view", 1);
+        store.add("u2", "a", "view", 2);
+        store.add("u3", "a", "view", 3);
+        store.add("u1", "b", "view", 4);
+        store.add("u4", "a", "view", 5);
+        assert(store.users() == 3 && store.evicted() == 1);
+        assert(store.recent("u2", 5).empty());
+        assert((items_of(store.recent("u1", 5)) == std::vector<std::string>{"b", "a"}));
+        assert(store.recent("u4", 5).size() == 1);
+        // an evicted user comes back with a fresh ring
+        store.add("u2", "c", "view", 6);
+        assert(store.evicted() == 2 && store.recent("u3", 5).empty());
+        assert((items_of(store.recent("u2", 5)) == std::vector<std::string>{"c"}));
+        assert(store.memory_bytes() <= config.max_bytes + 1024);
+
+        bool rejected = false;
+        try {
+            config.max_bytes = 10;
+            UserHistoryStore tiny(config);
+        } catch (const std::invalid_argument &) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+
+    {
+        // a warm start replays the source in its order, asking for what fits
+        UserHistoryConfig config;
+        config.capacity = 2;
+        config.stripes = 1;
+        config.max_bytes = 2 * UserHistoryStore::ring_bytes(2) + 2 * UserHistoryStore::name_bytes("u1") +
+                           3 * UserHistoryStore::name_bytes("a") + UserHistoryStore::name_bytes("view") +
+                           UserHistoryStore::name_bytes("click");
+        UserHistoryStore store(config);
+        FakeSource source;
+        source.rows = {
+            {"old", "x", "view", 1}, {"u1", "a", "view", 2}, {"u1", "b", "click", 3}, {"u2", "c", "view", 4}
+        };
+        assert(store.warm_start(source) == 4);
+        assert(source.asked_per_user == 2 && source.asked_users == config.max_bytes / UserHistoryStore::ring_bytes(2));
+        // only as far back as the lookback
+        const auto since = std::chrono::system_clock::now() - config.lookback;
+        const auto since_ms = std::chrono::duration_cast<std::chrono::milliseconds>(since.time_since_epoch()).count();
+        assert(source.asked_since_ms <= static_cast<std::uint64_t>(since_ms) &&
+               source.asked_since_ms + 60000 > static_cast<std::uint64_t>(since_ms));
+        assert(store.recent("old", 5).empty());
+        assert((items_of(store.recent("u1", 5)) == std::vector<std::string>{"b", "a"}));
+        assert(store.recent("u2", 5)[0].at_ms == 4);
+    }
+
+    {
+        // writers and readers on many threads
+        UserHistoryConfig config;
+        config.capacity = 8;
+        config.stripes = 4;
+        config.max_bytes = 4 * 50 * (8 * 16 + 20);
+        UserHistoryStore store(config);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&store, t]() {
+                for (int i = 0; i < 5000; ++i) {
+                    store.add("u" + std::to_string((i * 7 + t) % 300), "i" + std::to_string(i), "view",
+                              static_cast<std::uint64_t>(i));
+                    if (i % 10 == 0) assert(store.recent("u" + std::to_string(i % 300), 8).size() <= 8);
+                }
+            });
+        }
+        for (std::thread &thread: threads) thread.join();
+        assert(store.users() <= 200 && store.evicted() > 0);
+    }
+
+    {
+        // names of evicted users, and items no one refers to any more, are given back
+        UserHistoryConfig config;
+        config.capacity = 4;
+        config.stripes = 2;
+        config.max_bytes = 64 * 1024;
+        UserHistoryStore store(config);
+        for (int i = 0; i < 200000; ++i) {
+            store.add("user-" + std::to_string(i), "item-" + std::to_string(i), "view", static_cast<std::uint64_t>(i));
+        }
+        assert(store.evicted() > 199000);
+        assert(store.memory_bytes() <= config.max_bytes + 1024);
+        const std::size_t settled = store.memory_bytes();
+        for (int i = 200000; i < 400000; ++i) {
+            store.add("user-" + std::to_string(i), "item-" + std::to_string(i), "view", static_cast<std::uint64_t>(i));
+        }
+        assert(store.memory_bytes() <= settled + 1024);
+        assert((items_of(store.recent("user-399999", 5)) == std::vector<std::string>{"item-399999"}));
+        assert(store.recent("user-0", 5).empty());
+    }
+    return 0;
+}